@@ -26,6 +26,7 @@
 
 
 // 2) Define a macro to log messages
+#include "DvbLog.h"
 
 #define DVB_INFO   1
 #define DVB_DEBUG  2
@@ -36,11 +37,33 @@
 #define DVB_TRACE2 7
 #define DVB_TRACE3 8
 
+// Verbosity of a level, lower is more important. Usable in #if.
+#define DVB_LOG_VERBOSITY(level) \
+    ((level) == DVB_ERROR ? 0 : \
+     (level) == DVB_WARN ? 1 : \
+     (level) == DVB_INFO ? 2 : \
+     (level) == DVB_DEBUG ? 3 : \
+     (level) == DVB_TRACE ? 4 : \
+     (level) == DVB_TRACE1 ? 5 : \
+     (level) == DVB_TRACE2 ? 6 : 7)
+
+// Most verbose level compiled in, calls above it are removed by the compiler
+#ifndef DVB_LOG_MAX_LEVEL
+#define DVB_LOG_MAX_LEVEL DVB_DEBUG
+#endif
+
+#define DVB_LOG_COMPILED(level) (DVB_LOG_VERBOSITY(level) <= DVB_LOG_VERBOSITY(DVB_LOG_MAX_LEVEL))
+
+// The arguments are only evaluated if the level is enabled. Messages are written asynchronously
+// by DvbLog, see DvbLog.h.
 #define OS_LOG(level,format,...) \
+do \
 { \
-    fprintf(stderr, "%d:%s:",level,"INBSI"); \
-    fprintf(stderr, format,__VA_ARGS__); \
-}  
+    if(DVB_LOG_COMPILED(level) && DvbLog::isEnabled(DVB_LOG_VERBOSITY(level))) \
+    { \
+        DvbLog::getInstance().write(level, format, ##__VA_ARGS__); \
+    } \
+} while(0)
 
 #endif // _OSWRAP_H
 
@@ -0,0 +1,542 @@
+//
+// DVB_SI for Reference Design Kit (RDK)
+//
+// Copyright (C) 2015  Dmitry Barablin & Stan Partridge (stan.partridge@arris.com)
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+#include "BenchCorpus.h"
+
+// C system includes
+#include <string.h>
+
+// C++ system includes
+#include <algorithm>
+
+// Other libraries' includes
+
+// Project's includes
+#include "Crc32.h"
+#include "SiTable.h"
+#include "MpegDescriptor.h"
+
+#include "BenchRandom.h"
+
+using std::vector;
+using std::string;
+
+namespace
+{
+    enum
+    {
+        MAX_SECTION_SIZE = 1024,        //!< NIT, BAT, SDT
+        MAX_EIT_SECTION_SIZE = 4096,
+        FIRST_MJD = 0xE32A,             //!< 2017-11-29
+        NETWORK_ID = 0x2000,
+        ORIGINAL_NETWORK_ID = 0x2000
+    };
+
+    /**
+     * Section being built
+     */
+    class SectionWriter
+    {
+    public:
+        /**
+         * Start a section with the long header
+         */
+        void begin(uint8_t tableId, uint16_t extensionId, uint8_t version)
+        {
+            m_data.clear();
+            u8(tableId);
+            u16(0xf000);
+            u16(extensionId);
+            u8(0xc1 | (version << 1));
+            u8(0);      // section_number
+            u8(0);      // last_section_number
+        }
+
+        void u8(uint8_t v)
+        {
+            m_data.push_back(v);
+        }
+
+        void u16(uint16_t v)
+        {
+            m_data.push_back(v >> 8);
+            m_data.push_back(v & 0xff);
+        }
+
+        void bytes(const void* p, size_t len)
+        {
+            m_data.insert(m_data.end(), (const uint8_t*)p, (const uint8_t*)p + len);
+        }
+
+        void bytes(const SectionData_t& v)
+        {
+            m_data.insert(m_data.end(), v.begin(), v.end());
+        }
+
+        /**
+         * Write a 12 bit loop length (4 reserved bits set) at a position
+         */
+        void patchLength(size_t pos, size_t length)
+        {
+            m_data[pos] = 0xf0 | ((length >> 8) & 0x0f);
+            m_data[pos + 1] = length & 0xff;
+        }
+
+        size_t size() const
+        {
+            return m_data.size();
+        }
+
+        SectionData_t& data()
+        {
+            return m_data;
+        }
+
+    private:
+        SectionData_t m_data;
+    };
+
+    /**
+     * Set the section length and CRC_32 of a section
+     *
+     * @param s section without CRC_32
+     */
+    void finishSection(SectionData_t& s)
+    {
+        uint16_t length = s.size() - 3 + 4;
+        s[1] = (s[1] & 0xf0) | ((length >> 8) & 0x0f);
+        s[2] = length & 0xff;
+
+        uint32_t crc = Crc32::calculate(s.data(), s.size());
+        s.push_back(crc >> 24);
+        s.push_back(crc >> 16);
+        s.push_back(crc >> 8);
+        s.push_back(crc);
+    }
+
+    /**
+     * Number the sections of a sub-table and finish them
+     *
+     * @param sections sections without CRC_32
+     */
+    void finishSubTable(SubTableSections_t& sections)
+    {
+        for(size_t i = 0; i < sections.size(); i++)
+        {
+            sections[i][6] = i;
+            sections[i][7] = sections.size() - 1;
+            finishSection(sections[i]);
+        }
+    }
+
+    /**
+     * Append a descriptor
+     */
+    void addDescriptor(SectionData_t& out, DescriptorTag tag, const SectionData_t& body)
+    {
+        out.push_back((uint8_t)tag);
+        out.push_back(body.size());
+        out.insert(out.end(), body.begin(), body.end());
+    }
+
+    /**
+     * Append a descriptor with a name (network, bouquet)
+     */
+    void addNameDescriptor(SectionData_t& out, DescriptorTag tag, const string& name)
+    {
+        addDescriptor(out, tag, SectionData_t(name.begin(), name.end()));
+    }
+
+    /**
+     * Append an entry (transport stream, service) with its 12 bit descriptor loop length
+     *
+     * @param out entry list
+     * @param header entry fields before the loop length
+     * @param flags upper 4 bits of the loop length field
+     * @param descriptors descriptor loop
+     */
+    void addEntry(SectionData_t& out, const SectionData_t& header, uint8_t flags, const SectionData_t& descriptors)
+    {
+        out.insert(out.end(), header.begin(), header.end());
+        out.push_back((flags << 4) | ((descriptors.size() >> 8) & 0x0f));
+        out.push_back(descriptors.size() & 0xff);
+        out.insert(out.end(), descriptors.begin(), descriptors.end());
+    }
+
+    /**
+     * Encode a number as BCD
+     */
+    uint8_t bcd(uint32_t v)
+    {
+        return ((v / 10) << 4) | (v % 10);
+    }
+}
+
+/**
+ * Constructor. Builds the corpus.
+ *
+ * @param config network size
+ */
+BenchCorpus::BenchCorpus(const CorpusConfig& config)
+{
+    BenchRandom rnd(config.seed);
+    SectionWriter w;
+
+    uint32_t services = config.transports * config.servicesPerTransport;
+    uint32_t days = std::min(config.scheduleDays, 8u);
+
+    // Transport stream loop entries of the NIT (tuning + service list + channel numbers)
+    vector<SectionData_t> tsEntries;
+    for(uint32_t t = 0; t < config.transports; t++)
+    {
+        SectionData_t desc;
+
+        uint32_t freq = 3060000 + t * 80000;    // 306 MHz + 8 MHz steps, in 100 Hz
+        SectionData_t cable;
+        cable.push_back(bcd(freq / 1000000 % 100));
+        cable.push_back(bcd(freq / 10000 % 100));
+        cable.push_back(bcd(freq / 100 % 100));
+        cable.push_back(bcd(freq % 100));
+        cable.push_back(0xff); cable.push_back(0xf2);
+        cable.push_back(0x05);                                  // 256-QAM
+        cable.push_back(0x06); cable.push_back(0x95); cable.push_back(0x00); cable.push_back(0x0f);
+        addDescriptor(desc, DescriptorTag::CABLE_DELIVERY, cable);
+
+        SectionData_t list;
+        SectionData_t lcn;
+        for(uint32_t s = 0; s < config.servicesPerTransport; s++)
+        {
+            uint16_t sid = (t + 1) * 0x100 + s;
+            uint16_t number = t * config.servicesPerTransport + s + 1;
+            list.push_back(sid >> 8); list.push_back(sid & 0xff); list.push_back(rnd.range(0, 4) ? 0x01 : 0x02);
+            lcn.push_back(sid >> 8); lcn.push_back(sid & 0xff); lcn.push_back(0xfc | (number >> 8)); lcn.push_back(number & 0xff);
+        }
+        addDescriptor(desc, DescriptorTag::SERVICE_LIST, list);
+        addDescriptor(desc, DescriptorTag::LOGICAL_CHANNEL, lcn);
+
+        SectionData_t header = { (uint8_t)((t + 1) >> 8), (uint8_t)(t + 1), ORIGINAL_NETWORK_ID >> 8, ORIGINAL_NETWORK_ID & 0xff };
+        tsEntries.push_back(SectionData_t());
+        addEntry(tsEntries.back(), header, 0x0f, desc);
+    }
+
+    // NIT and BATs: name descriptor in the first loop, transport streams split over sections
+    for(uint32_t b = 0; b <= config.bouquets; b++)
+    {
+        bool nit = (b == 0);
+        string name = rnd.makeCodedText(rnd.spread(6, 20));
+        m_strings.push_back(name);
+
+        SectionData_t first;
+        addNameDescriptor(first, nit ? DescriptorTag::NETWORK_NAME : DescriptorTag::BOUQUET_NAME, name);
+
+        SubTableSections_t sections;
+        size_t next = 0;
+        while(next < tsEntries.size() || sections.empty())
+        {
+            w.begin(nit ? (uint8_t)TableId::NIT : (uint8_t)TableId::BAT, nit ? (uint16_t)NETWORK_ID : (uint16_t)(0x1000 + b), 0);
+            const SectionData_t& desc = sections.empty() ? first : SectionData_t();
+            w.u16(0xf000 | desc.size());
+            w.bytes(desc);
+            size_t loopPos = w.size();
+            w.u16(0);
+
+            // BATs list a subset of the transport streams
+            while(next < tsEntries.size() && w.size() + tsEntries[next].size() + 4 <= MAX_SECTION_SIZE)
+            {
+                if(nit || (next % (b + 1)) == 0)
+                {
+                    w.bytes(tsEntries[next]);
+                }
+                next++;
+            }
+            w.patchLength(loopPos, w.size() - loopPos - 2);
+            sections.push_back(w.data());
+        }
+        finishSubTable(sections);
+        (nit ? m_nit : m_bat).push_back(sections);
+    }
+
+    // SDT actual of every transport stream
+    vector<uint32_t> eitFlags;
+    for(uint32_t t = 0; t < config.transports; t++)
+    {
+        SubTableSections_t sections;
+        uint32_t s = 0;
+        while(s < config.servicesPerTransport || sections.empty())
+        {
+            w.begin((uint8_t)TableId::SDT, t + 1, 0);
+            w.u16(ORIGINAL_NETWORK_ID);
+            w.u8(0xff);
+
+            while(s < config.servicesPerTransport)
+            {
+                uint16_t sid = (t + 1) * 0x100 + s;
+                string provider = rnd.makeCodedText(rnd.spread(3, 12));
+                string name = rnd.makeCodedText(rnd.spread(4, 24));
+
+                SectionData_t body;
+                body.push_back(rnd.range(0, 4) ? 0x01 : 0x02);
+                body.push_back(provider.size());
+                body.insert(body.end(), provider.begin(), provider.end());
+                body.push_back(name.size());
+                body.insert(body.end(), name.begin(), name.end());
+
+                SectionData_t desc;
+                addDescriptor(desc, DescriptorTag::SERVICE, body);
+
+                SectionData_t entry;
+                SectionData_t header = { (uint8_t)(sid >> 8), (uint8_t)sid, 0xff };
+                bool scrambled = rnd.range(0, 2) == 0;
+                addEntry(entry, header, 0x8 | (scrambled ? 0x1 : 0), desc);
+                if(w.size() + entry.size() + 4 > MAX_SECTION_SIZE)
+                {
+                    break;
+                }
+
+                w.bytes(entry);
+                m_strings.push_back(provider);
+                m_strings.push_back(name);
+                s++;
+            }
+            sections.push_back(w.data());
+        }
+        finishSubTable(sections);
+        m_sdt.push_back(sections);
+    }
+
+    // EIT present/following and schedule of every service
+    for(uint32_t i = 0; i < services; i++)
+    {
+        uint32_t t = i / config.servicesPerTransport;
+        uint16_t sid = (t + 1) * 0x100 + i % config.servicesPerTransport;
+        uint16_t eventId = 1;
+
+        // Events of the service, 3 hour segments, 15 minutes to 2 hours long
+        vector<SectionData_t> segments[64];
+        uint32_t minutes = 0;
+        uint32_t totalMinutes = (days ? days : 1) * 24 * 60;
+        while(minutes < totalMinutes)
+        {
+            uint32_t duration = rnd.range(1, 8) * 15;
+            string name = rnd.makeCodedText(rnd.spread(8, 40));
+            string text = rnd.makeCodedText(rnd.spread(40, 200));
+            m_strings.push_back(name);
+            m_strings.push_back(text);
+
+            SectionData_t desc;
+            SectionData_t shortEvent = { 'e', 'n', 'g', (uint8_t)name.size() };
+            shortEvent.insert(shortEvent.end(), name.begin(), name.end());
+            shortEvent.push_back(text.size());
+            shortEvent.insert(shortEvent.end(), text.begin(), text.end());
+            addDescriptor(desc, DescriptorTag::SHORT_EVENT, shortEvent);
+
+            // Half of the events have a longer description
+            if(rnd.range(0, 1))
+            {
+                string ext = rnd.makeCodedText(rnd.spread(60, 240));
+                m_strings.push_back(ext);
+                SectionData_t extended = { 0x00, 'e', 'n', 'g', 0x00, (uint8_t)ext.size() };
+                extended.insert(extended.end(), ext.begin(), ext.end());
+                addDescriptor(desc, DescriptorTag::EXTENDED_EVENT, extended);
+            }
+
+            addDescriptor(desc, DescriptorTag::CONTENT_DESCRIPTOR, SectionData_t{ (uint8_t)(rnd.range(1, 10) << 4), 0x00 });
+            addDescriptor(desc, DescriptorTag::PARENTAL_RATING, SectionData_t{ 'G', 'B', 'R', (uint8_t)rnd.range(0, 15) });
+
+            uint16_t mjd = FIRST_MJD + minutes / (24 * 60);
+            uint32_t dayMinutes = minutes % (24 * 60);
+            SectionData_t header = { (uint8_t)(eventId >> 8), (uint8_t)eventId,
+                                     (uint8_t)(mjd >> 8), (uint8_t)mjd,
+                                     bcd(dayMinutes / 60), bcd(dayMinutes % 60), 0x00,
+                                     bcd(duration / 60), bcd(duration % 60), 0x00 };
+            SectionData_t entry;
+            addEntry(entry, header, minutes == 0 ? 0x8 : 0x2, desc);
+            segments[minutes / 180].push_back(entry);
+
+            eventId++;
+            minutes += duration;
+        }
+
+        // EIT p/f: the first two events
+        SubTableSections_t pf;
+        for(uint32_t n = 0; n < 2; n++)
+        {
+            w.begin((uint8_t)TableId::EIT_PF, sid, 0);
+            w.u16(t + 1);
+            w.u16(ORIGINAL_NETWORK_ID);
+            w.u8(1);
+            w.u8((uint8_t)TableId::EIT_PF);
+            w.bytes(segments[0][std::min<size_t>(n, segments[0].size() - 1)]);
+            pf.push_back(w.data());
+        }
+        finishSubTable(pf);
+        m_eitPf.push_back(pf);
+
+        // EIT schedule: 32 segments (4 days) per table_id, up to 8 sections per segment
+        if(days == 0)
+        {
+            continue;
+        }
+
+        uint32_t tables = (days + 3) / 4;
+        for(uint32_t tbl = 0; tbl < tables; tbl++)
+        {
+            uint8_t tableId = (uint8_t)TableId::EIT_SCHED_START + tbl;
+            SubTableSections_t sections;
+            vector<uint8_t> numbers;
+
+            // The last table_id only covers the remaining days
+            uint32_t segmentCount = std::min(32u, days * 8 - tbl * 32);
+            for(uint32_t seg = 0; seg < segmentCount; seg++)
+            {
+                const vector<SectionData_t>& events = segments[tbl * 32 + seg];
+                size_t firstSection = sections.size();
+                size_t next = 0;
+                do
+                {
+                    w.begin(tableId, sid, 0);
+                    w.u16(t + 1);
+                    w.u16(ORIGINAL_NETWORK_ID);
+                    w.u8(0);
+                    w.u8((uint8_t)TableId::EIT_SCHED_START + tables - 1);
+                    while(next < events.size() && w.size() + events[next].size() + 4 <= MAX_EIT_SECTION_SIZE)
+                    {
+                        w.bytes(events[next++]);
+                    }
+                    sections.push_back(w.data());
+                    numbers.push_back(seg * 8 + (sections.size() - 1 - firstSection));
+                }
+                while(next < events.size());
+
+                // segment_last_section_number
+                for(size_t k = firstSection; k < sections.size(); k++)
+                {
+                    sections[k][12] = numbers.back();
+                }
+            }
+
+            for(size_t k = 0; k < sections.size(); k++)
+            {
+                sections[k][6] = numbers[k];
+                sections[k][7] = numbers.back();
+                finishSection(sections[k]);
+            }
+            m_eitSched.push_back(sections);
+        }
+    }
+
+    // TOT with a local time offset for two regions
+    {
+        SectionData_t tot = { (uint8_t)TableId::TOT, 0x70, 0x00,
+                              (uint8_t)(FIRST_MJD >> 8), (uint8_t)FIRST_MJD, 0x12, 0x00, 0x00 };
+        SectionData_t lto;
+        const char* countries[] = { "GBR", "IRL" };
+        for(size_t c = 0; c < 2; c++)
+        {
+            lto.insert(lto.end(), countries[c], countries[c] + 3);
+            SectionData_t rest = { 0x02, 0x00, 0x00, 0xe3, 0x3c, 0x01, 0x00, 0x00, 0x01, 0x00, 0x00 };
+            lto.insert(lto.end(), rest.begin(), rest.end());
+        }
+        SectionData_t desc;
+        addDescriptor(desc, DescriptorTag::LOCAL_TIME_OFFSET, lto);
+        tot.push_back(0xf0 | (desc.size() >> 8));
+        tot.push_back(desc.size() & 0xff);
+        tot.insert(tot.end(), desc.begin(), desc.end());
+        finishSection(tot);
+        m_tot.push_back(SubTableSections_t(1, tot));
+    }
+
+    // Carousel: network level tables first, then the EITs service by service
+    const vector<SubTableSections_t>* groups[] = { &m_nit, &m_bat, &m_sdt, &m_tot, &m_eitPf, &m_eitSched };
+    for(size_t g = 0; g < sizeof(groups) / sizeof(groups[0]); g++)
+    {
+        for(auto it = groups[g]->begin(), end = groups[g]->end(); it != end; ++it)
+        {
+            m_carousel.insert(m_carousel.end(), it->begin(), it->end());
+        }
+    }
+}
+
+/**
+ * Get all the sub-tables of a table type
+ *
+ * @param tableId first table_id of the type (NIT, BAT, SDT, EIT_PF, EIT_SCHED_START, TOT)
+ * @return sub-tables
+ */
+const vector<SubTableSections_t>& BenchCorpus::getSubTables(uint8_t tableId) const
+{
+    switch(static_cast<TableId>(tableId))
+    {
+    case TableId::NIT:
+        return m_nit;
+    case TableId::BAT:
+        return m_bat;
+    case TableId::SDT:
+        return m_sdt;
+    case TableId::EIT_PF:
+        return m_eitPf;
+    case TableId::EIT_SCHED_START:
+        return m_eitSched;
+    default:
+        return m_tot;
+    }
+}
+
+/**
+ * Build the same carousel with another version_number
+ *
+ * @param version version number
+ * @param carousel filled with the sections
+ */
+void BenchCorpus::getCarousel(uint8_t version, SectionVector_t& carousel) const
+{
+    carousel = m_carousel;
+    for(auto it = carousel.begin(), end = carousel.end(); it != end; ++it)
+    {
+        SectionData_t& s = *it;
+        if(!(s[1] & 0x80))
+        {
+            continue;
+        }
+
+        s[5] = 0xc1 | ((version & 0x1f) << 1);
+        s.resize(s.size() - 4);
+        uint32_t crc = Crc32::calculate(s.data(), s.size());
+        s.push_back(crc >> 24);
+        s.push_back(crc >> 16);
+        s.push_back(crc >> 8);
+        s.push_back(crc);
+    }
+}
+
+/**
+ * Get the total size of the sections
+ *
+ * @return bytes
+ */
+size_t BenchCorpus::getBytes() const
+{
+    size_t bytes = 0;
+    for(auto it = m_carousel.begin(), end = m_carousel.end(); it != end; ++it)
+    {
+        bytes += it->size();
+    }
+    return bytes;
+}
@@ -0,0 +1,155 @@
+//
+// DVB_SI for Reference Design Kit (RDK)
+//
+// Copyright (C) 2015  Dmitry Barablin & Stan Partridge (stan.partridge@arris.com)
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+#ifndef BENCHCORPUS_H_
+#define BENCHCORPUS_H_
+
+// C system includes
+#include <stdint.h>
+#include <stddef.h>
+
+// C++ system includes
+#include <vector>
+#include <string>
+
+// Other libraries' includes
+
+// Project's includes
+#include "SectionEncoder.h"
+
+typedef std::vector<SectionData_t> SectionVector_t;
+
+/**
+ * Size of the synthetic SI of one network
+ */
+struct CorpusConfig
+{
+    /**
+     * Constructor: a mid-size cable network
+     */
+    CorpusConfig()
+        : transports(12),
+          servicesPerTransport(20),
+          bouquets(2),
+          scheduleDays(2),
+          seed(0x5eed)
+    {
+    }
+
+    uint32_t transports;
+    uint32_t servicesPerTransport;
+    uint32_t bouquets;
+
+    /**
+     * Days of EIT schedule per service (at most 8, 0x50 to 0x5f)
+     */
+    uint32_t scheduleDays;
+
+    /**
+     * Seed of the random generator: the same seed gives the same corpus
+     */
+    uint32_t seed;
+};
+
+/**
+ * BenchCorpus
+ *
+ * Synthetic, CRC-correct SI sections of one network: NIT, BAT, SDT, EIT p/f and schedule and
+ * TOT. Text lengths, descriptor counts and events per section follow the spread seen on real
+ * cable networks (short service names, 1 to 4 kB EIT schedule sections with short and extended
+ * event descriptors). The sections are grouped by sub-table.
+ */
+class BenchCorpus
+{
+public:
+    /**
+     * Constructor. Builds the corpus.
+     *
+     * @param config network size
+     */
+    explicit BenchCorpus(const CorpusConfig& config);
+
+    /**
+     * Get all the sub-tables of a table type
+     *
+     * @param tableId first table_id of the type (NIT, BAT, SDT, EIT_PF, EIT_SCHED_START, TOT)
+     * @return sub-tables
+     */
+    const std::vector<SubTableSections_t>& getSubTables(uint8_t tableId) const;
+
+    /**
+     * Get all the sections as one carousel round, interleaved the way a multiplexer sends them
+     * (every sub-table's sections in order, sub-tables of all types mixed)
+     *
+     * @return sections
+     */
+    const SectionVector_t& getCarousel() const
+    {
+        return m_carousel;
+    }
+
+    /**
+     * Build the same carousel with another version_number
+     *
+     * @param version version number
+     * @param carousel filled with the sections
+     */
+    void getCarousel(uint8_t version, SectionVector_t& carousel) const;
+
+    /**
+     * Get the coded strings used in the descriptors (raw, with their character table byte)
+     *
+     * @return strings
+     */
+    const std::vector<std::string>& getStrings() const
+    {
+        return m_strings;
+    }
+
+    /**
+     * Get the total size of the sections
+     *
+     * @return bytes
+     */
+    size_t getBytes() const;
+
+private:
+    /**
+     * Sub-tables per table type
+     */
+    std::vector<SubTableSections_t> m_nit;
+    std::vector<SubTableSections_t> m_bat;
+    std::vector<SubTableSections_t> m_sdt;
+    std::vector<SubTableSections_t> m_eitPf;
+    std::vector<SubTableSections_t> m_eitSched;
+    std::vector<SubTableSections_t> m_tot;
+
+    /**
+     * One carousel round
+     */
+    SectionVector_t m_carousel;
+
+    /**
+     * Coded strings
+     */
+    std::vector<std::string> m_strings;
+};
+
+#endif /* BENCHCORPUS_H_ */
@@ -0,0 +1,121 @@
+//
+// DVB_SI for Reference Design Kit (RDK)
+//
+// Copyright (C) 2015  Dmitry Barablin & Stan Partridge (stan.partridge@arris.com)
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+#ifndef BENCHRANDOM_H_
+#define BENCHRANDOM_H_
+
+// C system includes
+#include <stdint.h>
+#include <stddef.h>
+
+// C++ system includes
+#include <string>
+
+// Other libraries' includes
+
+// Project's includes
+
+/**
+ * xorshift32 random generator: the same seed gives the same sequence
+ */
+class BenchRandom
+{
+public:
+    explicit BenchRandom(uint32_t seed)
+        : m_state(seed ? seed : 1)
+    {
+    }
+
+    uint32_t next()
+    {
+        m_state ^= m_state << 13;
+        m_state ^= m_state >> 17;
+        m_state ^= m_state << 5;
+        return m_state;
+    }
+
+    /**
+     * Uniform value in [lo, hi]
+     */
+    uint32_t range(uint32_t lo, uint32_t hi)
+    {
+        return lo + next() % (hi - lo + 1);
+    }
+
+    /**
+     * Value in [lo, hi] around the middle (sum of two uniform values)
+     */
+    uint32_t spread(uint32_t lo, uint32_t hi)
+    {
+        return (range(lo, hi) + range(lo, hi)) / 2;
+    }
+
+    /**
+     * Build a text of random words
+     *
+     * @param length target length
+     * @return text
+     */
+    std::string makeText(size_t length)
+    {
+        static const char* const words[] =
+        {
+            "News", "Sport", "Movie", "Kids", "Music", "World", "Live", "Classic", "Drama", "Comedy",
+            "Nature", "History", "Science", "Travel", "Food", "Weather", "Report", "Magazine", "Series",
+            "Evening", "Morning", "Special", "Football", "Journal", "Documentary", "Premiere", "Jazz",
+            "Adventure", "Family", "Cinema", "Culture", "Europe", "Express", "Channel", "Plus", "One"
+        };
+
+        std::string text;
+        while(text.size() < length)
+        {
+            if(!text.empty())
+            {
+                text += ' ';
+            }
+            text += words[range(0, sizeof(words) / sizeof(words[0]) - 1)];
+        }
+        text.resize(length);
+        return text;
+    }
+
+    /**
+     * Build a coded string: default table (ISO/IEC 6937) with some accented characters, or
+     * ISO/IEC 8859-9 with its character table byte
+     *
+     * @param length target length
+     * @return coded string
+     */
+    std::string makeCodedText(size_t length)
+    {
+        std::string text = makeText(length);
+        if(range(0, 3) == 0 && length > 1)
+        {
+            text[0] = 0x05;
+            text[length / 2] = '\xe7';
+        }
+        return text;
+    }
+
+private:
+    uint32_t m_state;
+};
+
+#endif /* BENCHRANDOM_H_ */
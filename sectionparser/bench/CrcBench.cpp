@@ -0,0 +1,277 @@
+//
+// DVB_SI for Reference Design Kit (RDK)
+//
+// Copyright (C) 2015  Dmitry Barablin & Stan Partridge (stan.partridge@arris.com)
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+// CRC_32 benchmark: compares the cost of the CRC check with the cost of
+// SectionParser::parse() on a carousel of EIT schedule sections. Both are measured warm, over
+// several rounds of the same corpus; the CRC is timed over the sections that reach the check in
+// parse() only (the repeats of complete sub-tables are dropped before it).
+
+// C system includes
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+// C++ system includes
+#include <vector>
+#include <chrono>
+
+// Other libraries' includes
+
+// Project's includes
+#include "Crc32.h"
+#include "sectionparser.h"
+#include "SiTablePool.h"
+#include "MpegDescriptor.h"
+
+using std::vector;
+
+typedef vector<vector<uint8_t>> SectionVector_t;
+
+/**
+ * Build an EIT schedule section with a valid CRC_32
+ *
+ * @param serviceId service id
+ * @param version version number
+ * @param number section number
+ * @param lastNumber last section number
+ * @param events number of events in the section
+ * @return section data
+ */
+static vector<uint8_t> buildEitSection(uint16_t serviceId, uint8_t version, uint8_t number, uint8_t lastNumber, int events)
+{
+    static const char name[] = "Evening News";
+    static const char text[] = "The latest national and international news, followed by the weather forecast.";
+
+    vector<uint8_t> s;
+    s.push_back((uint8_t)TableId::EIT_SCHED_START);
+    s.push_back(0xf0);
+    s.push_back(0);
+    s.push_back(serviceId >> 8);
+    s.push_back(serviceId & 0xff);
+    s.push_back(0xc1 | (version << 1));
+    s.push_back(number);
+    s.push_back(lastNumber);
+    s.push_back(0x00); s.push_back(0x01);    // transport_stream_id
+    s.push_back(0x00); s.push_back(0x02);    // original_network_id
+    s.push_back(lastNumber);                 // segment_last_section_number
+    s.push_back((uint8_t)TableId::EIT_SCHED_START);
+
+    for(int i = 0; i < events; i++)
+    {
+        uint16_t eventId = number * events + i;
+        uint8_t descLength = 2 + 3 + 1 + sizeof(name) - 1 + 1 + sizeof(text) - 1;
+
+        s.push_back(eventId >> 8);
+        s.push_back(eventId & 0xff);
+        s.push_back(0xe0); s.push_back(0x2e);    // MJD
+        s.push_back(0x12); s.push_back(0x30); s.push_back(0x00);
+        s.push_back(0x00); s.push_back(0x30); s.push_back(0x00);
+        s.push_back(0x80 | (descLength >> 8));
+        s.push_back(descLength);
+
+        s.push_back((uint8_t)DescriptorTag::SHORT_EVENT);
+        s.push_back(descLength - 2);
+        s.push_back('e'); s.push_back('n'); s.push_back('g');
+        s.push_back(sizeof(name) - 1);
+        s.insert(s.end(), name, name + sizeof(name) - 1);
+        s.push_back(sizeof(text) - 1);
+        s.insert(s.end(), text, text + sizeof(text) - 1);
+    }
+
+    // section_length covers everything after the length field including the CRC_32
+    uint16_t length = s.size() - 3 + 4;
+    s[1] |= (length >> 8) & 0x0f;
+    s[2] = length & 0xff;
+
+    uint32_t crc = Crc32::calculate(s.data(), s.size());
+    s.push_back(crc >> 24);
+    s.push_back(crc >> 16);
+    s.push_back(crc >> 8);
+    s.push_back(crc);
+
+    return s;
+}
+
+/**
+ * Measure the CRC kernel over the given sections
+ *
+ * @param sections sections
+ * @param rounds number of rounds
+ * @return ns per section
+ */
+static double benchCrc(const SectionVector_t& sections, int rounds)
+{
+    uint32_t sink = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    for(int r = 0; r < rounds; r++)
+    {
+        for(auto it = sections.begin(), end = sections.end(); it != end; ++it)
+        {
+            sink |= Crc32::calculate(it->data(), it->size());
+        }
+    }
+
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    if(sink)
+    {
+        printf("CRC mismatch in corpus\n");
+    }
+
+    return (double)ns / ((double)rounds * sections.size());
+}
+
+/**
+ * Releases the tables published by the parser
+ */
+static void releaseTable(void*, uint32_t, void* tbl, size_t)
+{
+    SiTablePtr table(static_cast<SiTable*>(tbl));
+}
+
+/**
+ * Find the sections that reach the CRC check in SectionParser::parse()
+ *
+ * @param carousel sections, in carousel order
+ * @param checked filled with the sections that are not dropped as repeats
+ */
+static void findCheckedSections(const SectionVector_t& carousel, SectionVector_t& checked)
+{
+    int dummy = 0;
+    SectionParser parser(&dummy, releaseTable);
+    for(auto it = carousel.begin(), end = carousel.end(); it != end; ++it)
+    {
+        uint64_t repeats = parser.getRepeatCount();
+        vector<uint8_t> copy(*it);
+        parser.parse(copy.data(), copy.size());
+        if(parser.getRepeatCount() == repeats)
+        {
+            checked.push_back(*it);
+        }
+    }
+}
+
+/**
+ * Measure SectionParser::parse() over the carousel, a new parser per round so that every
+ * round builds the same tables. One warm-up round is not counted.
+ *
+ * @param carousel sections, in carousel order
+ * @param rounds number of rounds
+ * @return ns per carousel pass
+ */
+static double benchParse(const SectionVector_t& carousel, int rounds)
+{
+    // parse() is given copies, as a section filter would
+    SectionVector_t copy(carousel);
+    int64_t total = 0;
+    for(int r = 0; r <= rounds; r++)
+    {
+        int dummy = 0;
+        SectionParser parser(&dummy, releaseTable);
+
+        auto start = std::chrono::steady_clock::now();
+        for(auto it = copy.begin(), end = copy.end(); it != end; ++it)
+        {
+            parser.parse(it->data(), it->size());
+        }
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+        if(parser.getCrcErrorCount())
+        {
+            printf("%llu corpus sections rejected\n", (unsigned long long)parser.getCrcErrorCount());
+        }
+        if(r > 0)
+        {
+            total += ns;
+        }
+    }
+
+    return (double)total / rounds;
+}
+
+int main()
+{
+    const int services = 64;
+    const int sectionsPerService = 8;
+    const int versions = 8;
+
+    // Keep the log output from dominating the measurement
+    freopen("/dev/null", "w", stderr);
+
+    // An EIT carousel: every sub-table goes round twice so the EIT completeness check kicks in
+    SectionVector_t carousel;
+    SectionVector_t distinct;
+    for(int v = 0; v < versions; v++)
+    {
+        for(int s = 0; s < services; s++)
+        {
+            for(int pass = 0; pass < 2; pass++)
+            {
+                for(int n = 0; n < sectionsPerService; n++)
+                {
+                    carousel.push_back(buildEitSection(0x100 + s, v, n, sectionsPerService - 1, 12));
+                    if(pass == 0)
+                    {
+                        distinct.push_back(carousel.back());
+                    }
+                }
+            }
+        }
+    }
+
+    size_t bytes = 0;
+    for(auto it = distinct.begin(), end = distinct.end(); it != end; ++it)
+    {
+        bytes += it->size();
+    }
+    printf("corpus: %zu sections in carousel, average section size %zu bytes\n", carousel.size(), bytes / distinct.size());
+
+    // Parse time (includes the CRC check) and the sections that are CRC checked
+    const int rounds = 20;
+    double parsePass = benchParse(carousel, rounds);
+    SectionVector_t checked;
+    findCheckedSections(carousel, checked);
+
+    printf("parse: %.1f ns/section (%.2f ms per carousel pass), %zu of %zu sections reach the CRC check\n",
+           parsePass / carousel.size(), parsePass / 1e6, checked.size(), carousel.size());
+
+    // CRC kernels over the checked sections, as a share of the parse time of the same pass
+    const Crc32::Kernel detected = Crc32::getKernel();
+    const Crc32::Kernel kernels[] = { Crc32::Kernel::SLICING_BY_8, Crc32::Kernel::PCLMUL, detected };
+    for(size_t i = 0; i < sizeof(kernels) / sizeof(kernels[0]); i++)
+    {
+        // Each kernel once, the unsupported ones are skipped
+        bool seen = false;
+        for(size_t j = 0; j < i; j++)
+        {
+            seen = seen || (kernels[j] == kernels[i]);
+        }
+        if(seen || Crc32::setKernel(kernels[i]) != kernels[i])
+        {
+            continue;
+        }
+        double crcPerSection = benchCrc(checked, rounds);
+        printf("crc %-14s: %8.1f ns/checked section, %6.2f GB/s, %5.2f%% of parse time\n", Crc32::getKernelName(),
+               crcPerSection, (double)bytes / distinct.size() / crcPerSection,
+               100.0 * crcPerSection * checked.size() / parsePass);
+    }
+
+    return 0;
+}
@@ -0,0 +1,403 @@
+//
+// DVB_SI for Reference Design Kit (RDK)
+//
+// Copyright (C) 2015  Dmitry Barablin & Stan Partridge (stan.partridge@arris.com)
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+// Offline TS ingest benchmark (see TsFileIngest.h).
+//
+// Usage: ingestbench capture.ts [threads [chunk MB]]
+//        ingestbench gen capture.ts [seconds [mux Mbit/s [SI kbit/s]]]
+//
+// The first form pushes a capture through TsFileIngest into SectionParser and prints the
+// throughput and a checksum of the sections of every PID, in order: runs with different thread
+// counts and chunk sizes have to print the same checksums. The second form writes the synthetic
+// headend SI (see SyntheticEpg.h) as a full mux: the SI carousel packed the way a multiplexer
+// packs it (sections back to back, several per packet), among packets of random payload.
+
+// C system includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+// C++ system includes
+#include <vector>
+#include <map>
+#include <string>
+#include <algorithm>
+
+// Other libraries' includes
+
+// Project's includes
+#include "TsFileIngest.h"
+#include "TsDemux.h"
+#include "sectionparser.h"
+#include "SiTablePool.h"
+#include "SyntheticEpg.h"
+#include "SectionEncoder.h"
+#include "CarouselGenerator.h"
+#include "BenchRandom.h"
+
+using std::vector;
+
+namespace
+{
+    const uint64_t NS_PER_SECOND = 1000000000;
+
+    /**
+     * Writes the packets of a mux
+     */
+    class MuxWriter
+    {
+    public:
+        enum
+        {
+            PAYLOAD_PID = 0x100,
+            NOISE_SIZE = 64 * 1024
+        };
+
+        /**
+         * Constructor
+         *
+         * @param file output
+         * @param bitrate mux bitrate
+         */
+        MuxWriter(FILE* file, uint64_t bitrate)
+            : m_file(file),
+              m_bitrate(bitrate),
+              m_packets(0),
+              m_random(0x7e57)
+        {
+            memset(m_cc, 0, sizeof(m_cc));
+            for(size_t i = 0; i < NOISE_SIZE; i++)
+            {
+                m_noise.push_back(m_random.next());
+            }
+        }
+
+        /**
+         * Get the mux time of the next packet
+         *
+         * @return nanoseconds
+         */
+        uint64_t getTime() const
+        {
+            return m_packets * TsDemux::TS_PACKET_SIZE * 8 * NS_PER_SECOND / m_bitrate;
+        }
+
+        uint64_t getPacketCount() const
+        {
+            return m_packets;
+        }
+
+        /**
+         * Fill with payload packets up to a mux time
+         *
+         * @param time nanoseconds
+         */
+        void fill(uint64_t time)
+        {
+            while(getTime() < time)
+            {
+                size_t offset = m_random.range(0, NOISE_SIZE - CarouselGenerator::TS_PAYLOAD_SIZE);
+                writePacket(PAYLOAD_PID, false, &m_noise[offset], CarouselGenerator::TS_PAYLOAD_SIZE);
+            }
+        }
+
+        /**
+         * Queue a section on a PID. Full packets are written right away; the rest goes out with
+         * the next section, or stuffed now and then.
+         *
+         * @param pid PID
+         * @param data section data
+         * @param size section size
+         */
+        void addSection(uint16_t pid, const uint8_t* data, size_t size)
+        {
+            Stream& stream = m_streams[pid];
+            stream.starts.push_back(stream.pending.size());
+            stream.pending.insert(stream.pending.end(), data, data + size);
+            flush(pid, m_random.range(0, 3) == 0);
+        }
+
+        /**
+         * Write out what is queued on every PID
+         */
+        void flush()
+        {
+            for(auto it = m_streams.begin(), end = m_streams.end(); it != end; ++it)
+            {
+                flush(it->first, true);
+            }
+        }
+
+    private:
+        /**
+         * Queued sections of a PID
+         */
+        struct Stream
+        {
+            vector<uint8_t> pending;
+
+            /**
+             * Offsets of the sections in pending
+             */
+            vector<size_t> starts;
+        };
+
+        /**
+         * Packetize the queued sections of a PID
+         *
+         * @param pid PID
+         * @param all true to write out the last partial packet too, stuffed
+         */
+        void flush(uint16_t pid, bool all)
+        {
+            Stream& stream = m_streams[pid];
+            size_t pos = 0;
+            size_t next = 0;
+            while(pos < stream.pending.size())
+            {
+                while(next < stream.starts.size() && stream.starts[next] < pos)
+                {
+                    next++;
+                }
+
+                size_t left = stream.pending.size() - pos;
+                bool pusi = next < stream.starts.size() && stream.starts[next] < pos + CarouselGenerator::TS_PAYLOAD_SIZE - 1;
+                size_t room = pusi ? CarouselGenerator::TS_PAYLOAD_SIZE - 1 : CarouselGenerator::TS_PAYLOAD_SIZE;
+                if(!pusi && next < stream.starts.size())
+                {
+                    // A section starting in the last byte waits for the next packet
+                    room = std::min(room, stream.starts[next] - pos);
+                }
+                if(left < room && !all && (pusi || next == stream.starts.size()))
+                {
+                    break;
+                }
+
+                uint8_t payload[CarouselGenerator::TS_PAYLOAD_SIZE];
+                memset(payload, 0xff, sizeof(payload));
+                size_t used = std::min(left, room);
+                if(pusi)
+                {
+                    payload[0] = stream.starts[next] - pos;
+                    memcpy(payload + 1, &stream.pending[pos], used);
+                }
+                else
+                {
+                    memcpy(payload, &stream.pending[pos], used);
+                }
+                writePacket(pid, pusi, payload, sizeof(payload));
+                pos += used;
+            }
+
+            stream.pending.erase(stream.pending.begin(), stream.pending.begin() + pos);
+            vector<size_t> starts;
+            for(auto it = stream.starts.begin(), end = stream.starts.end(); it != end; ++it)
+            {
+                if(*it >= pos)
+                {
+                    starts.push_back(*it - pos);
+                }
+            }
+            stream.starts.swap(starts);
+        }
+
+        /**
+         * Write a packet
+         *
+         * @param pid PID
+         * @param pusi payload_unit_start_indicator
+         * @param payload payload
+         * @param size payload size (TS_PAYLOAD_SIZE)
+         */
+        void writePacket(uint16_t pid, bool pusi, const uint8_t* payload, size_t size)
+        {
+            uint8_t packet[TsDemux::TS_PACKET_SIZE];
+            packet[0] = TsDemux::TS_SYNC_BYTE;
+            packet[1] = (pusi ? 0x40 : 0) | (pid >> 8);
+            packet[2] = pid & 0xff;
+            packet[3] = 0x10 | m_cc[pid];
+            m_cc[pid] = (m_cc[pid] + 1) & 0xf;
+            memcpy(packet + 4, payload, size);
+            fwrite(packet, 1, sizeof(packet), m_file);
+            m_packets++;
+        }
+
+        FILE* m_file;
+        uint64_t m_bitrate;
+        uint64_t m_packets;
+        uint8_t m_cc[TsDemux::MAX_PID + 1];
+        BenchRandom m_random;
+        vector<uint8_t> m_noise;
+        std::map<uint16_t, Stream> m_streams;
+    };
+
+    /**
+     * Section checksum of a PID
+     */
+    struct PidSum
+    {
+        uint64_t sections;
+        uint64_t hash;
+    };
+
+    /**
+     * Checksums and parser
+     */
+    struct Sink
+    {
+        SectionParser* parser;
+        std::map<uint16_t, PidSum> sums;
+    };
+
+    /**
+     * Releases the tables published by the parser
+     */
+    void releaseTable(void*, uint32_t, void* tbl, size_t)
+    {
+        SiTablePtr table(static_cast<SiTable*>(tbl));
+    }
+
+    /**
+     * Adds a section to the checksum of its PID (FNV-1a, order dependent) and parses it
+     */
+    void checkSection(void* context, uint16_t pid, uint8_t* data, uint32_t size)
+    {
+        Sink* sink = static_cast<Sink*>(context);
+        PidSum& sum = sink->sums[pid];
+        if(sum.sections++ == 0)
+        {
+            sum.hash = 0xcbf29ce484222325ULL;
+        }
+        for(uint32_t i = 0; i < size; i++)
+        {
+            sum.hash = (sum.hash ^ data[i]) * 0x100000001b3ULL;
+        }
+        sink->parser->parse(data, size, pid);
+    }
+
+    /**
+     * Write a synthetic mux capture
+     */
+    int generate(int argc, char* argv[])
+    {
+        const char* filename = argv[2];
+        uint64_t seconds = argc > 3 ? atoi(argv[3]) : 60;
+        uint64_t muxBitrate = (argc > 4 ? atoi(argv[4]) : 38) * 1000000ULL;
+        uint64_t siBitrate = (argc > 5 ? atoi(argv[5]) : 4000) * 1000ULL;
+
+        EpgConfig config;
+        SyntheticEpg epg(config);
+        SectionEncoder encoder;
+        encoder.setScheduleStart(config.startMjd);
+        CarouselGenerator carousel;
+        carousel.setBitrate(siBitrate);
+        if(!epg.encode(encoder, 1, carousel))
+        {
+            printf("some tables could not be encoded\n");
+            return 1;
+        }
+
+        FILE* file = fopen(filename, "wb");
+        if(!file)
+        {
+            printf("cannot create %s\n", filename);
+            return 1;
+        }
+
+        MuxWriter mux(file, muxBitrate);
+        CarouselSection section;
+        uint64_t sections = 0;
+        while(carousel.next(section) && section.time < seconds * NS_PER_SECOND)
+        {
+            mux.fill(section.time);
+            mux.addSection(section.pid, section.data->data(), section.data->size());
+            sections++;
+        }
+        mux.flush();
+        mux.fill(seconds * NS_PER_SECOND);
+        fclose(file);
+
+        printf("%s: %llu s of %llu Mbit/s mux, %llu packets, %llu SI sections at %llu kbit/s\n", filename,
+               (unsigned long long)seconds, (unsigned long long)(muxBitrate / 1000000),
+               (unsigned long long)mux.getPacketCount(), (unsigned long long)sections,
+               (unsigned long long)(siBitrate / 1000));
+        return 0;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if(argc < 2)
+    {
+        printf("usage: %s capture.ts [threads [chunk MB]]\n"
+               "       %s gen capture.ts [seconds [mux Mbit/s [SI kbit/s]]]\n", argv[0], argv[0]);
+        return 1;
+    }
+    if(strcmp(argv[1], "gen") == 0)
+    {
+        return argc > 2 ? generate(argc, argv) : 1;
+    }
+
+    SectionParser parser(NULL, releaseTable);
+    Sink sink;
+    sink.parser = &parser;
+
+    TsFileIngest ingest;
+    if(argc > 2)
+    {
+        ingest.setThreadCount(atoi(argv[2]));
+    }
+    if(argc > 3)
+    {
+        ingest.setChunkSize(atof(argv[3]) * 1024 * 1024);
+    }
+
+    TsIngestStats stats;
+    if(!ingest.ingest(argv[1], checkSection, &sink, stats))
+    {
+        return 1;
+    }
+
+    double seconds = stats.time / 1e9;
+    printf("%.1f MB, %llu chunks, %llu packets, %llu sections, %llu cc errors in %.2f s: %.0f MB/s, %.0f sections/s\n",
+           stats.bytes / 1e6, (unsigned long long)stats.chunks, (unsigned long long)stats.packets,
+           (unsigned long long)stats.sections, (unsigned long long)stats.discontinuities, seconds,
+           stats.bytes / 1e6 / seconds, stats.sections / seconds);
+
+    for(auto it = sink.sums.begin(), end = sink.sums.end(); it != end; ++it)
+    {
+        printf("pid 0x%04x: %llu sections, checksum %016llx\n", it->first, (unsigned long long)it->second.sections,
+               (unsigned long long)it->second.hash);
+    }
+
+    ParserStatsSnapshot parserStats;
+    parser.getStats(parserStats);
+    uint64_t completed = 0;
+    uint64_t rejected = 0;
+    for(auto it = parserStats.tables.begin(), end = parserStats.tables.end(); it != end; ++it)
+    {
+        completed += it->counters.completed;
+        rejected += it->counters.rejected;
+    }
+    printf("sub-tables completed: %llu, sections rejected: %llu\n", (unsigned long long)completed,
+           (unsigned long long)rejected);
+    return 0;
+}
@@ -0,0 +1,246 @@
+//
+// DVB_SI for Reference Design Kit (RDK)
+//
+// Copyright (C) 2015  Dmitry Barablin & Stan Partridge (stan.partridge@arris.com)
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+// Headend scale load test: the SI of a synthetic headend (see SyntheticEpg.h) is encoded into
+// sections, checked to parse back into the same tables, and played as a carousel into
+// SectionParser as fast as it goes. A new version of every table is put on the carousel half way.
+// The carousel can be saved as a section capture, with the carousel times, for replay (see
+// SectionCapture.h).
+//
+// Usage: loadbench [transports [services per transport [schedule days [carousel seconds [SI kbit/s [capture]]]]]]
+
+// C system includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+// C++ system includes
+#include <vector>
+#include <chrono>
+
+// Other libraries' includes
+
+// Project's includes
+#include "SyntheticEpg.h"
+#include "SectionEncoder.h"
+#include "CarouselGenerator.h"
+#include "sectionparser.h"
+#include "SiTablePool.h"
+#include "SectionCapture.h"
+#include "ParserStats.h"
+
+using std::vector;
+
+namespace
+{
+    const uint64_t NS_PER_SECOND = 1000000000;
+
+    /**
+     * Keeps the last table published by the parser
+     */
+    void keepTable(void* context, uint32_t, void* tbl, size_t)
+    {
+        static_cast<SiTablePtr*>(context)->reset(static_cast<SiTable*>(tbl));
+    }
+
+    /**
+     * Releases the tables published by the parser
+     */
+    void releaseTable(void*, uint32_t, void* tbl, size_t)
+    {
+        SiTablePtr table(static_cast<SiTable*>(tbl));
+    }
+
+    /**
+     * Destination of the carousel sections
+     */
+    struct Feed
+    {
+        SectionParser* parser;
+
+        /**
+         * Capture, NULL if none
+         */
+        CaptureWriter* capture;
+
+        /**
+         * Start of the capture (ParserStats::now())
+         */
+        uint64_t captureStart;
+    };
+
+    /**
+     * Hands a carousel section to the parser and the capture
+     */
+    void parseSection(void* context, const uint8_t* data, uint32_t size, uint16_t pid, uint64_t time)
+    {
+        Feed* feed = static_cast<Feed*>(context);
+        if(feed->capture)
+        {
+            feed->capture->write(data, size, 0, pid, feed->captureStart + time);
+        }
+        feed->parser->parse(const_cast<uint8_t*>(data), size, pid);
+    }
+
+    /**
+     * Get the wall clock time
+     *
+     * @return seconds
+     */
+    double now()
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    /**
+     * Parse every sub-table of the carousel once and encode the table built out of it again
+     *
+     * @param encoder encoder
+     * @param carousel carousel
+     * @return number of sub-tables that did not come out the same
+     */
+    size_t verify(const SectionEncoder& encoder, const CarouselGenerator& carousel)
+    {
+        size_t mismatches = 0;
+        for(size_t i = 0; i < carousel.getSubTableCount(); i++)
+        {
+            const SubTableSections_t& sections = carousel.getSubTable(i);
+
+            SiTablePtr table;
+            SectionParser parser(&table, keepTable);
+            for(auto it = sections.begin(), end = sections.end(); it != end; ++it)
+            {
+                SectionData_t copy(*it);
+                parser.parse(copy.data(), copy.size());
+            }
+
+            SubTableSections_t encoded;
+            if(!table || !encoder.encode(*table, encoded) || encoded != sections)
+            {
+                if(mismatches++ < 10)
+                {
+                    printf("sub-table %zu (table_id 0x%02x, %zu sections) %s\n", i, sections[0][0], sections.size(),
+                           table ? "encodes differently" : "was not built");
+                }
+            }
+        }
+        return mismatches;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    EpgConfig config;
+    config.transports = argc > 1 ? atoi(argv[1]) : config.transports;
+    config.servicesPerTransport = argc > 2 ? atoi(argv[2]) : config.servicesPerTransport;
+    config.scheduleDays = argc > 3 ? atoi(argv[3]) : config.scheduleDays;
+    uint64_t seconds = argc > 4 ? atoi(argv[4]) : 120;
+    uint64_t kbps = argc > 5 ? atoi(argv[5]) : 0;
+
+    SyntheticEpg epg(config);
+    SectionEncoder encoder;
+    encoder.setScheduleStart(config.startMjd);
+    CarouselGenerator carousel;
+    carousel.setBitrate(kbps * 1000);
+
+    // Encoding
+    double start = now();
+    if(!epg.encode(encoder, 1, carousel))
+    {
+        printf("some tables could not be encoded\n");
+        return 1;
+    }
+    double encodeTime = now() - start;
+
+    size_t sections = 0;
+    for(size_t i = 0; i < carousel.getSubTableCount(); i++)
+    {
+        sections += carousel.getSubTable(i).size();
+    }
+    uint64_t bytes = carousel.getBytes();
+    printf("headend: %u transports, %u services, %u days of schedule\n", config.transports, epg.getServiceCount(),
+           config.scheduleDays);
+    printf("encoded: %zu sub-tables, %zu sections, %.1f MB in %.2f s (%.1f MB/s)\n", carousel.getSubTableCount(),
+           sections, bytes / 1e6, encodeTime, bytes / 1e6 / encodeTime);
+
+    // Round trip
+    start = now();
+    size_t mismatches = verify(encoder, carousel);
+    printf("round trip: %zu of %zu sub-tables differ (%.2f s)\n", mismatches, carousel.getSubTableCount(), now() - start);
+
+    // Carousel into the parser, a new version of every table half way
+    int dummy = 0;
+    SectionParser parser(&dummy, releaseTable);
+
+    CaptureWriter capture;
+    Feed feed = { &parser, NULL, 0 };
+    if(argc > 6)
+    {
+        if(!capture.open(argv[6]))
+        {
+            printf("cannot create %s\n", argv[6]);
+            return 1;
+        }
+        feed.capture = &capture;
+        feed.captureStart = ParserStats::now();
+    }
+
+    uint64_t count = 0;
+    double parseTime = 0;
+    for(int half = 0; half < 2; half++)
+    {
+        if(half == 1)
+        {
+            epg.encode(encoder, 2, carousel, true);
+        }
+
+        start = now();
+        count += carousel.run(seconds * NS_PER_SECOND / 2, parseSection, &feed);
+        parseTime += now() - start;
+    }
+
+    if(feed.capture)
+    {
+        capture.close();
+        printf("capture: %llu sections, %llu dropped\n", (unsigned long long)capture.getRecordCount(),
+               (unsigned long long)capture.getDropCount());
+    }
+
+    ParserStatsSnapshot stats;
+    parser.getStats(stats);
+    uint64_t completed = 0;
+    uint64_t duplicates = 0;
+    uint64_t receivedBytes = 0;
+    for(auto it = stats.tables.begin(), end = stats.tables.end(); it != end; ++it)
+    {
+        completed += it->counters.completed;
+        duplicates += it->counters.duplicates;
+        receivedBytes += it->counters.bytes;
+    }
+
+    printf("carousel: %llu s%s, %llu sections, %.1f MB\n", (unsigned long long)seconds,
+           kbps ? "" : " (no bitrate limit)", (unsigned long long)count, receivedBytes / 1e6);
+    printf("parsed in %.2f s: %.0f sections/s, %.1f MB/s, %.1fx real time\n", parseTime, count / parseTime,
+           receivedBytes / 1e6 / parseTime, seconds / parseTime);
+    printf("sub-tables completed: %llu, duplicate sections: %llu\n", (unsigned long long)completed,
+           (unsigned long long)duplicates);
+
+    return mismatches ? 1 : 0;
+}
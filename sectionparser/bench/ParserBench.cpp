@@ -0,0 +1,499 @@
+//
+// DVB_SI for Reference Design Kit (RDK)
+//
+// Copyright (C) 2015  Dmitry Barablin & Stan Partridge (stan.partridge@arris.com)
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+// Parser microbenchmarks over a synthetic network (see BenchCorpus.h). Every benchmark reports
+// the time and the number of heap allocations per operation.
+//
+// Usage: parserbench [transports [services per transport [schedule days [rounds]]]]
+
+// C system includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+// C++ system includes
+#include <vector>
+#include <chrono>
+#include <atomic>
+#include <new>
+
+// Other libraries' includes
+
+// Project's includes
+#include "BenchCorpus.h"
+#include "sectionparser.h"
+#include "sectionlist.h"
+#include "SiTablePool.h"
+#include "MpegDescriptor.h"
+#include "DescriptorList.h"
+#include "EitTable.h"
+#include "SdtTable.h"
+#include "DvbUtils.h"
+#include "ShortEventDescriptor.h"
+#include "ExtendedEventDescriptor.h"
+#include "ServiceDescriptor.h"
+#include "ContentDescriptor.h"
+#include "ParentalRatingDescriptor.h"
+
+using std::vector;
+
+namespace
+{
+    /**
+     * Number of heap allocations made by the process
+     */
+    std::atomic<uint64_t> s_allocations(0);
+
+    /**
+     * Keeps results alive so the compiler cannot drop the measured work
+     */
+    volatile uint64_t s_sink;
+
+    /**
+     * Result of a benchmark
+     */
+    struct Result
+    {
+        double ns;          //!< per operation
+        double allocs;      //!< per operation
+    };
+
+    /**
+     * Run a benchmark
+     *
+     * @param ops number of operations done by one call of the function
+     * @param rounds number of calls
+     * @param f function
+     * @return time and allocations per operation
+     */
+    template<typename F>
+    Result measure(size_t ops, int rounds, F f)
+    {
+        uint64_t allocs = s_allocations.load(std::memory_order_relaxed);
+        auto start = std::chrono::steady_clock::now();
+
+        for(int r = 0; r < rounds; r++)
+        {
+            f(r);
+        }
+
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        double total = (double)ops * rounds;
+
+        Result res;
+        res.ns = ns / total;
+        res.allocs = (s_allocations.load(std::memory_order_relaxed) - allocs) / total;
+        return res;
+    }
+
+    /**
+     * Print a result
+     *
+     * @param name benchmark name
+     * @param unit operation name
+     * @param res result
+     */
+    void report(const char* name, const char* unit, const Result& res)
+    {
+        printf("%-36s %10.1f ns/%-10s %8.2f allocs/%s\n", name, res.ns, unit, res.allocs, unit);
+    }
+
+    /**
+     * Releases the tables published by the parser
+     */
+    void releaseTable(void*, uint32_t, void* tbl, size_t)
+    {
+        SiTablePtr table(static_cast<SiTable*>(tbl));
+    }
+
+    /**
+     * Fill the section lists of a table type
+     *
+     * @param subTables sections
+     * @param lists filled with one complete section list per sub-table
+     */
+    void fillLists(const vector<SubTableSections_t>& subTables, vector<SectionList>& lists)
+    {
+        lists.resize(subTables.size());
+        for(size_t i = 0; i < subTables.size(); i++)
+        {
+            for(auto it = subTables[i].begin(), end = subTables[i].end(); it != end; ++it)
+            {
+                SectionData_t copy(*it);
+                lists[i].add(SectionView(copy.data(), copy.size()));
+            }
+        }
+    }
+
+    /**
+     * Count the sections of a table type
+     */
+    size_t countSections(const vector<SubTableSections_t>& subTables)
+    {
+        size_t count = 0;
+        for(auto it = subTables.begin(), end = subTables.end(); it != end; ++it)
+        {
+            count += it->size();
+        }
+        return count;
+    }
+
+    /**
+     * Descriptor loop of an event or a service in the corpus
+     */
+    struct Loop
+    {
+        uint8_t* data;
+        uint16_t length;
+    };
+
+    /**
+     * Find the event descriptor loops of EIT sections
+     *
+     * @param subTables EIT sections
+     * @param storage copy of the sections the loops point into
+     * @param loops filled with the loops
+     */
+    void findEventLoops(const vector<SubTableSections_t>& subTables, SectionVector_t& storage, vector<Loop>& loops)
+    {
+        for(auto st = subTables.begin(), stEnd = subTables.end(); st != stEnd; ++st)
+        {
+            storage.insert(storage.end(), st->begin(), st->end());
+        }
+
+        for(auto it = storage.begin(), end = storage.end(); it != end; ++it)
+        {
+            uint8_t* p = it->data() + 14;
+            uint8_t* payloadEnd = it->data() + it->size() - 4;
+            while(p + 12 <= payloadEnd)
+            {
+                Loop loop = { p + 12, (uint16_t)(((p[10] & 0x0f) << 8) | p[11]) };
+                loops.push_back(loop);
+                p += 12 + loop.length;
+            }
+        }
+    }
+}
+
+void* operator new(size_t size)
+{
+    s_allocations.fetch_add(1, std::memory_order_relaxed);
+    void* p = malloc(size ? size : 1);
+    if(!p)
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept
+{
+    free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+    free(p);
+}
+
+int main(int argc, char* argv[])
+{
+    CorpusConfig config;
+    config.transports = argc > 1 ? atoi(argv[1]) : config.transports;
+    config.servicesPerTransport = argc > 2 ? atoi(argv[2]) : config.servicesPerTransport;
+    config.scheduleDays = argc > 3 ? atoi(argv[3]) : config.scheduleDays;
+    int rounds = argc > 4 ? atoi(argv[4]) : 5;
+
+    BenchCorpus corpus(config);
+    const SectionVector_t& carousel = corpus.getCarousel();
+
+    printf("corpus: %u transports, %u services, %u days of schedule: %zu sections, %zu bytes (%zu bytes/section)\n\n",
+           config.transports, config.transports * config.servicesPerTransport, config.scheduleDays,
+           carousel.size(), corpus.getBytes(), corpus.getBytes() / carousel.size());
+
+    // SectionParser::parse(): every round is a new version (all tables built), then a repeat of it,
+    // with the default settings, with the latency histograms and with the carousel monitor
+    {
+        vector<SectionVector_t> versions(rounds);
+        for(int r = 0; r < rounds; r++)
+        {
+            corpus.getCarousel(r + 1, versions[r]);
+        }
+
+        const struct
+        {
+            const char* fresh;
+            const char* repeat;
+            bool latencyStats;
+            bool carouselMonitor;
+        } settings[] =
+        {
+            { "parse, new version", "parse, duplicate", false, false },
+            { "parse, new version, latency stats", "parse, duplicate, latency stats", true, false },
+            { "parse, new version, carousel monitor", "parse, duplicate, carousel monitor", false, true }
+        };
+
+        for(size_t s = 0; s < sizeof(settings) / sizeof(settings[0]); s++)
+        {
+            int dummy = 0;
+            SectionParser parser(&dummy, releaseTable);
+            parser.setLatencyStatsEnabled(settings[s].latencyStats);
+            parser.setCarouselMonitorEnabled(settings[s].carouselMonitor);
+            Result fresh = { 0, 0 };
+            Result repeat = { 0, 0 };
+            for(int r = 0; r < rounds; r++)
+            {
+                SectionVector_t& sections = versions[r];
+                Result res = measure(sections.size(), 1, [&](int) {
+                    for(auto it = sections.begin(), end = sections.end(); it != end; ++it)
+                    {
+                        parser.parse(it->data(), it->size());
+                    }
+                });
+                fresh.ns += res.ns / rounds;
+                fresh.allocs += res.allocs / rounds;
+
+                res = measure(sections.size(), 1, [&](int) {
+                    for(auto it = sections.begin(), end = sections.end(); it != end; ++it)
+                    {
+                        parser.parse(it->data(), it->size());
+                    }
+                });
+                repeat.ns += res.ns / rounds;
+                repeat.allocs += res.allocs / rounds;
+            }
+            report(settings[s].fresh, "section", fresh);
+            report(settings[s].repeat, "section", repeat);
+            if(parser.getCrcErrorCount())
+            {
+                printf("warning: %llu corpus sections rejected\n", (unsigned long long)parser.getCrcErrorCount());
+            }
+        }
+    }
+
+    // SectionList::buildTable() per table type
+    {
+        const struct
+        {
+            const char* name;
+            TableId tableId;
+        } types[] =
+        {
+            { "buildTable NIT", TableId::NIT },
+            { "buildTable BAT", TableId::BAT },
+            { "buildTable SDT", TableId::SDT },
+            { "buildTable EIT p/f", TableId::EIT_PF },
+            { "buildTable EIT schedule", TableId::EIT_SCHED_START },
+            { "buildTable TOT", TableId::TOT }
+        };
+
+        for(size_t t = 0; t < sizeof(types) / sizeof(types[0]); t++)
+        {
+            const vector<SubTableSections_t>& subTables = corpus.getSubTables((uint8_t)types[t].tableId);
+            if(subTables.empty())
+            {
+                continue;
+            }
+
+            vector<SectionList> lists;
+            fillLists(subTables, lists);
+
+            Result res = measure(countSections(subTables), rounds, [&](int) {
+                for(auto it = lists.begin(), end = lists.end(); it != end; ++it)
+                {
+                    SiTablePtr tbl(it->buildTable());
+                }
+            });
+            report(types[t].name, "section", res);
+        }
+    }
+
+    // EIT event descriptor loops
+    SectionVector_t storage;
+    vector<Loop> loops;
+    findEventLoops(corpus.getSubTables((uint8_t)TableId::EIT_SCHED_START), storage, loops);
+    if(!loops.empty())
+    {
+        // As done by buildTable(): the descriptors refer to the table's buffer
+        DescriptorBufferPtr buffer = std::make_shared<DescriptorBuffer>();
+        Result res = measure(loops.size(), rounds, [&](int) {
+            for(auto it = loops.begin(), end = loops.end(); it != end; ++it)
+            {
+                DescriptorList list = MpegDescriptor::parseDescriptors(it->data, it->length, buffer);
+                s_sink += list.size();
+            }
+        });
+        report("parseDescriptors, shared buffer", "loop", res);
+
+        // With a copy of the loop
+        res = measure(loops.size(), rounds, [&](int) {
+            for(auto it = loops.begin(), end = loops.end(); it != end; ++it)
+            {
+                DescriptorList list = MpegDescriptor::parseDescriptors(it->data, it->length);
+                s_sink += list.size();
+            }
+        });
+        report("parseDescriptors, copied", "loop", res);
+    }
+
+    // DecodeText
+    {
+        const vector<std::string>& strings = corpus.getStrings();
+        Result res = measure(strings.size(), rounds, [&](int) {
+            for(auto it = strings.begin(), end = strings.end(); it != end; ++it)
+            {
+                s_sink += DecodeText((const unsigned char*)it->data(), it->size()).size();
+            }
+        });
+        report("DecodeText", "string", res);
+    }
+
+    // MjdToDate over the event start times
+    {
+        vector<int64_t> times;
+        for(auto it = loops.begin(), end = loops.end(); it != end; ++it)
+        {
+            const uint8_t* p = it->data - 10;
+            times.push_back(((int64_t)p[0] << 32) | ((int64_t)p[1] << 24) | (p[2] << 16) | (p[3] << 8) | p[4]);
+        }
+        if(!times.empty())
+        {
+            Result res = measure(times.size(), rounds * 10, [&](int) {
+                for(auto it = times.begin(), end = times.end(); it != end; ++it)
+                {
+                    s_sink += MjdToDate(*it);
+                }
+            });
+            report("MjdToDate", "time", res);
+        }
+    }
+
+    // Typed descriptor getters on built tables: first call (decodes) and second call (cached)
+    {
+        const vector<SubTableSections_t>& eits = corpus.getSubTables((uint8_t)TableId::EIT_SCHED_START);
+        const vector<SubTableSections_t>& sdts = corpus.getSubTables((uint8_t)TableId::SDT);
+        vector<SectionList> eitLists;
+        vector<SectionList> sdtLists;
+        fillLists(eits.empty() ? corpus.getSubTables((uint8_t)TableId::EIT_PF) : eits, eitLists);
+        fillLists(sdts, sdtLists);
+
+        size_t events = 0;
+        size_t services = 0;
+        Result first = { 0, 0 };
+        Result cached = { 0, 0 };
+        for(int r = 0; r < rounds; r++)
+        {
+            vector<SiTablePtr> tables;
+            for(auto it = eitLists.begin(), end = eitLists.end(); it != end; ++it)
+            {
+                tables.push_back(SiTablePtr(it->buildTable()));
+            }
+            for(auto it = sdtLists.begin(), end = sdtLists.end(); it != end; ++it)
+            {
+                tables.push_back(SiTablePtr(it->buildTable()));
+            }
+
+            auto pass = [&]() {
+                events = 0;
+                services = 0;
+                for(auto tbl = tables.begin(), tblEnd = tables.end(); tbl != tblEnd; ++tbl)
+                {
+                    if(SectionList::isEit((uint8_t)(*tbl)->getTableId()))
+                    {
+                        const vector<DvbEvent>& list = static_cast<EitTable*>(tbl->get())->getEvents();
+                        for(auto ev = list.begin(), evEnd = list.end(); ev != evEnd; ++ev)
+                        {
+                            const DescriptorList& descs = ev->getEventDescriptors();
+                            const MpegDescriptor* desc = descs.find(DescriptorTag::SHORT_EVENT);
+                            if(desc)
+                            {
+                                ShortEventDescriptor sed(*desc);
+                                s_sink += sed.getEventName().size() + sed.getText().size();
+                            }
+                            desc = descs.find(DescriptorTag::EXTENDED_EVENT);
+                            if(desc)
+                            {
+                                ExtendedEventDescriptor eed(*desc);
+                                s_sink += eed.getText().size();
+                            }
+                            desc = descs.find(DescriptorTag::CONTENT_DESCRIPTOR);
+                            if(desc)
+                            {
+                                ContentDescriptor cd(*desc);
+                                s_sink += cd.getCount() ? cd.getNibbleLvl1(0) : 0;
+                            }
+                            desc = descs.find(DescriptorTag::PARENTAL_RATING);
+                            if(desc)
+                            {
+                                ParentalRatingDescriptor prd(*desc);
+                                s_sink += prd.getCount();
+                            }
+                            events++;
+                        }
+                    }
+                    else
+                    {
+                        const vector<DvbService>& list = static_cast<SdtTable*>(tbl->get())->getServices();
+                        for(auto srv = list.begin(), srvEnd = list.end(); srv != srvEnd; ++srv)
+                        {
+                            const MpegDescriptor* desc = srv->getServiceDescriptors().find(DescriptorTag::SERVICE);
+                            if(desc)
+                            {
+                                ServiceDescriptor sd(*desc);
+                                s_sink += sd.getServiceName().size() + sd.getServiceProviderName().size();
+                            }
+                            services++;
+                        }
+                    }
+                }
+            };
+
+            pass();
+            size_t items = events + services;
+            Result res = measure(items, 1, [&](int) { pass(); });
+            cached.ns += res.ns / rounds;
+            cached.allocs += res.allocs / rounds;
+
+            // Fresh tables for the decoding pass
+            tables.clear();
+            for(auto it = eitLists.begin(), end = eitLists.end(); it != end; ++it)
+            {
+                tables.push_back(SiTablePtr(it->buildTable()));
+            }
+            for(auto it = sdtLists.begin(), end = sdtLists.end(); it != end; ++it)
+            {
+                tables.push_back(SiTablePtr(it->buildTable()));
+            }
+            res = measure(items, 1, [&](int) { pass(); });
+            first.ns += res.ns / rounds;
+            first.allocs += res.allocs / rounds;
+        }
+        report("descriptor getters, first call", "entry", first);
+        report("descriptor getters, cached", "entry", cached);
+    }
+
+    return 0;
+}
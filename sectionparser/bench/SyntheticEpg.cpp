@@ -0,0 +1,454 @@
+//
+// DVB_SI for Reference Design Kit (RDK)
+//
+// Copyright (C) 2015  Dmitry Barablin & Stan Partridge (stan.partridge@arris.com)
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+#include "SyntheticEpg.h"
+
+// C system includes
+
+// C++ system includes
+#include <algorithm>
+#include <string>
+
+// Other libraries' includes
+
+// Project's includes
+#include "SectionEncoder.h"
+#include "CarouselGenerator.h"
+
+#include "BenchRandom.h"
+
+using std::vector;
+using std::string;
+using std::unique_ptr;
+
+namespace
+{
+    enum
+    {
+        NETWORK_ID = 0x2000,
+        ORIGINAL_NETWORK_ID = 0x2000,
+        FIRST_BOUQUET_ID = 0x1000,
+        MINUTES_PER_DAY = 24 * 60,
+        NOW = 12 * 60,                  //!< minutes into the first day
+        MAX_EXTENDED_TEXT = 200         //!< per extended event descriptor
+    };
+
+    /**
+     * Encode a number as BCD
+     */
+    uint8_t bcd(uint32_t v)
+    {
+        return ((v / 10) << 4) | (v % 10);
+    }
+
+    /**
+     * Descriptor built from its payload bytes
+     */
+    MpegDescriptor makeDescriptor(DescriptorTag tag, vector<uint8_t>& body)
+    {
+        return MpegDescriptor(tag, body.data(), (uint8_t)body.size());
+    }
+
+    /**
+     * Append a coded string with its length byte
+     */
+    void appendString(vector<uint8_t>& body, const string& text)
+    {
+        body.push_back((uint8_t)text.size());
+        body.insert(body.end(), text.begin(), text.end());
+    }
+
+    /**
+     * Get the random generator of an object of the model, independent of the order objects are
+     * built in
+     */
+    BenchRandom getRandom(uint32_t seed, uint32_t kind, uint32_t index)
+    {
+        BenchRandom rnd(seed ^ (kind * 0x9e3779b9u) ^ (index * 0x85ebca6bu));
+        rnd.next();
+        return rnd;
+    }
+}
+
+/**
+ * Constructor
+ *
+ * @param config headend size
+ */
+SyntheticEpg::SyntheticEpg(const EpgConfig& config)
+    : m_config(config)
+{
+    m_config.servicesPerTransport = std::min(m_config.servicesPerTransport, 256u);
+    m_config.scheduleDays = std::min(m_config.scheduleDays, 16u);
+}
+
+/**
+ * Get the service_id of a service
+ *
+ * @param service service index
+ * @return service id
+ */
+uint16_t SyntheticEpg::getServiceId(uint32_t service) const
+{
+    uint32_t transport = service / m_config.servicesPerTransport;
+    return (transport + 1) * 0x100 + service % m_config.servicesPerTransport;
+}
+
+/**
+ * Build the transport stream loop entry of a transport
+ *
+ * @param transport transport index
+ * @return transport stream
+ */
+TransportStream SyntheticEpg::makeTransport(uint32_t transport) const
+{
+    TransportStream ts(transport + 1, ORIGINAL_NETWORK_ID);
+    BenchRandom rnd = getRandom(m_config.seed, 1, transport);
+
+    // 306 MHz + 8 MHz steps, in 100 Hz, 256-QAM, 6.9 MSymbol/s
+    uint32_t freq = 3060000 + transport * 80000;
+    vector<uint8_t> cable = { bcd(freq / 1000000 % 100), bcd(freq / 10000 % 100), bcd(freq / 100 % 100), bcd(freq % 100),
+                              0xff, 0xf2, 0x05, 0x06, 0x95, 0x00, 0x0f };
+    MpegDescriptor cableDesc = makeDescriptor(DescriptorTag::CABLE_DELIVERY, cable);
+    ts.addDescriptor(cableDesc);
+
+    // Service list and logical channel numbers, split in descriptors of up to 255 bytes
+    vector<uint8_t> list;
+    vector<uint8_t> lcn;
+    for(uint32_t s = 0; s < m_config.servicesPerTransport; s++)
+    {
+        uint32_t service = transport * m_config.servicesPerTransport + s;
+        uint16_t sid = getServiceId(service);
+        uint16_t number = service + 1;
+        if(list.size() + 3 > 255)
+        {
+            MpegDescriptor desc = makeDescriptor(DescriptorTag::SERVICE_LIST, list);
+            ts.addDescriptor(desc);
+            list.clear();
+        }
+        if(lcn.size() + 4 > 255)
+        {
+            MpegDescriptor desc = makeDescriptor(DescriptorTag::LOGICAL_CHANNEL, lcn);
+            ts.addDescriptor(desc);
+            lcn.clear();
+        }
+        list.insert(list.end(), { (uint8_t)(sid >> 8), (uint8_t)sid, (uint8_t)(rnd.range(0, 4) ? 0x01 : 0x02) });
+        lcn.insert(lcn.end(), { (uint8_t)(sid >> 8), (uint8_t)sid, (uint8_t)(0xfc | (number >> 8)), (uint8_t)number });
+    }
+    MpegDescriptor listDesc = makeDescriptor(DescriptorTag::SERVICE_LIST, list);
+    MpegDescriptor lcnDesc = makeDescriptor(DescriptorTag::LOGICAL_CHANNEL, lcn);
+    ts.addDescriptor(listDesc);
+    ts.addDescriptor(lcnDesc);
+    return ts;
+}
+
+/**
+ * Build the NIT actual
+ *
+ * @param version version number
+ * @return table
+ */
+unique_ptr<NitTable> SyntheticEpg::buildNit(uint8_t version) const
+{
+    unique_ptr<NitTable> nit(new NitTable((uint8_t)TableId::NIT, NETWORK_ID, version, true));
+
+    BenchRandom rnd = getRandom(m_config.seed, 2, 0);
+    string name = rnd.makeCodedText(rnd.spread(6, 20));
+    vector<uint8_t> body(name.begin(), name.end());
+    MpegDescriptor desc = makeDescriptor(DescriptorTag::NETWORK_NAME, body);
+    nit->addNetworkDescriptor(desc);
+
+    for(uint32_t t = 0; t < m_config.transports; t++)
+    {
+        TransportStream ts = makeTransport(t);
+        nit->addTransportStream(ts);
+    }
+    return nit;
+}
+
+/**
+ * Build a BAT. Bouquet n carries every (n + 1)-th transport stream.
+ *
+ * @param bouquet bouquet index
+ * @param version version number
+ * @return table
+ */
+unique_ptr<BatTable> SyntheticEpg::buildBat(uint32_t bouquet, uint8_t version) const
+{
+    unique_ptr<BatTable> bat(new BatTable((uint8_t)TableId::BAT, FIRST_BOUQUET_ID + bouquet, version, true));
+
+    BenchRandom rnd = getRandom(m_config.seed, 3, bouquet);
+    string name = rnd.makeCodedText(rnd.spread(6, 20));
+    vector<uint8_t> body(name.begin(), name.end());
+    bat->addBouquetDescriptor(makeDescriptor(DescriptorTag::BOUQUET_NAME, body));
+
+    for(uint32_t t = 0; t < m_config.transports; t += bouquet + 1)
+    {
+        bat->addTransportStream(makeTransport(t));
+    }
+    return bat;
+}
+
+/**
+ * Build the SDT actual of a transport stream
+ *
+ * @param transport transport index
+ * @param version version number
+ * @return table
+ */
+unique_ptr<SdtTable> SyntheticEpg::buildSdt(uint32_t transport, uint8_t version) const
+{
+    unique_ptr<SdtTable> sdt(new SdtTable((uint8_t)TableId::SDT, transport + 1, version, true));
+    sdt->setOriginalNetworkId(ORIGINAL_NETWORK_ID);
+
+    for(uint32_t s = 0; s < m_config.servicesPerTransport; s++)
+    {
+        uint32_t service = transport * m_config.servicesPerTransport + s;
+        BenchRandom rnd = getRandom(m_config.seed, 4, service);
+
+        vector<uint8_t> body;
+        body.push_back(rnd.range(0, 4) ? 0x01 : 0x02);
+        appendString(body, rnd.makeCodedText(rnd.spread(3, 12)));
+        appendString(body, rnd.makeCodedText(rnd.spread(4, 24)));
+
+        DvbService dvbService(getServiceId(service), m_config.scheduleDays > 0, true, 4, rnd.range(0, 2) == 0);
+        dvbService.addDescriptor(makeDescriptor(DescriptorTag::SERVICE, body));
+        sdt->addService(dvbService);
+    }
+    return sdt;
+}
+
+/**
+ * Get the events of a service
+ *
+ * @param service service index
+ * @param events filled with the events, in start order
+ */
+void SyntheticEpg::getEvents(uint32_t service, vector<Event>& events) const
+{
+    BenchRandom rnd = getRandom(m_config.seed, 5, service);
+
+    // 15 minutes to 2 hours long, back to back
+    events.clear();
+    uint32_t minutes = 0;
+    uint32_t total = std::max(m_config.scheduleDays, 1u) * MINUTES_PER_DAY;
+    while(minutes < total)
+    {
+        Event event;
+        event.id = events.size() + 1;
+        event.start = minutes;
+        event.duration = rnd.range(1, 8) * 15;
+        events.push_back(event);
+        minutes += event.duration;
+    }
+}
+
+/**
+ * Build an event with its descriptors
+ *
+ * @param service service index
+ * @param event event
+ * @param runningStatus running status
+ * @return event
+ */
+DvbEvent SyntheticEpg::makeEvent(uint32_t service, const Event& event, uint8_t runningStatus) const
+{
+    BenchRandom rnd = getRandom(m_config.seed, 6, (service << 16) | event.id);
+
+    uint32_t mjd = m_config.startMjd + event.start / MINUTES_PER_DAY;
+    uint32_t minute = event.start % MINUTES_PER_DAY;
+    uint64_t start = ((uint64_t)mjd << 24) | (bcd(minute / 60) << 16) | (bcd(minute % 60) << 8);
+    uint32_t duration = (bcd(event.duration / 60) << 16) | (bcd(event.duration % 60) << 8);
+
+    DvbEvent dvbEvent(event.id, start, duration, runningStatus, rnd.range(0, 2) == 0);
+
+    vector<uint8_t> shortEvent = { 'e', 'n', 'g' };
+    appendString(shortEvent, rnd.makeCodedText(rnd.spread(8, 40)));
+    appendString(shortEvent, rnd.makeCodedText(rnd.spread(40, 160)));
+    dvbEvent.addDescriptor(makeDescriptor(DescriptorTag::SHORT_EVENT, shortEvent));
+
+    // Extended description, split over up to three descriptors
+    string text = rnd.makeCodedText(rnd.spread(80, 3 * MAX_EXTENDED_TEXT));
+    uint8_t last = (text.size() - 1) / MAX_EXTENDED_TEXT;
+    for(uint8_t n = 0; n <= last; n++)
+    {
+        vector<uint8_t> extended = { (uint8_t)((n << 4) | last), 'e', 'n', 'g', 0x00 };
+        appendString(extended, text.substr(n * MAX_EXTENDED_TEXT, MAX_EXTENDED_TEXT));
+        dvbEvent.addDescriptor(makeDescriptor(DescriptorTag::EXTENDED_EVENT, extended));
+    }
+
+    vector<uint8_t> content = { (uint8_t)(rnd.range(1, 10) << 4), 0x00 };
+    dvbEvent.addDescriptor(makeDescriptor(DescriptorTag::CONTENT_DESCRIPTOR, content));
+    vector<uint8_t> rating = { 'G', 'B', 'R', (uint8_t)rnd.range(0, 15) };
+    dvbEvent.addDescriptor(makeDescriptor(DescriptorTag::PARENTAL_RATING, rating));
+    return dvbEvent;
+}
+
+/**
+ * Start an EIT actual of a service
+ *
+ * @param tableId table id
+ * @param service service index
+ * @param version version number
+ * @param lastTableId last table id
+ * @return table
+ */
+unique_ptr<EitTable> SyntheticEpg::makeEit(uint8_t tableId, uint32_t service, uint8_t version, uint8_t lastTableId) const
+{
+    unique_ptr<EitTable> eit(new EitTable(tableId, getServiceId(service), version, true));
+    eit->setTsId(service / m_config.servicesPerTransport + 1);
+    eit->setNetworkId(ORIGINAL_NETWORK_ID);
+    eit->setLastTableId(lastTableId);
+    return eit;
+}
+
+/**
+ * Build the EIT p/f actual of a service
+ *
+ * @param service service index
+ * @param version version number
+ * @return table
+ */
+unique_ptr<EitTable> SyntheticEpg::buildEitPf(uint32_t service, uint8_t version) const
+{
+    unique_ptr<EitTable> eit = makeEit((uint8_t)TableId::EIT_PF, service, version, (uint8_t)TableId::EIT_PF);
+
+    vector<Event> events;
+    getEvents(service, events);
+    for(size_t n = 0; n < events.size(); n++)
+    {
+        if(events[n].start + events[n].duration > NOW)
+        {
+            // Present (running) and following (starts in a few seconds if it is short)
+            DvbEvent present = makeEvent(service, events[n], 4);
+            eit->addEvent(present);
+            if(n + 1 < events.size())
+            {
+                DvbEvent following = makeEvent(service, events[n + 1], 1);
+                eit->addEvent(following);
+            }
+            break;
+        }
+    }
+    return eit;
+}
+
+/**
+ * Build an EIT schedule actual sub-table of a service
+ *
+ * @param service service index
+ * @param table table_id index (0 for 0x50, 4 days each)
+ * @param version version number
+ * @return table
+ */
+unique_ptr<EitTable> SyntheticEpg::buildEitSchedule(uint32_t service, uint32_t table, uint8_t version) const
+{
+    uint8_t first = (uint8_t)TableId::EIT_SCHED_START;
+    unique_ptr<EitTable> eit = makeEit(first + table, service, version, first + getScheduleTableCount() - 1);
+
+    vector<Event> events;
+    getEvents(service, events);
+
+    uint32_t begin = table * 4 * MINUTES_PER_DAY;
+    uint32_t end = std::min(begin + 4 * MINUTES_PER_DAY, m_config.scheduleDays * MINUTES_PER_DAY);
+    for(auto it = events.begin(); it != events.end(); ++it)
+    {
+        if(it->start >= begin && it->start < end)
+        {
+            DvbEvent event = makeEvent(service, *it, 1);
+            eit->addEvent(event);
+        }
+    }
+    return eit;
+}
+
+/**
+ * Build the TOT
+ *
+ * @return table
+ */
+unique_ptr<TotTable> SyntheticEpg::buildTot() const
+{
+    unique_ptr<TotTable> tot(new TotTable((uint8_t)TableId::TOT, 0, 0, true));
+    tot->setUtcTime(((uint64_t)m_config.startMjd << 24) | (bcd(NOW / 60) << 16));
+
+    // Local time offset of two regions, +01:00 with a change to +02:00
+    vector<uint8_t> lto;
+    const char* countries[] = { "GBR", "IRL" };
+    for(size_t c = 0; c < 2; c++)
+    {
+        lto.insert(lto.end(), countries[c], countries[c] + 3);
+        lto.insert(lto.end(), { 0x02, 0x01, 0x00, (uint8_t)(m_config.startMjd >> 8), (uint8_t)m_config.startMjd,
+                                0x01, 0x00, 0x00, 0x02, 0x00 });
+    }
+    tot->addDescriptor(makeDescriptor(DescriptorTag::LOCAL_TIME_OFFSET, lto));
+    return tot;
+}
+
+/**
+ * Encode every table and add the sub-tables to a carousel, network level tables first, then
+ * the EITs service by service
+ *
+ * @param encoder encoder
+ * @param version version number of the tables
+ * @param carousel carousel the sub-tables are added to
+ * @param replace true if the carousel holds the sub-tables of an earlier call, to be replaced
+ *        by the new version
+ * @return false if a table could not be encoded, true otherwise
+ */
+bool SyntheticEpg::encode(const SectionEncoder& encoder, uint8_t version, CarouselGenerator& carousel, bool replace) const
+{
+    SubTableSections_t sections;
+    size_t index = 0;
+    bool ok = true;
+
+    auto add = [&](const SiTable& table) {
+        ok = encoder.encode(table, sections) && ok;
+        if(replace)
+        {
+            carousel.replaceSubTable(index++, sections);
+        }
+        else
+        {
+            carousel.addSubTable(sections);
+        }
+    };
+
+    add(*buildNit(version));
+    for(uint32_t b = 0; b < m_config.bouquets; b++)
+    {
+        add(*buildBat(b, version));
+    }
+    for(uint32_t t = 0; t < m_config.transports; t++)
+    {
+        add(*buildSdt(t, version));
+    }
+    add(*buildTot());
+
+    for(uint32_t s = 0; s < getServiceCount(); s++)
+    {
+        add(*buildEitPf(s, version));
+        for(uint32_t n = 0; n < getScheduleTableCount(); n++)
+        {
+            add(*buildEitSchedule(s, n, version));
+        }
+    }
+    return ok;
+}
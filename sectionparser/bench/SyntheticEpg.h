@@ -0,0 +1,264 @@
+//
+// DVB_SI for Reference Design Kit (RDK)
+//
+// Copyright (C) 2015  Dmitry Barablin & Stan Partridge (stan.partridge@arris.com)
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+#ifndef SYNTHETICEPG_H_
+#define SYNTHETICEPG_H_
+
+// C system includes
+#include <stdint.h>
+#include <stddef.h>
+
+// C++ system includes
+#include <memory>
+#include <vector>
+
+// Other libraries' includes
+
+// Project's includes
+#include "NitTable.h"
+#include "BatTable.h"
+#include "SdtTable.h"
+#include "EitTable.h"
+#include "TotTable.h"
+
+class SectionEncoder;
+class CarouselGenerator;
+
+/**
+ * Size of the synthetic headend
+ */
+struct EpgConfig
+{
+    /**
+     * Constructor: a large cable headend
+     */
+    EpgConfig()
+        : transports(50),
+          servicesPerTransport(30),
+          bouquets(4),
+          scheduleDays(8),
+          startMjd(0xE32A),
+          seed(0x5eed)
+    {
+    }
+
+    uint32_t transports;
+
+    /**
+     * Services per transport stream (at most 256)
+     */
+    uint32_t servicesPerTransport;
+
+    uint32_t bouquets;
+
+    /**
+     * Days of EIT schedule per service (at most 16, table_id 0x50 to 0x53)
+     */
+    uint32_t scheduleDays;
+
+    /**
+     * First day of the schedule; the TOT and the present events are at 12:00 UTC of that day
+     */
+    uint16_t startMjd;
+
+    /**
+     * Seed of the random generator: the same seed gives the same tables
+     */
+    uint32_t seed;
+};
+
+/**
+ * SyntheticEpg
+ *
+ * Deterministic model of the SI of a headend: transports with cable delivery, service list and
+ * channel number descriptors, bouquets, named services, and a gapless event schedule per service
+ * with short, extended (one to three descriptors per event), content and parental rating
+ * descriptors. The tables are built on request, so the whole schedule never has to be in memory
+ * as table objects at once.
+ */
+class SyntheticEpg
+{
+public:
+    /**
+     * Constructor
+     *
+     * @param config headend size
+     */
+    explicit SyntheticEpg(const EpgConfig& config);
+
+    /**
+     * Get the configuration
+     *
+     * @return configuration
+     */
+    const EpgConfig& getConfig() const
+    {
+        return m_config;
+    }
+
+    /**
+     * Get the number of services
+     *
+     * @return count
+     */
+    uint32_t getServiceCount() const
+    {
+        return m_config.transports * m_config.servicesPerTransport;
+    }
+
+    /**
+     * Get the number of EIT schedule table_ids per service
+     *
+     * @return count
+     */
+    uint32_t getScheduleTableCount() const
+    {
+        return (m_config.scheduleDays + 3) / 4;
+    }
+
+    /**
+     * Build the NIT actual
+     *
+     * @param version version number
+     * @return table
+     */
+    std::unique_ptr<NitTable> buildNit(uint8_t version) const;
+
+    /**
+     * Build a BAT. Bouquet n carries every (n + 1)-th transport stream.
+     *
+     * @param bouquet bouquet index
+     * @param version version number
+     * @return table
+     */
+    std::unique_ptr<BatTable> buildBat(uint32_t bouquet, uint8_t version) const;
+
+    /**
+     * Build the SDT actual of a transport stream
+     *
+     * @param transport transport index
+     * @param version version number
+     * @return table
+     */
+    std::unique_ptr<SdtTable> buildSdt(uint32_t transport, uint8_t version) const;
+
+    /**
+     * Build the EIT p/f actual of a service
+     *
+     * @param service service index
+     * @param version version number
+     * @return table
+     */
+    std::unique_ptr<EitTable> buildEitPf(uint32_t service, uint8_t version) const;
+
+    /**
+     * Build an EIT schedule actual sub-table of a service
+     *
+     * @param service service index
+     * @param table table_id index (0 for 0x50, 4 days each)
+     * @param version version number
+     * @return table
+     */
+    std::unique_ptr<EitTable> buildEitSchedule(uint32_t service, uint32_t table, uint8_t version) const;
+
+    /**
+     * Build the TOT
+     *
+     * @return table
+     */
+    std::unique_ptr<TotTable> buildTot() const;
+
+    /**
+     * Encode every table and add the sub-tables to a carousel, network level tables first, then
+     * the EITs service by service
+     *
+     * @param encoder encoder
+     * @param version version number of the tables
+     * @param carousel carousel the sub-tables are added to
+     * @param replace true if the carousel holds the sub-tables of an earlier call, to be replaced
+     *        by the new version
+     * @return false if a table could not be encoded, true otherwise
+     */
+    bool encode(const SectionEncoder& encoder, uint8_t version, CarouselGenerator& carousel, bool replace = false) const;
+
+private:
+    /**
+     * Event of the schedule (no descriptors, they are built with the table)
+     */
+    struct Event
+    {
+        uint16_t id;
+
+        /**
+         * Minutes from the start of the schedule
+         */
+        uint32_t start;
+        uint32_t duration;
+    };
+
+    /**
+     * Get the service_id of a service
+     *
+     * @param service service index
+     * @return service id
+     */
+    uint16_t getServiceId(uint32_t service) const;
+
+    /**
+     * Get the events of a service
+     *
+     * @param service service index
+     * @param events filled with the events, in start order
+     */
+    void getEvents(uint32_t service, std::vector<Event>& events) const;
+
+    /**
+     * Build an event with its descriptors
+     *
+     * @param service service index
+     * @param event event
+     * @param runningStatus running status
+     * @return event
+     */
+    DvbEvent makeEvent(uint32_t service, const Event& event, uint8_t runningStatus) const;
+
+    /**
+     * Build the transport stream loop entry of a transport
+     *
+     * @param transport transport index
+     * @return transport stream
+     */
+    TransportStream makeTransport(uint32_t transport) const;
+
+    /**
+     * Start an EIT actual of a service
+     *
+     * @param tableId table id
+     * @param service service index
+     * @param version version number
+     * @param lastTableId last table id
+     * @return table
+     */
+    std::unique_ptr<EitTable> makeEit(uint8_t tableId, uint32_t service, uint8_t version, uint8_t lastTableId) const;
+
+    EpgConfig m_config;
+};
+
+#endif /* SYNTHETICEPG_H_ */
@@ -27,7 +27,7 @@
 
 // Project's includes
 #include "SiTable.h"
-#include "MpegDescriptor.h"
+#include "DescriptorList.h"
 #include "TransportStream.h"
 
 /**
@@ -49,6 +49,21 @@ public:
     {
     }
 
+    /**
+     * Reinitialize the table for reuse
+     *
+     * @param id table identifier
+     * @param extId table identifier extension
+     * @param ver version number
+     * @param cur current/next indicator
+     */
+    virtual void reset(uint8_t id, uint16_t extId, uint8_t ver, bool cur)
+    {
+        SiTable::reset(id, extId, ver, cur);
+        m_bouquetDescriptors.clear();
+        m_tsList.clear();
+    }
+
     /**
      * Get bouquet identifier
      *
@@ -74,17 +89,17 @@ public:
      *
      * @param descriptors bouquet descriptors
      */
-    void addBouquetDescriptors(const std::vector<MpegDescriptor>& descriptors)
+    void addBouquetDescriptors(const DescriptorList& descriptors)
     {
-        m_bouquetDescriptors.insert(m_bouquetDescriptors.end(), descriptors.begin(), descriptors.end());
+        m_bouquetDescriptors.append(descriptors);
     }
 
     /**
      * Get bouquet descriptors
      *
-     * @return vector of bouquet descriptors
+     * @return list of bouquet descriptors
      */
-    const std::vector<MpegDescriptor>& getBouquetDescriptors() const
+    const DescriptorList& getBouquetDescriptors() const
     {
         return m_bouquetDescriptors;
     }
@@ -129,7 +144,7 @@ private:
     /**
      * Bouquet descriptors
      */
-    std::vector<MpegDescriptor> m_bouquetDescriptors;
+    DescriptorList m_bouquetDescriptors;
 
     /**
      * List of transport streams
@@ -0,0 +1,213 @@
+//
+// DVB_SI for Reference Design Kit (RDK)
+//
+// Copyright (C) 2015  Dmitry Barablin & Stan Partridge (stan.partridge@arris.com)
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+
+#ifndef BITFIELD_H_
+#define BITFIELD_H_
+
+// C system includes
+#include <stdint.h>
+#include <stddef.h>
+
+// C++ system includes
+#include <type_traits>
+
+// Other libraries' includes
+
+// Project's includes
+
+// Compile time description of the bit fields of the ETSI EN 300 468 structures.
+//
+// A field is given by its bit offset (from the MSB of the structure's first byte) and width,
+// exactly as in the syntax tables of the standard. Its extractor loads just the bytes the field
+// spans, big endian, and shifts/masks them; everything is known at compile time, so it inlines
+// to the same code as the hand written shifts. A layout groups the fields of a structure and
+// checks the size of the data once, before any field is read:
+//
+//    struct ServiceEntry : BitLayout<3>
+//    {
+//        typedef Field<0, 16> ServiceId;
+//        typedef Field<16, 8> ServiceType;
+//    };
+//
+//    if(ServiceEntry::fits(p, end))
+//    {
+//        uint16_t serviceId = ServiceEntry::ServiceId::get(p);
+//        ...
+//    }
+//
+// set() writes a field back, leaving the other bits of its bytes alone (reserved bits are
+// usually preset to 1 by filling the structure with 0xff first).
+
+/**
+ * Smallest unsigned type holding a field of the given width
+ */
+template<size_t Width>
+struct BitFieldType
+{
+    typedef typename std::conditional<(Width <= 8), uint8_t,
+            typename std::conditional<(Width <= 16), uint16_t,
+            typename std::conditional<(Width <= 32), uint32_t, uint64_t>::type>::type>::type type;
+};
+
+/**
+ * Big endian load of Count bytes starting at byte First
+ */
+template<typename Word, size_t First, size_t Count>
+struct BigEndianLoad
+{
+    static Word get(const uint8_t* p)
+    {
+        return ((Word)p[First] << ((Count - 1) * 8)) | BigEndianLoad<Word, First + 1, Count - 1>::get(p);
+    }
+};
+
+template<typename Word, size_t First>
+struct BigEndianLoad<Word, First, 0>
+{
+    static Word get(const uint8_t*)
+    {
+        return 0;
+    }
+};
+
+/**
+ * Big endian store of the low Count bytes of a word, starting at byte First
+ */
+template<typename Word, size_t First, size_t Count>
+struct BigEndianStore
+{
+    static void set(uint8_t* p, Word word)
+    {
+        p[First] = (uint8_t)(word >> ((Count - 1) * 8));
+        BigEndianStore<Word, First + 1, Count - 1>::set(p, word);
+    }
+};
+
+template<typename Word, size_t First>
+struct BigEndianStore<Word, First, 0>
+{
+    static void set(uint8_t*, Word)
+    {
+    }
+};
+
+/**
+ * Bit field of a big endian structure
+ *
+ * @tparam Offset bit offset from the start of the structure
+ * @tparam Width width in bits
+ * @tparam T value type (defaults to the smallest unsigned type holding the field)
+ */
+template<size_t Offset, size_t Width, typename T = typename BitFieldType<Width>::type>
+struct BitField
+{
+    typedef T value_type;
+
+    enum : size_t
+    {
+        OFFSET = Offset,
+        WIDTH = Width,
+        FIRST_BYTE = Offset / 8,                       //!< first byte the field spans
+        END_BYTE = (Offset + Width + 7) / 8,           //!< one past the last byte the field spans
+        BYTE_COUNT = END_BYTE - FIRST_BYTE,
+        SHIFT = END_BYTE * 8 - (Offset + Width)        //!< bits to the right of the field
+    };
+
+    static_assert(Width > 0, "empty bit field");
+    static_assert(BYTE_COUNT <= 8, "bit field spans more than 8 bytes");
+
+    /**
+     * Word the field's bytes are loaded into
+     */
+    typedef typename std::conditional<(BYTE_COUNT <= 4), uint32_t, uint64_t>::type Word;
+
+    /**
+     * Extract the field
+     *
+     * @param p start of the structure
+     * @return field value
+     */
+    static T get(const uint8_t* p)
+    {
+        Word word = BigEndianLoad<Word, FIRST_BYTE, BYTE_COUNT>::get(p);
+        return static_cast<T>((word >> SHIFT) & mask());
+    }
+
+    /**
+     * Store the field, the other bits of the bytes it spans are kept
+     *
+     * @param p start of the structure
+     * @param value field value (truncated to the field's width)
+     */
+    static void set(uint8_t* p, T value)
+    {
+        Word word = BigEndianLoad<Word, FIRST_BYTE, BYTE_COUNT>::get(p);
+        word &= ~(mask() << SHIFT);
+        word |= ((Word)value & mask()) << SHIFT;
+        BigEndianStore<Word, FIRST_BYTE, BYTE_COUNT>::set(p, word);
+    }
+
+private:
+    /**
+     * Mask of the field's width
+     */
+    static constexpr Word mask()
+    {
+        return (Width >= sizeof(Word) * 8) ? ~(Word)0 : (((Word)1 << (Width % (sizeof(Word) * 8))) - 1);
+    }
+};
+
+/**
+ * Fixed size structure (or loop entry) of an SI table or descriptor
+ *
+ * @tparam Size size in bytes
+ */
+template<size_t Size>
+struct BitLayout
+{
+    enum : size_t
+    {
+        SIZE = Size
+    };
+
+    /**
+     * Field of the structure; fields reaching past the structure don't compile
+     */
+    template<size_t Offset, size_t Width, typename T = typename BitFieldType<Width>::type>
+    struct Field : BitField<Offset, Width, T>
+    {
+        static_assert(Offset + Width <= Size * 8, "bit field exceeds the structure");
+    };
+
+    /**
+     * Check if the structure fits in the data, so all of its fields can be read
+     *
+     * @param p start of the structure
+     * @param end end of the data
+     * @return true if the structure fits, false otherwise
+     */
+    static bool fits(const uint8_t* p, const uint8_t* end)
+    {
+        return (p <= end) && ((size_t)(end - p) >= Size);
+    }
+};
+
+#endif /* BITFIELD_H_ */
@@ -28,6 +28,20 @@
 // Project's includes
 #include "MpegDescriptor.h"
 #include "DvbUtils.h"
+#include "BitField.h"
+
+// Syntax of the descriptor from ETSI EN 300 468
+//
+//cable_delivery_system_descriptor(){
+//    descriptor_tag             8 uimsbf
+//    descriptor_length          8 uimsbf
+//    frequency                 32 bslbf
+//    reserved_future_use       12 bslbf
+//    FEC_outer                  4 bslbf
+//    modulation                 8 bslbf
+//    symbol_rate               28 bslbf
+//    FEC_inner                  4 bslbf
+//}
 
 /**
  * Cable delivery system descriptor class
@@ -50,9 +64,9 @@ public:
      *
      * @return frequency (BCD)
      */
-    uint32_t getFrequencyBcd()
+    uint32_t getFrequencyBcd() const
     {
-        return ((m_data[0] << 24) | (m_data[1] << 16) | (m_data[2] << 8) | (m_data[3]));
+        return Header::Frequency::get(m_data.data());
     }
 
     /**
@@ -60,9 +74,10 @@ public:
      *
      * @return frequency
      */
-    uint32_t getFrequency()
+    uint32_t getFrequency() const
     {
-        return BcdToDec((m_data[0] << 8) | m_data[1]) * 1000000 + BcdToDec((m_data[2] << 8) | m_data[3]) * 100;
+        uint32_t bcd = getFrequencyBcd();
+        return BcdToDec(bcd >> 16) * 1000000 + BcdToDec(bcd & 0xffff) * 100;
     }
 
     /**
@@ -83,9 +98,9 @@ public:
      *
      * @return modulation
      */
-    CableDeliverySystemDescriptor::Modulation getModulation()
+    CableDeliverySystemDescriptor::Modulation getModulation() const
     {
-        return static_cast<CableDeliverySystemDescriptor::Modulation>(m_data[6]);
+        return static_cast<CableDeliverySystemDescriptor::Modulation>(Header::Modulation::get(m_data.data()));
     }
 
     /**
@@ -93,9 +108,9 @@ public:
      *
      * @return symbol rate (BCD)
      */
-    uint32_t getSymbolRateBcd()
+    uint32_t getSymbolRateBcd() const
     {
-        return ((m_data[7] << 20) | (m_data[8] << 12) | (m_data[9] << 4) | (m_data[10] >> 4));
+        return Header::SymbolRate::get(m_data.data());
     }
 
     /**
@@ -103,10 +118,10 @@ public:
      *
      * @return symbol rate
      */
-    uint32_t getSymbolRate()
+    uint32_t getSymbolRate() const
     {
-        return (BcdByteToDec(m_data[7])*100000 + BcdByteToDec(m_data[8])*1000 +
-                BcdByteToDec(m_data[9])*10 + BcdByteToDec(m_data[10]>>4))*100;
+        uint32_t bcd = getSymbolRateBcd();
+        return (BcdToDec(bcd >> 12)*1000 + BcdToDec(bcd & 0xfff))*100;
     }
 
     /**
@@ -114,9 +129,9 @@ public:
      *
      * @return FEC_inner
      */
-    uint8_t  getFecInner()
+    uint8_t  getFecInner() const
     {
-        return (m_data[10] & 0xf);
+        return Header::FecInner::get(m_data.data());
     }
 
     /**
@@ -124,9 +139,9 @@ public:
      *
      * @return FEC_outer
      */
-    uint8_t  getFecOuter()
+    uint8_t  getFecOuter() const
     {
-        return (m_data[5] & 0xf);
+        return Header::FecOuter::get(m_data.data());
     }
 
     /**
@@ -138,6 +153,19 @@ public:
     {
         return std::string("Not implemented");
     }
+
+private:
+    /**
+     * Descriptor data
+     */
+    struct Header : BitLayout<11>
+    {
+        typedef Field<0, 32> Frequency;
+        typedef Field<44, 4> FecOuter;
+        typedef Field<48, 8> Modulation;
+        typedef Field<56, 28> SymbolRate;
+        typedef Field<84, 4> FecInner;
+    };
 };
 
 #endif /* CABLEDELIVERYSYSTEMDESCRIPTOR_H_ */
@@ -0,0 +1,339 @@
+//
+// DVB_SI for Reference Design Kit (RDK)
+//
+// Copyright (C) 2015  Dmitry Barablin & Stan Partridge (stan.partridge@arris.com)
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+#ifndef CAROUSELGENERATOR_H_
+#define CAROUSELGENERATOR_H_
+
+// C system includes
+#include <stdint.h>
+#include <stddef.h>
+
+// C++ system includes
+#include <vector>
+#include <queue>
+
+// Other libraries' includes
+
+// Project's includes
+#include "SectionEncoder.h"
+
+/**
+ * Section callback of CarouselGenerator::run()
+ *
+ * @param context calling context
+ * @param data section data
+ * @param size section size
+ * @param pid PID the section is sent on
+ * @param time send time, nanoseconds from the start of the carousel
+ */
+typedef void (*CarouselSectionCallback) (void* context, const uint8_t* data, uint32_t size, uint16_t pid, uint64_t time);
+
+/**
+ * How the sections of a sub-table are sent in one repetition interval
+ */
+enum class CarouselOrder : uint8_t
+{
+    SPREAD,     //!< evenly spaced over the interval (default)
+    BURST       //!< back to back at the start of the interval
+};
+
+/**
+ * Section handed out by CarouselGenerator::next()
+ */
+struct CarouselSection
+{
+    /**
+     * Section data, valid until the next call to CarouselGenerator::next()
+     */
+    const SectionData_t* data;
+
+    uint16_t pid;
+
+    /**
+     * Send time, nanoseconds from the start of the carousel
+     */
+    uint64_t time;
+
+    /**
+     * Sub-table index (see CarouselGenerator::addSubTable())
+     */
+    size_t subTable;
+};
+
+/**
+ * CarouselGenerator
+ *
+ * Plays encoded sub-tables (see SectionEncoder) as an SI carousel: every sub-table is repeated
+ * with the repetition interval of its table_id, the sub-tables of a table_id are staggered over
+ * the interval in the order they were added, and the send times are computed on a virtual clock
+ * starting at 0. Nothing sleeps; a caller that needs real time paces on the send times.
+ *
+ * With a bitrate set, every section takes its share of the SI bandwidth (TS packets of 188 bytes
+ * carrying 184 bytes of section data); a carousel that does not fit falls behind, the way an
+ * overloaded multiplexer stretches its repetition intervals.
+ *
+ * The default repetition intervals are the maximum ones of ETSI TS 101 211 (4.4): NIT, BAT and
+ * other SDT 10 s, actual SDT and EIT p/f 2 s, other EIT p/f 10 s, actual EIT schedule 10 s for
+ * the first table_id and 30 s beyond, other EIT schedule and TDT/TOT 30 s.
+ */
+class CarouselGenerator
+{
+public:
+    enum
+    {
+        UNKNOWN_PID = 0xFFFF,           //!< the standard SI PID of the table_id is used
+        TS_PACKET_SIZE = 188,
+        TS_PAYLOAD_SIZE = 184
+    };
+
+    /**
+     * Constructor
+     */
+    CarouselGenerator();
+
+    /**
+     * Destructor
+     */
+    ~CarouselGenerator();
+
+    /**
+     * Add a sub-table to the carousel
+     *
+     * @param sections sections of the sub-table, copied
+     * @param pid PID to send it on, UNKNOWN_PID for the standard SI PID of its table_id
+     * @return sub-table index
+     */
+    size_t addSubTable(const SubTableSections_t& sections, uint16_t pid = UNKNOWN_PID);
+
+    /**
+     * Replace the sections of a sub-table (a new version). The sections in the current round are
+     * sent out, the new ones from the next round on.
+     *
+     * @param index sub-table index
+     * @param sections new sections, copied; none to take the sub-table off the carousel
+     */
+    void replaceSubTable(size_t index, const SubTableSections_t& sections);
+
+    /**
+     * Get the sections of a sub-table (the pending new version if there is one)
+     *
+     * @param index sub-table index
+     * @return sections
+     */
+    const SubTableSections_t& getSubTable(size_t index) const;
+
+    /**
+     * Get the number of sub-tables
+     *
+     * @return count
+     */
+    size_t getSubTableCount() const
+    {
+        return m_subTables.size();
+    }
+
+    /**
+     * Get the size of one round of the carousel (every section of every sub-table once)
+     *
+     * @return bytes
+     */
+    uint64_t getBytes() const;
+
+    /**
+     * Set the repetition interval of the sub-tables of a table_id
+     *
+     * @param tableId table id
+     * @param ms interval in milliseconds
+     */
+    void setRepetitionInterval(uint8_t tableId, uint32_t ms);
+
+    /**
+     * Get the repetition interval of the sub-tables of a table_id
+     *
+     * @param tableId table id
+     * @return interval in milliseconds
+     */
+    uint32_t getRepetitionInterval(uint8_t tableId) const
+    {
+        return m_intervals[tableId];
+    }
+
+    /**
+     * Set how the sections of a sub-table are sent within an interval
+     *
+     * @param order order
+     */
+    void setOrder(CarouselOrder order)
+    {
+        m_order = order;
+    }
+
+    /**
+     * Set the bandwidth of the SI
+     *
+     * @param bitsPerSecond bitrate, 0 for unlimited (the default)
+     */
+    void setBitrate(uint64_t bitsPerSecond)
+    {
+        m_bitrate = bitsPerSecond;
+    }
+
+    /**
+     * Get the next section of the carousel
+     *
+     * @param section filled with the section
+     * @return false if the carousel is empty, true otherwise
+     */
+    bool next(CarouselSection& section);
+
+    /**
+     * Send the sections of a stretch of the carousel
+     *
+     * @param duration nanoseconds to run, starting at the time the previous call stopped
+     * @param callback called for every section
+     * @param context callback context
+     * @return number of sections sent
+     */
+    uint64_t run(uint64_t duration, CarouselSectionCallback callback, void* context);
+
+    /**
+     * Get the current time of the carousel
+     *
+     * @return nanoseconds from the start
+     */
+    uint64_t getTime() const
+    {
+        return m_time;
+    }
+
+    /**
+     * Restart the carousel at time 0
+     */
+    void rewind();
+
+private:
+    /**
+     * Sub-table and its carousel state
+     */
+    struct SubTable
+    {
+        SubTableSections_t sections;
+
+        /**
+         * New version, sent from the next round on
+         */
+        SubTableSections_t pending;
+        bool replaced;
+
+        uint16_t pid;
+
+        /**
+         * Start of the current round, nanoseconds
+         */
+        uint64_t roundStart;
+    };
+
+    /**
+     * Next section of a sub-table, as queued
+     */
+    struct Slot
+    {
+        uint64_t due;
+        uint64_t sequence;
+        uint32_t subTable;
+        uint32_t section;
+
+        /**
+         * Priority order: the later slot is the lower one
+         */
+        bool operator<(const Slot& other) const
+        {
+            return (due != other.due) ? (due > other.due) : (sequence > other.sequence);
+        }
+    };
+
+    /**
+     * Queue the first round of every sub-table, staggered per table_id
+     */
+    void start();
+
+    /**
+     * Queue a section of a sub-table
+     *
+     * @param index sub-table index
+     * @param section section number within the round
+     */
+    void schedule(size_t index, size_t section);
+
+    /**
+     * Get the repetition interval of a sub-table
+     *
+     * @param subTable sub-table
+     * @return nanoseconds
+     */
+    uint64_t getInterval(const SubTable& subTable) const;
+
+    /**
+     * Get the time a section takes on the wire
+     *
+     * @param size section size
+     * @return nanoseconds, 0 if the bitrate is unlimited
+     */
+    uint64_t getSendTime(size_t size) const;
+
+    /**
+     * Copy constructor
+     */
+    CarouselGenerator(const CarouselGenerator& other);
+
+    /**
+     * Assignment operator
+     */
+    CarouselGenerator& operator=(const CarouselGenerator&);
+
+    std::vector<SubTable> m_subTables;
+
+    /**
+     * Next section of every sub-table
+     */
+    std::priority_queue<Slot> m_queue;
+
+    /**
+     * Repetition intervals per table_id, milliseconds
+     */
+    uint32_t m_intervals[256];
+
+    CarouselOrder m_order;
+    uint64_t m_bitrate;
+
+    /**
+     * Current time, the end of the last section sent
+     */
+    uint64_t m_time;
+
+    /**
+     * Queue order of slots due at the same time
+     */
+    uint64_t m_sequence;
+
+    bool m_started;
+};
+
+#endif /* CAROUSELGENERATOR_H_ */
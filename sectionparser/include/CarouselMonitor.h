@@ -0,0 +1,288 @@
+//
+// DVB_SI for Reference Design Kit (RDK)
+//
+// Copyright (C) 2015  Dmitry Barablin & Stan Partridge (stan.partridge@arris.com)
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+#ifndef CAROUSELMONITOR_H_
+#define CAROUSELMONITOR_H_
+
+// C system includes
+#include <stdint.h>
+#include <stddef.h>
+
+// C++ system includes
+#include <atomic>
+#include <vector>
+#include <memory>
+#include <mutex>
+
+// Other libraries' includes
+
+// Project's includes
+#include "SubTableMap.h"
+#include "ParserStats.h"
+
+/**
+ * Carousel timing of the sub-tables of one table_id on one PID (snapshot).
+ * All the times are in microseconds.
+ */
+struct CarouselEstimate
+{
+    /**
+     * Constructor
+     */
+    CarouselEstimate()
+        : pid(0),
+          tableId(0),
+          subTables(0),
+          repetitionEwma(0),
+          cycleEwma(0)
+    {
+    }
+
+    uint16_t pid;
+    uint8_t tableId;
+
+    /**
+     * Number of sub-tables seen
+     */
+    uint32_t subTables;
+
+    /**
+     * Interval between two transmissions of the same section, moving average
+     */
+    uint64_t repetitionEwma;
+
+    /**
+     * Interval between two transmissions of the same section, distribution
+     */
+    HistogramSnapshot repetition;
+
+    /**
+     * Time to receive every section of every sub-table once, moving average. This is the time a
+     * scan has to wait for the table_id. 0 until the first full cycle has been measured.
+     */
+    uint64_t cycleEwma;
+
+    /**
+     * Time to receive every section of every sub-table once, distribution
+     */
+    HistogramSnapshot cycle;
+};
+
+/**
+ * CarouselMonitor
+ *
+ * Measures how the SI carousel repeats, per PID and table_id, from the arrival times of the
+ * sections (duplicates included).
+ *
+ * Repetition interval: the first section number seen of every sub-table is its anchor, the time
+ * between two arrivals of the anchor is a repetition sample.
+ *
+ * Cycle time: a cycle ends when every section of every sub-table of the PID/table_id known at that
+ * time has been received again since the cycle started. The first two cycles are used to learn
+ * the sub-tables and their sections, samples start with the third.
+ *
+ * Moving averages use a weight of 1/8 for the new sample. Updated by the thread calling
+ * SectionParser::parse() only; snapshots may be taken from any thread.
+ */
+class CarouselMonitor
+{
+public:
+    enum
+    {
+        UNKNOWN_PID = 0xFFFF,   //!< the standard SI PID of the table_id is assumed
+        LEARNING_CYCLES = 2     //!< cycles without samples
+    };
+
+    /**
+     * Constructor
+     */
+    CarouselMonitor();
+
+    /**
+     * Destructor
+     */
+    ~CarouselMonitor();
+
+    /**
+     * Record the arrival of a section
+     *
+     * @param key sub-table key
+     * @param pid PID the section was carried on, UNKNOWN_PID if not known
+     * @param data section data
+     * @param size data size
+     * @param now arrival time, nanoseconds of the monotonic clock (see ParserStats::now())
+     */
+    void onSection(SubTableKey key, uint16_t pid, const uint8_t* data, uint32_t size, uint64_t now);
+
+    /**
+     * Get the estimates of a PID and table_id
+     *
+     * @param pid PID, UNKNOWN_PID for the standard SI PID of the table_id
+     * @param tableId table id
+     * @param estimate filled with the estimates
+     * @return true if sections of the table_id have been seen on the PID, false otherwise
+     */
+    bool getEstimate(uint16_t pid, uint8_t tableId, CarouselEstimate& estimate) const;
+
+    /**
+     * Get the estimates of all the PIDs and table_ids seen
+     *
+     * @param estimates filled with the estimates, in the order the PID/table_id was first seen
+     */
+    void getEstimates(std::vector<CarouselEstimate>& estimates) const;
+
+    /**
+     * Get the standard SI PID of a table_id (ETSI EN 300 468, 5.1.3)
+     *
+     * @param tableId table id
+     * @return PID, UNKNOWN_PID if the table_id has no standard PID
+     */
+    static uint16_t getStandardPid(uint8_t tableId);
+
+private:
+    /**
+     * Sub-tables of one PID and table_id
+     */
+    struct Group
+    {
+        /**
+         * Constructor
+         *
+         * @param p PID
+         * @param id table id
+         */
+        Group(uint16_t p, uint8_t id);
+
+        /**
+         * Take a snapshot
+         *
+         * @param estimate filled with the estimates
+         */
+        void load(CarouselEstimate& estimate) const;
+
+        uint16_t pid;
+        uint8_t tableId;
+
+        // Cycle tracking, used by the parsing thread only
+        uint32_t cycleId;
+        uint64_t cycleStart;
+        uint32_t done;
+
+        // Estimates
+        std::atomic<uint64_t> members;
+        std::atomic<uint64_t> repetitionEwma;
+        std::atomic<uint64_t> cycleEwma;
+        LatencyHistogram repetition;
+        LatencyHistogram cycle;
+    };
+
+    /**
+     * Arrival state of one sub-table
+     */
+    struct SubTable
+    {
+        /**
+         * Constructor
+         */
+        SubTable();
+
+        /**
+         * Last arrival of the anchor section, microseconds, 0 if none
+         */
+        uint64_t anchorTime;
+
+        /**
+         * Section numbers seen in the current version
+         */
+        uint32_t known[8];
+
+        /**
+         * Section numbers seen in the current cycle of the group
+         */
+        uint32_t cycle[8];
+
+        /**
+         * Cycle of the group the cycle bitmap belongs to
+         */
+        uint32_t cycleId;
+
+        /**
+         * Group index + 1, 0 for a new sub-table
+         */
+        uint32_t group;
+
+        uint8_t anchor;
+        uint8_t version;
+
+        /**
+         * All the known sections have been seen in the current cycle
+         */
+        bool done;
+    };
+
+    /**
+     * Get the group of a PID and table_id, create it if it is new
+     *
+     * @param pid PID
+     * @param tableId table id
+     * @return group index
+     */
+    uint32_t getGroup(uint16_t pid, uint8_t tableId);
+
+    /**
+     * Update a moving average
+     *
+     * @param ewma moving average, 0 if there are no samples yet
+     * @param sample new sample
+     */
+    static void updateEwma(std::atomic<uint64_t>& ewma, uint64_t sample);
+
+    /**
+     * Copy constructor
+     */
+    CarouselMonitor(const CarouselMonitor& other);
+
+    /**
+     * Assignment operator
+     */
+    CarouselMonitor& operator=(const CarouselMonitor&);
+
+    /**
+     * Sub-table states, used by the parsing thread only
+     */
+    SubTableMap<SubTable> m_subTables;
+
+    /**
+     * Group lookup (PID << 8 | table_id to group index + 1), used by the parsing thread only
+     */
+    SubTableMap<uint32_t> m_groupMap;
+
+    /**
+     * Groups in the order they were first seen, guarded by m_mutex
+     */
+    std::vector<std::unique_ptr<Group> > m_groups;
+
+    /**
+     * Guards m_groups
+     */
+    mutable std::mutex m_mutex;
+};
+
+#endif /* CAROUSELMONITOR_H_ */
@@ -24,7 +24,7 @@
 
 // Project's includes
 #include "MpegDescriptor.h"
-#include "DvbUtils.h"
+#include "BitField.h"
 
 // Syntax of the descriptor from ETSI EN 300 468
 //
@@ -71,7 +71,7 @@ public:
      */
     uint8_t getStreamContent() const
     {
-        return m_data[0] & 0xf;
+        return Header::StreamContent::get(m_data.data());
     }
 
     /**
@@ -81,7 +81,7 @@ public:
      */
     uint8_t getComponentType() const
     {
-        return m_data[1];
+        return Header::ComponentType::get(m_data.data());
     }
 
     /**
@@ -91,7 +91,7 @@ public:
      */
     uint8_t getComponentTag()  const
     {
-        return m_data[2];
+        return Header::ComponentTag::get(m_data.data());
     }
 
     /**
@@ -109,10 +109,21 @@ public:
      *
      * @return text (UTF)
      */
-    std::string getText(void) const
+    const std::string& getText(void) const
     {
-        return DecodeText(m_data.data() + 6, m_data.size() - 6);
+        return getDecodedText(m_data.data() + Header::SIZE, m_data.size() - Header::SIZE);
     }
+
+private:
+    /**
+     * Fixed part of the descriptor, followed by the text
+     */
+    struct Header : BitLayout<6>
+    {
+        typedef Field<4, 4> StreamContent;
+        typedef Field<8, 8> ComponentType;
+        typedef Field<16, 8> ComponentTag;
+    };
 };
 
 #endif /* COMPONENTDESCRIPTOR_H_ */
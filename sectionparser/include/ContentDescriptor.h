@@ -24,6 +24,7 @@
 
 // Project's includes
 #include "MpegDescriptor.h"
+#include "BitField.h"
 
 // Syntax of the descriptor from ETSI EN 300 468
 //
@@ -58,9 +59,9 @@ public:
      *
      * @return count
      */
-    uint8_t getCount()
+    uint8_t getCount() const
     {
-        return m_data.size()/2;
+        return m_data.size()/Entry::SIZE;
     }
 
     /**
@@ -71,7 +72,7 @@ public:
      */
     uint8_t getNibbleLvl1(uint8_t n) const
     {
-        return m_data[n*2] >> 4;
+        return Entry::ContentNibbleLevel1::get(m_data.data() + n*Entry::SIZE);
     }
 
     /**
@@ -82,7 +83,7 @@ public:
      */
     uint8_t getNibbleLvl2(uint8_t n) const
     {
-        return m_data[n*2] & 0xf;
+        return Entry::ContentNibbleLevel2::get(m_data.data() + n*Entry::SIZE);
     }
 
     /**
@@ -93,9 +94,20 @@ public:
      */
     uint8_t getUserByte(uint8_t n) const
     {
-        return m_data[n*2 + 1];
+        return Entry::UserByte::get(m_data.data() + n*Entry::SIZE);
     }
 
+
+private:
+    /**
+     * Content loop entry
+     */
+    struct Entry : BitLayout<2>
+    {
+        typedef Field<0, 4> ContentNibbleLevel1;
+        typedef Field<4, 4> ContentNibbleLevel2;
+        typedef Field<8, 8> UserByte;
+    };
 };
 
 #endif /* CONTENTDESCRIPTOR_H_ */
@@ -0,0 +1,183 @@
+//
+// DVB_SI for Reference Design Kit (RDK)
+//
+// Copyright (C) 2015  Dmitry Barablin & Stan Partridge (stan.partridge@arris.com)
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+#ifndef CRC32_H_
+#define CRC32_H_
+
+// C system includes
+#include <stdint.h>
+#include <stddef.h>
+
+// C++ system includes
+
+// Other libraries' includes
+
+// Project's includes
+
+/**
+ * CRC_32 as used by MPEG-2 sections (ISO/IEC 13818-1 Annex A):
+ * polynomial 0x04C11DB7, MSB first, initial value 0xFFFFFFFF, no final XOR.
+ * A section with a correct CRC_32 field yields a CRC of 0 over the whole section.
+ */
+namespace Crc32
+{
+    enum : uint32_t
+    {
+        POLYNOMIAL = 0x04C11DB7,
+        INITIAL_VALUE = 0xFFFFFFFF
+    };
+
+    /**
+     * CRC kernel types
+     */
+    enum class Kernel
+    {
+        SLICING_BY_8,  //!< portable table driven kernel
+        PCLMUL,        //!< x86 carry-less multiplication folding
+        VPCLMUL,       //!< x86 256-bit carry-less multiplication folding (VPCLMULQDQ, AVX2)
+        ARMV8_CRC      //!< ARMv8 CRC32 instructions
+    };
+
+    namespace detail
+    {
+        /**
+         * Multiply a CRC value by x^n modulo the polynomial (one bit at a time)
+         */
+        constexpr uint32_t shift(uint32_t crc, uint32_t n)
+        {
+            return n == 0 ? crc : shift((crc & 0x80000000) ? ((crc << 1) ^ POLYNOMIAL) : (crc << 1), n - 1);
+        }
+
+        /**
+         * CRC of a single byte
+         */
+        constexpr uint32_t byteCrc(uint32_t byte)
+        {
+            return shift(byte << 24, 8);
+        }
+
+        /**
+         * Apply n zero bytes to a CRC value
+         */
+        constexpr uint32_t zeroBytes(uint32_t crc, uint32_t n)
+        {
+            return n == 0 ? crc : zeroBytes((crc << 8) ^ byteCrc(crc >> 24), n - 1);
+        }
+
+        /**
+         * Slicing-by-8 table entry: CRC of the byte followed by 'slice' zero bytes
+         */
+        constexpr uint32_t tableEntry(uint32_t slice, uint32_t byte)
+        {
+            return zeroBytes(byteCrc(byte), slice);
+        }
+
+        /**
+         * x^n modulo the polynomial
+         */
+        constexpr uint32_t xPowMod(uint32_t n)
+        {
+            return n < 32 ? (1u << n) : (n < 40 ? shift(xPowMod(n - 1), 1) : shift(xPowMod(n - 8), 8));
+        }
+
+        /**
+         * Compile time index list (std::index_sequence is C++14)
+         */
+        template<uint32_t... I> struct Indices {};
+        template<uint32_t N, uint32_t... I> struct MakeIndices : MakeIndices<N - 1, N - 1, I...> {};
+        template<uint32_t... I> struct MakeIndices<0, I...>
+        {
+            typedef Indices<I...> type;
+        };
+
+        /**
+         * Slicing-by-8 lookup table, generated at compile time
+         */
+        template<typename T> struct Table;
+        template<uint32_t... I> struct Table<Indices<I...>>
+        {
+            static constexpr uint32_t value[8][256] =
+            {
+                { tableEntry(0, I)... }, { tableEntry(1, I)... }, { tableEntry(2, I)... }, { tableEntry(3, I)... },
+                { tableEntry(4, I)... }, { tableEntry(5, I)... }, { tableEntry(6, I)... }, { tableEntry(7, I)... }
+            };
+        };
+        template<uint32_t... I> constexpr uint32_t Table<Indices<I...>>::value[8][256];
+
+        typedef Table<MakeIndices<256>::type> CrcTable;
+    }
+
+    /**
+     * Update a CRC value using the portable slicing-by-8 kernel
+     *
+     * @param crc current CRC value
+     * @param data data
+     * @param len data length
+     * @return updated CRC value
+     */
+    uint32_t updateSlicing8(uint32_t crc, const uint8_t* data, size_t len);
+
+    /**
+     * Update a CRC value using the fastest kernel available on this CPU
+     *
+     * @param crc current CRC value
+     * @param data data
+     * @param len data length
+     * @return updated CRC value
+     */
+    uint32_t update(uint32_t crc, const uint8_t* data, size_t len);
+
+    /**
+     * Calculate the CRC of a buffer
+     *
+     * @param data data
+     * @param len data length
+     * @return CRC value
+     */
+    inline uint32_t calculate(const uint8_t* data, size_t len)
+    {
+        return update(INITIAL_VALUE, data, len);
+    }
+
+    /**
+     * Get the kernel selected for this CPU
+     *
+     * @return kernel type
+     */
+    Kernel getKernel();
+
+    /**
+     * Get the name of the kernel selected for this CPU
+     *
+     * @return kernel name
+     */
+    const char* getKernelName();
+
+    /**
+     * Force a kernel (used for testing and benchmarking).
+     * Falls back to the portable kernel if the CPU doesn't support the requested one.
+     *
+     * @param kernel kernel type
+     * @return the kernel in effect
+     */
+    Kernel setKernel(Kernel kernel);
+}
+
+#endif /* CRC32_H_ */
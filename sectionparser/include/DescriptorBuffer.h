@@ -0,0 +1,259 @@
+//
+// DVB_SI for Reference Design Kit (RDK)
+//
+// Copyright (C) 2015  Dmitry Barablin & Stan Partridge (stan.partridge@arris.com)
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+#ifndef DESCRIPTORBUFFER_H_
+#define DESCRIPTORBUFFER_H_
+
+// C system includes
+#include <stdint.h>
+#include <stddef.h>
+
+// C++ system includes
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+// Other libraries' includes
+
+// Project's includes
+#include "TextPool.h"
+
+/**
+ * Read-only, non-owning view of descriptor bytes.
+ * Offers the subset of the std::vector interface the descriptor classes use.
+ */
+class DescriptorData
+{
+public:
+    /**
+     * Constructor (empty view)
+     */
+    DescriptorData()
+        : m_data(NULL),
+          m_size(0)
+    {
+    }
+
+    /**
+     * Constructor
+     *
+     * @param data first byte (an empty view has no data pointer, like an empty vector)
+     * @param size number of bytes
+     */
+    DescriptorData(const uint8_t* data, size_t size)
+        : m_data(size ? data : NULL),
+          m_size(size)
+    {
+    }
+
+    /**
+     * Get the first byte
+     *
+     * @return pointer to the data, NULL if empty
+     */
+    const uint8_t* data() const
+    {
+        return m_data;
+    }
+
+    /**
+     * Get the number of bytes
+     *
+     * @return size
+     */
+    size_t size() const
+    {
+        return m_size;
+    }
+
+    /**
+     * Check if the view is empty
+     *
+     * @return true if empty, false otherwise
+     */
+    bool empty() const
+    {
+        return m_size == 0;
+    }
+
+    /**
+     * Get a byte
+     *
+     * @param n byte index
+     * @return byte
+     */
+    uint8_t operator[](size_t n) const
+    {
+        return m_data[n];
+    }
+
+    /**
+     * Get an iterator to the first byte
+     */
+    const uint8_t* begin() const
+    {
+        return m_data;
+    }
+
+    /**
+     * Get an iterator past the last byte
+     */
+    const uint8_t* end() const
+    {
+        return m_data + m_size;
+    }
+
+private:
+    /**
+     * First byte
+     */
+    const uint8_t* m_data;
+
+    /**
+     * Number of bytes
+     */
+    size_t m_size;
+};
+
+/**
+ * DescriptorBuffer
+ *
+ * Owns the raw bytes the descriptors of a table refer to, and caches the text decoded out of
+ * them (ETSI EN 300 468 annex A to UTF-8), so each string is decoded once no matter how often
+ * its getter is called. The texts come from the TextPool, so a string repeated across tables
+ * is decoded and stored only once. Descriptors share the buffer through a DescriptorBufferPtr; the bytes
+ * live as long as the last descriptor referring to them.
+ */
+class DescriptorBuffer
+{
+public:
+    /**
+     * Constructor
+     */
+    DescriptorBuffer()
+    {
+    }
+
+    /**
+     * Constructor
+     *
+     * @param data bytes to copy
+     * @param size number of bytes
+     */
+    DescriptorBuffer(const uint8_t* data, size_t size);
+
+    /**
+     * Reinitialize the buffer with room for the given number of bytes.
+     * The text cache is cleared, the allocated capacity is kept.
+     *
+     * @param size number of bytes
+     * @return first byte of the (uninitialized) buffer
+     */
+    uint8_t* allocate(size_t size);
+
+    /**
+     * Get the first byte
+     *
+     * @return pointer to the data
+     */
+    uint8_t* data()
+    {
+        return m_bytes.data();
+    }
+
+    /**
+     * Get the number of bytes
+     *
+     * @return size
+     */
+    size_t size() const
+    {
+        return m_bytes.size();
+    }
+
+    /**
+     * Get the decoded text of a string stored in the buffer, decoding it on first use
+     *
+     * @param text first byte of the coded text (must point into the buffer)
+     * @param len length of the coded text
+     * @return decoded text in UTF-8, valid as long as the buffer
+     */
+    const std::string& getText(const uint8_t* text, size_t len)
+    {
+        return findText(text, len).str();
+    }
+
+    /**
+     * Get the shared decoded text of a string stored in the buffer, decoding it on first use
+     *
+     * @param text first byte of the coded text (must point into the buffer)
+     * @param len length of the coded text
+     * @return decoded text in UTF-8, may outlive the buffer
+     */
+    SharedText getSharedText(const uint8_t* text, size_t len)
+    {
+        return findText(text, len);
+    }
+
+private:
+    /**
+     * Find the decoded text of a string stored in the buffer, getting it from the text pool
+     * on first use
+     *
+     * @param text first byte of the coded text (must point into the buffer)
+     * @param len length of the coded text
+     * @return decoded text, valid as long as the buffer
+     */
+    const SharedText& findText(const uint8_t* text, size_t len);
+
+    /**
+     * Copy constructor
+     */
+    DescriptorBuffer(const DescriptorBuffer& other);
+
+    /**
+     * Assignment operator
+     */
+    DescriptorBuffer& operator=(const DescriptorBuffer&);
+
+    /**
+     * Raw bytes
+     */
+    std::vector<uint8_t> m_bytes;
+
+    /**
+     * Protects the text cache (tables may be read from several threads)
+     */
+    std::mutex m_mutex;
+
+    /**
+     * Decoded texts keyed by offset and length of the coded text
+     */
+    std::unordered_map<uint64_t, SharedText> m_textCache;
+};
+
+/**
+ * Shared descriptor buffer handle
+ */
+typedef std::shared_ptr<DescriptorBuffer> DescriptorBufferPtr;
+
+#endif /* DESCRIPTORBUFFER_H_ */
@@ -0,0 +1,397 @@
+//
+// DVB_SI for Reference Design Kit (RDK)
+//
+// Copyright (C) 2015  Dmitry Barablin & Stan Partridge (stan.partridge@arris.com)
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+#ifndef DESCRIPTORLIST_H_
+#define DESCRIPTORLIST_H_
+
+// C system includes
+#include <stdint.h>
+#include <stddef.h>
+
+// C++ system includes
+#include <vector>
+#include <iterator>
+
+// Other libraries' includes
+
+// Project's includes
+#include "MpegDescriptor.h"
+
+class DescriptorList;
+
+/**
+ * Non-copying view of the descriptors of a DescriptorList that have a given tag, in list order
+ */
+class DescriptorRange
+{
+public:
+    /**
+     * Iterator following the descriptors with the same tag
+     */
+    class const_iterator : public std::iterator<std::forward_iterator_tag, const MpegDescriptor>
+    {
+    public:
+        /**
+         * Constructor
+         *
+         * @param list descriptor list
+         * @param index descriptor index, DescriptorList::NONE for the end
+         */
+        const_iterator(const DescriptorList* list, uint16_t index)
+            : m_list(list),
+              m_index(index)
+        {
+        }
+
+        /**
+         * Get the current descriptor
+         */
+        const MpegDescriptor& operator*() const;
+
+        /**
+         * Access the current descriptor
+         */
+        const MpegDescriptor* operator->() const
+        {
+            return &(**this);
+        }
+
+        /**
+         * Move to the next descriptor with the same tag
+         */
+        const_iterator& operator++();
+
+        /**
+         * Move to the next descriptor with the same tag
+         */
+        const_iterator operator++(int)
+        {
+            const_iterator ret = *this;
+            ++(*this);
+            return ret;
+        }
+
+        /**
+         * Compare iterators
+         */
+        bool operator==(const const_iterator& other) const
+        {
+            return m_index == other.m_index;
+        }
+
+        /**
+         * Compare iterators
+         */
+        bool operator!=(const const_iterator& other) const
+        {
+            return m_index != other.m_index;
+        }
+
+    private:
+        /**
+         * Descriptor list
+         */
+        const DescriptorList* m_list;
+
+        /**
+         * Index of the current descriptor
+         */
+        uint16_t m_index;
+    };
+
+    /**
+     * Constructor
+     *
+     * @param list descriptor list
+     * @param first index of the first descriptor, DescriptorList::NONE for an empty range
+     */
+    DescriptorRange(const DescriptorList* list, uint16_t first)
+        : m_list(list),
+          m_first(first)
+    {
+    }
+
+    /**
+     * Get an iterator to the first descriptor
+     */
+    const_iterator begin() const;
+
+    /**
+     * Get an iterator past the last descriptor
+     */
+    const_iterator end() const;
+
+    /**
+     * Check if the range is empty
+     *
+     * @return true if no descriptor has the tag, false otherwise
+     */
+    bool empty() const;
+
+private:
+    /**
+     * Descriptor list
+     */
+    const DescriptorList* m_list;
+
+    /**
+     * Index of the first descriptor
+     */
+    uint16_t m_first;
+};
+
+/**
+ * DescriptorList
+ *
+ * A descriptor loop, indexed by tag as it is built: a 256-bit tag presence bitmap, the indexes
+ * of the first and last descriptors of each present tag (ordered by tag, looked up by the rank
+ * of the tag's bit) and, per descriptor, the index of the next one with the same tag.
+ * find() rejects an absent tag with a single bit test and reaches a present one without
+ * scanning; findAll() returns a DescriptorRange instead of copies.
+ *
+ * The list can be iterated like a vector; it is only modified through push_back()/append()
+ * so the index stays in sync.
+ */
+class DescriptorList
+{
+public:
+    typedef std::vector<MpegDescriptor>::const_iterator const_iterator;
+
+    enum : uint16_t
+    {
+        NONE = 0xffff       //!< no descriptor (end of a tag's chain)
+    };
+
+    /**
+     * Constructor
+     */
+    DescriptorList();
+
+    /**
+     * Reserve room for descriptors
+     *
+     * @param count number of descriptors
+     */
+    void reserve(size_t count);
+
+    /**
+     * Add a descriptor at the end of the list
+     *
+     * @param desc descriptor
+     */
+    void push_back(const MpegDescriptor& desc);
+
+    /**
+     * Add the descriptors of another list at the end of the list
+     *
+     * @param other descriptor list
+     */
+    void append(const DescriptorList& other);
+
+    /**
+     * Remove all descriptors (the allocated capacity is kept)
+     */
+    void clear();
+
+    /**
+     * Check if a descriptor with the given tag is in the list
+     *
+     * @param tag descriptor tag
+     * @return true if present, false otherwise
+     */
+    bool contains(DescriptorTag tag) const
+    {
+        uint8_t t = static_cast<uint8_t>(tag);
+        return (m_tags[t >> 6] >> (t & 63)) & 1;
+    }
+
+    /**
+     * Find the first descriptor with the given tag
+     *
+     * @param tag descriptor tag to search for
+     * @return descriptor if found, NULL otherwise
+     */
+    const MpegDescriptor* find(DescriptorTag tag) const
+    {
+        if(!contains(tag))
+        {
+            return NULL;
+        }
+
+        return &m_descriptors[m_chains[getRank(static_cast<uint8_t>(tag))].first];
+    }
+
+    /**
+     * Find all the descriptors with the given tag
+     *
+     * @param tag descriptor tag to search for
+     * @return range of descriptors (valid as long as the list is not modified), empty if none
+     */
+    DescriptorRange findAll(DescriptorTag tag) const
+    {
+        if(!contains(tag))
+        {
+            return DescriptorRange(this, NONE);
+        }
+
+        return DescriptorRange(this, m_chains[getRank(static_cast<uint8_t>(tag))].first);
+    }
+
+    /**
+     * Get an iterator to the first descriptor
+     */
+    const_iterator begin() const
+    {
+        return m_descriptors.begin();
+    }
+
+    /**
+     * Get an iterator past the last descriptor
+     */
+    const_iterator end() const
+    {
+        return m_descriptors.end();
+    }
+
+    /**
+     * Get an iterator to the first descriptor
+     */
+    const_iterator cbegin() const
+    {
+        return m_descriptors.begin();
+    }
+
+    /**
+     * Get an iterator past the last descriptor
+     */
+    const_iterator cend() const
+    {
+        return m_descriptors.end();
+    }
+
+    /**
+     * Get a descriptor
+     *
+     * @param n index
+     * @return descriptor
+     */
+    const MpegDescriptor& operator[](size_t n) const
+    {
+        return m_descriptors[n];
+    }
+
+    /**
+     * Get the number of descriptors
+     *
+     * @return size
+     */
+    size_t size() const
+    {
+        return m_descriptors.size();
+    }
+
+    /**
+     * Check if the list is empty
+     *
+     * @return true if empty, false otherwise
+     */
+    bool empty() const
+    {
+        return m_descriptors.empty();
+    }
+
+private:
+    friend class DescriptorRange;
+
+    /**
+     * Descriptors of a present tag
+     */
+    struct TagChain
+    {
+        uint16_t first;     //!< index of the first descriptor with the tag
+        uint16_t last;      //!< index of the last one, where the next one is linked
+    };
+
+    /**
+     * Get the rank of a tag: the number of present tags below it
+     *
+     * @param tag descriptor tag
+     * @return index into the tag chain table
+     */
+    size_t getRank(uint8_t tag) const
+    {
+        size_t word = tag >> 6;
+        size_t rank = __builtin_popcountll(m_tags[word] & ((1ull << (tag & 63)) - 1));
+        for(size_t i = 0; i < word; i++)
+        {
+            rank += __builtin_popcountll(m_tags[i]);
+        }
+
+        return rank;
+    }
+
+    /**
+     * Descriptors in loop order
+     */
+    std::vector<MpegDescriptor> m_descriptors;
+
+    /**
+     * Tag presence bitmap
+     */
+    uint64_t m_tags[4];
+
+    /**
+     * First and last descriptor of each present tag, in tag order
+     */
+    std::vector<TagChain> m_chains;
+
+    /**
+     * Index of the next descriptor with the same tag, NONE for the last one
+     */
+    std::vector<uint16_t> m_next;
+};
+
+inline const MpegDescriptor& DescriptorRange::const_iterator::operator*() const
+{
+    return m_list->m_descriptors[m_index];
+}
+
+inline DescriptorRange::const_iterator& DescriptorRange::const_iterator::operator++()
+{
+    m_index = m_list->m_next[m_index];
+    return *this;
+}
+
+inline DescriptorRange::const_iterator DescriptorRange::begin() const
+{
+    return const_iterator(m_list, m_first);
+}
+
+inline DescriptorRange::const_iterator DescriptorRange::end() const
+{
+    return const_iterator(m_list, DescriptorList::NONE);
+}
+
+inline bool DescriptorRange::empty() const
+{
+    return m_first == DescriptorList::NONE;
+}
+
+#endif /* DESCRIPTORLIST_H_ */
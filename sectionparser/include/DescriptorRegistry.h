@@ -0,0 +1,241 @@
+//
+// DVB_SI for Reference Design Kit (RDK)
+//
+// Copyright (C) 2015  Dmitry Barablin & Stan Partridge (stan.partridge@arris.com)
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+#ifndef DESCRIPTORREGISTRY_H_
+#define DESCRIPTORREGISTRY_H_
+
+// C system includes
+#include <stdint.h>
+#include <stddef.h>
+
+// C++ system includes
+
+// Other libraries' includes
+
+// Project's includes
+#include "MpegDescriptor.h"
+#include "DescriptorList.h"
+#include "NetworkNameDescriptor.h"
+#include "ServiceListDescriptor.h"
+#include "CableDeliverySystemDescriptor.h"
+#include "ServiceDescriptor.h"
+#include "ShortEventDescriptor.h"
+#include "ExtendedEventDescriptor.h"
+#include "ComponentDescriptor.h"
+#include "ContentDescriptor.h"
+#include "ParentalRatingDescriptor.h"
+#include "LocalTimeOffsetDescriptor.h"
+#include "MultilingualNetworkNameDescriptor.h"
+#include "MultilingualServiceNameDescriptor.h"
+#include "MultilingualComponentDescriptor.h"
+#include "LogicalChannelDescriptor.h"
+
+/**
+ * Typed descriptor class of a descriptor tag. Tags without a class of their own map to
+ * MpegDescriptor; classes are registered with DVB_REGISTER_DESCRIPTOR.
+ */
+template<size_t Tag>
+struct DescriptorType
+{
+    typedef MpegDescriptor type;
+};
+
+/**
+ * Register the typed class of a descriptor tag
+ *
+ * @param tag DescriptorTag enumerator
+ * @param cls descriptor class (constructible from an MpegDescriptor)
+ */
+#define DVB_REGISTER_DESCRIPTOR(tag, cls) \
+    template<> \
+    struct DescriptorType<static_cast<size_t>(DescriptorTag::tag)> \
+    { \
+        typedef cls type; \
+    }
+
+DVB_REGISTER_DESCRIPTOR(NETWORK_NAME, NetworkNameDescriptor);
+DVB_REGISTER_DESCRIPTOR(SERVICE_LIST, ServiceListDescriptor);
+DVB_REGISTER_DESCRIPTOR(CABLE_DELIVERY, CableDeliverySystemDescriptor);
+DVB_REGISTER_DESCRIPTOR(SERVICE, ServiceDescriptor);
+DVB_REGISTER_DESCRIPTOR(SHORT_EVENT, ShortEventDescriptor);
+DVB_REGISTER_DESCRIPTOR(EXTENDED_EVENT, ExtendedEventDescriptor);
+DVB_REGISTER_DESCRIPTOR(COMPONENT, ComponentDescriptor);
+DVB_REGISTER_DESCRIPTOR(CONTENT_DESCRIPTOR, ContentDescriptor);
+DVB_REGISTER_DESCRIPTOR(PARENTAL_RATING, ParentalRatingDescriptor);
+DVB_REGISTER_DESCRIPTOR(LOCAL_TIME_OFFSET, LocalTimeOffsetDescriptor);
+DVB_REGISTER_DESCRIPTOR(MULTILINGUAL_NETWORK_NAME, MultilingualNetworkNameDescriptor);
+DVB_REGISTER_DESCRIPTOR(MULTILINGUAL_SERVICE_NAME, MultilingualServiceNameDescriptor);
+DVB_REGISTER_DESCRIPTOR(MULTILINGUAL_COMPONENT, MultilingualComponentDescriptor);
+DVB_REGISTER_DESCRIPTOR(LOGICAL_CHANNEL, LogicalChannelDescriptor);
+
+/**
+ * Tells if a visitor has a "void visit(const T&)" member (exact signature, so a visitor for
+ * one descriptor class is not picked for another one through the converting constructors)
+ */
+template<typename Visitor, typename T>
+class DescriptorVisitorHandles
+{
+    template<typename V>
+    static char test(decltype(static_cast<void (V::*)(const T&)>(&V::visit)));
+
+    template<typename V>
+    static long test(...);
+
+public:
+    enum
+    {
+        value = (sizeof(test<Visitor>(nullptr)) == 1)
+    };
+};
+
+/**
+ * Compile-time list of descriptor tags
+ */
+template<size_t... Tags>
+struct DescriptorTagSequence
+{
+};
+
+/**
+ * Build the list of descriptor tags 0..N-1
+ */
+template<size_t N, size_t... Tags>
+struct MakeDescriptorTagSequence : MakeDescriptorTagSequence<N - 1, N - 1, Tags...>
+{
+};
+
+template<size_t... Tags>
+struct MakeDescriptorTagSequence<0, Tags...>
+{
+    typedef DescriptorTagSequence<Tags...> type;
+};
+
+/**
+ * DescriptorDispatcher
+ *
+ * Jump table from descriptor tags to a visitor's visit() overloads, built at compile time.
+ * Tags the visitor has no overload for get a NULL entry and are skipped without building
+ * a typed wrapper.
+ */
+template<typename Visitor>
+class DescriptorDispatcher
+{
+public:
+    /**
+     * Jump table entry
+     */
+    typedef void (*Handler)(Visitor&, const MpegDescriptor&);
+
+    /**
+     * Get the jump table
+     *
+     * @return 256 handlers indexed by descriptor tag, NULL for unhandled tags
+     */
+    static const Handler* getTable()
+    {
+        return getTable(typename MakeDescriptorTagSequence<256>::type());
+    }
+
+private:
+    /**
+     * Visit a descriptor as the typed class registered for its tag
+     */
+    template<size_t Tag>
+    static void call(Visitor& visitor, const MpegDescriptor& desc)
+    {
+        invoke(visitor, desc, static_cast<typename DescriptorType<Tag>::type*>(nullptr));
+    }
+
+    /**
+     * Build the typed wrapper of a descriptor and visit it
+     */
+    template<typename T>
+    static void invoke(Visitor& visitor, const MpegDescriptor& desc, T*)
+    {
+        T typed(desc);
+        visitor.visit(typed);
+    }
+
+    /**
+     * Untyped descriptors are visited as they are
+     */
+    static void invoke(Visitor& visitor, const MpegDescriptor& desc, MpegDescriptor*)
+    {
+        visitor.visit(desc);
+    }
+
+    /**
+     * Jump table entry of a tag
+     */
+    template<size_t Tag, bool Handled = DescriptorVisitorHandles<Visitor, typename DescriptorType<Tag>::type>::value>
+    struct Entry
+    {
+        static constexpr Handler get()
+        {
+            return &DescriptorDispatcher::call<Tag>;
+        }
+    };
+
+    template<size_t Tag>
+    struct Entry<Tag, false>
+    {
+        static constexpr Handler get()
+        {
+            return nullptr;
+        }
+    };
+
+    /**
+     * Get the jump table (constant initialized, no run-time set up)
+     */
+    template<size_t... Tags>
+    static const Handler* getTable(DescriptorTagSequence<Tags...>)
+    {
+        static const Handler table[] = { Entry<Tags>::get()... };
+        return table;
+    }
+};
+
+/**
+ * Visit the descriptors of a loop in a single pass.
+ * Each descriptor is dispatched through a jump table to the visitor's
+ * "void visit(const XxxDescriptor&)" overload for the typed class registered for its tag;
+ * descriptors the visitor has no overload for are skipped. Unregistered tags are visited as
+ * "void visit(const MpegDescriptor&)".
+ *
+ * @param list descriptor loop
+ * @param visitor visitor
+ */
+template<typename Visitor>
+void visitDescriptors(const DescriptorList& list, Visitor& visitor)
+{
+    const typename DescriptorDispatcher<Visitor>::Handler* table = DescriptorDispatcher<Visitor>::getTable();
+
+    for(auto it = list.begin(), end = list.end(); it != end; ++it)
+    {
+        typename DescriptorDispatcher<Visitor>::Handler handler = table[static_cast<uint8_t>(it->getTag())];
+        if(handler)
+        {
+            handler(visitor, *it);
+        }
+    }
+}
+
+#endif /* DESCRIPTORREGISTRY_H_ */
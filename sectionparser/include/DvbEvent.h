@@ -30,6 +30,7 @@
 
 // Project's includes
 #include "DvbUtils.h"
+#include "DescriptorList.h"
 
 /**
  * EIT event class
@@ -38,7 +39,7 @@ class DvbEvent
 {
 public:
     /**
-     * Constructor
+     * Constructor. The start time and duration are decoded here, once.
      *
      * @param id event identifier
      * @param startTime the event start time
@@ -50,6 +51,8 @@ public:
         : m_eventId(id),
           m_startTime(startTime),
           m_duration(dur),
+          m_startEpoch(MjdBcdToEpoch(startTime)),
+          m_durationSeconds(BcdTimeToSeconds(dur)),
           m_runningStatus(runningStatus),
           m_freeCa(freeCa)
     {
@@ -66,9 +69,9 @@ public:
     /**
      * Get event descriptors
      *
-     * @return vector of event descriptors
+     * @return list of event descriptors
      */
-    const std::vector<MpegDescriptor>& getEventDescriptors() const
+    const DescriptorList& getEventDescriptors() const
     {
         return m_eventDescriptors;
     }
@@ -88,9 +91,9 @@ public:
      *
      * @param descriptors event descriptors
      */
-    void addDescriptors(const std::vector<MpegDescriptor>& descriptors)
+    void addDescriptors(const DescriptorList& descriptors)
     {
-        m_eventDescriptors.insert(m_eventDescriptors.end(), descriptors.begin(), descriptors.end());
+        m_eventDescriptors.append(descriptors);
     }
 
     /**
@@ -114,11 +117,11 @@ public:
     /**
      * Get the event duration
      *
-     * @return duration
+     * @return duration in seconds
      */
     uint32_t getDuration() const
     {
-        return BcdByteToDec((m_duration >> 16) & 0xFF)*3600 + BcdByteToDec((m_duration >> 8) & 0xFF)*60 + BcdByteToDec(m_duration & 0xFF);
+        return m_durationSeconds;
     }
 
     /**
@@ -173,11 +176,11 @@ public:
     /**
      * Get the start time of the event
      *
-     * @return time_t the event start time
+     * @return time_t the event start time (UTC)
      */
     time_t getStartTime() const
     {
-        return MjdToDate(m_startTime);
+        return m_startEpoch;
     }
 
     /**
@@ -206,6 +209,16 @@ private:
      */
     uint32_t m_duration;
 
+    /**
+     * Decoded start time (seconds since the epoch, UTC)
+     */
+    time_t m_startEpoch;
+
+    /**
+     * Decoded duration (seconds)
+     */
+    uint32_t m_durationSeconds;
+
     /**
      * Running status
      */
@@ -224,7 +237,7 @@ private:
     /**
      * Event descriptors
      */
-    std::vector<MpegDescriptor> m_eventDescriptors;
+    DescriptorList m_eventDescriptors;
 };
 
 #endif /* DVBEVENT_H_ */
@@ -0,0 +1,402 @@
+//
+// DVB_SI for Reference Design Kit (RDK)
+//
+// Copyright (C) 2015  Dmitry Barablin & Stan Partridge (stan.partridge@arris.com)
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+#ifndef DVBLOG_H_
+#define DVBLOG_H_
+
+// C system includes
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+// C++ system includes
+#include <atomic>
+#include <string>
+#include <type_traits>
+
+// Other libraries' includes
+
+// Project's includes
+
+/**
+ * Log record: the arguments of one OS_LOG call in binary form. The format string is kept as a
+ * pointer (OS_LOG formats are literals), the text is only formatted by the writer thread.
+ */
+struct DvbLogRecord
+{
+    enum
+    {
+        SIZE = 256,                                                 //!< record size in bytes
+        HEADER_SIZE = 8 + sizeof(const char*) + 4,
+        PAYLOAD_SIZE = SIZE - HEADER_SIZE                           //!< room for the arguments
+    };
+
+    /**
+     * Argument types
+     */
+    enum ArgType
+    {
+        ARG_SIGNED = 'i',       //!< 8 byte signed integer
+        ARG_UNSIGNED = 'u',     //!< 8 byte unsigned integer
+        ARG_DOUBLE = 'f',       //!< 8 byte double
+        ARG_POINTER = 'p',      //!< 8 byte pointer value
+        ARG_STRING = 's'        //!< 1 byte length followed by the characters (truncated to 255)
+    };
+
+    /**
+     * Time of the call, nanoseconds of the monotonic clock
+     */
+    uint64_t timestamp;
+
+    /**
+     * Format string
+     */
+    const char* format;
+
+    /**
+     * OS_LOG level (DVB_ERROR, DVB_DEBUG ...)
+     */
+    uint8_t level;
+
+    /**
+     * Set if arguments did not fit into the payload
+     */
+    uint8_t truncated;
+
+    /**
+     * Number of payload bytes used
+     */
+    uint16_t size;
+
+    /**
+     * Encoded arguments
+     */
+    uint8_t payload[PAYLOAD_SIZE];
+};
+
+/**
+ * DvbLog
+ *
+ * Logging back-end of OS_LOG (see oswrap.h). OS_LOG checks the level of a call at compile time
+ * (DVB_LOG_MAX_LEVEL) and at run time (setLevel()) before its arguments are evaluated. Calls that
+ * pass both checks copy their arguments into a record of a lock-free ring buffer owned by the
+ * calling thread. A background thread drains the rings, formats the records in time order and
+ * writes them to stderr. When a ring is full the record is dropped and counted, the caller never
+ * waits.
+ *
+ * The initial level is taken from the FEATURE.DVB.LOG_LEVEL environment variable (the numeric
+ * value of a DVB_* level), DVB_INFO if not set.
+ */
+class DvbLog
+{
+public:
+    enum
+    {
+        RING_RECORDS = 256      //!< records per thread ring (power of 2)
+    };
+
+    /**
+     * Get the process wide logger
+     *
+     * @return logger
+     */
+    static DvbLog& getInstance();
+
+    /**
+     * Check if messages of a verbosity are enabled at run time
+     *
+     * @param verbosity verbosity of the level, see DVB_LOG_VERBOSITY()
+     * @return true if enabled, false otherwise
+     */
+    static bool isEnabled(int verbosity)
+    {
+        return verbosity <= s_maxVerbosity.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Set the run time level. Messages more verbose than the level are filtered out.
+     * Levels above the compile time level (DVB_LOG_MAX_LEVEL) have no effect.
+     *
+     * @param level DVB_* level
+     */
+    static void setLevel(int level);
+
+    /**
+     * Log a message
+     *
+     * @param level DVB_* level
+     * @param format printf style format, must stay valid (a literal)
+     * @param args arguments
+     */
+    template<typename... Args>
+    void write(int level, const char* format, const Args&... args)
+    {
+        DvbLogRecord* rec = beginRecord();
+        if(rec)
+        {
+            rec->level = static_cast<uint8_t>(level);
+            rec->format = format;
+            rec->truncated = 0;
+            rec->size = 0;
+            encode(*rec, args...);
+            commitRecord();
+        }
+    }
+
+    /**
+     * Wait until the records logged so far are written
+     */
+    void flush();
+
+    /**
+     * Get the number of records dropped because a ring was full
+     *
+     * @return number of dropped records
+     */
+    uint64_t getDropCount() const
+    {
+        return m_dropCount.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Format a record
+     *
+     * @param rec record
+     * @param text formatted message
+     */
+    static void format(const DvbLogRecord& rec, std::string& text);
+
+private:
+    struct Ring;
+    struct Writer;
+    struct ThreadRing;
+
+    /**
+     * Constructor
+     */
+    DvbLog();
+
+    /**
+     * Destructor. Writes the pending records.
+     */
+    ~DvbLog();
+
+    /**
+     * Copy constructor
+     */
+    DvbLog(const DvbLog& other);
+
+    /**
+     * Assignment operator
+     */
+    DvbLog& operator=(const DvbLog&);
+
+    /**
+     * Get a free record of the calling thread's ring
+     *
+     * @return record, NULL if the ring is full
+     */
+    DvbLogRecord* beginRecord();
+
+    /**
+     * Publish the record returned by beginRecord()
+     */
+    void commitRecord();
+
+    /**
+     * Get the initial verbosity (FEATURE.DVB.LOG_LEVEL)
+     *
+     * @return verbosity
+     */
+    static int getInitialVerbosity();
+
+    /**
+     * Append bytes to the payload of a record
+     *
+     * @param rec record
+     * @param data bytes
+     * @param len number of bytes
+     * @return true if the bytes fit, false otherwise (record marked truncated)
+     */
+    static bool append(DvbLogRecord& rec, const void* data, size_t len)
+    {
+        if(rec.truncated || rec.size + len > DvbLogRecord::PAYLOAD_SIZE)
+        {
+            rec.truncated = 1;
+            return false;
+        }
+        memcpy(rec.payload + rec.size, data, len);
+        rec.size += len;
+        return true;
+    }
+
+    /**
+     * Append a fixed size argument
+     *
+     * @param rec record
+     * @param type argument type
+     * @param value 8 byte value
+     */
+    static void appendValue(DvbLogRecord& rec, uint8_t type, const void* value)
+    {
+        if(rec.truncated || rec.size + 9 > DvbLogRecord::PAYLOAD_SIZE)
+        {
+            rec.truncated = 1;
+            return;
+        }
+        rec.payload[rec.size] = type;
+        memcpy(rec.payload + rec.size + 1, value, 8);
+        rec.size += 9;
+    }
+
+    /**
+     * Append a string argument
+     *
+     * @param rec record
+     * @param str characters
+     * @param len number of characters
+     */
+    static void appendString(DvbLogRecord& rec, const char* str, size_t len)
+    {
+        if(!str)
+        {
+            str = "(null)";
+            len = 6;
+        }
+        if(len > 255)
+        {
+            len = 255;
+        }
+
+        // Strings are cut to the room left rather than dropped
+        if(!rec.truncated && rec.size + 2 + len > DvbLogRecord::PAYLOAD_SIZE && rec.size + 2 < DvbLogRecord::PAYLOAD_SIZE)
+        {
+            len = DvbLogRecord::PAYLOAD_SIZE - rec.size - 2;
+        }
+
+        uint8_t header[2] = { DvbLogRecord::ARG_STRING, static_cast<uint8_t>(len) };
+        if(append(rec, header, 2))
+        {
+            append(rec, str, len);
+        }
+    }
+
+    /**
+     * Encode the arguments (end of the recursion)
+     *
+     * @param rec record
+     */
+    static void encode(DvbLogRecord& rec)
+    {
+        (void)rec;
+    }
+
+    /**
+     * Encode the arguments
+     *
+     * @param rec record
+     * @param first first argument
+     * @param rest other arguments
+     */
+    template<typename T, typename... Args>
+    static void encode(DvbLogRecord& rec, const T& first, const Args&... rest)
+    {
+        put(rec, first);
+        encode(rec, rest...);
+    }
+
+    /**
+     * Encode one argument: integers and enums as 8 byte integers, floating point as double,
+     * pointers by value, C and C++ strings by content
+     *
+     * @param rec record
+     * @param value argument
+     */
+    template<typename T>
+    static typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type put(DvbLogRecord& rec, T value)
+    {
+        int64_t v = value;
+        appendValue(rec, DvbLogRecord::ARG_SIGNED, &v);
+    }
+
+    template<typename T>
+    static typename std::enable_if<std::is_integral<T>::value && !std::is_signed<T>::value>::type put(DvbLogRecord& rec, T value)
+    {
+        uint64_t v = value;
+        appendValue(rec, DvbLogRecord::ARG_UNSIGNED, &v);
+    }
+
+    template<typename T>
+    static typename std::enable_if<std::is_enum<T>::value>::type put(DvbLogRecord& rec, T value)
+    {
+        put(rec, static_cast<typename std::underlying_type<T>::type>(value));
+    }
+
+    template<typename T>
+    static typename std::enable_if<std::is_floating_point<T>::value>::type put(DvbLogRecord& rec, T value)
+    {
+        double v = value;
+        appendValue(rec, DvbLogRecord::ARG_DOUBLE, &v);
+    }
+
+    template<typename T>
+    static void put(DvbLogRecord& rec, const T* value)
+    {
+        uint64_t v = reinterpret_cast<uintptr_t>(value);
+        appendValue(rec, DvbLogRecord::ARG_POINTER, &v);
+    }
+
+    static void put(DvbLogRecord& rec, const char* value)
+    {
+        appendString(rec, value, value ? strlen(value) : 0);
+    }
+
+    static void put(DvbLogRecord& rec, char* value)
+    {
+        put(rec, static_cast<const char*>(value));
+    }
+
+    static void put(DvbLogRecord& rec, const std::string& value)
+    {
+        appendString(rec, value.data(), value.size());
+    }
+
+    /**
+     * Run time verbosity
+     */
+    static std::atomic<int> s_maxVerbosity;
+
+    /**
+     * Ring of the calling thread
+     */
+    static thread_local ThreadRing s_threadRing;
+
+    /**
+     * Writer thread and ring list
+     */
+    Writer* m_writer;
+
+    /**
+     * Number of records dropped
+     */
+    std::atomic<uint64_t> m_dropCount;
+};
+
+#endif /* DVBLOG_H_ */
@@ -29,7 +29,7 @@
 // Other libraries' includes
 
 // Project's includes
-#include "MpegDescriptor.h"
+#include "DescriptorList.h"
 
 /**
  * SDT service class
@@ -65,9 +65,9 @@ public:
     /**
      * Get service descriptors
      *
-     * @return vector of service descriptors
+     * @return list of service descriptors
      */
-    const std::vector<MpegDescriptor>& getServiceDescriptors() const
+    const DescriptorList& getServiceDescriptors() const
     {
         return m_serviceDescriptors;
     }
@@ -87,9 +87,9 @@ public:
      *
      * @param descriptors dervice descriptors
      */
-    void addDescriptors(const std::vector<MpegDescriptor>& descriptors)
+    void addDescriptors(const DescriptorList& descriptors)
     {
-        m_serviceDescriptors.insert(m_serviceDescriptors.end(), descriptors.begin(), descriptors.end());
+        m_serviceDescriptors.append(descriptors);
     }
 
     /**
@@ -163,7 +163,7 @@ private:
     /**
      * Service descriptors
      */
-    std::vector<MpegDescriptor> m_serviceDescriptors;
+    DescriptorList m_serviceDescriptors;
 
     /**
      * Service identifier
@@ -22,6 +22,8 @@
 
 // C system includes
 #include <stdint.h>
+#include <stddef.h>
+#include <time.h>
 
 // C++ system includes
 #include <string>
@@ -52,10 +54,51 @@ uint16_t BcdToDec(uint16_t bcd);
  */
 void BcdToTime(int64_t encodedTime, uint32_t& hour, uint32_t& min, uint32_t& sec);
 
+/**
+ * Modified Julian Date of the Unix epoch (1970-01-01)
+ */
+static const int32_t MJD_UNIX_EPOCH = 40587;
+
+/**
+ * Convert a BCD coded time of day or duration (hhmmss, 6 digits) to seconds.
+ * Pure integer arithmetic, usable in constant expressions.
+ *
+ * @param bcd time coded as 24 bits of binary coded decimal
+ * @return number of seconds
+ */
+constexpr uint32_t BcdTimeToSeconds(uint32_t bcd)
+{
+    return (((bcd >> 20) & 0x0F) * 10 + ((bcd >> 16) & 0x0F)) * 3600 +
+           (((bcd >> 12) & 0x0F) * 10 + ((bcd >> 8) & 0x0F)) * 60 +
+           (((bcd >> 4) & 0x0F) * 10 + (bcd & 0x0F));
+}
+
+/**
+ * Convert a 40 bit MJD + BCD time (ETSI EN 300 468 annex C) to seconds since the epoch (UTC).
+ * Pure integer arithmetic, usable in constant expressions.
+ *
+ * @param encodedTime 16 bit MJD followed by the 24 bit BCD coded time
+ * @return time_t
+ */
+constexpr time_t MjdBcdToEpoch(uint64_t encodedTime)
+{
+    return ((time_t)((encodedTime >> 24) & 0xFFFF) - MJD_UNIX_EPOCH) * 86400 +
+           BcdTimeToSeconds(encodedTime & 0xFFFFFF);
+}
+
+/**
+ * Convert a batch of MJD + BCD times to seconds since the epoch (UTC)
+ *
+ * @param encodedTimes 40 bit MJD + BCD times
+ * @param times converted times
+ * @param count number of times
+ */
+void MjdBcdToEpoch(const uint64_t* encodedTimes, time_t* times, size_t count);
+
 /**
  * Convert Modified Julian Date to date
  *
- * @param encodedTime
+ * @param encodedTime 40 bit MJD + BCD time (UTC)
  * @return time_t
  */
 time_t MjdToDate (int64_t encodedTime);
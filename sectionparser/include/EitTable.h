@@ -36,6 +36,11 @@
 class EitTable: public SiTable
 {
 public:
+    enum
+    {
+        ALL_SEGMENTS = -1   //!< the table holds the whole sub-table
+    };
+
     /**
      * Constructor
      *
@@ -48,10 +53,29 @@ public:
         : SiTable(id, extId, ver, cur),
           m_tsId(0),
           m_networkId(0),
-          m_lastTableId(0)
+          m_lastTableId(0),
+          m_segment(ALL_SEGMENTS)
     {
     }
 
+    /**
+     * Reinitialize the table for reuse
+     *
+     * @param id table identifier
+     * @param extId table identifier extension
+     * @param ver version number
+     * @param cur current/next indicator
+     */
+    virtual void reset(uint8_t id, uint16_t extId, uint8_t ver, bool cur)
+    {
+        SiTable::reset(id, extId, ver, cur);
+        m_tsId = 0;
+        m_networkId = 0;
+        m_lastTableId = 0;
+        m_segment = ALL_SEGMENTS;
+        m_eventList.clear();
+    }
+
     /**
      * Add an event
      *
@@ -140,6 +164,36 @@ public:
         m_tsId = tsId;
     }
 
+    /**
+     * Get the segment index of a partial table
+     *
+     * @return segment index (0..31), ALL_SEGMENTS if the table holds the whole sub-table
+     */
+    int getSegment() const
+    {
+        return m_segment;
+    }
+
+    /**
+     * Set the segment index of a partial table
+     *
+     * @param segment segment index (0..31) or ALL_SEGMENTS
+     */
+    void setSegment(int segment)
+    {
+        m_segment = segment;
+    }
+
+    /**
+     * Check if the table only holds the events of one segment (3 hours of schedule)
+     *
+     * @return true if the table is partial, false otherwise
+     */
+    bool isPartial() const
+    {
+        return m_segment != ALL_SEGMENTS;
+    }
+
 private:
     /**
      * Transport identifier
@@ -156,6 +210,11 @@ private:
      */
     uint8_t m_lastTableId;
 
+    /**
+     * Segment index for partial tables, ALL_SEGMENTS otherwise
+     */
+    int m_segment;
+
     /**
      * List of events
      */
@@ -28,7 +28,7 @@
 
 // Project's includes
 #include "MpegDescriptor.h"
-#include "DvbUtils.h"
+#include "BitField.h"
 
 // Syntax of the descriptor from ETSI EN 300 468
 //
@@ -70,10 +70,15 @@ public:
         : MpegDescriptor(desc)
     {
         const uint8_t* p = m_data.data();
-        if(p)
+        if(p && Header::fits(p, m_data.end()))
         {
-            p += 5;
+            p += Header::SIZE;
             const uint8_t* end = p + getLengthOfItems();
+            if(end > m_data.end())
+            {
+                end = m_data.end();
+            }
+
             while(p < end)
             {
                 m_items.push_back(p);
@@ -94,7 +99,7 @@ public:
      */
     uint8_t getNumber() const
     {
-        return m_data[0] >> 4;
+        return Header::DescriptorNumber::get(m_data.data());
     }
 
     /**
@@ -104,7 +109,7 @@ public:
      */
     uint8_t getLastNumber() const
     {
-        return m_data[0] & 0xf;
+        return Header::LastDescriptorNumber::get(m_data.data());
     }
 
     /**
@@ -124,7 +129,7 @@ public:
      */
     uint8_t getLengthOfItems() const
     {
-        return m_data[4];
+        return Header::LengthOfItems::get(m_data.data());
     }
 
     /**
@@ -154,9 +159,9 @@ public:
      * @param n
      * @return item_description_char
      */
-    std::string getItemDescription(uint8_t n) const
+    const std::string& getItemDescription(uint8_t n) const
     {
-        return DecodeText(m_items[n] + 1, *(m_items[n]));
+        return getDecodedText(m_items[n] + 1, *(m_items[n]));
     }
 
     /**
@@ -176,9 +181,9 @@ public:
      * @param n
      * @return item_char
      */
-    std::string getItem(uint8_t n) const
+    const std::string& getItem(uint8_t n) const
     {
-        return DecodeText(m_items[n] + getItemDescriptionLength(n) + 2, getItemLength(n));
+        return getDecodedText(m_items[n] + getItemDescriptionLength(n) + 2, getItemLength(n));
     }
 
     /**
@@ -188,7 +193,7 @@ public:
      */
     uint8_t getTextLength() const
     {
-        return m_data[5 + getLengthOfItems()];
+        return m_data[Header::SIZE + getLengthOfItems()];
     }
 
     /**
@@ -196,12 +201,22 @@ public:
      *
      * @return text
      */
-    std::string getText() const
+    const std::string& getText() const
     {
-        return DecodeText(m_data.data() + 6 + getLengthOfItems(), getTextLength());
+        return getDecodedText(m_data.data() + Header::SIZE + 1 + getLengthOfItems(), getTextLength());
     }
 
 private:
+    /**
+     * Fixed part of the descriptor, followed by the items
+     */
+    struct Header : BitLayout<5>
+    {
+        typedef Field<0, 4> DescriptorNumber;
+        typedef Field<4, 4> LastDescriptorNumber;
+        typedef Field<32, 8> LengthOfItems;
+    };
+
     /**
      * List of items
      */
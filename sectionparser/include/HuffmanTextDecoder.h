@@ -0,0 +1,203 @@
+//
+// DVB_SI for Reference Design Kit (RDK)
+//
+// Copyright (C) 2015  Dmitry Barablin & Stan Partridge (stan.partridge@arris.com)
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+
+#ifndef HUFFMANTEXTDECODER_H_
+#define HUFFMANTEXTDECODER_H_
+
+// C system includes
+#include <stdint.h>
+#include <stddef.h>
+
+// C++ system includes
+#include <string>
+#include <vector>
+
+// Other libraries' includes
+
+// Project's includes
+#include "TextDecoder.h"
+
+/**
+ * HuffmanTextDecoder
+ *
+ * Expands Huffman compressed text (encoding_type_id 0x01/0x02 as used by Freesat). The code
+ * is order-1: each character has its own code table for the character that follows it.
+ * Decoding starts in the START context and ends with the STOP symbol. ESCAPE is followed by
+ * uncompressed 8 bit characters, up to and including the first one below 0x80.
+ *
+ * Code tables are loaded from text files, one code per line:
+ *
+ *    <previous character>:<code bits>:<next character>:
+ *
+ * where a character is a literal character, 0xNN, or one of START, STOP and ESCAPE, e.g.
+ * "START:0010:T:". Lines starting with '#' are ignored.
+ *
+ * Decoding is table driven: each context gets a lookup table indexed by the next LOOKUP_BITS
+ * bits of the input, longer codes continue in sub-tables. An entry that ends a code also links
+ * to the table of the decoded character's context, so a symbol usually takes a single lookup.
+ */
+class HuffmanTextDecoder : public TextDecoder::Decompressor
+{
+public:
+    enum
+    {
+        START = 0x00,       //!< context at the start of a text
+        STOP = 0x00,        //!< end of the text
+        ESCAPE = 0x01,      //!< uncompressed characters follow
+        LOOKUP_BITS = 8     //!< bits decoded by a single lookup
+    };
+
+    /**
+     * Constructor
+     */
+    HuffmanTextDecoder();
+
+    /**
+     * Destructor
+     */
+    virtual ~HuffmanTextDecoder();
+
+    /**
+     * Load a code table file and build the lookup tables
+     *
+     * @param path file name
+     * @return true if successful, false otherwise
+     */
+    bool load(const std::string& path);
+
+    /**
+     * Add a code. build() must be called once all the codes are added.
+     *
+     * @param context previous character (START for the first one)
+     * @param bits code bits, '0' and '1' characters
+     * @param symbol next character (or STOP, ESCAPE)
+     * @return true if successful, false if the code is not valid
+     */
+    bool addCode(uint8_t context, const std::string& bits, uint8_t symbol);
+
+    /**
+     * Build the lookup tables from the codes added
+     *
+     * @return true if successful, false if the codes are not prefix free
+     */
+    bool build();
+
+    /**
+     * Expand a compressed text
+     *
+     * @param data compressed data (after the encoding_type_id)
+     * @param len compressed data length
+     * @param out expanded text, appended to
+     * @return true if successful, false otherwise
+     */
+    virtual bool decompress(const uint8_t* data, size_t len, std::string& out) const;
+
+private:
+    /**
+     * Code of a context
+     */
+    struct Code
+    {
+        uint32_t bits;      //!< code bits, right aligned
+        uint8_t length;     //!< number of bits
+        uint8_t symbol;     //!< decoded character
+    };
+
+    /**
+     * Lookup table entry
+     */
+    struct Entry
+    {
+        enum : uint8_t
+        {
+            INVALID,        //!< no code starts with these bits
+            SYMBOL,         //!< a code ends in this table
+            TABLE           //!< the code continues in a sub-table
+        };
+
+        /**
+         * SYMBOL: root table of the symbol's context (the next lookup), TABLE: sub-table
+         */
+        int32_t next;
+
+        /**
+         * Index bits of the next table
+         */
+        uint8_t nextBits;
+
+        /**
+         * SYMBOL: bits the code takes in this table
+         */
+        uint8_t length;
+
+        /**
+         * SYMBOL: decoded character
+         */
+        uint8_t symbol;
+
+        /**
+         * Entry type
+         */
+        uint8_t type;
+    };
+
+    /**
+     * Build the lookup table of a set of codes
+     *
+     * @param codes codes
+     * @param skip number of leading bits already decoded by the parent tables
+     * @param bits index bits of the table
+     * @return offset of the table, -1 if the codes are not prefix free
+     */
+    int32_t buildTable(const std::vector<Code>& codes, uint8_t skip, uint8_t bits);
+
+    /**
+     * Copy constructor
+     */
+    HuffmanTextDecoder(const HuffmanTextDecoder& other);
+
+    /**
+     * Assignment operator
+     */
+    HuffmanTextDecoder& operator=(const HuffmanTextDecoder&);
+
+    /**
+     * Codes by context
+     */
+    std::vector<Code> m_codes[256];
+
+    /**
+     * Offset of the root lookup table of each context, -1 if the context has no codes
+     */
+    int32_t m_roots[256];
+
+    /**
+     * Index bits of the root lookup table of each context
+     */
+    uint8_t m_rootBits[256];
+
+    /**
+     * Lookup tables of all the contexts
+     */
+    std::vector<Entry> m_entries;
+};
+
+#endif /* HUFFMANTEXTDECODER_H_ */
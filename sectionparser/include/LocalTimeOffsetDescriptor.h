@@ -30,6 +30,7 @@
 
 // Project's includes
 #include "MpegDescriptor.h"
+#include "BitField.h"
 
 // Syntax of the descriptor from ETSI EN 300 468
 //
@@ -77,7 +78,7 @@ public:
      */
     uint8_t getCount() const
     {
-        return m_data.size()/13;
+        return m_data.size()/Entry::SIZE;
     }
 
     /**
@@ -88,7 +89,7 @@ public:
      */
     std::string getCountryCode(uint8_t n) const
     {
-        return std::string((const char*)m_data.data() + (n*13), 3);
+        return std::string((const char*)m_data.data() + n*Entry::SIZE, 3);
     }
 
     /**
@@ -99,7 +100,7 @@ public:
      */
     uint8_t getCountryRegionId(uint8_t n) const
     {
-        return (m_data[n*13 + 3] >> 2);
+        return Entry::CountryRegionId::get(m_data.data() + n*Entry::SIZE);
     }
 
     /**
@@ -110,7 +111,7 @@ public:
      */
     bool getPolarity(uint8_t n) const
     {
-        return m_data[n*13 + 3] & 0x01;
+        return Entry::LocalTimeOffsetPolarity::get(m_data.data() + n*Entry::SIZE);
     }
 
     /**
@@ -121,7 +122,7 @@ public:
      */
     uint16_t getLocalTimeOffset(uint8_t n) const
     {
-        return (m_data[n*13 + 4] << 8) | m_data[n*13 + 5];
+        return Entry::LocalTimeOffset::get(m_data.data() + n*Entry::SIZE);
     }
 
     /**
@@ -132,9 +133,7 @@ public:
      */
     uint64_t getTimeOfChange(uint8_t n) const
     {
-        return ((uint64_t)m_data[n*13 + 6] << 32) | ((uint64_t)m_data[n*13 + 7] << 24) |
-                ((uint64_t)m_data[n*13 + 8] << 16) | ((uint64_t)m_data[n*13 + 9] << 8) |
-                (uint64_t)m_data[n*13 + 10];
+        return Entry::TimeOfChange::get(m_data.data() + n*Entry::SIZE);
     }
 
     /**
@@ -145,8 +144,21 @@ public:
      */
     uint16_t getNextTimeOffset(uint8_t n) const
     {
-        return (m_data[n*13 + 11] << 8) | m_data[n*13 + 12];
+        return Entry::NextTimeOffset::get(m_data.data() + n*Entry::SIZE);
     }
+
+private:
+    /**
+     * Local time offset loop entry
+     */
+    struct Entry : BitLayout<13>
+    {
+        typedef Field<24, 6> CountryRegionId;
+        typedef Field<31, 1, bool> LocalTimeOffsetPolarity;
+        typedef Field<32, 16> LocalTimeOffset;
+        typedef Field<48, 40> TimeOfChange;
+        typedef Field<88, 16> NextTimeOffset;
+    };
 };
 
 #endif /* LOCALTIMEOFFSETDESCRIPTOR_H_ */
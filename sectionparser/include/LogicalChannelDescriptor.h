@@ -25,6 +25,7 @@
 
 // Project's includes
 #include "MpegDescriptor.h"
+#include "BitField.h"
 
 // Syntax of the descriptor from ETSI EN 300 468
 //
@@ -69,7 +70,7 @@ public:
      */
     uint8_t getCount() const
     {
-        return m_data.size()/4;
+        return m_data.size()/Entry::SIZE;
     }
 
     /**
@@ -80,7 +81,7 @@ public:
      */
     uint16_t getServiceId(uint8_t n) const
     {
-        return (m_data[n*4] << 8) | m_data[n*4 + 1];
+        return Entry::ServiceId::get(m_data.data() + n*Entry::SIZE);
     }
 
     /**
@@ -89,9 +90,9 @@ public:
      * @param n
      * @return true if visible, false otherwise
      */
-    bool isVisible(uint8_t n)
+    bool isVisible(uint8_t n) const
     {
-        return m_data[n*4 + 2] & 0x80;
+        return Entry::VisibleServiceFlag::get(m_data.data() + n*Entry::SIZE);
     }
 
     /**
@@ -102,8 +103,19 @@ public:
      */
     uint16_t getLcn(uint8_t n) const
     {
-        return ((m_data[n*4 + 2] & 0x3) << 8) | m_data[n*4 + 3];
+        return Entry::LogicalChannelNumber::get(m_data.data() + n*Entry::SIZE);
     }
+
+private:
+    /**
+     * Logical channel loop entry
+     */
+    struct Entry : BitLayout<4>
+    {
+        typedef Field<0, 16> ServiceId;
+        typedef Field<16, 1, bool> VisibleServiceFlag;
+        typedef Field<22, 10> LogicalChannelNumber;
+    };
 };
 
 #endif /* LOGICALCHANNELDESCRIPTOR_H_ */
@@ -26,6 +26,12 @@
 
 // C++ system includes
 #include <vector>
+#include <string>
+
+// Other libraries' includes
+
+// Project's includes
+#include "DescriptorBuffer.h"
 
 /**
  * Descriptor tag enumeration
@@ -102,14 +108,19 @@ enum class DescriptorTag : uint8_t
     FORBIDDEN = 0xFF                 //!< FORBIDDEN
 };
 
+class DescriptorList;
+
 /**
  * MPEG descriptor base class
+ *
+ * A descriptor is a view of its bytes in a DescriptorBuffer, normally the buffer shared by all
+ * the descriptors of a table, so copying a descriptor does not copy its data.
  */
 class MpegDescriptor
 {
 public:
     /**
-     * Constructor
+     * Constructor. The data is copied into a buffer of the descriptor's own.
      *
      * @param tag descriptor tag
      * @param data descriptor data
@@ -117,6 +128,21 @@ public:
      */
     MpegDescriptor(DescriptorTag tag, uint8_t *data, uint8_t length);
 
+    /**
+     * Constructor. The descriptor refers to data kept in the given buffer.
+     *
+     * @param tag descriptor tag
+     * @param data descriptor data (must point into the buffer)
+     * @param length data length
+     * @param buffer buffer holding the data
+     */
+    MpegDescriptor(DescriptorTag tag, const uint8_t *data, uint8_t length, const DescriptorBufferPtr& buffer)
+        : m_data(data, length),
+          m_buffer(buffer),
+          m_tag(tag)
+    {
+    }
+
     /**
      * Destructor
      */
@@ -127,9 +153,9 @@ public:
     /**
      * Get descriptor data
      *
-     * @return vector
+     * @return view of the data, valid as long as the descriptor or a copy of it
      */
-    const std::vector<uint8_t>& getData() const
+    const DescriptorData& getData() const
     {
         return m_data;
     }
@@ -158,10 +184,7 @@ public:
      *
      * @param data the descriptor data
      */
-    void setData(const std::vector<uint8_t>& data)
-    {
-        m_data = data;
-    }
+    void setData(const std::vector<uint8_t>& data);
 
     /**
      * Find a descriptor by tag
@@ -181,19 +204,58 @@ public:
     static std::vector<MpegDescriptor> findAll(const std::vector<MpegDescriptor>& list, DescriptorTag tag);
 
     /**
-     * Parse descriptors
+     * Parse descriptors. The raw data is copied once into a buffer shared by the descriptors.
      *
      * @param p pointer to the raw data
      * @param length length of the raw data
-     * @return vector of descriptors
+     * @return list of descriptors
      */
-    static std::vector<MpegDescriptor> parseDescriptors(uint8_t* p, uint16_t length);
+    static DescriptorList parseDescriptors(uint8_t* p, uint16_t length);
+
+    /**
+     * Parse descriptors without copying them: the descriptors refer to the given buffer
+     *
+     * @param p pointer to the raw data (must point into the buffer)
+     * @param length length of the raw data
+     * @param buffer buffer holding the raw data
+     * @return list of descriptors
+     */
+    static DescriptorList parseDescriptors(uint8_t* p, uint16_t length, const DescriptorBufferPtr& buffer);
 
 protected:
+    /**
+     * Get the decoded text of a string in the descriptor data (decoded once, then cached)
+     *
+     * @param text first byte of the coded text
+     * @param len length of the coded text
+     * @return decoded text in UTF-8, valid as long as the descriptor or a copy of it
+     */
+    const std::string& getDecodedText(const uint8_t* text, size_t len) const
+    {
+        return m_buffer->getText(text, len);
+    }
+
+    /**
+     * Get the shared decoded text of a string in the descriptor data (decoded once, then pooled)
+     *
+     * @param text first byte of the coded text
+     * @param len length of the coded text
+     * @return decoded text in UTF-8, may outlive the descriptor
+     */
+    SharedText getSharedDecodedText(const uint8_t* text, size_t len) const
+    {
+        return m_buffer->getSharedText(text, len);
+    }
+
     /**
      * Descriptor data
      */
-    std::vector<uint8_t> m_data;
+    DescriptorData m_data;
+
+    /**
+     * Buffer holding the descriptor data
+     */
+    DescriptorBufferPtr m_buffer;
 private:
     /**
      * Descriptor tag
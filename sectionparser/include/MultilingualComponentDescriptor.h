@@ -27,7 +27,6 @@
 
 // Project's includes
 #include "MpegDescriptor.h"
-#include "DvbUtils.h"
 
 /**
  * Multilingual component descriptor class
@@ -110,9 +109,9 @@ public:
      * @param n
      * @return text
      */
-    std::string getText(uint8_t n) const
+    const std::string& getText(uint8_t n) const
     {
-        return DecodeText(m_items[n] + 4, getTextLength(n));
+        return getDecodedText(m_items[n] + 4, getTextLength(n));
     }
 
 private:
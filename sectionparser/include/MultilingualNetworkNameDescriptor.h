@@ -28,7 +28,6 @@
 
 // Project's includes
 #include "MpegDescriptor.h"
-#include "DvbUtils.h"
 
 // Syntax of the descriptor from ETSI EN 300 468
 //
@@ -110,9 +109,9 @@ public:
      * @param n
      * @return network_name
      */
-    std::string getNetworkName(uint8_t n) const
+    const std::string& getNetworkName(uint8_t n) const
     {
-        return DecodeText(m_items[n] + 4, getNetworkNameLength(n));
+        return getDecodedText(m_items[n] + 4, getNetworkNameLength(n));
     }
 
 private:
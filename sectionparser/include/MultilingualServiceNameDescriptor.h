@@ -28,7 +28,6 @@
 
 // Project's includes
 #include "MpegDescriptor.h"
-#include "DvbUtils.h"
 
 // Syntax of the descriptor from ETSI EN 300 468
 //
@@ -117,9 +116,9 @@ public:
      * @param n
      * @return service_provider_name
      */
-    std::string getServiceProviderName(uint8_t n) const
+    const std::string& getServiceProviderName(uint8_t n) const
     {
-        return DecodeText(m_items[n] + 4, getServiceProviderNameLength(n));
+        return getDecodedText(m_items[n] + 4, getServiceProviderNameLength(n));
     }
 
     /**
@@ -139,9 +138,9 @@ public:
      * @param n
      * @return service_name
      */
-    std::string getServiceName(uint8_t n) const
+    const std::string& getServiceName(uint8_t n) const
     {
-        return DecodeText(m_items[n] + 5 + getServiceProviderNameLength(n), getServiceNameLength(n));
+        return getDecodedText(m_items[n] + 5 + getServiceProviderNameLength(n), getServiceNameLength(n));
     }
 
 private:
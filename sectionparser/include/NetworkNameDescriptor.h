@@ -28,7 +28,6 @@
 
 // Project's includes
 #include "MpegDescriptor.h"
-#include "DvbUtils.h"
 
 /**
  * Network name descriptor class
@@ -51,9 +50,9 @@ public:
      *
      * @return network_name
      */
-    std::string getName()
+    const std::string& getName() const
     {
-        return DecodeText(m_data.data(), m_data.size());
+        return getDecodedText(m_data.data(), m_data.size());
     }
 
     /**
@@ -63,7 +62,7 @@ public:
      */
     std::string toString()
     {
-        return DecodeText(m_data.data(), m_data.size());
+        return getDecodedText(m_data.data(), m_data.size());
     }
 };
 
@@ -28,7 +28,7 @@
 
 // Project's includes
 #include "SiTable.h"
-#include "MpegDescriptor.h"
+#include "DescriptorList.h"
 #include "TransportStream.h"
 
 /**
@@ -50,6 +50,21 @@ public:
     {
     }
 
+    /**
+     * Reinitialize the table for reuse
+     *
+     * @param id table identifier
+     * @param extId table identifier extension
+     * @param ver version number
+     * @param cur current/next indicator
+     */
+    virtual void reset(uint8_t id, uint16_t extId, uint8_t ver, bool cur)
+    {
+        SiTable::reset(id, extId, ver, cur);
+        m_networkDescriptors.clear();
+        m_tsList.clear();
+    }
+
     /**
      * Get the network identifier
      *
@@ -75,17 +90,17 @@ public:
      *
      * @param descriptors network descriptors
      */
-    void addNetworkDescriptors(const std::vector<MpegDescriptor>& descriptors)
+    void addNetworkDescriptors(const DescriptorList& descriptors)
     {
-        m_networkDescriptors.insert(m_networkDescriptors.end(), descriptors.begin(), descriptors.end());
+        m_networkDescriptors.append(descriptors);
     }
 
     /**
      * Get network descriptors
      *
-     * @return vector of network descriptors
+     * @return list of network descriptors
      */
-    const std::vector<MpegDescriptor>& getNetworkDescriptors() const
+    const DescriptorList& getNetworkDescriptors() const
     {
         return m_networkDescriptors;
     }
@@ -130,7 +145,7 @@ private:
     /**
      * Network descriptors
      */
-    std::vector<MpegDescriptor> m_networkDescriptors;
+    DescriptorList m_networkDescriptors;
 
     /**
      * List of transport streams
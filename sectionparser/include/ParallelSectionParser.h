@@ -0,0 +1,234 @@
+//
+// DVB_SI for Reference Design Kit (RDK)
+//
+// Copyright (C) 2015  Dmitry Barablin & Stan Partridge (stan.partridge@arris.com)
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+#ifndef PARALLELSECTIONPARSER_H_
+#define PARALLELSECTIONPARSER_H_
+
+// C system includes
+#include <stdint.h>
+#include <stddef.h>
+
+// C++ system includes
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+// Other libraries' includes
+
+// Project's includes
+#include "sectionparser.h"
+
+/**
+ * ParallelSectionParser
+ *
+ * Spreads sections over N worker threads ("shards"), each running its own SectionParser.
+ * A section is routed by its sub-table key, so all the sections of a sub-table are parsed
+ * by the same shard, in the order they were passed in.
+ *
+ * parse() copies the section into the shard's bounded lock-free queue and returns; it may
+ * be called from several threads at once. Tables are published through the SendEventCallback
+ * from the worker threads, one call at a time.
+ */
+class ParallelSectionParser
+{
+public:
+    enum
+    {
+        MAX_SECTION_SIZE = 4096,
+        DEFAULT_QUEUE_SIZE = 256
+    };
+
+    /**
+     * Constructor
+     *
+     * @param context SendEvent's calling context
+     * @param callback SendEvent function pointer
+     * @param shards number of worker threads, 0 for one per CPU core
+     * @param queueSize number of sections each shard can queue (rounded up to a power of two)
+     */
+    ParallelSectionParser(void* context, SendEventCallback callback, size_t shards = 0,
+                          size_t queueSize = DEFAULT_QUEUE_SIZE);
+
+    /**
+     * Destructor. The queued sections are parsed before the workers stop.
+     */
+    virtual ~ParallelSectionParser();
+
+    /**
+     * Queue an SI section for parsing.
+     * Blocks (yields) if the shard's queue is full.
+     *
+     * @param data section data
+     * @param size data size
+     */
+    void parse(uint8_t* data, uint32_t size);
+
+    /**
+     * Wait until all the sections queued so far have been parsed
+     */
+    void flush();
+
+    /**
+     * Get the number of shards
+     *
+     * @return number of worker threads
+     */
+    size_t getShardCount() const
+    {
+        return m_shards.size();
+    }
+
+private:
+    /**
+     * Queue slot
+     */
+    struct Slot
+    {
+        /**
+         * Sequence number: tells producers and the consumer whose turn it is
+         */
+        std::atomic<size_t> sequence;
+
+        /**
+         * Section size
+         */
+        uint32_t size;
+
+        /**
+         * Section data
+         */
+        uint8_t data[MAX_SECTION_SIZE];
+    };
+
+    /**
+     * Worker shard
+     */
+    struct Shard
+    {
+        /**
+         * Constructor
+         *
+         * @param owner parallel section parser
+         * @param queueSize queue size (power of two)
+         */
+        Shard(ParallelSectionParser& owner, size_t queueSize);
+
+        /**
+         * Section parser (only used by the worker thread)
+         */
+        SectionParser parser;
+
+        /**
+         * Bounded multi-producer/single-consumer queue
+         */
+        std::vector<Slot> slots;
+
+        /**
+         * Queue size - 1
+         */
+        size_t mask;
+
+        /**
+         * Next slot to be claimed by a producer
+         */
+        std::atomic<size_t> tail;
+
+        /**
+         * Keeps the producers' and the consumer's index on different cache lines
+         */
+        char padding[64];
+
+        /**
+         * Next slot to be consumed
+         */
+        std::atomic<size_t> head;
+
+        /**
+         * Set by the worker before it waits for sections
+         */
+        std::atomic<bool> sleeping;
+
+        /**
+         * Protects the wake up of a sleeping worker
+         */
+        std::mutex mutex;
+
+        /**
+         * Signalled when a section is queued for a sleeping worker
+         */
+        std::condition_variable condition;
+
+        /**
+         * Worker thread
+         */
+        std::thread thread;
+    };
+
+    /**
+     * Worker thread main loop
+     *
+     * @param shard worker shard
+     */
+    void workerThread(Shard* shard);
+
+    /**
+     * SectionParser's SendEvent callback: serializes the calls of the shards
+     */
+    static void sendEvent(void* context, uint32_t tableId, void* tbl, size_t size);
+
+    /**
+     * Copy constructor
+     */
+    ParallelSectionParser(const ParallelSectionParser& other);
+
+    /**
+     * Assignment operator
+     */
+    ParallelSectionParser& operator=(const ParallelSectionParser&);
+
+    /**
+     * SendEvent's calling context
+     */
+    void* m_context;
+
+    /**
+     *  SendEvent function pointer
+     */
+    SendEventCallback m_sendEventCb;
+
+    /**
+     * Serializes the SendEvent calls
+     */
+    std::mutex m_sendEventMutex;
+
+    /**
+     * Workers keep running while set
+     */
+    std::atomic<bool> m_running;
+
+    /**
+     * Worker shards
+     */
+    std::vector<Shard*> m_shards;
+};
+
+#endif /* PARALLELSECTIONPARSER_H_ */
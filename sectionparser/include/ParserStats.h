@@ -0,0 +1,533 @@
+//
+// DVB_SI for Reference Design Kit (RDK)
+//
+// Copyright (C) 2015  Dmitry Barablin & Stan Partridge (stan.partridge@arris.com)
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+#ifndef PARSERSTATS_H_
+#define PARSERSTATS_H_
+
+// C system includes
+#include <stdint.h>
+#include <stddef.h>
+
+// C++ system includes
+#include <atomic>
+#include <vector>
+#include <memory>
+#include <mutex>
+
+// Other libraries' includes
+
+// Project's includes
+#include "SubTableMap.h"
+
+/**
+ * Section counters (snapshot)
+ */
+struct SectionCounters
+{
+    /**
+     * Constructor
+     */
+    SectionCounters()
+        : received(0),
+          rejected(0),
+          duplicates(0),
+          completed(0),
+          versionChanges(0),
+          bytes(0)
+    {
+    }
+
+    uint64_t received;          //!< sections handed to the parser
+    uint64_t rejected;          //!< unsupported table_id, bad section length or CRC_32
+    uint64_t duplicates;        //!< sections already received for the current version
+    uint64_t completed;         //!< sub-tables completed
+    uint64_t versionChanges;    //!< new version_number of a sub-table seen before
+    uint64_t bytes;             //!< bytes of the received sections
+};
+
+/**
+ * Latency histogram (snapshot). See LatencyHistogram for the bucket layout.
+ */
+struct HistogramSnapshot
+{
+    /**
+     * Constructor
+     */
+    HistogramSnapshot()
+        : count(0),
+          sum(0),
+          min(0),
+          max(0)
+    {
+    }
+
+    /**
+     * Get a percentile. The value returned is the upper bound of the bucket the percentile
+     * falls into (at most 1/8 above the true value), capped by the maximum.
+     *
+     * @param percentile percentile, 0 to 100
+     * @return value in nanoseconds, 0 if the histogram is empty
+     */
+    uint64_t getPercentile(double percentile) const;
+
+    /**
+     * Get the mean
+     *
+     * @return mean in nanoseconds, 0 if the histogram is empty
+     */
+    uint64_t getMean() const
+    {
+        return count ? sum / count : 0;
+    }
+
+    uint64_t count;                 //!< number of values
+    uint64_t sum;                   //!< sum of the values, nanoseconds
+    uint64_t min;                   //!< smallest value, nanoseconds
+    uint64_t max;                   //!< largest value, nanoseconds
+    std::vector<uint64_t> buckets;  //!< counts, empty if count is 0
+};
+
+/**
+ * Statistics of one table_id (snapshot)
+ */
+struct TableIdStats
+{
+    uint8_t tableId;
+    SectionCounters counters;
+
+    /**
+     * Time spent in SectionParser::parse() per section, the SendEvent callback excluded
+     */
+    HistogramSnapshot sectionLatency;
+
+    /**
+     * Time spent building tables (and EIT segments)
+     */
+    HistogramSnapshot buildLatency;
+};
+
+/**
+ * Statistics of one sub-table (snapshot)
+ */
+struct SubTableStats
+{
+    /**
+     * Sub-table key, see makeSubTableKey()
+     */
+    SubTableKey key;
+
+    /**
+     * Current version_number, ParserStats::NO_VERSION if none was seen
+     */
+    uint8_t version;
+
+    SectionCounters counters;
+};
+
+/**
+ * Statistics of a SectionParser (snapshot)
+ */
+struct ParserStatsSnapshot
+{
+    /**
+     * Table ids that received sections, in table_id order
+     */
+    std::vector<TableIdStats> tables;
+
+    /**
+     * Sub-tables, in the order they were first seen
+     */
+    std::vector<SubTableStats> subTables;
+};
+
+/**
+ * LatencyHistogram
+ *
+ * HDR style log-linear histogram of nanosecond values. Values below 8 have a bucket each, above
+ * that every power of two range is split into 8 buckets, so a bucket is at most 1/8 of its value
+ * wide. Values of 2^36 ns (about 68 s) and more go to the last bucket.
+ *
+ * The histogram has a single writer; snapshots may be taken from any thread.
+ */
+class LatencyHistogram
+{
+public:
+    enum
+    {
+        SUB_BUCKET_BITS = 3,
+        SUB_BUCKETS = 1 << SUB_BUCKET_BITS,
+        MAX_MAGNITUDE = 36,
+        BUCKET_COUNT = (MAX_MAGNITUDE - SUB_BUCKET_BITS + 1) * SUB_BUCKETS
+    };
+
+    /**
+     * Constructor
+     */
+    LatencyHistogram();
+
+    /**
+     * Add a value
+     *
+     * @param ns value in nanoseconds
+     */
+    void record(uint64_t ns)
+    {
+        increment(m_buckets[getBucket(ns)], 1);
+        increment(m_count, 1);
+        increment(m_sum, ns);
+        if(ns < m_min.load(std::memory_order_relaxed))
+        {
+            m_min.store(ns, std::memory_order_relaxed);
+        }
+        if(ns > m_max.load(std::memory_order_relaxed))
+        {
+            m_max.store(ns, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * Take a snapshot
+     *
+     * @param snapshot filled with the current values
+     */
+    void load(HistogramSnapshot& snapshot) const;
+
+    /**
+     * Get the bucket of a value
+     *
+     * @param ns value in nanoseconds
+     * @return bucket index
+     */
+    static size_t getBucket(uint64_t ns)
+    {
+        if(ns < SUB_BUCKETS)
+        {
+            return ns;
+        }
+
+        int magnitude = 63 - __builtin_clzll(ns);
+        if(magnitude >= MAX_MAGNITUDE)
+        {
+            return BUCKET_COUNT - 1;
+        }
+
+        return (magnitude - SUB_BUCKET_BITS + 1) * SUB_BUCKETS + ((ns >> (magnitude - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1));
+    }
+
+    /**
+     * Get the largest value of a bucket
+     *
+     * @param bucket bucket index
+     * @return value in nanoseconds
+     */
+    static uint64_t getBucketMax(size_t bucket);
+
+    /**
+     * Add to a counter that has a single writer (no locked instruction)
+     *
+     * @param counter counter
+     * @param n value to add
+     */
+    static void increment(std::atomic<uint64_t>& counter, uint64_t n)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<uint64_t> m_count;
+    std::atomic<uint64_t> m_sum;
+    std::atomic<uint64_t> m_min;
+    std::atomic<uint64_t> m_max;
+    std::atomic<uint64_t> m_buckets[BUCKET_COUNT];
+};
+
+/**
+ * ParserStats
+ *
+ * Ingest counters and latency histograms of a SectionParser, per table_id and per sub-table.
+ * Updated by the thread calling SectionParser::parse() only; getSnapshot() may be called from
+ * any thread at any time.
+ */
+class ParserStats
+{
+public:
+    enum
+    {
+        NO_VERSION = 0xFF       //!< version of a sub-table without long header sections
+    };
+
+    /**
+     * Section counters (live)
+     */
+    struct Counters
+    {
+        /**
+         * Constructor
+         */
+        Counters();
+
+        /**
+         * Take a snapshot
+         *
+         * @param snapshot filled with the current values
+         */
+        void load(SectionCounters& snapshot) const;
+
+        std::atomic<uint64_t> received;
+        std::atomic<uint64_t> rejected;
+        std::atomic<uint64_t> duplicates;
+        std::atomic<uint64_t> completed;
+        std::atomic<uint64_t> versionChanges;
+        std::atomic<uint64_t> bytes;
+    };
+
+    /**
+     * Counters of one sub-table (live)
+     */
+    struct SubTable
+    {
+        /**
+         * Constructor
+         *
+         * @param k sub-table key
+         */
+        explicit SubTable(SubTableKey k)
+            : key(k),
+              version(NO_VERSION)
+        {
+        }
+
+        SubTableKey key;
+        std::atomic<uint8_t> version;
+        Counters counters;
+    };
+
+    /**
+     * Constructor
+     */
+    ParserStats();
+
+    /**
+     * Destructor
+     */
+    ~ParserStats();
+
+    /**
+     * Get the time of the monotonic clock
+     *
+     * @return nanoseconds
+     */
+    static uint64_t now();
+
+    /**
+     * Get the counters of a sub-table, create them if it is new
+     *
+     * @param key sub-table key
+     * @return sub-table counters
+     */
+    SubTable* getSubTable(SubTableKey key)
+    {
+        SubTable*& entry = m_subTableMap[key];
+        if(!entry)
+        {
+            entry = addSubTable(key);
+        }
+        return entry;
+    }
+
+    /**
+     * Count a received section
+     *
+     * @param entry sub-table counters, NULL if the section has no sub-table (unsupported or corrupt)
+     * @param tableId table id
+     * @param size section size
+     */
+    void onReceived(SubTable* entry, uint8_t tableId, uint32_t size)
+    {
+        count(entry, tableId, &Counters::received, 1);
+        count(entry, tableId, &Counters::bytes, size);
+    }
+
+    /**
+     * Count a rejected section
+     *
+     * @param entry sub-table counters, may be NULL
+     * @param tableId table id
+     */
+    void onRejected(SubTable* entry, uint8_t tableId)
+    {
+        count(entry, tableId, &Counters::rejected, 1);
+    }
+
+    /**
+     * Count a duplicate section
+     *
+     * @param entry sub-table counters
+     * @param tableId table id
+     */
+    void onDuplicate(SubTable* entry, uint8_t tableId)
+    {
+        count(entry, tableId, &Counters::duplicates, 1);
+    }
+
+    /**
+     * Count a completed sub-table
+     *
+     * @param entry sub-table counters
+     * @param tableId table id
+     */
+    void onCompleted(SubTable* entry, uint8_t tableId)
+    {
+        count(entry, tableId, &Counters::completed, 1);
+    }
+
+    /**
+     * Track the version_number of a sub-table, count the changes
+     *
+     * @param entry sub-table counters
+     * @param tableId table id
+     * @param version version_number of the section
+     * @return true if the version is the current one, false if it is new
+     */
+    bool onVersion(SubTable* entry, uint8_t tableId, uint8_t version)
+    {
+        uint8_t current = entry->version.load(std::memory_order_relaxed);
+        if(current == version)
+        {
+            return true;
+        }
+        if(current != NO_VERSION)
+        {
+            count(entry, tableId, &Counters::versionChanges, 1);
+        }
+        entry->version.store(version, std::memory_order_relaxed);
+        return false;
+    }
+
+    /**
+     * Record the time spent on a section
+     *
+     * @param tableId table id
+     * @param ns nanoseconds
+     */
+    void recordSection(uint8_t tableId, uint64_t ns)
+    {
+        getHistogram(m_sectionLatency[tableId]).record(ns);
+    }
+
+    /**
+     * Record the time spent building a table
+     *
+     * @param tableId table id
+     * @param ns nanoseconds
+     */
+    void recordBuild(uint8_t tableId, uint64_t ns)
+    {
+        getHistogram(m_buildLatency[tableId]).record(ns);
+    }
+
+    /**
+     * Take a snapshot
+     *
+     * @param snapshot filled with the current statistics
+     */
+    void getSnapshot(ParserStatsSnapshot& snapshot) const;
+
+private:
+    /**
+     * Add a value to a counter of a sub-table and of its table id
+     *
+     * @param entry sub-table counters, may be NULL
+     * @param tableId table id
+     * @param counter counter
+     * @param n value to add
+     */
+    void count(SubTable* entry, uint8_t tableId, std::atomic<uint64_t> Counters::*counter, uint64_t n)
+    {
+        LatencyHistogram::increment(m_tables[tableId].*counter, n);
+        if(entry)
+        {
+            LatencyHistogram::increment(entry->counters.*counter, n);
+        }
+    }
+
+    /**
+     * Get a histogram, allocate it on first use
+     *
+     * @param histogram histogram slot
+     * @return histogram
+     */
+    LatencyHistogram& getHistogram(std::atomic<LatencyHistogram*>& histogram)
+    {
+        LatencyHistogram* h = histogram.load(std::memory_order_relaxed);
+        if(!h)
+        {
+            h = new LatencyHistogram;
+            histogram.store(h, std::memory_order_release);
+        }
+        return *h;
+    }
+
+    /**
+     * Create the counters of a new sub-table
+     *
+     * @param key sub-table key
+     * @return sub-table counters
+     */
+    SubTable* addSubTable(SubTableKey key);
+
+    /**
+     * Copy constructor
+     */
+    ParserStats(const ParserStats& other);
+
+    /**
+     * Assignment operator
+     */
+    ParserStats& operator=(const ParserStats&);
+
+    /**
+     * Counters per table id
+     */
+    Counters m_tables[256];
+
+    /**
+     * Histograms per table id, allocated on first use
+     */
+    std::atomic<LatencyHistogram*> m_sectionLatency[256];
+    std::atomic<LatencyHistogram*> m_buildLatency[256];
+
+    /**
+     * Sub-table lookup, used by the parsing thread only
+     */
+    SubTableMap<SubTable*> m_subTableMap;
+
+    /**
+     * Sub-tables in the order they were first seen, guarded by m_mutex
+     */
+    std::vector<std::unique_ptr<SubTable> > m_subTables;
+
+    /**
+     * Guards m_subTables
+     */
+    mutable std::mutex m_mutex;
+};
+
+#endif /* PARSERSTATS_H_ */
@@ -49,6 +49,21 @@ public:
     {
     }
 
+    /**
+     * Reinitialize the table for reuse
+     *
+     * @param id table identifier
+     * @param extId table identifier extension
+     * @param ver version number
+     * @param cur current/next indicator
+     */
+    virtual void reset(uint8_t id, uint16_t extId, uint8_t ver, bool cur)
+    {
+        SiTable::reset(id, extId, ver, cur);
+        m_serviceList.clear();
+        m_originalNetworkId = 0;
+    }
+
     /**
      * Add a service
      *
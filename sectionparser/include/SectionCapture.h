@@ -0,0 +1,396 @@
+//
+// DVB_SI for Reference Design Kit (RDK)
+//
+// Copyright (C) 2015  Dmitry Barablin & Stan Partridge (stan.partridge@arris.com)
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+#ifndef SECTIONCAPTURE_H_
+#define SECTIONCAPTURE_H_
+
+// C system includes
+#include <stdint.h>
+#include <stdio.h>
+
+// C++ system includes
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+// Other libraries' includes
+
+// Project's includes
+
+class SectionParser;
+
+// Section capture file, all numbers big endian:
+//
+//   header   "DVBSICAP" | u16 format version (1) | u16 flags (0) | u64 capture start, ns since the epoch
+//   record   varint time | u8 tuner | u16 PID | u16 section size | section
+//
+// The time of a record is the difference to the time of the previous record (the start of the
+// capture for the first one) in nanoseconds, zigzag coded (records of parsers running on
+// different threads may be slightly out of order) in LEB128: 1 to 3 bytes for most sections.
+
+/**
+ * Section read from a capture
+ */
+struct CaptureRecord
+{
+    /**
+     * Arrival time, nanoseconds from the start of the capture
+     */
+    uint64_t time;
+
+    uint8_t tuner;
+    uint16_t pid;
+    std::vector<uint8_t> data;
+};
+
+/**
+ * CaptureWriter
+ *
+ * Records sections to a capture file. write() only appends to a memory buffer, a background
+ * thread writes it out, so recording does not stall the parser on disk I/O. If the disk cannot
+ * keep up the buffer is capped and sections are dropped (see getDropCount()).
+ * Thread safe.
+ */
+class CaptureWriter
+{
+public:
+    enum
+    {
+        FLUSH_SIZE = 256 * 1024,                //!< buffered bytes that wake up the writer thread
+        MAX_BUFFER_SIZE = 16 * 1024 * 1024      //!< buffered bytes beyond which sections are dropped
+    };
+
+    /**
+     * Constructor
+     */
+    CaptureWriter();
+
+    /**
+     * Destructor. Closes the capture.
+     */
+    ~CaptureWriter();
+
+    /**
+     * Create a capture file and start the capture
+     *
+     * @param filename file name, truncated if it exists
+     * @return false if the file could not be created, true otherwise
+     */
+    bool open(const std::string& filename);
+
+    /**
+     * Write out the buffered sections and close the capture
+     */
+    void close();
+
+    /**
+     * Check if a capture is open
+     *
+     * @return true if open, false otherwise
+     */
+    bool isOpen() const
+    {
+        return m_file != NULL;
+    }
+
+    /**
+     * Record a section. Ignored if no capture is open.
+     *
+     * @param data section data
+     * @param size section size
+     * @param tuner source tuner
+     * @param pid PID the section was carried on
+     * @param time arrival time (ParserStats::now())
+     */
+    void write(const uint8_t* data, uint32_t size, uint8_t tuner, uint16_t pid, uint64_t time);
+
+    /**
+     * Get the number of sections recorded
+     *
+     * @return count
+     */
+    uint64_t getRecordCount() const;
+
+    /**
+     * Get the number of sections dropped because the file could not be written fast enough
+     *
+     * @return count
+     */
+    uint64_t getDropCount() const;
+
+    /**
+     * Recorder callback (see SectionParser::setRecorder()): records a section of the tuner of a
+     * CaptureSource
+     *
+     * @param context CaptureSource
+     * @param data section data
+     * @param size section size
+     * @param pid PID the section was carried on
+     * @param time arrival time
+     */
+    static void record(void* context, const uint8_t* data, uint32_t size, uint16_t pid, uint64_t time);
+
+private:
+    /**
+     * Writes the buffer out until the capture is closed
+     */
+    void writerThread();
+
+    /**
+     * Copy constructor
+     */
+    CaptureWriter(const CaptureWriter& other);
+
+    /**
+     * Assignment operator
+     */
+    CaptureWriter& operator=(const CaptureWriter&);
+
+    FILE* m_file;
+
+    /**
+     * Records not written out yet
+     */
+    std::vector<uint8_t> m_buffer;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::thread m_thread;
+    bool m_running;
+
+    /**
+     * Start of the capture (ParserStats::now())
+     */
+    uint64_t m_start;
+
+    /**
+     * Time of the last record
+     */
+    uint64_t m_lastTime;
+
+    uint64_t m_recordCount;
+    uint64_t m_dropCount;
+};
+
+/**
+ * Recorder context of CaptureWriter::record(): the sections of a parser come from one tuner
+ */
+struct CaptureSource
+{
+    CaptureWriter* writer;
+    uint8_t tuner;
+};
+
+/**
+ * CaptureReader
+ *
+ * Reads the records of a capture file in order
+ */
+class CaptureReader
+{
+public:
+    /**
+     * Constructor
+     */
+    CaptureReader();
+
+    /**
+     * Destructor
+     */
+    ~CaptureReader();
+
+    /**
+     * Open a capture file and check its header
+     *
+     * @param filename file name
+     * @return false if the file could not be opened or is not a capture, true otherwise
+     */
+    bool open(const std::string& filename);
+
+    /**
+     * Close the capture
+     */
+    void close();
+
+    /**
+     * Read the next record
+     *
+     * @param record filled with the record
+     * @return false at the end of the capture or if the rest of it is damaged, true otherwise
+     */
+    bool next(CaptureRecord& record);
+
+    /**
+     * Check if reading stopped at a damaged or truncated record
+     *
+     * @return true if damaged, false otherwise
+     */
+    bool isDamaged() const
+    {
+        return m_damaged;
+    }
+
+    /**
+     * Get the start of the capture
+     *
+     * @return nanoseconds since the epoch
+     */
+    uint64_t getStartTime() const
+    {
+        return m_startTime;
+    }
+
+private:
+    /**
+     * Copy constructor
+     */
+    CaptureReader(const CaptureReader& other);
+
+    /**
+     * Assignment operator
+     */
+    CaptureReader& operator=(const CaptureReader&);
+
+    FILE* m_file;
+    uint64_t m_startTime;
+
+    /**
+     * Time of the last record
+     */
+    uint64_t m_time;
+
+    bool m_damaged;
+};
+
+/**
+ * Replay statistics
+ */
+struct ReplayStats
+{
+    uint64_t sections;
+    uint64_t bytes;
+
+    /**
+     * Time between the first and the last section replayed, as captured, nanoseconds
+     */
+    uint64_t captureTime;
+
+    /**
+     * Replay time, nanoseconds
+     */
+    uint64_t wallTime;
+
+    /**
+     * Largest delay of a section past its replay time, nanoseconds (0 flat out)
+     */
+    uint64_t maxLag;
+
+    /**
+     * Sum of the delays, nanoseconds
+     */
+    uint64_t totalLag;
+};
+
+/**
+ * Section callback of CaptureReplayer
+ *
+ * @param context calling context
+ * @param record section
+ */
+typedef void (*CaptureReplayCallback) (void* context, CaptureRecord& record);
+
+/**
+ * CaptureReplayer
+ *
+ * Replays a capture with its original timing, N times faster, or as fast as it goes. The first
+ * section is replayed right away; the replay clock is CLOCK_MONOTONIC, as ParserStats::now().
+ * The time the consumer spends on a section delays the following ones, and shows in the lag.
+ */
+class CaptureReplayer
+{
+public:
+    enum
+    {
+        ALL_TUNERS = 0x100
+    };
+
+    /**
+     * Constructor: original timing, all tuners
+     */
+    CaptureReplayer();
+
+    /**
+     * Set the replay speed
+     *
+     * @param speed 1 for the original timing, N for N times faster, 0 for as fast as it goes
+     */
+    void setSpeed(double speed)
+    {
+        m_speed = speed;
+    }
+
+    /**
+     * Replay the sections of one tuner only
+     *
+     * @param tuner tuner, ALL_TUNERS for all of them (default)
+     */
+    void setTuner(uint16_t tuner)
+    {
+        m_tuner = tuner;
+    }
+
+    /**
+     * Replay a capture
+     *
+     * @param filename capture file
+     * @param callback called for every section
+     * @param context callback context
+     * @param stats filled with the replay statistics
+     * @return false if the capture could not be opened or is damaged (the sections before the
+     *         damage are replayed), true otherwise
+     */
+    bool replay(const std::string& filename, CaptureReplayCallback callback, void* context, ReplayStats& stats);
+
+    /**
+     * Replay a capture into a parser
+     *
+     * @param filename capture file
+     * @param parser parser
+     * @param stats filled with the replay statistics
+     * @return false if the capture could not be opened or is damaged, true otherwise
+     */
+    bool replay(const std::string& filename, SectionParser& parser, ReplayStats& stats);
+
+private:
+    /**
+     * Hands a section to a SectionParser
+     *
+     * @param context parser
+     * @param record section
+     */
+    static void parseSection(void* context, CaptureRecord& record);
+
+    double m_speed;
+    uint16_t m_tuner;
+};
+
+#endif /* SECTIONCAPTURE_H_ */
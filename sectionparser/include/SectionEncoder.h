@@ -0,0 +1,205 @@
+//
+// DVB_SI for Reference Design Kit (RDK)
+//
+// Copyright (C) 2015  Dmitry Barablin & Stan Partridge (stan.partridge@arris.com)
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+#ifndef SECTIONENCODER_H_
+#define SECTIONENCODER_H_
+
+// C system includes
+#include <stdint.h>
+#include <stddef.h>
+
+// C++ system includes
+#include <vector>
+
+// Other libraries' includes
+
+// Project's includes
+
+class SiTable;
+class NitTable;
+class BatTable;
+class SdtTable;
+class EitTable;
+class TotTable;
+class DescriptorList;
+
+typedef std::vector<uint8_t> SectionData_t;
+
+/**
+ * Sections of one sub-table, in section number order
+ */
+typedef std::vector<SectionData_t> SubTableSections_t;
+
+/**
+ * SectionEncoder
+ *
+ * Serializes tables back into SI sections (ETSI EN 300 468), the reverse of
+ * SectionList::buildTable(): section headers, loop lengths, reserved bits and CRC_32 are set the
+ * way a multiplexer sets them, so the sections go through SectionParser like received ones.
+ *
+ * Loops are split across sections at entry boundaries (NIT/BAT: the first descriptor loop, then
+ * the transport streams; SDT: the services; EIT: the events). EIT schedule events are placed in
+ * the 3 hour segment of their start time, up to 8 sections per segment, with an empty section for
+ * each empty segment before the last one (ETSI TS 101 211, 4.1.4). EIT p/f tables carry the
+ * present event in section 0 and the following one in section 1.
+ */
+class SectionEncoder
+{
+public:
+    enum
+    {
+        MAX_SECTION_SIZE = 1024,        //!< all tables but EIT (section_length up to 1021)
+        MAX_EIT_SECTION_SIZE = 4096,    //!< EIT (section_length up to 4093)
+        SEGMENT_HOURS = 3,              //!< EIT schedule segment
+        SEGMENTS_PER_TABLE = 32,        //!< EIT schedule segments per table_id (4 days)
+        SECTIONS_PER_SEGMENT = 8
+    };
+
+    /**
+     * Constructor
+     */
+    SectionEncoder();
+
+    /**
+     * Set the day the EIT schedule starts: segment 0 of table_id 0x50 (0x60) covers 00:00 to
+     * 03:00 UTC of this day
+     *
+     * @param mjd Modified Julian Date, 0 to start at the day of the earliest event of each table
+     */
+    void setScheduleStart(uint16_t mjd)
+    {
+        m_scheduleStart = mjd;
+    }
+
+    /**
+     * Set the size limit of the sections. Smaller sections make more sections per sub-table.
+     *
+     * @param size size limit of all tables but EIT (at most MAX_SECTION_SIZE)
+     * @param eitSize size limit of EIT (at most MAX_EIT_SECTION_SIZE)
+     */
+    void setMaxSectionSize(size_t size, size_t eitSize);
+
+    /**
+     * Encode a table, dispatching on its table_id
+     *
+     * @param table NIT, BAT, SDT, EIT or TDT/TOT
+     * @param sections filled with the sections of the sub-table
+     * @return true on success, false if the table_id is not supported or the table does not fit
+     *         in 256 sections (8 per EIT segment)
+     */
+    bool encode(const SiTable& table, SubTableSections_t& sections) const;
+
+    /**
+     * Encode a NIT
+     *
+     * @param nit table
+     * @param sections filled with the sections of the sub-table
+     * @return true on success, false if the table does not fit
+     */
+    bool encode(const NitTable& nit, SubTableSections_t& sections) const;
+
+    /**
+     * Encode a BAT
+     *
+     * @param bat table
+     * @param sections filled with the sections of the sub-table
+     * @return true on success, false if the table does not fit
+     */
+    bool encode(const BatTable& bat, SubTableSections_t& sections) const;
+
+    /**
+     * Encode an SDT
+     *
+     * @param sdt table
+     * @param sections filled with the sections of the sub-table
+     * @return true on success, false if the table does not fit
+     */
+    bool encode(const SdtTable& sdt, SubTableSections_t& sections) const;
+
+    /**
+     * Encode an EIT (p/f or schedule)
+     *
+     * @param eit table
+     * @param sections filled with the sections of the sub-table
+     * @return true on success, false if the table does not fit
+     */
+    bool encode(const EitTable& eit, SubTableSections_t& sections) const;
+
+    /**
+     * Encode a TDT or TOT
+     *
+     * @param tot table
+     * @param sections filled with the section
+     * @return true on success, false if the descriptors do not fit
+     */
+    bool encode(const TotTable& tot, SubTableSections_t& sections) const;
+
+    /**
+     * Change the version_number of an encoded section and update its CRC_32
+     *
+     * @param section section with the long header (others are left alone)
+     * @param version version number
+     */
+    static void setVersion(SectionData_t& section, uint8_t version);
+
+    /**
+     * Set the section_length of a section and append its CRC_32
+     *
+     * @param section section without CRC_32
+     */
+    static void finishSection(SectionData_t& section);
+
+private:
+    /**
+     * Encode a NIT or BAT (same structure)
+     *
+     * @param table table
+     * @param descriptors network or bouquet descriptors
+     * @param transports transport stream loop
+     * @param sections filled with the sections
+     * @return true on success, false if the table does not fit
+     */
+    template<typename T>
+    bool encodeNetwork(const SiTable& table, const DescriptorList& descriptors, const T& transports,
+            SubTableSections_t& sections) const;
+
+    /**
+     * Get the segment of an EIT schedule event
+     *
+     * @param tableId table id
+     * @param start event start time (MJD and BCD time, see DvbEvent::getStartTimeBcd())
+     * @param scheduleStart MJD of the first day of table_id 0x50 (0x60)
+     * @return segment index within the table, clamped to 0..31
+     */
+    static uint32_t getSegment(uint8_t tableId, uint64_t start, uint16_t scheduleStart);
+
+    /**
+     * MJD of the first day of the schedule, 0 for the day of the earliest event
+     */
+    uint16_t m_scheduleStart;
+
+    /**
+     * Section size limits
+     */
+    size_t m_maxSectionSize;
+    size_t m_maxEitSectionSize;
+};
+
+#endif /* SECTIONENCODER_H_ */
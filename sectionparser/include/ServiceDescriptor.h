@@ -28,7 +28,6 @@
 
 // Project's includes
 #include "MpegDescriptor.h"
-#include "DvbUtils.h"
 
 /**
  * Service descriptor class
@@ -58,7 +57,7 @@ public:
      *
      * @return service_type
      */
-    uint8_t getServiceType()
+    uint8_t getServiceType() const
     {
         return m_data[0];
     }
@@ -68,7 +67,7 @@ public:
      *
      * @return service_provider_name_length
      */
-    uint8_t getServiceProviderNameLength()
+    uint8_t getServiceProviderNameLength() const
     {
         return m_data[1];
     }
@@ -78,9 +77,9 @@ public:
      *
      * @return service_provider_name
      */
-    std::string getServiceProviderName()
+    const std::string& getServiceProviderName() const
     {
-        return DecodeText(m_data.data() + 2, getServiceProviderNameLength());
+        return getDecodedText(m_data.data() + 2, getServiceProviderNameLength());
     }
 
     /**
@@ -88,7 +87,7 @@ public:
      *
      * @return service_name_length
      */
-    uint8_t getServiceNameLength()
+    uint8_t getServiceNameLength() const
     {
         return m_data[2 + getServiceProviderNameLength()];
     }
@@ -97,9 +96,9 @@ public:
      * Get the service name
      * @return
      */
-    std::string getServiceName()
+    const std::string& getServiceName() const
     {
-        return DecodeText(m_data.data() + 3 + getServiceProviderNameLength(), getServiceNameLength());
+        return getDecodedText(m_data.data() + 3 + getServiceProviderNameLength(), getServiceNameLength());
     }
 
     /**
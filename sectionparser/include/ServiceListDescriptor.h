@@ -25,6 +25,7 @@
 
 // Project's includes
 #include "MpegDescriptor.h"
+#include "BitField.h"
 
 // Syntax of the descriptor from ETSI EN 300 468
 //
@@ -67,7 +68,7 @@ public:
      */
     uint8_t getCount() const
     {
-        return m_data.size()/3;
+        return m_data.size()/Entry::SIZE;
     }
 
     /**
@@ -78,7 +79,7 @@ public:
      */
     uint16_t getServiceId(uint8_t n) const
     {
-        return (m_data[n*3] << 8) | m_data[n*3 + 1];
+        return Entry::ServiceId::get(m_data.data() + n*Entry::SIZE);
     }
 
     /**
@@ -89,8 +90,18 @@ public:
      */
     uint16_t getServiceType(uint8_t n) const
     {
-        return m_data[n*3 + 2];
+        return Entry::ServiceType::get(m_data.data() + n*Entry::SIZE);
     }
+
+private:
+    /**
+     * Service list loop entry
+     */
+    struct Entry : BitLayout<3>
+    {
+        typedef Field<0, 16> ServiceId;
+        typedef Field<16, 8> ServiceType;
+    };
 };
 
 #endif /* SERVICELISTDESCRIPTOR_H_ */
@@ -30,7 +30,6 @@
 // Other libraries' includes
 
 // Project's includes
-#include "DvbUtils.h"
 #include "MpegDescriptor.h"
 
 /**
@@ -81,9 +80,19 @@ public:
      *
      * @return event_name
      */
-    std::string getEventName() const
+    const std::string& getEventName() const
     {
-        return DecodeText(m_data.data() + 4, getEventNameLength());
+        return getDecodedText(m_data.data() + 4, getEventNameLength());
+    }
+
+    /**
+     * Get the event name as a pooled text that may outlive the descriptor
+     *
+     * @return event_name
+     */
+    SharedText getSharedEventName() const
+    {
+        return getSharedDecodedText(m_data.data() + 4, getEventNameLength());
     }
 
     /**
@@ -101,9 +110,19 @@ public:
      *
      * @return text
      */
-    std::string getText() const
+    const std::string& getText() const
+    {
+        return getDecodedText(m_data.data() + 5 + getEventNameLength(), getTextLength());
+    }
+
+    /**
+     * Get the text as a pooled text that may outlive the descriptor
+     *
+     * @return text
+     */
+    SharedText getSharedText() const
     {
-        return DecodeText(m_data.data() + 5 + getEventNameLength(), getTextLength());
+        return getSharedDecodedText(m_data.data() + 5 + getEventNameLength(), getTextLength());
     }
 
     /**
@@ -0,0 +1,151 @@
+//
+// DVB_SI for Reference Design Kit (RDK)
+//
+// Copyright (C) 2015  Dmitry Barablin & Stan Partridge (stan.partridge@arris.com)
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+
+#ifndef SILAYOUTS_H_
+#define SILAYOUTS_H_
+
+// C system includes
+#include <stdint.h>
+#include <stddef.h>
+
+// C++ system includes
+
+// Other libraries' includes
+
+// Project's includes
+#include "BitField.h"
+
+/**
+ * Bit layouts of the SI sections and table structures (ISO/IEC 13818-1, ETSI EN 300 468).
+ * Offsets are relative to the start of each structure.
+ */
+namespace SiLayout
+{
+    enum : size_t
+    {
+        CRC_32_SIZE = 4     //!< size of the CRC_32 at the end of a section
+    };
+
+    /**
+     * Section header, common to all sections
+     */
+    struct SectionHeader : BitLayout<3>
+    {
+        typedef Field<0, 8> TableId;
+        typedef Field<8, 1, bool> SectionSyntaxIndicator;
+        typedef Field<12, 12, uint16_t> SectionLength;
+    };
+
+    /**
+     * Long section header (section_syntax_indicator set)
+     */
+    struct SyntaxSectionHeader : BitLayout<8>
+    {
+        typedef Field<24, 16> TableIdExtension;
+        typedef Field<42, 5> VersionNumber;
+        typedef Field<47, 1, bool> CurrentNextIndicator;
+        typedef Field<48, 8> SectionNumber;
+        typedef Field<56, 8> LastSectionNumber;
+    };
+
+    /**
+     * Descriptor loop length (network_descriptors_length, transport_stream_loop_length,
+     * bouquet_descriptors_length, descriptors_loop_length)
+     */
+    struct LoopLength : BitLayout<2>
+    {
+        typedef Field<4, 12, uint16_t> Length;
+    };
+
+    /**
+     * NIT/BAT transport stream loop entry, followed by the transport descriptors
+     */
+    struct TransportStreamEntry : BitLayout<6>
+    {
+        typedef Field<0, 16> TransportStreamId;
+        typedef Field<16, 16> OriginalNetworkId;
+        typedef Field<36, 12, uint16_t> DescriptorsLength;
+    };
+
+    /**
+     * SDT table data header
+     */
+    struct SdtHeader : BitLayout<3>
+    {
+        typedef Field<0, 16> OriginalNetworkId;
+    };
+
+    /**
+     * SDT service loop entry, followed by the service descriptors
+     */
+    struct SdtServiceEntry : BitLayout<5>
+    {
+        typedef Field<0, 16> ServiceId;
+        typedef Field<22, 1, bool> EitScheduleFlag;
+        typedef Field<23, 1, bool> EitPresentFollowingFlag;
+        typedef Field<24, 3> RunningStatus;
+        typedef Field<27, 1, bool> FreeCaMode;
+        typedef Field<28, 12, uint16_t> DescriptorsLength;
+    };
+
+    /**
+     * EIT table data header
+     */
+    struct EitHeader : BitLayout<6>
+    {
+        typedef Field<0, 16> TransportStreamId;
+        typedef Field<16, 16> OriginalNetworkId;
+        typedef Field<32, 8> SegmentLastSectionNumber;
+        typedef Field<40, 8> LastTableId;
+    };
+
+    /**
+     * EIT event loop entry, followed by the event descriptors
+     */
+    struct EitEventEntry : BitLayout<12>
+    {
+        typedef Field<0, 16> EventId;
+        typedef Field<16, 40> StartTime;
+        typedef Field<56, 24> Duration;
+        typedef Field<80, 3> RunningStatus;
+        typedef Field<83, 1, bool> FreeCaMode;
+        typedef Field<84, 12, uint16_t> DescriptorsLength;
+    };
+
+    /**
+     * TDT table data
+     */
+    struct Tdt : BitLayout<5>
+    {
+        typedef Field<0, 40> UtcTime;
+    };
+
+    /**
+     * TOT table data header, followed by the descriptors
+     */
+    struct Tot : BitLayout<7>
+    {
+        typedef Field<0, 40> UtcTime;
+        typedef Field<44, 12, uint16_t> DescriptorsLoopLength;
+    };
+}
+
+#endif /* SILAYOUTS_H_ */
@@ -24,6 +24,14 @@
 // C system includes
 #include <stdint.h>
 
+// C++ system includes
+#include <memory>
+
+// Other libraries' includes
+
+// Project's includes
+#include "DescriptorBuffer.h"
+
 /**
  * Table identifier enumeration
  */
@@ -83,6 +91,40 @@ public:
     {
     }
 
+    /**
+     * Reinitialize a table for reuse (see SiTablePool).
+     * Derived classes clear their contents, keeping the allocated capacity.
+     *
+     * @param id table id
+     * @param extId extension id
+     * @param ver version number
+     * @param cur current/next indicator
+     */
+    virtual void reset(uint8_t id, uint16_t extId, uint8_t ver, bool cur)
+    {
+        m_tableId = id;
+        m_extensionId = extId;
+        m_version = ver;
+        m_current = cur;
+    }
+
+    /**
+     * Get the buffer holding the descriptor data of the table.
+     * The buffer of the previous contents is reused unless descriptors handed out
+     * earlier still refer to it.
+     *
+     * @return descriptor buffer
+     */
+    DescriptorBufferPtr getDescriptorBuffer()
+    {
+        if(!m_descriptorBuffer || (m_descriptorBuffer.use_count() > 1))
+        {
+            m_descriptorBuffer = std::make_shared<DescriptorBuffer>();
+        }
+
+        return m_descriptorBuffer;
+    }
+
     /**
      * Check if table is current
      *
@@ -143,6 +185,11 @@ private:
      * Current/next indicator
      */
     bool m_current;
+
+    /**
+     * Descriptor data of the table
+     */
+    DescriptorBufferPtr m_descriptorBuffer;
 };
 
 #endif
@@ -0,0 +1,190 @@
+//
+// DVB_SI for Reference Design Kit (RDK)
+//
+// Copyright (C) 2015  Dmitry Barablin & Stan Partridge (stan.partridge@arris.com)
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+#ifndef SITABLEPOOL_H_
+#define SITABLEPOOL_H_
+
+// C system includes
+#include <stdint.h>
+#include <stddef.h>
+
+// C++ system includes
+#include <vector>
+#include <memory>
+#include <mutex>
+
+// Other libraries' includes
+
+// Project's includes
+#include "SiTable.h"
+
+/**
+ * SiTablePool
+ *
+ * Recycles the SI table objects handed out by the section parser. Released tables are kept
+ * in a free list per table type and reset on reuse, so the objects and the capacity of their
+ * event/service/transport stream vectors survive from one table version to the next.
+ *
+ * Ownership: a table published through the SendEventCallback belongs to the consumer, which
+ * gives it back with SiTablePool::release() (or by wrapping it in an SiTablePtr). Plain
+ * delete is still fine, the object is just not recycled.
+ *
+ * The pool is shared by all the parsers of the process and is thread safe.
+ */
+class SiTablePool
+{
+public:
+    enum
+    {
+        DEFAULT_MAX_FREE = 64      //!< default number of free objects kept per table type
+    };
+
+    /**
+     * Get the process wide pool
+     *
+     * @return pool
+     */
+    static SiTablePool& getInstance();
+
+    /**
+     * Get a table object for the given table id, recycled if possible
+     *
+     * @param id table identifier (selects NitTable, BatTable, SdtTable, EitTable or TotTable)
+     * @param extId table identifier extension
+     * @param ver version number
+     * @param cur current/next indicator
+     * @return table, NULL if the table id is not supported
+     */
+    SiTable* acquire(uint8_t id, uint16_t extId, uint8_t ver, bool cur);
+
+    /**
+     * Give a table back to the pool
+     *
+     * @param tbl table (may be NULL)
+     */
+    void release(SiTable* tbl);
+
+    /**
+     * Set the number of free objects kept per table type. Extra objects are deleted.
+     *
+     * @param maxFree number of free objects
+     */
+    void setMaxFree(size_t maxFree);
+
+    /**
+     * Get the number of acquire() calls served from the free lists
+     *
+     * @return number of recycled objects handed out
+     */
+    uint64_t getReuseCount();
+
+    /**
+     * Get the number of acquire() calls that allocated a new object
+     *
+     * @return number of new objects
+     */
+    uint64_t getAllocCount();
+
+private:
+    /**
+     * Table types with a free list of their own
+     */
+    enum TableType
+    {
+        NIT_TABLE,
+        BAT_TABLE,
+        SDT_TABLE,
+        EIT_TABLE,
+        TOT_TABLE,
+        TABLE_TYPE_COUNT,
+        UNKNOWN_TABLE = TABLE_TYPE_COUNT
+    };
+
+    /**
+     * Get the table type of a table id
+     *
+     * @param id table identifier
+     * @return table type
+     */
+    static TableType getTableType(uint8_t id);
+
+    /**
+     * Constructor
+     */
+    SiTablePool();
+
+    /**
+     * Destructor
+     */
+    virtual ~SiTablePool();
+
+    /**
+     * Copy constructor
+     */
+    SiTablePool(const SiTablePool& other);
+
+    /**
+     * Assignment operator
+     */
+    SiTablePool& operator=(const SiTablePool&);
+
+    /**
+     * Protects the free lists and the counters
+     */
+    std::mutex m_mutex;
+
+    /**
+     * Free lists, one per table type
+     */
+    std::vector<SiTable*> m_free[TABLE_TYPE_COUNT];
+
+    /**
+     * Number of free objects kept per table type
+     */
+    size_t m_maxFree;
+
+    /**
+     * Number of recycled objects handed out
+     */
+    uint64_t m_reuseCount;
+
+    /**
+     * Number of new objects handed out
+     */
+    uint64_t m_allocCount;
+};
+
+/**
+ * Deleter that gives tables back to the pool
+ */
+struct SiTableDeleter
+{
+    void operator()(SiTable* tbl) const
+    {
+        SiTablePool::getInstance().release(tbl);
+    }
+};
+
+/**
+ * Owning table handle: the table goes back to the pool when the handle is destroyed
+ */
+typedef std::unique_ptr<SiTable, SiTableDeleter> SiTablePtr;
+
+#endif /* SITABLEPOOL_H_ */
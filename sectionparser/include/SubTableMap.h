@@ -0,0 +1,269 @@
+//
+// DVB_SI for Reference Design Kit (RDK)
+//
+// Copyright (C) 2015  Dmitry Barablin & Stan Partridge (stan.partridge@arris.com)
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+#ifndef SUBTABLEMAP_H_
+#define SUBTABLEMAP_H_
+
+// C system includes
+#include <stdint.h>
+#include <stddef.h>
+
+// C++ system includes
+#include <vector>
+#include <utility>
+
+// Other libraries' includes
+
+// Project's includes
+#include "SiTable.h"
+
+/**
+ * Sub-table identity: table_id, table_id_extension, original_network_id and
+ * transport_stream_id packed into 56 bits.
+ */
+typedef uint64_t SubTableKey;
+
+/**
+ * Get the sub-table key of a section.
+ * The original_network_id/transport_stream_id part is taken from the payload of EITs
+ * (both) and SDTs (original_network_id, the extension being the transport_stream_id).
+ * Fields that are not present in the section are left 0.
+ *
+ * @param data section data
+ * @param size data size
+ * @return sub-table key
+ */
+inline SubTableKey makeSubTableKey(const uint8_t* data, uint32_t size)
+{
+    SubTableKey key = (uint64_t)data[0] << 48;
+
+    // Only sections with the long header have a table_id_extension
+    if(size < 8 || !(data[1] & 0x80))
+    {
+        return key;
+    }
+
+    key |= ((uint64_t)data[3] << 40) | ((uint64_t)data[4] << 32);
+
+    TableId tableId = static_cast<TableId>(data[0]);
+    if((tableId >= TableId::EIT_PF) && (tableId <= TableId::EIT_SCHED_OTHER_END))
+    {
+        // transport_stream_id, original_network_id
+        if(size >= 12)
+        {
+            key |= ((uint64_t)data[10] << 24) | ((uint64_t)data[11] << 16) | ((uint64_t)data[8] << 8) | data[9];
+        }
+    }
+    else if((tableId == TableId::SDT) || (tableId == TableId::SDT_OTHER))
+    {
+        // original_network_id
+        if(size >= 10)
+        {
+            key |= ((uint64_t)data[8] << 24) | ((uint64_t)data[9] << 16);
+        }
+    }
+
+    return key;
+}
+
+/**
+ * SubTableMap
+ *
+ * Open-addressing (linear probing) hash map from sub-table keys to values.
+ * Keys are kept in their own array so a lookup only touches the key array until it hits.
+ * Entries are never removed; the capacity is always a power of two.
+ */
+template<typename T>
+class SubTableMap
+{
+public:
+    /**
+     * Constructor
+     *
+     * @param capacity initial capacity (rounded up to a power of two)
+     */
+    explicit SubTableMap(size_t capacity = 64)
+        : m_size(0),
+          m_mask(0)
+    {
+        size_t cap = MIN_CAPACITY;
+        while(cap < capacity)
+        {
+            cap <<= 1;
+        }
+
+        m_keys.assign(cap, EMPTY_KEY);
+        m_values.resize(cap);
+        m_mask = cap - 1;
+    }
+
+    /**
+     * Find a value
+     *
+     * @param key sub-table key
+     * @return pointer to the value, NULL if the key is not in the map
+     */
+    T* find(SubTableKey key)
+    {
+        size_t idx = hash(key) & m_mask;
+        while(true)
+        {
+            uint64_t k = m_keys[idx];
+            if(k == key)
+            {
+                return &m_values[idx];
+            }
+
+            if(k == EMPTY_KEY)
+            {
+                return NULL;
+            }
+
+            idx = (idx + 1) & m_mask;
+        }
+    }
+
+    /**
+     * Find a value, insert a default constructed one if the key is not in the map
+     *
+     * @param key sub-table key
+     * @return value
+     */
+    T& operator[](SubTableKey key)
+    {
+        size_t idx = hash(key) & m_mask;
+        while(true)
+        {
+            uint64_t k = m_keys[idx];
+            if(k == key)
+            {
+                return m_values[idx];
+            }
+
+            if(k == EMPTY_KEY)
+            {
+                break;
+            }
+
+            idx = (idx + 1) & m_mask;
+        }
+
+        // Keep the load factor below 3/4
+        if((m_size + 1) * 4 > m_keys.size() * 3)
+        {
+            grow();
+            return (*this)[key];
+        }
+
+        m_keys[idx] = key;
+        m_size++;
+
+        return m_values[idx];
+    }
+
+    /**
+     * Get the number of entries
+     *
+     * @return number of entries
+     */
+    size_t size() const
+    {
+        return m_size;
+    }
+
+    /**
+     * Remove all entries
+     */
+    void clear()
+    {
+        m_keys.assign(m_keys.size(), EMPTY_KEY);
+        m_values.assign(m_values.size(), T());
+        m_size = 0;
+    }
+
+private:
+    enum : uint64_t
+    {
+        EMPTY_KEY = ~0ull,  //!< sub-table keys are 56 bits, so this is never a valid key
+        MIN_CAPACITY = 16
+    };
+
+    /**
+     * Hash a key (Fibonacci hashing, the high bits are folded down)
+     */
+    static size_t hash(SubTableKey key)
+    {
+        uint64_t h = key * 0x9e3779b97f4a7c15ull;
+        return (size_t)(h ^ (h >> 32));
+    }
+
+    /**
+     * Double the capacity and rehash
+     */
+    void grow()
+    {
+        std::vector<uint64_t> keys(m_keys.size() * 2, EMPTY_KEY);
+        std::vector<T> values(keys.size());
+        size_t mask = keys.size() - 1;
+
+        for(size_t i = 0; i < m_keys.size(); i++)
+        {
+            if(m_keys[i] == EMPTY_KEY)
+            {
+                continue;
+            }
+
+            size_t idx = hash(m_keys[i]) & mask;
+            while(keys[idx] != EMPTY_KEY)
+            {
+                idx = (idx + 1) & mask;
+            }
+
+            keys[idx] = m_keys[i];
+            std::swap(values[idx], m_values[i]);
+        }
+
+        m_keys.swap(keys);
+        m_values.swap(values);
+        m_mask = mask;
+    }
+
+    /**
+     * Keys, EMPTY_KEY for free slots
+     */
+    std::vector<uint64_t> m_keys;
+
+    /**
+     * Values, same index as the keys
+     */
+    std::vector<T> m_values;
+
+    /**
+     * Number of entries
+     */
+    size_t m_size;
+
+    /**
+     * Capacity - 1
+     */
+    size_t m_mask;
+};
+
+#endif /* SUBTABLEMAP_H_ */
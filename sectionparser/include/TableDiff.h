@@ -0,0 +1,314 @@
+//
+// DVB_SI for Reference Design Kit (RDK)
+//
+// Copyright (C) 2015  Dmitry Barablin & Stan Partridge (stan.partridge@arris.com)
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+#ifndef TABLEDIFF_H_
+#define TABLEDIFF_H_
+
+// C system includes
+#include <stdint.h>
+#include <stddef.h>
+
+// C++ system includes
+#include <vector>
+
+// Other libraries' includes
+
+// Project's includes
+#include "SiTable.h"
+#include "DvbService.h"
+#include "DvbEvent.h"
+#include "TransportStream.h"
+
+class NitTable;
+class BatTable;
+class SdtTable;
+class EitTable;
+
+/**
+ * Kind of change of a table entry
+ */
+enum class DeltaKind : uint8_t
+{
+    ADDED,      //!< the entry is new
+    REMOVED,    //!< the entry is gone
+    CHANGED     //!< the entry is in both versions, see the change flags
+};
+
+/**
+ * Change of a transport stream of a NIT or BAT
+ */
+struct TransportDelta
+{
+    enum
+    {
+        DELIVERY_CHANGED    = 0x01,     //!< delivery system descriptors (tuning parameters)
+        DESCRIPTORS_CHANGED = 0x02      //!< other descriptors
+    };
+
+    /**
+     * Constructor
+     *
+     * @param k kind of change
+     * @param ts transport stream (the old one if removed, the new one otherwise)
+     * @param flags change flags
+     */
+    TransportDelta(DeltaKind k, const TransportStream& ts, uint32_t flags)
+        : kind(k), changes(flags), transport(ts)
+    {
+    }
+
+    DeltaKind kind;
+    uint32_t changes;
+    TransportStream transport;
+};
+
+/**
+ * Change of a service of an SDT
+ */
+struct ServiceDelta
+{
+    enum
+    {
+        NAME_CHANGED           = 0x01,  //!< service and multilingual service name descriptors
+        RUNNING_STATUS_CHANGED = 0x02,  //!< running_status
+        SCRAMBLING_CHANGED     = 0x04,  //!< free_CA_mode
+        EIT_FLAGS_CHANGED      = 0x08,  //!< EIT_schedule_flag, EIT_present_following_flag
+        DESCRIPTORS_CHANGED    = 0x10   //!< other descriptors
+    };
+
+    /**
+     * Constructor
+     *
+     * @param k kind of change
+     * @param srv service (the old one if removed, the new one otherwise)
+     * @param flags change flags
+     */
+    ServiceDelta(DeltaKind k, const DvbService& srv, uint32_t flags)
+        : kind(k), changes(flags), service(srv)
+    {
+    }
+
+    DeltaKind kind;
+    uint32_t changes;
+    DvbService service;
+};
+
+/**
+ * Change of an event of an EIT
+ */
+struct EventDelta
+{
+    enum
+    {
+        START_TIME_CHANGED     = 0x01,  //!< the event moved
+        DURATION_CHANGED       = 0x02,  //!< duration
+        TITLE_CHANGED          = 0x04,  //!< short event descriptors (name and text)
+        RUNNING_STATUS_CHANGED = 0x08,  //!< running_status
+        SCRAMBLING_CHANGED     = 0x10,  //!< free_CA_mode
+        DESCRIPTORS_CHANGED    = 0x20   //!< other descriptors
+    };
+
+    /**
+     * Constructor
+     *
+     * @param k kind of change
+     * @param ev event (the old one if removed, the new one otherwise)
+     * @param flags change flags
+     */
+    EventDelta(DeltaKind k, const DvbEvent& ev, uint32_t flags)
+        : kind(k), changes(flags), event(ev)
+    {
+    }
+
+    DeltaKind kind;
+    uint32_t changes;
+    DvbEvent event;
+};
+
+/**
+ * Differences between two versions of a table. Entries present in both versions without any
+ * change are not listed. The entries copied into the deltas share the descriptor data of the
+ * tables, they do not copy it.
+ */
+struct TableDelta
+{
+    /**
+     * Constructor
+     */
+    TableDelta()
+        : tableId(0),
+          extensionId(0),
+          oldVersion(NO_VERSION),
+          newVersion(0),
+          descriptorsChanged(false)
+    {
+    }
+
+    enum
+    {
+        NO_VERSION = 0xFF       //!< oldVersion of a table seen for the first time
+    };
+
+    /**
+     * Check if the versions are the same apart from the version number
+     *
+     * @return true if nothing changed, false otherwise
+     */
+    bool empty() const
+    {
+        return !descriptorsChanged && transports.empty() && services.empty() && events.empty();
+    }
+
+    /**
+     * Clear the delta for reuse
+     */
+    void clear()
+    {
+        tableId = 0;
+        extensionId = 0;
+        oldVersion = NO_VERSION;
+        newVersion = 0;
+        descriptorsChanged = false;
+        transports.clear();
+        services.clear();
+        events.clear();
+    }
+
+    uint8_t tableId;
+    uint16_t extensionId;
+    uint8_t oldVersion;
+    uint8_t newVersion;
+
+    /**
+     * NIT network descriptors or BAT bouquet descriptors changed
+     */
+    bool descriptorsChanged;
+
+    std::vector<TransportDelta> transports;
+    std::vector<ServiceDelta> services;
+    std::vector<EventDelta> events;
+};
+
+/**
+ * TableDiff
+ *
+ * Compares a new version of a table with the previous one. Entries are matched by their
+ * identity (original_network_id/transport_stream_id, service_id, event_id) and compared
+ * field by field; descriptors are compared as raw bytes, nothing is decoded.
+ *
+ * Without a previous version (NULL) all the entries of the new table are reported as added.
+ */
+class TableDiff
+{
+public:
+    /**
+     * Compare two versions of a NIT
+     *
+     * @param prev previous version, may be NULL
+     * @param next new version
+     * @param delta filled with the differences
+     * @return true if the tables are versions of the same sub-table, false otherwise (delta left empty)
+     */
+    static bool diff(const NitTable* prev, const NitTable& next, TableDelta& delta);
+
+    /**
+     * Compare two versions of a BAT
+     *
+     * @param prev previous version, may be NULL
+     * @param next new version
+     * @param delta filled with the differences
+     * @return true if the tables are versions of the same sub-table, false otherwise (delta left empty)
+     */
+    static bool diff(const BatTable* prev, const BatTable& next, TableDelta& delta);
+
+    /**
+     * Compare two versions of an SDT
+     *
+     * @param prev previous version, may be NULL
+     * @param next new version
+     * @param delta filled with the differences
+     * @return true if the tables are versions of the same sub-table, false otherwise (delta left empty)
+     */
+    static bool diff(const SdtTable* prev, const SdtTable& next, TableDelta& delta);
+
+    /**
+     * Compare two versions of an EIT. Partial tables (see EitTable::getSegment()) are only
+     * comparable with the same segment.
+     *
+     * @param prev previous version, may be NULL
+     * @param next new version
+     * @param delta filled with the differences
+     * @return true if the tables are versions of the same sub-table, false otherwise (delta left empty)
+     */
+    static bool diff(const EitTable* prev, const EitTable& next, TableDelta& delta);
+
+    /**
+     * Compare two descriptor lists byte by byte
+     *
+     * @param a descriptor list
+     * @param b descriptor list
+     * @return true if the lists are the same, false otherwise
+     */
+    static bool isEqual(const DescriptorList& a, const DescriptorList& b);
+
+    /**
+     * Compare the descriptors with the given tags of two lists
+     *
+     * @param a descriptor list
+     * @param b descriptor list
+     * @param tags tags to compare
+     * @param count number of tags
+     * @return true if the selected descriptors are the same, false otherwise
+     */
+    static bool isEqual(const DescriptorList& a, const DescriptorList& b, const DescriptorTag* tags, size_t count);
+
+    /**
+     * Compare the descriptors of two lists, ignoring the given tags
+     *
+     * @param a descriptor list
+     * @param b descriptor list
+     * @param tags tags to ignore
+     * @param count number of tags
+     * @return true if the remaining descriptors are the same, false otherwise
+     */
+    static bool isEqualExcept(const DescriptorList& a, const DescriptorList& b, const DescriptorTag* tags, size_t count);
+
+private:
+    /**
+     * Compare the transport stream loops of a NIT or BAT
+     *
+     * @param prev previous transport streams, may be NULL
+     * @param next new transport streams
+     * @param delta filled with the transport stream differences
+     */
+    static void diffTransports(const std::vector<TransportStream>* prev, const std::vector<TransportStream>& next,
+                               TableDelta& delta);
+
+    /**
+     * Fill in the table identity of a delta
+     *
+     * @param prev previous version, may be NULL
+     * @param next new version
+     * @param delta delta
+     */
+    static void setHeader(const SiTable* prev, const SiTable& next, TableDelta& delta);
+};
+
+#endif /* TABLEDIFF_H_ */
@@ -0,0 +1,162 @@
+//
+// DVB_SI for Reference Design Kit (RDK)
+//
+// Copyright (C) 2015  Dmitry Barablin & Stan Partridge (stan.partridge@arris.com)
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+
+#ifndef TEXTDECODER_H_
+#define TEXTDECODER_H_
+
+// C system includes
+#include <stdint.h>
+#include <stddef.h>
+
+// C++ system includes
+#include <string>
+#include <memory>
+
+// Other libraries' includes
+
+// Project's includes
+
+/**
+ * Text decoding as described in ETSI EN 300 468 annex A.
+ *
+ * The first byte(s) of a text field may select the character table (A.2); without a selector
+ * the text is coded in the default table 00 (ISO/IEC 6937 with the euro sign). Supported
+ * tables: ISO/IEC 6937, ISO/IEC 8859-1..11, 13..15, ISO/IEC 10646 BMP (UTF-16) and UTF-8.
+ * Compressed text (0x1F followed by an encoding_type_id) is expanded by the decompressor
+ * registered for its encoding_type_id, the result is then decoded like any other text.
+ * The control codes of table A.1 are applied: character emphasis on/off is removed and CR/LF
+ * becomes '\n'. Characters that cannot be decoded are replaced with U+FFFD.
+ *
+ * The output is UTF-8, sized exactly: a text is scanned once to get the output size and then
+ * converted into a string of that size. Runs of ASCII characters are copied 16 bytes at a time
+ * on CPUs with SSE2 or NEON.
+ */
+namespace TextDecoder
+{
+    /**
+     * Character tables
+     */
+    enum class Charset
+    {
+        ISO_6937,       //!< default table 00
+        ISO_8859,       //!< ISO/IEC 8859 part 1..15
+        UTF_16,         //!< ISO/IEC 10646 Basic Multilingual Plane, big endian
+        UTF_8,          //!< ISO/IEC 10646 UTF-8
+        COMPRESSED,     //!< compressed text, see encodingTypeId
+        UNSUPPORTED     //!< reserved or unsupported table (only ASCII is kept)
+    };
+
+    /**
+     * Character table selection of a text field
+     */
+    struct Selection
+    {
+        /**
+         * Character table
+         */
+        Charset charset;
+
+        /**
+         * ISO/IEC 8859 part number (ISO_8859 only)
+         */
+        uint8_t part;
+
+        /**
+         * encoding_type_id (COMPRESSED only)
+         */
+        uint8_t encodingTypeId;
+
+        /**
+         * Number of selector bytes in front of the text
+         */
+        uint8_t headerSize;
+    };
+
+    /**
+     * Decompressor of the texts of an encoding_type_id (ETSI TS 101 162)
+     */
+    class Decompressor
+    {
+    public:
+        /**
+         * Destructor
+         */
+        virtual ~Decompressor()
+        {
+        }
+
+        /**
+         * Expand a compressed text
+         *
+         * @param data compressed data (after the encoding_type_id)
+         * @param len compressed data length
+         * @param out expanded text, appended to
+         * @return true if successful, false otherwise
+         */
+        virtual bool decompress(const uint8_t* data, size_t len, std::string& out) const = 0;
+    };
+
+    /**
+     * Register the decompressor of an encoding_type_id, replacing the previous one.
+     * Meant to be called at startup, but it is thread safe.
+     *
+     * @param encodingTypeId encoding_type_id
+     * @param decompressor decompressor, NULL to remove it
+     */
+    void registerDecompressor(uint8_t encodingTypeId, const std::shared_ptr<const Decompressor>& decompressor);
+
+    /**
+     * Get the decompressor of an encoding_type_id
+     *
+     * @param encodingTypeId encoding_type_id
+     * @return decompressor, NULL if none is registered
+     */
+    std::shared_ptr<const Decompressor> getDecompressor(uint8_t encodingTypeId);
+
+    /**
+     * Get the character table selected by the first bytes of a text field (A.2)
+     *
+     * @param str text field
+     * @param len text field length
+     * @return character table selection
+     */
+    Selection select(const uint8_t* str, size_t len);
+
+    /**
+     * Decode a text field
+     *
+     * @param str text field
+     * @param len text field length
+     * @return decoded text in UTF-8
+     */
+    std::string decode(const uint8_t* str, size_t len);
+
+    /**
+     * Get the length of the leading run of ASCII (< 0x80) bytes
+     *
+     * @param str data
+     * @param len data length
+     * @return number of ASCII bytes at the start of the data
+     */
+    size_t getAsciiRun(const uint8_t* str, size_t len);
+}
+
+#endif /* TEXTDECODER_H_ */
@@ -0,0 +1,323 @@
+//
+// DVB_SI for Reference Design Kit (RDK)
+//
+// Copyright (C) 2015  Dmitry Barablin & Stan Partridge (stan.partridge@arris.com)
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+
+#ifndef TEXTPOOL_H_
+#define TEXTPOOL_H_
+
+// C system includes
+#include <stdint.h>
+#include <stddef.h>
+
+// C++ system includes
+#include <string>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <unordered_map>
+
+// Other libraries' includes
+
+// Project's includes
+
+/**
+ * Shared, immutable UTF-8 text handed out by the TextPool.
+ * Copies share the same string; it converts to const std::string& so it can be used
+ * wherever a string is expected.
+ */
+class SharedText
+{
+public:
+    /**
+     * Constructor (empty text)
+     */
+    SharedText()
+    {
+    }
+
+    /**
+     * Constructor (text that is not pooled)
+     *
+     * @param text text to copy
+     */
+    SharedText(const std::string& text)
+        : m_text(std::make_shared<const std::string>(text))
+    {
+    }
+
+    /**
+     * Constructor
+     *
+     * @param text shared string
+     */
+    explicit SharedText(const std::shared_ptr<const std::string>& text)
+        : m_text(text)
+    {
+    }
+
+    /**
+     * Get the text
+     *
+     * @return text, an empty string if none
+     */
+    const std::string& str() const
+    {
+        return m_text ? *m_text : getEmpty();
+    }
+
+    /**
+     * Conversion to const std::string&
+     */
+    operator const std::string&() const
+    {
+        return str();
+    }
+
+    /**
+     * Get the text as a C string
+     *
+     * @return null terminated text
+     */
+    const char* c_str() const
+    {
+        return str().c_str();
+    }
+
+    /**
+     * Get the length of the text
+     *
+     * @return number of bytes
+     */
+    size_t size() const
+    {
+        return str().size();
+    }
+
+    /**
+     * Check if the text is empty
+     *
+     * @return true if empty, false otherwise
+     */
+    bool empty() const
+    {
+        return str().empty();
+    }
+
+    /**
+     * Compare two texts (pooled texts are equal if they share the same string)
+     *
+     * @param other text to compare with
+     * @return true if equal, false otherwise
+     */
+    bool operator==(const SharedText& other) const
+    {
+        return (m_text == other.m_text) || (str() == other.str());
+    }
+
+    /**
+     * Compare two texts
+     *
+     * @param other text to compare with
+     * @return true if different, false otherwise
+     */
+    bool operator!=(const SharedText& other) const
+    {
+        return !(*this == other);
+    }
+
+private:
+    /**
+     * Get the string returned for empty texts
+     *
+     * @return empty string
+     */
+    static const std::string& getEmpty()
+    {
+        static const std::string empty;
+        return empty;
+    }
+
+    /**
+     * Shared string, NULL for an empty text
+     */
+    std::shared_ptr<const std::string> m_text;
+};
+
+/**
+ * TextPool
+ *
+ * Hash-consed pool of decoded texts. Event titles, series names, provider names and the like
+ * are repeated thousands of times across EIT versions and segments; the pool decodes each
+ * distinct coded string once (keyed on the raw annex A bytes) and hands out SharedText
+ * references to a single copy of the UTF-8 result.
+ *
+ * The pool only holds weak references: a text is freed when its last SharedText goes away,
+ * and the expired entries are swept as the pool grows. The pool is split in shards, each with
+ * its own lock, and is thread safe.
+ */
+class TextPool
+{
+public:
+    /**
+     * Get the process wide pool
+     *
+     * @return pool
+     */
+    static TextPool& getInstance();
+
+    /**
+     * Get the decoded text of a coded string (ETSI EN 300 468 annex A), decoding it
+     * only if it is not in the pool yet
+     *
+     * @param text first byte of the coded text
+     * @param len length of the coded text
+     * @return decoded text in UTF-8
+     */
+    SharedText decode(const uint8_t* text, size_t len);
+
+    /**
+     * Get the pooled copy of an already decoded text
+     *
+     * @param text UTF-8 text
+     * @return shared text
+     */
+    SharedText intern(const std::string& text);
+
+    /**
+     * Get the number of texts in the pool (including expired ones not swept yet)
+     *
+     * @return number of entries
+     */
+    size_t size();
+
+    /**
+     * Get the number of lookups served from the pool
+     *
+     * @return number of hits
+     */
+    uint64_t getHitCount() const
+    {
+        return m_hitCount.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Get the number of lookups that added a text to the pool
+     *
+     * @return number of misses
+     */
+    uint64_t getMissCount() const
+    {
+        return m_missCount.load(std::memory_order_relaxed);
+    }
+
+private:
+    enum
+    {
+        SHARD_COUNT = 16,        //!< number of independently locked shards
+        MIN_SWEEP_SIZE = 256     //!< shard size below which expired entries are left alone
+    };
+
+    /**
+     * Kind of key, so coded and decoded texts with the same bytes do not collide
+     */
+    enum KeyKind : char
+    {
+        CODED_KEY = 'c',
+        DECODED_KEY = 'd'
+    };
+
+    /**
+     * Pool shard
+     */
+    struct Shard
+    {
+        /**
+         * Constructor
+         */
+        Shard()
+            : sweepSize(MIN_SWEEP_SIZE)
+        {
+        }
+
+        /**
+         * Protects the texts
+         */
+        std::mutex mutex;
+
+        /**
+         * Texts keyed by kind and bytes
+         */
+        std::unordered_map<std::string, std::weak_ptr<const std::string>> texts;
+
+        /**
+         * Number of entries that triggers the next sweep
+         */
+        size_t sweepSize;
+    };
+
+    /**
+     * Look a text up, adding it if it is not in the pool or has expired
+     *
+     * @param kind key kind
+     * @param data key bytes
+     * @param len number of key bytes
+     * @return shared text
+     */
+    SharedText get(KeyKind kind, const uint8_t* data, size_t len);
+
+    /**
+     * Remove the expired entries of a shard (the shard must be locked)
+     *
+     * @param shard pool shard
+     */
+    static void sweep(Shard& shard);
+
+    /**
+     * Constructor
+     */
+    TextPool();
+
+    /**
+     * Copy constructor
+     */
+    TextPool(const TextPool& other);
+
+    /**
+     * Assignment operator
+     */
+    TextPool& operator=(const TextPool&);
+
+    /**
+     * Shards
+     */
+    Shard m_shards[SHARD_COUNT];
+
+    /**
+     * Number of lookups served from the pool
+     */
+    std::atomic<uint64_t> m_hitCount;
+
+    /**
+     * Number of lookups that added a text
+     */
+    std::atomic<uint64_t> m_missCount;
+};
+
+#endif /* TEXTPOOL_H_ */
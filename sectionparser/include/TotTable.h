@@ -28,7 +28,7 @@
 
 // Project's includes
 #include "SiTable.h"
-#include "MpegDescriptor.h"
+#include "DescriptorList.h"
 
 #include "DvbUtils.h"
 
@@ -52,6 +52,21 @@ public:
     {
     }
 
+    /**
+     * Reinitialize the table for reuse
+     *
+     * @param id table identifier
+     * @param extId table identifier extension
+     * @param ver version number
+     * @param cur current/next indicator
+     */
+    virtual void reset(uint8_t id, uint16_t extId, uint8_t ver, bool cur)
+    {
+        SiTable::reset(id, extId, ver, cur);
+        m_utcTime = 0;
+        m_descriptors.clear();
+    }
+
     /**
      * Add a descriptor
      *
@@ -67,17 +82,17 @@ public:
      *
      * @param descriptors the descriptors
      */
-    void addDescriptors(const std::vector<MpegDescriptor>& descriptors)
+    void addDescriptors(const DescriptorList& descriptors)
     {
-        m_descriptors.insert(m_descriptors.end(), descriptors.begin(), descriptors.end());
+        m_descriptors.append(descriptors);
     }
 
     /**
      * Get descriptors
      *
-     * @return vector of descriptors
+     * @return list of descriptors
      */
-    std::vector<MpegDescriptor>& getDescriptors()
+    const DescriptorList& getDescriptors() const
     {
         return m_descriptors;
     }
@@ -129,7 +144,7 @@ private:
     /**
      * Descriptors
      */
-    std::vector<MpegDescriptor> m_descriptors;
+    DescriptorList m_descriptors;
 };
 
 #endif /* TOTTABLE_H_ */
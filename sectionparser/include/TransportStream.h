@@ -27,6 +27,11 @@
 // C++ system includes
 #include <vector>
 
+// Other libraries' includes
+
+// Project's includes
+#include "DescriptorList.h"
+
 /**
  * Transport stream class
  */
@@ -95,9 +100,9 @@ public:
     /**
      * Get transport stream descriptors
      *
-     * @return vector of ts descriptors
+     * @return list of ts descriptors
      */
-    const std::vector<MpegDescriptor>& getTsDescriptors() const
+    const DescriptorList& getTsDescriptors() const
     {
         return m_tsDescriptors;
     }
@@ -117,9 +122,9 @@ public:
      *
      * @param descriptors the descriptors
      */
-    void addDescriptors(const std::vector<MpegDescriptor>& descriptors)
+    void addDescriptors(const DescriptorList& descriptors)
     {
-        m_tsDescriptors.insert(m_tsDescriptors.end(), descriptors.begin(), descriptors.end());
+        m_tsDescriptors.append(descriptors);
     }
 
     /**
@@ -144,7 +149,7 @@ private:
     /**
      * Transport stream descriptors
      */
-    std::vector<MpegDescriptor> m_tsDescriptors;
+    DescriptorList m_tsDescriptors;
 };
 
 #endif /* TRANSPORTSTREAM_H_ */
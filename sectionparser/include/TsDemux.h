@@ -0,0 +1,301 @@
+//
+// DVB_SI for Reference Design Kit (RDK)
+//
+// Copyright (C) 2015  Dmitry Barablin & Stan Partridge (stan.partridge@arris.com)
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+#ifndef TSDEMUX_H_
+#define TSDEMUX_H_
+
+// C system includes
+#include <stdint.h>
+#include <stddef.h>
+
+// C++ system includes
+#include <vector>
+
+// Other libraries' includes
+
+// Project's includes
+
+// Forward declarations
+class SectionParser;
+
+/**
+ * Section callback. Called for every reassembled section.
+ *
+ * @param context calling context
+ * @param pid PID the section was carried on
+ * @param data section data (valid for the duration of the call only)
+ * @param size section size
+ */
+typedef void (*SectionCallback) (void*, uint16_t, uint8_t*, uint32_t);
+
+/**
+ * DVB SI PIDs (ETSI EN 300 468, 5.1.3)
+ */
+enum class SiPid : uint16_t
+{
+    NIT = 0x10,                  //!< NIT, ST
+    SDT_BAT = 0x11,              //!< SDT, BAT, ST
+    EIT = 0x12,                  //!< EIT, ST, CIT
+    TDT_TOT = 0x14               //!< TDT, TOT, ST
+};
+
+/**
+ * TsDemux
+ *
+ * Takes raw 188-byte transport stream packets as an input, filters them by PID and
+ * reassembles the SI sections carried in them. Every complete section is handed to
+ * the section callback (SectionParser::parse() by default).
+ *
+ * Sections that are fully contained in a single packet are passed on directly from the
+ * packet; only sections spanning several packets are collected in a per-PID buffer.
+ */
+class TsDemux
+{
+public:
+    enum
+    {
+        TS_PACKET_SIZE = 188,
+        TS_SYNC_BYTE = 0x47,
+        MAX_PID = 0x1fff,
+        MAX_SECTION_SIZE = 4096
+    };
+
+    /**
+     * Constructor. Sections are passed on to the given section parser.
+     * The standard DVB SI PIDs are added to the filter.
+     *
+     * @param parser section parser
+     */
+    TsDemux(SectionParser& parser);
+
+    /**
+     * Constructor. Sections are passed on to the given callback.
+     * The standard DVB SI PIDs are added to the filter.
+     *
+     * @param context callback's calling context
+     * @param callback section callback
+     */
+    TsDemux(void* context, SectionCallback callback);
+
+    /**
+     * Destructor
+     */
+    virtual ~TsDemux();
+
+    /**
+     * Add a PID to the PID filter
+     *
+     * @param pid PID
+     * @return true if the PID was added, false otherwise
+     */
+    bool addPid(uint16_t pid);
+
+    /**
+     * Remove a PID from the PID filter
+     *
+     * @param pid PID
+     */
+    void removePid(uint16_t pid);
+
+    /**
+     * Demultiplex a buffer of TS packets.
+     * The buffer is expected to start at a packet boundary. Any trailing partial packet is not consumed.
+     *
+     * @param data TS data
+     * @param size data size
+     * @return number of bytes consumed
+     */
+    size_t demux(uint8_t* data, size_t size);
+
+    /**
+     * Demultiplex a single TS packet
+     *
+     * @param packet TS packet (TS_PACKET_SIZE bytes)
+     */
+    void demuxPacket(uint8_t* packet);
+
+    /**
+     * Drop all partially reassembled sections and continuity counter state
+     */
+    void reset();
+
+    /**
+     * Check if a section of a PID is partially reassembled
+     *
+     * @param pid PID
+     * @return true if a section is pending, false otherwise
+     */
+    bool hasPendingSection(uint16_t pid) const
+    {
+        uint8_t idx = m_pidIndex[pid & MAX_PID];
+        return idx && m_contexts[idx - 1]->filled;
+    }
+
+    /**
+     * Get the number of TS packets processed
+     *
+     * @return packet count
+     */
+    uint64_t getPacketCount() const
+    {
+        return m_packetCount;
+    }
+
+    /**
+     * Get the number of sections passed on
+     *
+     * @return section count
+     */
+    uint64_t getSectionCount() const
+    {
+        return m_sectionCount;
+    }
+
+    /**
+     * Get the number of continuity counter errors detected
+     *
+     * @return discontinuity count
+     */
+    uint64_t getDiscontinuityCount() const
+    {
+        return m_discontinuityCount;
+    }
+
+private:
+    /**
+     * Per-PID reassembly context
+     */
+    struct PidContext
+    {
+        /**
+         * PID
+         */
+        uint16_t pid;
+
+        /**
+         * Last continuity counter value, -1 if unknown
+         */
+        int8_t lastCc;
+
+        /**
+         * Number of bytes collected so far
+         */
+        uint16_t filled;
+
+        /**
+         * Expected section size, 0 if not known yet
+         */
+        uint16_t expected;
+
+        /**
+         * Reassembly buffer
+         */
+        uint8_t buffer[MAX_SECTION_SIZE];
+    };
+
+    /**
+     * Add the standard DVB SI PIDs to the filter
+     */
+    void addSiPids();
+
+    /**
+     * Start new sections at the given position of a packet payload
+     *
+     * @param ctx PID context
+     * @param p payload pointer
+     * @param end end of the payload
+     */
+    void startSections(PidContext& ctx, uint8_t* p, uint8_t* end);
+
+    /**
+     * Append payload to a partially reassembled section
+     *
+     * @param ctx PID context
+     * @param p payload pointer
+     * @param len number of bytes available
+     * @return number of bytes used
+     */
+    size_t appendSection(PidContext& ctx, uint8_t* p, size_t len);
+
+    /**
+     * Pass a complete section on
+     *
+     * @param pid PID
+     * @param data section data
+     * @param size section size
+     */
+    void emitSection(uint16_t pid, uint8_t* data, uint32_t size)
+    {
+        m_sectionCount++;
+        m_sectionCb(m_context, pid, data, size);
+    }
+
+    /**
+     * SectionParser's section callback
+     */
+    static void parseSection(void* context, uint16_t pid, uint8_t* data, uint32_t size);
+
+    /**
+     * Copy constructor
+     */
+    TsDemux(const TsDemux& other);
+
+    /**
+     * Assignment operator
+     */
+    TsDemux& operator=(const TsDemux&);
+
+    /**
+     * Section callback's calling context
+     */
+    void* m_context;
+
+    /**
+     * Section callback
+     */
+    SectionCallback m_sectionCb;
+
+    /**
+     * PID filter: index into m_contexts + 1 for every filtered PID, 0 otherwise
+     */
+    uint8_t m_pidIndex[MAX_PID + 1];
+
+    /**
+     * Reassembly contexts of the filtered PIDs
+     */
+    std::vector<PidContext*> m_contexts;
+
+    /**
+     * Number of TS packets processed
+     */
+    uint64_t m_packetCount;
+
+    /**
+     * Number of sections passed on
+     */
+    uint64_t m_sectionCount;
+
+    /**
+     * Number of continuity counter errors
+     */
+    uint64_t m_discontinuityCount;
+};
+
+#endif /* TSDEMUX_H_ */
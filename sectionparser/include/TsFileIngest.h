@@ -0,0 +1,216 @@
+//
+// DVB_SI for Reference Design Kit (RDK)
+//
+// Copyright (C) 2015  Dmitry Barablin & Stan Partridge (stan.partridge@arris.com)
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+#ifndef TSFILEINGEST_H_
+#define TSFILEINGEST_H_
+
+// C system includes
+#include <stdint.h>
+#include <stddef.h>
+
+// C++ system includes
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+
+// Other libraries' includes
+
+// Project's includes
+#include "TsDemux.h"
+
+class SectionParser;
+
+/**
+ * Ingest statistics
+ */
+struct TsIngestStats
+{
+    uint64_t bytes;
+    uint64_t packets;
+    uint64_t sections;
+
+    /**
+     * Continuity counter errors on the filtered PIDs
+     */
+    uint64_t discontinuities;
+
+    uint64_t chunks;
+
+    /**
+     * Ingest time, nanoseconds
+     */
+    uint64_t time;
+};
+
+/**
+ * TsFileIngest
+ *
+ * Pushes a transport stream capture file through the section demultiplexer and the parser.
+ * The file is memory mapped and split into chunks that start on a packet boundary (a sync byte
+ * found with memchr() and confirmed RESYNC_PACKETS times a packet apart). Worker threads demux
+ * the chunks in parallel, each with its own TsDemux, and the sections are handed on in chunk
+ * order on the calling thread. The sections of a PID come out in file order: a section that
+ * crosses the end of a chunk is completed by the worker of that chunk, which demuxes on into
+ * the next one until its pending sections are done; the next chunk starts with the first
+ * section beginning in it.
+ */
+class TsFileIngest
+{
+public:
+    enum
+    {
+        DEFAULT_CHUNK_SIZE = 16 * 1024 * 1024,
+        RESYNC_PACKETS = 5                      //!< sync bytes a packet apart that confirm a packet boundary
+    };
+
+    /**
+     * Constructor. The standard DVB SI PIDs are filtered, one worker per CPU core.
+     */
+    TsFileIngest();
+
+    /**
+     * Destructor
+     */
+    ~TsFileIngest();
+
+    /**
+     * Add a PID to the PID filter
+     *
+     * @param pid PID
+     * @return true if the PID was added, false otherwise
+     */
+    bool addPid(uint16_t pid);
+
+    /**
+     * Set the number of worker threads
+     *
+     * @param threads thread count, 0 for one per CPU core
+     */
+    void setThreadCount(size_t threads);
+
+    /**
+     * Set the chunk size
+     *
+     * @param bytes size of a chunk (a packet boundary is looked for from there on)
+     */
+    void setChunkSize(size_t bytes);
+
+    /**
+     * Ingest a capture file into a parser
+     *
+     * @param filename TS file
+     * @param parser parser
+     * @param stats filled with the ingest statistics
+     * @return false if the file could not be mapped, true otherwise
+     */
+    bool ingest(const std::string& filename, SectionParser& parser, TsIngestStats& stats);
+
+    /**
+     * Ingest a capture file
+     *
+     * @param filename TS file
+     * @param callback called for every section, on the calling thread
+     * @param context callback context
+     * @param stats filled with the ingest statistics
+     * @return false if the file could not be mapped, true otherwise
+     */
+    bool ingest(const std::string& filename, SectionCallback callback, void* context, TsIngestStats& stats);
+
+private:
+    struct Chunk;
+
+    /**
+     * Find a packet boundary
+     *
+     * @param p where to start looking
+     * @param end end of the data
+     * @return first packet boundary at p or later, end if there is none
+     */
+    static uint8_t* findSync(uint8_t* p, uint8_t* end);
+
+    /**
+     * Demuxes the chunks until there are none left
+     */
+    void workerThread();
+
+    /**
+     * Demux a chunk
+     *
+     * @param chunk chunk
+     */
+    void demuxChunk(Chunk& chunk);
+
+    /**
+     * TsDemux section callback: keeps the section in the chunk
+     */
+    static void keepSection(void* context, uint16_t pid, uint8_t* data, uint32_t size);
+
+    /**
+     * SectionParser's section callback
+     */
+    static void parseSection(void* context, uint16_t pid, uint8_t* data, uint32_t size);
+
+    /**
+     * Copy constructor
+     */
+    TsFileIngest(const TsFileIngest& other);
+
+    /**
+     * Assignment operator
+     */
+    TsFileIngest& operator=(const TsFileIngest&);
+
+    /**
+     * Filtered PIDs
+     */
+    std::vector<uint16_t> m_pids;
+
+    size_t m_threads;
+    size_t m_chunkSize;
+
+    /**
+     * File mapping of the current ingest
+     */
+    uint8_t* m_data;
+    size_t m_size;
+
+    /**
+     * Chunks of the current ingest
+     */
+    std::vector<std::unique_ptr<Chunk> > m_chunks;
+
+    /**
+     * Next chunk to demux
+     */
+    std::atomic<size_t> m_next;
+
+    /**
+     * Number of chunks handed on; the workers stay within a window ahead of it
+     */
+    size_t m_handed;
+
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+};
+
+#endif /* TSFILEINGEST_H_ */
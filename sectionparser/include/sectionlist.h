@@ -23,24 +23,21 @@
 
 // C system includes
 #include <stdint.h>
+#include <stddef.h>
 
 // C++ system includes
 #include <vector>
-#include <list>
 #include <string>
 
 /**
- * SI Section structure
+ * SI Section header fields
  */
-struct Section
+struct SectionHeader
 {
     /**
      * Constructor
-     *
-     * @param data section data
-     * @param len data length
      */
-    Section(uint8_t *data, size_t len);
+    SectionHeader();
 
     /**
      * Table Identifier
@@ -91,11 +88,49 @@ struct Section
      * This indicates which table is the last table in the sequence of tables.
      */
     uint8_t lastNumber;
+};
+
+/**
+ * Non-owning view of an SI section.
+ * The header is decoded from the input buffer; the payload points into it, so the view
+ * is only valid as long as the input buffer is.
+ */
+struct SectionView : public SectionHeader
+{
+    /**
+     * Constructor
+     *
+     * @param data section data
+     * @param len data length
+     */
+    SectionView(uint8_t *data, size_t len);
+
+    /**
+     * Table data (NULL if the section is malformed)
+     */
+    uint8_t* payload;
+
+    /**
+     * Table data size
+     */
+    uint16_t payloadSize;
+};
+
+/**
+ * SI Section kept in a section list.
+ * The payload lives in the section list's payload buffer.
+ */
+struct Section : public SectionHeader
+{
+    /**
+     * Offset of the table data in the section list's payload buffer
+     */
+    uint32_t payloadOffset;
 
     /**
-     * Table data
+     * Table data size
      */
-    std::vector<uint8_t> payload;
+    uint16_t payloadSize;
 };
 
 // Forward declarations
@@ -105,6 +140,7 @@ class BatTable;
 class SdtTable;
 class EitTable;
 class TotTable;
+class DescriptorBuffer;
 
 /**
  * Section list class
@@ -124,12 +160,13 @@ public:
     virtual ~SectionList();
 
     /**
-     * Add a section to the section list
+     * Add a section to the section list.
+     * The section's payload is copied into the list only if the section is kept.
      *
      * @param section
      * @return true if the section was added successfully
      */
-    bool add(Section& section);
+    bool add(const SectionView& section);
 
     /**
      * Build an SI Table out of the sections in the section list
@@ -148,6 +185,59 @@ public:
         return m_complete;
     }
 
+    /**
+     * Check if all the sections of an EIT segment are in place
+     *
+     * @param segment segment index (section_number / 8)
+     * @return true if the segment is complete, false otherwise
+     */
+    bool isSegmentComplete(uint8_t segment) const;
+
+    /**
+     * Check if an EIT segment has already been built
+     *
+     * @param segment segment index (section_number / 8)
+     * @return true if the segment was built, false otherwise
+     */
+    bool isSegmentBuilt(uint8_t segment) const
+    {
+        return m_builtSegments & (1u << segment);
+    }
+
+    /**
+     * Build a partial EIT table out of the sections of one segment
+     *
+     * @param segment segment index (section_number / 8)
+     * @return EitTable* if table was built successfully, NULL otherwise
+     */
+    EitTable* buildSegment(uint8_t segment);
+
+    /**
+     * Check if a table id is an EIT table id
+     *
+     * @param tableId
+     * @return true if the table id is for EIT sections, false otherwise
+     */
+    static bool isEit(uint8_t tableId);
+
+    /**
+     * Get the section numbers in the list as a bitmap
+     *
+     * @param bitmap [out] one bit per section number
+     */
+    void getSectionBitmap(uint32_t (&bitmap)[8]) const;
+
+    /**
+     * Check if a section number has been received
+     *
+     * @param number section number
+     * @return true if the section is in the list, false otherwise
+     */
+    bool isReceived(uint8_t number) const
+    {
+        return m_received[number >> 5] & (1u << (number & 0x1f));
+    }
+
     /**
      * Get a string with debug data such as table id, section numbers etc
      *
@@ -162,30 +252,73 @@ private:
      *
      * @param section SI section
      */
-    void insert(Section& section);
+    void insert(const SectionView& section);
 
     /**
      * Check if the section list is complete (all sections of the table are in place)
      *
-     * @param lastRcvdSect
      * @return true if the list is complete, false otherwise
      */
-    bool complete(Section& lastRcvdSect);
+    bool complete() const;
+
+    /**
+     * Get the lowest section number in the list
+     *
+     * @return section number
+     */
+    uint8_t getFirstNumber() const;
+
+    /**
+     * Mark the sections of an EIT segment as expected
+     *
+     * @param section first section received from the segment
+     */
+    void addSegment(const SectionView& section);
 
     /**
      * Initialize the section list
      *
      * @param section SI section
      */
-    void init(Section& section);
+    void init(const SectionView& section);
 
     /**
-     * Check if the list is for EIT sections
+     * Copy the section into the payload buffer
      *
-     * @param tableId
-     * @return true if the list contains EIT sections, false otherwise
+     * @param section SI section
+     * @return the stored section
+     */
+    Section store(const SectionView& section);
+
+    /**
+     * Get the table data of a stored section
+     *
+     * @param section stored section
+     * @return table data, NULL if the section has no payload
+     */
+    uint8_t* getPayload(const Section& section)
+    {
+        return section.payloadSize ? m_payloadBuffer.data() + section.payloadOffset : NULL;
+    }
+
+    /**
+     * Get the size of the table data of a stored section, without the CRC_32
+     *
+     * @param section stored section
+     * @return table data size
+     */
+    static uint16_t getTableDataSize(const Section& section);
+
+    /**
+     * Copy the table data of the received sections firstNumber..lastNumber into a descriptor buffer,
+     * in section number order, so the table's descriptors can refer to it
+     *
+     * @param buffer descriptor buffer
+     * @param firstNumber first section number
+     * @param lastNumber last section number
+     * @return copy of the first section's table data, followed by the others
      */
-    bool isEit(uint8_t tableId);
+    uint8_t* copyPayloads(DescriptorBuffer& buffer, uint32_t firstNumber = 0, uint32_t lastNumber = 0xff);
 
     /**
      * Build an NIT table
@@ -211,9 +344,11 @@ private:
     /**
      * Build an EIT table
      *
+     * @param first first section number to include
+     * @param last last section number to include
      * @return EitTable if successful, NULL otherwise
      */
-    EitTable* buildEit();
+    EitTable* buildEit(uint32_t first = 0, uint32_t last = 0xff);
 
     /**
      * Build a TOT/TDT table
@@ -228,14 +363,54 @@ private:
     bool m_complete;
 
     /**
-     * First section number that was received
+     * Header fields shared by all the sections of the list
+     */
+    SectionHeader m_header;
+
+    /**
+     * Received section numbers, one bit per section
+     */
+    uint32_t m_received[8];
+
+    /**
+     * Section numbers needed to complete the table, one bit per section
+     */
+    uint32_t m_expected[8];
+
+    /**
+     * Number of sections received
+     */
+    uint16_t m_receivedCount;
+
+    /**
+     * Number of sections needed to complete the table
+     */
+    uint16_t m_expectedCount;
+
+    /**
+     * EIT segments whose segment_last_section_number is known, one bit per segment
+     */
+    uint32_t m_knownSegments;
+
+    /**
+     * EIT segments needed to complete the table, one bit per segment
+     */
+    uint32_t m_neededSegments;
+
+    /**
+     * EIT segments already built as partial tables, one bit per segment
+     */
+    uint32_t m_builtSegments;
+
+    /**
+     * Sections indexed by section number (0..last_section_number), valid if received
      */
-    uint8_t m_firstReceivedNumber;
+    std::vector<Section> m_slots;
 
     /**
-     * The list of sections
+     * Table data of the sections in the list. Reused (not freed) when the list is reinitialized.
      */
-    std::list<Section> m_sectionList;
+    std::vector<uint8_t> m_payloadBuffer;
 };
 
 #endif /* SECTIONLIST_H_ */
@@ -25,7 +25,6 @@
 #include <stdint.h>
 
 // C++ system includes
-#include <map>
 #include <list>
 #include <utility>
 #include <memory>
@@ -34,10 +33,62 @@
 
 // Project's includes
 #include "sectionlist.h"
+#include "SubTableMap.h"
+#include "ParserStats.h"
+#include "CarouselMonitor.h"
 
-typedef std::map<std::pair<uint8_t, uint16_t>, SectionList> SectionMap_t;
+/**
+ * Fingerprint of a completed sub-table: enough to recognize repeated sections
+ * of the same version from the section header alone.
+ */
+struct SectionFingerprint
+{
+    /**
+     * Version number of the completed sub-table
+     */
+    uint8_t version;
+
+    /**
+     * Last section number of the completed sub-table
+     */
+    uint8_t lastNumber;
+
+    /**
+     * Received section numbers, one bit per section
+     */
+    uint32_t received[8];
+
+    /**
+     * Counters of the sub-table, the repeats are counted without looking them up
+     */
+    ParserStats::SubTable* stats;
+};
+
+typedef SubTableMap<SectionList> SectionMap_t;
+typedef SubTableMap<SectionFingerprint> FingerprintMap_t;
+/**
+ * SendEvent callback. Called for every table built.
+ * The table (an SiTable*) is owned by the callee from then on: it has to be given back with
+ * SiTablePool::release() (see SiTablePtr) or deleted.
+ *
+ * @param context calling context
+ * @param tableId table identifier
+ * @param tbl table
+ * @param size unused, 0
+ */
 typedef void (*SendEventCallback) (void*, uint32_t, void*, size_t);
 
+/**
+ * Recorder callback. Called with every section handed to the parser, before it is parsed.
+ *
+ * @param context calling context
+ * @param data section data
+ * @param size section size
+ * @param pid PID the section was carried on
+ * @param time arrival time (ParserStats::now())
+ */
+typedef void (*SectionRecordCallback) (void*, const uint8_t*, uint32_t, uint16_t, uint64_t);
+
 /**
  * SectionParser
  *
@@ -66,7 +117,167 @@ public:
      */
     void parse(uint8_t* data, uint32_t size);
 
+    /**
+     * Parse SI Section
+     *
+     * @param data section data
+     * @param size data size
+     * @param pid PID the section was carried on
+     */
+    void parse(uint8_t* data, uint32_t size, uint16_t pid);
+
+    /**
+     * Set the recorder, e.g. CaptureWriter::record(). To be set before parsing starts or from
+     * the parsing thread.
+     *
+     * @param context recorder's calling context
+     * @param callback recorder, NULL to stop recording
+     */
+    void setRecorder(void* context, SectionRecordCallback callback)
+    {
+        m_recorderContext = context;
+        m_recorderCb = callback;
+    }
+
+    /**
+     * Enable or disable per-segment EIT emission.
+     * When enabled, every EIT segment (3 hours of schedule) is published as a partial EitTable
+     * (see EitTable::getSegment()) as soon as its sections are in place, and complete EIT
+     * sub-tables are not published as a whole. Consumers have to merge the segments.
+     *
+     * @param enable true to enable, false to publish complete sub-tables only (default)
+     */
+    void setEitSegmentMode(bool enable)
+    {
+        m_eitSegmentMode = enable;
+    }
+
+    /**
+     * Get the number of sections rejected because of a bad section length or CRC_32
+     *
+     * @return number of rejected sections
+     */
+    uint64_t getCrcErrorCount() const
+    {
+        return m_crcErrorCount;
+    }
+
+    /**
+     * Get the number of sections dropped because they belong to an already complete sub-table
+     *
+     * @return number of dropped sections
+     */
+    uint64_t getRepeatCount() const
+    {
+        return m_repeatCount;
+    }
+
+    /**
+     * Enable or disable the latency histograms (disabled by default). Enabling costs two clock
+     * reads per section; the counters are always kept.
+     *
+     * @param enable true to enable, false to disable
+     */
+    void setLatencyStatsEnabled(bool enable)
+    {
+        m_latencyStatsEnabled = enable;
+    }
+
+    /**
+     * Get the ingest counters and latency histograms, per table_id and per sub-table.
+     * Can be called from any thread.
+     *
+     * @param snapshot filled with the current statistics
+     */
+    void getStats(ParserStatsSnapshot& snapshot) const
+    {
+        m_stats.getSnapshot(snapshot);
+    }
+
+    /**
+     * Enable or disable the carousel monitor (disabled by default). Enabling costs a clock read
+     * and a sub-table lookup per section.
+     *
+     * @param enable true to enable, false to disable
+     */
+    void setCarouselMonitorEnabled(bool enable)
+    {
+        m_carouselMonitorEnabled = enable;
+    }
+
+    /**
+     * Get the carousel repetition interval and cycle time of a table_id.
+     * Can be called from any thread.
+     *
+     * @param pid PID, CarouselMonitor::UNKNOWN_PID for the standard SI PID of the table_id
+     * @param tableId table id
+     * @param estimate filled with the estimates
+     * @return true if sections of the table_id have been seen on the PID, false otherwise
+     */
+    bool getCarouselEstimate(uint16_t pid, uint8_t tableId, CarouselEstimate& estimate) const
+    {
+        return m_carousel.getEstimate(pid, tableId, estimate);
+    }
+
+    /**
+     * Get the carousel estimates of all the PIDs and table_ids seen.
+     * Can be called from any thread.
+     *
+     * @param estimates filled with the estimates
+     */
+    void getCarouselEstimates(std::vector<CarouselEstimate>& estimates) const
+    {
+        m_carousel.getEstimates(estimates);
+    }
+
 private:
+    /**
+     * Handle an SI section
+     *
+     * @param data section data
+     * @param size data size
+     * @param pid PID the section was carried on
+     * @param now arrival time (ParserStats::now()), 0 if neither latency nor carousel statistics are enabled
+     */
+    void handleSection(uint8_t* data, uint32_t size, uint16_t pid, uint64_t now);
+
+    /**
+     * Hand a table to the SendEvent callback, release it if there is none
+     *
+     * @param tbl table
+     */
+    void publish(SiTable* tbl);
+
+    /**
+     * Check the section length and CRC_32 of a section
+     *
+     * @param data section data
+     * @param size data size
+     * @return true if the section is valid, false otherwise
+     */
+    bool isSectionValid(uint8_t* data, uint32_t size);
+
+    /**
+     * Check if a section repeats a sub-table version that is already complete.
+     * Only the section header is read.
+     *
+     * @param key sub-table key
+     * @param data section data
+     * @param size data size
+     * @return fingerprint of the sub-table if the section can be dropped, NULL otherwise
+     */
+    const SectionFingerprint* findRepeat(SubTableKey key, const uint8_t* data, uint32_t size);
+
+    /**
+     * Record the fingerprint of a completed sub-table
+     *
+     * @param key sub-table key
+     * @param data data of the section that completed the sub-table
+     * @param secList completed section list
+     * @param stats counters of the sub-table
+     */
+    void addFingerprint(SubTableKey key, const uint8_t* data, const SectionList& secList, ParserStats::SubTable* stats);
+
     /**
      * Check if tables of certain type are supported or not.
      * Note that some optional DVB tables might not be supported.
@@ -97,9 +308,64 @@ private:
     SendEventCallback m_sendEventCb;
 
     /**
-     * Map of section lists
+     * Map of section lists, one per sub-table
      */
     SectionMap_t m_sectionMap;
+
+    /**
+     * Fingerprints of the completed sub-tables
+     */
+    FingerprintMap_t m_fingerprints;
+
+    /**
+     * Per-segment EIT emission flag
+     */
+    bool m_eitSegmentMode;
+
+    /**
+     * Number of sections rejected because of a bad section length or CRC_32
+     */
+    uint64_t m_crcErrorCount;
+
+    /**
+     * Number of sections dropped because they belong to an already complete sub-table
+     */
+    uint64_t m_repeatCount;
+
+    /**
+     * Statistics
+     */
+    ParserStats m_stats;
+
+    /**
+     * Latency histograms flag
+     */
+    bool m_latencyStatsEnabled;
+
+    /**
+     * Carousel monitor
+     */
+    CarouselMonitor m_carousel;
+
+    /**
+     * Carousel monitor flag
+     */
+    bool m_carouselMonitorEnabled;
+
+    /**
+     * Time spent in the SendEvent callback by the current section, nanoseconds
+     */
+    uint64_t m_callbackTime;
+
+    /**
+     * Recorder's calling context
+     */
+    void* m_recorderContext;
+
+    /**
+     * Recorder function pointer
+     */
+    SectionRecordCallback m_recorderCb;
 };
 
 #endif
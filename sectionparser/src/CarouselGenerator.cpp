@@ -0,0 +1,359 @@
+//
+// DVB_SI for Reference Design Kit (RDK)
+//
+// Copyright (C) 2015  Dmitry Barablin & Stan Partridge (stan.partridge@arris.com)
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+#include "CarouselGenerator.h"
+
+// C system includes
+
+// C++ system includes
+#include <algorithm>
+
+// Other libraries' includes
+
+// Project's includes
+#include "SiTable.h"
+#include "CarouselMonitor.h"
+
+// Using declarations
+using std::vector;
+
+namespace
+{
+    const uint64_t NS_PER_MS = 1000000;
+    const uint64_t NS_PER_SECOND = 1000000000;
+}
+
+/**
+ * Constructor
+ */
+CarouselGenerator::CarouselGenerator()
+    : m_order(CarouselOrder::SPREAD),
+      m_bitrate(0),
+      m_time(0),
+      m_sequence(0),
+      m_started(false)
+{
+    // ETSI TS 101 211, 4.4: maximum repetition intervals
+    for(size_t id = 0; id < 256; id++)
+    {
+        m_intervals[id] = 30000;
+    }
+    m_intervals[(uint8_t)TableId::NIT] = 10000;
+    m_intervals[(uint8_t)TableId::NIT_OTHER] = 10000;
+    m_intervals[(uint8_t)TableId::BAT] = 10000;
+    m_intervals[(uint8_t)TableId::SDT] = 2000;
+    m_intervals[(uint8_t)TableId::SDT_OTHER] = 10000;
+    m_intervals[(uint8_t)TableId::EIT_PF] = 2000;
+    m_intervals[(uint8_t)TableId::EIT_PF_OTHER] = 10000;
+    m_intervals[(uint8_t)TableId::EIT_SCHED_START] = 10000;
+}
+
+/**
+ * Destructor
+ */
+CarouselGenerator::~CarouselGenerator()
+{
+}
+
+/**
+ * Add a sub-table to the carousel
+ *
+ * @param sections sections of the sub-table, copied
+ * @param pid PID to send it on, UNKNOWN_PID for the standard SI PID of its table_id
+ * @return sub-table index
+ */
+size_t CarouselGenerator::addSubTable(const SubTableSections_t& sections, uint16_t pid)
+{
+    if(pid == UNKNOWN_PID && !sections.empty() && !sections[0].empty())
+    {
+        pid = CarouselMonitor::getStandardPid(sections[0][0]);
+    }
+
+    m_subTables.push_back(SubTable());
+    SubTable& subTable = m_subTables.back();
+    subTable.sections = sections;
+    subTable.replaced = false;
+    subTable.pid = pid;
+    subTable.roundStart = m_time;
+
+    // Once running, a new sub-table starts right away
+    size_t index = m_subTables.size() - 1;
+    if(m_started)
+    {
+        schedule(index, 0);
+    }
+    return index;
+}
+
+/**
+ * Replace the sections of a sub-table (a new version). The sections in the current round are
+ * sent out, the new ones from the next round on.
+ *
+ * @param index sub-table index
+ * @param sections new sections, copied; none to take the sub-table off the carousel
+ */
+void CarouselGenerator::replaceSubTable(size_t index, const SubTableSections_t& sections)
+{
+    SubTable& subTable = m_subTables[index];
+
+    // A sub-table without sections has no round in progress
+    if(subTable.sections.empty())
+    {
+        subTable.sections = sections;
+        subTable.roundStart = m_time;
+        if(m_started)
+        {
+            schedule(index, 0);
+        }
+        return;
+    }
+
+    subTable.pending = sections;
+    subTable.replaced = true;
+}
+
+/**
+ * Get the sections of a sub-table (the pending new version if there is one)
+ *
+ * @param index sub-table index
+ * @return sections
+ */
+const SubTableSections_t& CarouselGenerator::getSubTable(size_t index) const
+{
+    const SubTable& subTable = m_subTables[index];
+    return subTable.replaced ? subTable.pending : subTable.sections;
+}
+
+/**
+ * Get the size of one round of the carousel (every section of every sub-table once)
+ *
+ * @return bytes
+ */
+uint64_t CarouselGenerator::getBytes() const
+{
+    uint64_t bytes = 0;
+    for(auto it = m_subTables.begin(), end = m_subTables.end(); it != end; ++it)
+    {
+        for(auto sec = it->sections.begin(), secEnd = it->sections.end(); sec != secEnd; ++sec)
+        {
+            bytes += sec->size();
+        }
+    }
+    return bytes;
+}
+
+/**
+ * Set the repetition interval of the sub-tables of a table_id
+ *
+ * @param tableId table id
+ * @param ms interval in milliseconds
+ */
+void CarouselGenerator::setRepetitionInterval(uint8_t tableId, uint32_t ms)
+{
+    m_intervals[tableId] = ms;
+}
+
+/**
+ * Get the repetition interval of a sub-table
+ *
+ * @param subTable sub-table
+ * @return nanoseconds
+ */
+uint64_t CarouselGenerator::getInterval(const SubTable& subTable) const
+{
+    return m_intervals[subTable.sections[0][0]] * NS_PER_MS;
+}
+
+/**
+ * Get the time a section takes on the wire
+ *
+ * @param size section size
+ * @return nanoseconds, 0 if the bitrate is unlimited
+ */
+uint64_t CarouselGenerator::getSendTime(size_t size) const
+{
+    if(!m_bitrate)
+    {
+        return 0;
+    }
+
+    // The first packet also carries the pointer_field
+    uint64_t packets = (size + 1 + TS_PAYLOAD_SIZE - 1) / TS_PAYLOAD_SIZE;
+    return packets * TS_PACKET_SIZE * 8 * NS_PER_SECOND / m_bitrate;
+}
+
+/**
+ * Queue the first round of every sub-table, staggered per table_id
+ */
+void CarouselGenerator::start()
+{
+    uint32_t count[256] = { 0 };
+    for(auto it = m_subTables.begin(), end = m_subTables.end(); it != end; ++it)
+    {
+        if(!it->sections.empty())
+        {
+            count[it->sections[0][0]]++;
+        }
+    }
+
+    uint32_t nth[256] = { 0 };
+    for(size_t i = 0; i < m_subTables.size(); i++)
+    {
+        SubTable& subTable = m_subTables[i];
+        if(subTable.sections.empty())
+        {
+            continue;
+        }
+
+        uint8_t tableId = subTable.sections[0][0];
+        subTable.roundStart = m_time + getInterval(subTable) * nth[tableId]++ / count[tableId];
+        schedule(i, 0);
+    }
+
+    m_started = true;
+}
+
+/**
+ * Queue a section of a sub-table
+ *
+ * @param index sub-table index
+ * @param section section number within the round
+ */
+void CarouselGenerator::schedule(size_t index, size_t section)
+{
+    SubTable& subTable = m_subTables[index];
+    if(subTable.sections.empty())
+    {
+        return;
+    }
+
+    // End of the round: the next one starts an interval later
+    if(section >= subTable.sections.size())
+    {
+        subTable.roundStart += getInterval(subTable);
+        section = 0;
+    }
+
+    Slot slot;
+    slot.due = subTable.roundStart;
+    if(m_order == CarouselOrder::SPREAD)
+    {
+        slot.due += getInterval(subTable) * section / subTable.sections.size();
+    }
+    slot.sequence = m_sequence++;
+    slot.subTable = index;
+    slot.section = section;
+    m_queue.push(slot);
+}
+
+/**
+ * Get the next section of the carousel
+ *
+ * @param section filled with the section
+ * @return false if the carousel is empty, true otherwise
+ */
+bool CarouselGenerator::next(CarouselSection& section)
+{
+    if(!m_started)
+    {
+        start();
+    }
+    // A new version starts with a round. The previous section handed out is not used any more.
+    // An empty one takes the sub-table off the carousel.
+    Slot slot;
+    do
+    {
+        if(m_queue.empty())
+        {
+            return false;
+        }
+
+        slot = m_queue.top();
+        m_queue.pop();
+
+        SubTable& subTable = m_subTables[slot.subTable];
+        if(slot.section == 0 && subTable.replaced)
+        {
+            subTable.sections.swap(subTable.pending);
+            subTable.pending.clear();
+            subTable.replaced = false;
+        }
+    }
+    while(m_subTables[slot.subTable].sections.empty());
+
+    const SubTable& subTable = m_subTables[slot.subTable];
+    section.data = &subTable.sections[slot.section];
+    section.pid = subTable.pid;
+    section.time = std::max(slot.due, m_time);
+    section.subTable = slot.subTable;
+
+    m_time = section.time + getSendTime(section.data->size());
+    schedule(slot.subTable, slot.section + 1);
+    return true;
+}
+
+/**
+ * Send the sections of a stretch of the carousel
+ *
+ * @param duration nanoseconds to run, starting at the time the previous call stopped
+ * @param callback called for every section
+ * @param context callback context
+ * @return number of sections sent
+ */
+uint64_t CarouselGenerator::run(uint64_t duration, CarouselSectionCallback callback, void* context)
+{
+    if(!m_started)
+    {
+        start();
+    }
+
+    uint64_t end = m_time + duration;
+    uint64_t count = 0;
+    CarouselSection section;
+    while(!m_queue.empty() && std::max(m_queue.top().due, m_time) < end && next(section))
+    {
+        callback(context, section.data->data(), section.data->size(), section.pid, section.time);
+        count++;
+    }
+
+    m_time = std::max(m_time, end);
+    return count;
+}
+
+/**
+ * Restart the carousel at time 0
+ */
+void CarouselGenerator::rewind()
+{
+    m_queue = std::priority_queue<Slot>();
+    m_time = 0;
+    m_sequence = 0;
+    m_started = false;
+
+    for(auto it = m_subTables.begin(), end = m_subTables.end(); it != end; ++it)
+    {
+        if(it->replaced)
+        {
+            it->sections.swap(it->pending);
+            it->pending.clear();
+            it->replaced = false;
+        }
+    }
+}
@@ -0,0 +1,313 @@
+//
+// DVB_SI for Reference Design Kit (RDK)
+//
+// Copyright (C) 2015  Dmitry Barablin & Stan Partridge (stan.partridge@arris.com)
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+#include "CarouselMonitor.h"
+
+// C system includes
+#include <string.h>
+
+// C++ system includes
+
+// Other libraries' includes
+
+// Project's includes
+#include "SiTable.h"
+#include "TsDemux.h"
+
+/**
+ * Constructor
+ *
+ * @param p PID
+ * @param id table id
+ */
+CarouselMonitor::Group::Group(uint16_t p, uint8_t id)
+    : pid(p),
+      tableId(id),
+      cycleId(0),
+      cycleStart(0),
+      done(0),
+      members(0),
+      repetitionEwma(0),
+      cycleEwma(0)
+{
+}
+
+/**
+ * Take a snapshot
+ *
+ * @param estimate filled with the estimates
+ */
+void CarouselMonitor::Group::load(CarouselEstimate& estimate) const
+{
+    estimate.pid = pid;
+    estimate.tableId = tableId;
+    estimate.subTables = static_cast<uint32_t>(members.load(std::memory_order_relaxed));
+    estimate.repetitionEwma = repetitionEwma.load(std::memory_order_relaxed);
+    estimate.cycleEwma = cycleEwma.load(std::memory_order_relaxed);
+    repetition.load(estimate.repetition);
+    cycle.load(estimate.cycle);
+}
+
+/**
+ * Constructor
+ */
+CarouselMonitor::SubTable::SubTable()
+    : anchorTime(0),
+      cycleId(0),
+      group(0),
+      anchor(0),
+      version(0),
+      done(false)
+{
+    memset(known, 0, sizeof(known));
+    memset(cycle, 0, sizeof(cycle));
+}
+
+/**
+ * Constructor
+ */
+CarouselMonitor::CarouselMonitor()
+    : m_subTables(256),
+      m_groupMap(16)
+{
+}
+
+/**
+ * Destructor
+ */
+CarouselMonitor::~CarouselMonitor()
+{
+}
+
+/**
+ * Get the standard SI PID of a table_id (ETSI EN 300 468, 5.1.3)
+ *
+ * @param tableId table id
+ * @return PID, UNKNOWN_PID if the table_id has no standard PID
+ */
+uint16_t CarouselMonitor::getStandardPid(uint8_t id)
+{
+    TableId tableId = static_cast<TableId>(id);
+
+    if((tableId == TableId::NIT) || (tableId == TableId::NIT_OTHER))
+    {
+        return static_cast<uint16_t>(SiPid::NIT);
+    }
+    if((tableId == TableId::SDT) || (tableId == TableId::SDT_OTHER) || (tableId == TableId::BAT))
+    {
+        return static_cast<uint16_t>(SiPid::SDT_BAT);
+    }
+    if((tableId >= TableId::EIT_PF) && (tableId <= TableId::EIT_SCHED_OTHER_END))
+    {
+        return static_cast<uint16_t>(SiPid::EIT);
+    }
+    if((tableId == TableId::TDT) || (tableId == TableId::TOT))
+    {
+        return static_cast<uint16_t>(SiPid::TDT_TOT);
+    }
+    return UNKNOWN_PID;
+}
+
+/**
+ * Update a moving average
+ *
+ * @param ewma moving average, 0 if there are no samples yet
+ * @param sample new sample
+ */
+void CarouselMonitor::updateEwma(std::atomic<uint64_t>& ewma, uint64_t sample)
+{
+    int64_t avg = static_cast<int64_t>(ewma.load(std::memory_order_relaxed));
+    if(avg == 0)
+    {
+        avg = static_cast<int64_t>(sample);
+    }
+    else
+    {
+        avg += (static_cast<int64_t>(sample) - avg) / 8;
+    }
+    ewma.store(static_cast<uint64_t>(avg), std::memory_order_relaxed);
+}
+
+/**
+ * Get the group of a PID and table_id, create it if it is new
+ *
+ * @param pid PID
+ * @param tableId table id
+ * @return group index
+ */
+uint32_t CarouselMonitor::getGroup(uint16_t pid, uint8_t tableId)
+{
+    uint32_t& index = m_groupMap[(static_cast<uint64_t>(pid) << 8) | tableId];
+    if(!index)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_groups.push_back(std::unique_ptr<Group>(new Group(pid, tableId)));
+        index = static_cast<uint32_t>(m_groups.size());
+    }
+    return index - 1;
+}
+
+/**
+ * Record the arrival of a section
+ *
+ * @param key sub-table key
+ * @param pid PID the section was carried on, UNKNOWN_PID if not known
+ * @param data section data
+ * @param size data size
+ * @param now arrival time, nanoseconds of the monotonic clock (see ParserStats::now())
+ */
+void CarouselMonitor::onSection(SubTableKey key, uint16_t pid, const uint8_t* data, uint32_t size, uint64_t now)
+{
+    // Microseconds; 0 means "not seen"
+    uint64_t time = now / 1000 + 1;
+
+    // Sections without the long header are tables of one section
+    uint8_t number = 0;
+    uint8_t version = 0;
+    if(size >= 8 && (data[1] & 0x80))
+    {
+        version = (data[5] >> 1) & 0x1f;
+        number = data[6];
+    }
+
+    if(pid == UNKNOWN_PID)
+    {
+        pid = getStandardPid(data[0]);
+    }
+
+    SubTable& st = m_subTables[key];
+    if(!st.group)
+    {
+        st.group = getGroup(pid, data[0]) + 1;
+        st.anchor = number;
+        st.version = version;
+        m_groups[st.group - 1]->members.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // m_groups only grows on this thread, no lock needed to read it here
+    Group& group = *m_groups[st.group - 1];
+
+    // A new version may have a different set of sections. If the sub-table is done for the
+    // current cycle it stays so.
+    if(st.version != version)
+    {
+        st.version = version;
+        memset(st.known, 0, sizeof(st.known));
+        memset(st.cycle, 0, sizeof(st.cycle));
+    }
+
+    // Repetition of the anchor section
+    if(number == st.anchor)
+    {
+        if(st.anchorTime)
+        {
+            uint64_t interval = time - st.anchorTime;
+            group.repetition.record(interval);
+            updateEwma(group.repetitionEwma, interval);
+        }
+        st.anchorTime = time;
+    }
+
+    // A new cycle of the group started since the sub-table was last seen
+    if(st.cycleId != group.cycleId)
+    {
+        st.cycleId = group.cycleId;
+        memset(st.cycle, 0, sizeof(st.cycle));
+        st.done = false;
+    }
+
+    uint32_t bit = 1u << (number & 0x1f);
+    st.known[number >> 5] |= bit;
+    st.cycle[number >> 5] |= bit;
+
+    if(st.done)
+    {
+        return;
+    }
+
+    for(size_t i = 0; i < 8; i++)
+    {
+        if(st.known[i] & ~st.cycle[i])
+        {
+            return;
+        }
+    }
+
+    st.done = true;
+    group.done++;
+    if(group.done < group.members.load(std::memory_order_relaxed))
+    {
+        return;
+    }
+
+    // Every sub-table of the group went round once
+    if(group.cycleId >= LEARNING_CYCLES)
+    {
+        uint64_t cycle = time - group.cycleStart;
+        group.cycle.record(cycle);
+        updateEwma(group.cycleEwma, cycle);
+    }
+
+    group.cycleId++;
+    group.cycleStart = time;
+    group.done = 0;
+}
+
+/**
+ * Get the estimates of a PID and table_id
+ *
+ * @param pid PID, UNKNOWN_PID for the standard SI PID of the table_id
+ * @param tableId table id
+ * @param estimate filled with the estimates
+ * @return true if sections of the table_id have been seen on the PID, false otherwise
+ */
+bool CarouselMonitor::getEstimate(uint16_t pid, uint8_t tableId, CarouselEstimate& estimate) const
+{
+    if(pid == UNKNOWN_PID)
+    {
+        pid = getStandardPid(tableId);
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for(auto it = m_groups.begin(), end = m_groups.end(); it != end; ++it)
+    {
+        if((*it)->pid == pid && (*it)->tableId == tableId)
+        {
+            (*it)->load(estimate);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Get the estimates of all the PIDs and table_ids seen
+ *
+ * @param estimates filled with the estimates, in the order the PID/table_id was first seen
+ */
+void CarouselMonitor::getEstimates(std::vector<CarouselEstimate>& estimates) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    estimates.resize(m_groups.size());
+    for(size_t i = 0; i < m_groups.size(); i++)
+    {
+        m_groups[i]->load(estimates[i]);
+    }
+}
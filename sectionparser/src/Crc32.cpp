@@ -0,0 +1,480 @@
+//
+// DVB_SI for Reference Design Kit (RDK)
+//
+// Copyright (C) 2015  Dmitry Barablin & Stan Partridge (stan.partridge@arris.com)
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+#include "Crc32.h"
+
+// C system includes
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <immintrin.h>
+#define CRC32_HAVE_PCLMUL
+#ifdef bit_VPCLMULQDQ
+#define CRC32_HAVE_VPCLMUL
+#endif
+#elif defined(__aarch64__)
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#include <arm_acle.h>
+#define CRC32_HAVE_ARMV8
+#endif
+
+// C++ system includes
+
+// Other libraries' includes
+
+// Project's includes
+
+namespace Crc32
+{
+
+typedef uint32_t (*UpdateFunction)(uint32_t, const uint8_t*, size_t);
+
+/**
+ * Update a CRC value using the portable slicing-by-8 kernel
+ *
+ * @param crc current CRC value
+ * @param data data
+ * @param len data length
+ * @return updated CRC value
+ */
+uint32_t updateSlicing8(uint32_t crc, const uint8_t* data, size_t len)
+{
+    const uint32_t (*t)[256] = detail::CrcTable::value;
+
+    // 8 bytes per iteration, each table folds a byte the right number of zero bytes forward
+    while(len >= 8)
+    {
+        uint32_t hi = crc ^ (((uint32_t)data[0] << 24) | ((uint32_t)data[1] << 16) | ((uint32_t)data[2] << 8) | data[3]);
+
+        crc = t[7][hi >> 24] ^ t[6][(hi >> 16) & 0xff] ^ t[5][(hi >> 8) & 0xff] ^ t[4][hi & 0xff] ^
+              t[3][data[4]] ^ t[2][data[5]] ^ t[1][data[6]] ^ t[0][data[7]];
+
+        data += 8;
+        len -= 8;
+    }
+
+    // Remaining bytes one by one
+    while(len--)
+    {
+        crc = (crc << 8) ^ t[0][(crc >> 24) ^ *data++];
+    }
+
+    return crc;
+}
+
+#ifdef CRC32_HAVE_PCLMUL
+/**
+ * Fold a 128-bit accumulator forward using the given x^(n+64)/x^n constant pair
+ */
+__attribute__((target("pclmul,ssse3")))
+static inline __m128i fold(__m128i acc, __m128i k)
+{
+    return _mm_xor_si128(_mm_clmulepi64_si128(acc, k, 0x11), _mm_clmulepi64_si128(acc, k, 0x00));
+}
+
+/**
+ * Finish a carry-less multiplication CRC: fold the four 128-bit accumulators over the rest of
+ * the message 512 bits at a time, combine them and reduce the remaining 128-bit value with the
+ * table driven kernel.
+ *
+ * @param x0 accumulator of the first 128 bits of the last 512
+ * @param x1 accumulator of the second 128 bits
+ * @param x2 accumulator of the third 128 bits
+ * @param x3 accumulator of the fourth 128 bits
+ * @param data rest of the message
+ * @param len length of the rest
+ * @return CRC value
+ */
+__attribute__((target("pclmul,ssse3")))
+static inline uint32_t finishPclmul(__m128i x0, __m128i x1, __m128i x2, __m128i x3, const uint8_t* data, size_t len)
+{
+    const __m128i bswap = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    const __m128i k128 = _mm_set_epi64x(detail::xPowMod(128 + 64), detail::xPowMod(128));
+    const __m128i k512 = _mm_set_epi64x(detail::xPowMod(512 + 64), detail::xPowMod(512));
+
+    while(len >= 64)
+    {
+        x0 = _mm_xor_si128(fold(x0, k512), _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data +  0)), bswap));
+        x1 = _mm_xor_si128(fold(x1, k512), _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 16)), bswap));
+        x2 = _mm_xor_si128(fold(x2, k512), _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 32)), bswap));
+        x3 = _mm_xor_si128(fold(x3, k512), _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 48)), bswap));
+
+        data += 64;
+        len -= 64;
+    }
+
+    // Let's combine the four accumulators
+    __m128i x = _mm_xor_si128(fold(x0, k128), x1);
+    x = _mm_xor_si128(fold(x, k128), x2);
+    x = _mm_xor_si128(fold(x, k128), x3);
+
+    while(len >= 16)
+    {
+        x = _mm_xor_si128(fold(x, k128), _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)data), bswap));
+        data += 16;
+        len -= 16;
+    }
+
+    // Final reduction: the CRC of the remaining 128 bits with a zero initial value
+    uint8_t rest[16];
+    _mm_storeu_si128((__m128i*)rest, _mm_shuffle_epi8(x, bswap));
+    uint32_t crc = updateSlicing8(0, rest, sizeof(rest));
+
+    return updateSlicing8(crc, data, len);
+}
+
+/**
+ * Update a CRC value using carry-less multiplication.
+ *
+ * The message is treated as a polynomial and folded 512 bits (4 x 128 bits) at a time;
+ * the remaining 128-bit value is then reduced with the table driven kernel.
+ *
+ * @param crc current CRC value
+ * @param data data
+ * @param len data length
+ * @return updated CRC value
+ */
+__attribute__((target("pclmul,ssse3")))
+static uint32_t updatePclmul(uint32_t crc, const uint8_t* data, size_t len)
+{
+    // Not worth it for short buffers
+    if(len < 64)
+    {
+        return updateSlicing8(crc, data, len);
+    }
+
+    // MSB first CRC: the first byte of the block is the most significant one
+    const __m128i bswap = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+
+    __m128i x0 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data +  0)), bswap);
+    __m128i x1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 16)), bswap);
+    __m128i x2 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 32)), bswap);
+    __m128i x3 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 48)), bswap);
+
+    // The current CRC value is XORed into the first 32 bits of the message
+    x0 = _mm_xor_si128(x0, _mm_set_epi32(crc, 0, 0, 0));
+
+    return finishPclmul(x0, x1, x2, x3, data + 64, len - 64);
+}
+
+/**
+ * Check if the CPU supports PCLMULQDQ (and SSSE3 for byte shuffling)
+ */
+static bool hasPclmul()
+{
+    unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+    if(!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+    {
+        return false;
+    }
+
+    return (ecx & bit_PCLMUL) && (ecx & bit_SSSE3);
+}
+#endif // CRC32_HAVE_PCLMUL
+
+#ifdef CRC32_HAVE_VPCLMUL
+/**
+ * Fold two 128-bit accumulators forward using the given x^(n+64)/x^n constant pair
+ */
+__attribute__((target("vpclmulqdq,avx2,pclmul,ssse3")))
+static inline __m256i fold(__m256i acc, __m256i k)
+{
+    return _mm256_xor_si256(_mm256_clmulepi64_epi128(acc, k, 0x11), _mm256_clmulepi64_epi128(acc, k, 0x00));
+}
+
+/**
+ * Update a CRC value using 256-bit carry-less multiplication.
+ *
+ * The PCLMUL kernel is bound by the throughput of the 128-bit multiplications; here every
+ * instruction folds two 128-bit blocks. The message is folded 1024 bits (4 x 256 bits) at a
+ * time, then the eight 128-bit accumulators are combined into the four of the PCLMUL kernel.
+ *
+ * @param crc current CRC value
+ * @param data data
+ * @param len data length
+ * @return updated CRC value
+ */
+__attribute__((target("vpclmulqdq,avx2,pclmul,ssse3")))
+static uint32_t updateVpclmul(uint32_t crc, const uint8_t* data, size_t len)
+{
+    // Two rounds at least, the PCLMUL kernel does as well below
+    if(len < 256)
+    {
+        return updatePclmul(crc, data, len);
+    }
+
+    // MSB first CRC: the first byte of each 128-bit block is the most significant one
+    const __m256i bswap = _mm256_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+                                          0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    const __m256i k1024 = _mm256_set_epi64x(detail::xPowMod(1024 + 64), detail::xPowMod(1024),
+                                            detail::xPowMod(1024 + 64), detail::xPowMod(1024));
+    const __m128i k512 = _mm_set_epi64x(detail::xPowMod(512 + 64), detail::xPowMod(512));
+
+    // Blocks 0 and 1 in y0, 2 and 3 in y1...
+    __m256i y0 = _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i*)(data +  0)), bswap);
+    __m256i y1 = _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i*)(data + 32)), bswap);
+    __m256i y2 = _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i*)(data + 64)), bswap);
+    __m256i y3 = _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i*)(data + 96)), bswap);
+
+    // The current CRC value is XORed into the first 32 bits of the message
+    y0 = _mm256_xor_si256(y0, _mm256_set_epi32(0, 0, 0, 0, crc, 0, 0, 0));
+
+    data += 128;
+    len -= 128;
+
+    while(len >= 128)
+    {
+        y0 = _mm256_xor_si256(fold(y0, k1024), _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i*)(data +  0)), bswap));
+        y1 = _mm256_xor_si256(fold(y1, k1024), _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i*)(data + 32)), bswap));
+        y2 = _mm256_xor_si256(fold(y2, k1024), _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i*)(data + 64)), bswap));
+        y3 = _mm256_xor_si256(fold(y3, k1024), _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i*)(data + 96)), bswap));
+
+        data += 128;
+        len -= 128;
+    }
+
+    // Blocks 0..3 are 512 bits ahead of blocks 4..7
+    __m128i x0 = _mm_xor_si128(fold(_mm256_castsi256_si128(y0), k512), _mm256_castsi256_si128(y2));
+    __m128i x1 = _mm_xor_si128(fold(_mm256_extracti128_si256(y0, 1), k512), _mm256_extracti128_si256(y2, 1));
+    __m128i x2 = _mm_xor_si128(fold(_mm256_castsi256_si128(y1), k512), _mm256_castsi256_si128(y3));
+    __m128i x3 = _mm_xor_si128(fold(_mm256_extracti128_si256(y1, 1), k512), _mm256_extracti128_si256(y3, 1));
+
+    return finishPclmul(x0, x1, x2, x3, data, len);
+}
+
+/**
+ * Check if the CPU and the OS support VPCLMULQDQ and AVX2
+ */
+static bool hasVpclmul()
+{
+    unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+    if(!hasPclmul() || !__get_cpuid(1, &eax, &ebx, &ecx, &edx) || !(ecx & bit_OSXSAVE))
+    {
+        return false;
+    }
+
+    // The OS has to save the YMM registers
+    unsigned int xcr0 = 0, xcr0High = 0;
+    __asm__("xgetbv" : "=a"(xcr0), "=d"(xcr0High) : "c"(0));
+    if((xcr0 & 0x6) != 0x6)
+    {
+        return false;
+    }
+
+    if(!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx))
+    {
+        return false;
+    }
+
+    return (ebx & bit_AVX2) && (ecx & bit_VPCLMULQDQ);
+}
+#endif // CRC32_HAVE_VPCLMUL
+
+#ifdef CRC32_HAVE_ARMV8
+/**
+ * Reverse the bits of a 32-bit word
+ */
+static inline uint32_t reverseBits32(uint32_t v)
+{
+    uint32_t r;
+    __asm__("rbit %w0, %w1" : "=r"(r) : "r"(v));
+    return r;
+}
+
+/**
+ * Reverse the bits of a 64-bit word
+ */
+static inline uint64_t reverseBits64(uint64_t v)
+{
+    uint64_t r;
+    __asm__("rbit %0, %1" : "=r"(r) : "r"(v));
+    return r;
+}
+
+/**
+ * Update a CRC value using the ARMv8 CRC32 instructions.
+ *
+ * The instructions implement the bit reflected variant of the same polynomial, so the
+ * CRC register and every input byte are bit reversed on the way in and out.
+ *
+ * @param crc current CRC value
+ * @param data data
+ * @param len data length
+ * @return updated CRC value
+ */
+__attribute__((target("+crc")))
+static uint32_t updateArmv8(uint32_t crc, const uint8_t* data, size_t len)
+{
+    uint32_t r = reverseBits32(crc);
+
+    while(len >= 8)
+    {
+        uint64_t w;
+        memcpy(&w, data, sizeof(w));
+
+        // Reverse the bits within each byte, keep the byte order
+        r = __crc32d(r, reverseBits64(__builtin_bswap64(w)));
+
+        data += 8;
+        len -= 8;
+    }
+
+    while(len--)
+    {
+        r = __crc32b(r, reverseBits32(*data++) >> 24);
+    }
+
+    return reverseBits32(r);
+}
+
+/**
+ * Check if the CPU supports the ARMv8 CRC32 instructions
+ */
+static bool hasArmv8Crc()
+{
+    return getauxval(AT_HWCAP) & HWCAP_CRC32;
+}
+#endif // CRC32_HAVE_ARMV8
+
+/**
+ * Select the fastest kernel available on this CPU
+ */
+static Kernel detectKernel()
+{
+#if defined(CRC32_HAVE_PCLMUL)
+#ifdef CRC32_HAVE_VPCLMUL
+    if(hasVpclmul())
+    {
+        return Kernel::VPCLMUL;
+    }
+#endif
+    if(hasPclmul())
+    {
+        return Kernel::PCLMUL;
+    }
+#elif defined(CRC32_HAVE_ARMV8)
+    if(hasArmv8Crc())
+    {
+        return Kernel::ARMV8_CRC;
+    }
+#endif
+
+    return Kernel::SLICING_BY_8;
+}
+
+/**
+ * Get the update function of a kernel
+ */
+static UpdateFunction getUpdateFunction(Kernel kernel)
+{
+    switch(kernel)
+    {
+#if defined(CRC32_HAVE_PCLMUL)
+        case Kernel::PCLMUL:
+            return updatePclmul;
+#ifdef CRC32_HAVE_VPCLMUL
+        case Kernel::VPCLMUL:
+            return updateVpclmul;
+#endif
+#elif defined(CRC32_HAVE_ARMV8)
+        case Kernel::ARMV8_CRC:
+            return updateArmv8;
+#endif
+        default:
+            return updateSlicing8;
+    }
+}
+
+/**
+ * Kernel in effect and its update function
+ */
+static Kernel s_kernel = detectKernel();
+static UpdateFunction s_update = getUpdateFunction(s_kernel);
+
+/**
+ * Update a CRC value using the fastest kernel available on this CPU
+ *
+ * @param crc current CRC value
+ * @param data data
+ * @param len data length
+ * @return updated CRC value
+ */
+uint32_t update(uint32_t crc, const uint8_t* data, size_t len)
+{
+    return s_update(crc, data, len);
+}
+
+/**
+ * Get the kernel selected for this CPU
+ *
+ * @return kernel type
+ */
+Kernel getKernel()
+{
+    return s_kernel;
+}
+
+/**
+ * Get the name of the kernel selected for this CPU
+ *
+ * @return kernel name
+ */
+const char* getKernelName()
+{
+    switch(s_kernel)
+    {
+        case Kernel::PCLMUL:
+            return "pclmul";
+        case Kernel::VPCLMUL:
+            return "vpclmul";
+        case Kernel::ARMV8_CRC:
+            return "armv8-crc";
+        default:
+            return "slicing-by-8";
+    }
+}
+
+/**
+ * Force a kernel
+ *
+ * @param kernel kernel type
+ * @return the kernel in effect
+ */
+Kernel setKernel(Kernel kernel)
+{
+    Kernel detected = detectKernel();
+
+    // Only the portable kernel and the detected one are guaranteed to work (and PCLMUL where
+    // VPCLMUL is, it is checked for as well)
+    bool supported = (kernel == detected) || (kernel == Kernel::PCLMUL && detected == Kernel::VPCLMUL);
+    if(kernel != Kernel::SLICING_BY_8 && !supported)
+    {
+        kernel = Kernel::SLICING_BY_8;
+    }
+
+    s_kernel = kernel;
+    s_update = getUpdateFunction(kernel);
+
+    return s_kernel;
+}
+
+} // namespace Crc32
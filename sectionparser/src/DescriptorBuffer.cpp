@@ -0,0 +1,79 @@
+//
+// DVB_SI for Reference Design Kit (RDK)
+//
+// Copyright (C) 2015  Dmitry Barablin & Stan Partridge (stan.partridge@arris.com)
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+#include "DescriptorBuffer.h"
+
+// C system includes
+
+// C++ system includes
+
+// Other libraries' includes
+
+// Project's includes
+
+/**
+ * Constructor
+ *
+ * @param data bytes to copy
+ * @param size number of bytes
+ */
+DescriptorBuffer::DescriptorBuffer(const uint8_t* data, size_t size)
+    : m_bytes(data, data + size)
+{
+}
+
+/**
+ * Reinitialize the buffer with room for the given number of bytes.
+ * The text cache is cleared, the allocated capacity is kept.
+ *
+ * @param size number of bytes
+ * @return first byte of the (uninitialized) buffer
+ */
+uint8_t* DescriptorBuffer::allocate(size_t size)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_textCache.clear();
+    m_bytes.resize(size);
+
+    return m_bytes.data();
+}
+
+/**
+ * Find the decoded text of a string stored in the buffer, getting it from the text pool
+ * on first use
+ *
+ * @param text first byte of the coded text (must point into the buffer)
+ * @param len length of the coded text
+ * @return decoded text, valid as long as the buffer
+ */
+const SharedText& DescriptorBuffer::findText(const uint8_t* text, size_t len)
+{
+    uint64_t key = ((uint64_t)(text - m_bytes.data()) << 16) | (len & 0xffff);
+
+    // References to the elements of an unordered_map survive later insertions
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_textCache.find(key);
+    if(it == m_textCache.end())
+    {
+        it = m_textCache.emplace(key, TextPool::getInstance().decode(text, len)).first;
+    }
+
+    return it->second;
+}
@@ -0,0 +1,108 @@
+//
+// DVB_SI for Reference Design Kit (RDK)
+//
+// Copyright (C) 2015  Dmitry Barablin & Stan Partridge (stan.partridge@arris.com)
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+#include "DescriptorList.h"
+
+// C system includes
+#include <string.h>
+
+// C++ system includes
+
+// Other libraries' includes
+
+// Project's includes
+
+/**
+ * Constructor
+ */
+DescriptorList::DescriptorList()
+{
+    memset(m_tags, 0, sizeof(m_tags));
+}
+
+/**
+ * Reserve room for descriptors
+ *
+ * @param count number of descriptors
+ */
+void DescriptorList::reserve(size_t count)
+{
+    m_descriptors.reserve(count);
+    m_next.reserve(count);
+}
+
+/**
+ * Add a descriptor at the end of the list
+ *
+ * @param desc descriptor
+ */
+void DescriptorList::push_back(const MpegDescriptor& desc)
+{
+    uint8_t tag = static_cast<uint8_t>(desc.getTag());
+    uint16_t index = (uint16_t)m_descriptors.size();
+
+    m_descriptors.push_back(desc);
+    m_next.push_back(NONE);
+
+    size_t rank = getRank(tag);
+    if(!contains(desc.getTag()))
+    {
+        m_tags[tag >> 6] |= 1ull << (tag & 63);
+        TagChain chain = { index, index };
+        m_chains.insert(m_chains.begin() + rank, chain);
+        return;
+    }
+
+    // Link the descriptor to the last one with the same tag
+    TagChain& chain = m_chains[rank];
+    m_next[chain.last] = index;
+    chain.last = index;
+}
+
+/**
+ * Add the descriptors of another list at the end of the list
+ *
+ * @param other descriptor list
+ */
+void DescriptorList::append(const DescriptorList& other)
+{
+    if(m_descriptors.empty())
+    {
+        *this = other;
+        return;
+    }
+
+    reserve(m_descriptors.size() + other.m_descriptors.size());
+    for(auto it = other.m_descriptors.begin(), end = other.m_descriptors.end(); it != end; ++it)
+    {
+        push_back(*it);
+    }
+}
+
+/**
+ * Remove all descriptors (the allocated capacity is kept)
+ */
+void DescriptorList::clear()
+{
+    m_descriptors.clear();
+    m_chains.clear();
+    m_next.clear();
+    memset(m_tags, 0, sizeof(m_tags));
+}
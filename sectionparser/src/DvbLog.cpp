@@ -0,0 +1,714 @@
+//
+// DVB_SI for Reference Design Kit (RDK)
+//
+// Copyright (C) 2015  Dmitry Barablin & Stan Partridge (stan.partridge@arris.com)
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+#include "DvbLog.h"
+
+// C system includes
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+// C++ system includes
+#include <vector>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+// Other libraries' includes
+
+// Project's includes
+#include "oswrap.h"
+
+using std::string;
+using std::vector;
+
+/**
+ * Ring buffer of one thread. Single producer (the thread), single consumer (the writer).
+ */
+struct DvbLog::Ring
+{
+    /**
+     * Constructor
+     */
+    Ring()
+        : head(0),
+          tail(0),
+          closed(false)
+    {
+    }
+
+    /**
+     * Records
+     */
+    DvbLogRecord records[RING_RECORDS];
+
+    /**
+     * Next record to fill, written by the producer only
+     */
+    std::atomic<uint32_t> head;
+
+    /**
+     * Next record to write out, written by the consumer only
+     */
+    std::atomic<uint32_t> tail;
+
+    /**
+     * Set when the thread exits, the writer deletes the ring once it is empty
+     */
+    std::atomic<bool> closed;
+};
+
+/**
+ * Ring of the calling thread, closed when the thread exits
+ */
+struct DvbLog::ThreadRing
+{
+    /**
+     * Constructor
+     */
+    ThreadRing()
+        : ring(NULL)
+    {
+    }
+
+    /**
+     * Destructor
+     */
+    ~ThreadRing()
+    {
+        if(ring)
+        {
+            ring->closed.store(true, std::memory_order_release);
+        }
+    }
+
+    /**
+     * Ring, NULL until the thread logs for the first time
+     */
+    Ring* ring;
+};
+
+/**
+ * Writer thread and the list of rings it drains
+ */
+struct DvbLog::Writer
+{
+    enum
+    {
+        IDLE_WAIT_MS = 10       //!< wait between two rounds without records
+    };
+
+    /**
+     * Constructor
+     */
+    Writer()
+        : running(true),
+          round(0),
+          reportedDrops(0)
+    {
+    }
+
+    /**
+     * Thread main loop
+     *
+     * @param log logger
+     */
+    void run(DvbLog* log);
+
+    /**
+     * Guards the ring list and the round counter
+     */
+    std::mutex mutex;
+
+    /**
+     * Signals the end of a round, or a flush request to the writer
+     */
+    std::condition_variable cond;
+
+    /**
+     * Rings of the threads that logged
+     */
+    vector<Ring*> rings;
+
+    /**
+     * Writer thread
+     */
+    std::thread thread;
+
+    /**
+     * Cleared to stop the writer
+     */
+    bool running;
+
+    /**
+     * Number of completed rounds
+     */
+    uint64_t round;
+
+    /**
+     * Dropped records already reported
+     */
+    uint64_t reportedDrops;
+};
+
+namespace
+{
+    /**
+     * Set once the logger is destroyed: late records are dropped
+     */
+    std::atomic<bool> s_destroyed(false);
+
+    /**
+     * Get the verbosity of a level
+     *
+     * @param level DVB_* level
+     * @return verbosity
+     */
+    int getVerbosity(int level)
+    {
+        return DVB_LOG_VERBOSITY(level);
+    }
+
+    /**
+     * Get the time of the monotonic clock
+     *
+     * @return nanoseconds
+     */
+    uint64_t getTimestamp()
+    {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+    }
+
+    /**
+     * Reader of the encoded arguments of a record
+     */
+    class ArgReader
+    {
+    public:
+        /**
+         * Constructor
+         *
+         * @param rec record
+         */
+        ArgReader(const DvbLogRecord& rec)
+            : m_rec(rec),
+              m_pos(0)
+        {
+        }
+
+        /**
+         * Get the type of the next argument
+         *
+         * @return argument type, 0 if there are no more arguments
+         */
+        uint8_t peek() const
+        {
+            return m_pos < m_rec.size ? m_rec.payload[m_pos] : 0;
+        }
+
+        /**
+         * Read a fixed size argument
+         *
+         * @param value 8 byte value
+         * @return argument type, 0 if there are no more arguments or the next one is a string
+         */
+        uint8_t readValue(void* value)
+        {
+            uint8_t type = peek();
+            if(type == 0 || type == DvbLogRecord::ARG_STRING)
+            {
+                return 0;
+            }
+            memcpy(value, m_rec.payload + m_pos + 1, 8);
+            m_pos += 9;
+            return type;
+        }
+
+        /**
+         * Read a string argument
+         *
+         * @param str string
+         * @return true if the next argument is a string, false otherwise
+         */
+        bool readString(string& str)
+        {
+            if(peek() != DvbLogRecord::ARG_STRING)
+            {
+                return false;
+            }
+            uint8_t len = m_rec.payload[m_pos + 1];
+            str.assign(reinterpret_cast<const char*>(m_rec.payload + m_pos + 2), len);
+            m_pos += 2 + len;
+            return true;
+        }
+
+        /**
+         * Skip the next argument
+         */
+        void skip()
+        {
+            if(peek() == DvbLogRecord::ARG_STRING)
+            {
+                m_pos += 2 + m_rec.payload[m_pos + 1];
+            }
+            else if(peek())
+            {
+                m_pos += 9;
+            }
+        }
+
+        /**
+         * Read the next argument as an integer
+         *
+         * @param value integer
+         * @return true if found, false otherwise
+         */
+        bool readInteger(uint64_t& value)
+        {
+            uint8_t type = peek();
+            if(type == DvbLogRecord::ARG_DOUBLE)
+            {
+                double d;
+                readValue(&d);
+                value = static_cast<uint64_t>(static_cast<int64_t>(d));
+                return true;
+            }
+            return readValue(&value) != 0;
+        }
+
+    private:
+        /**
+         * Record
+         */
+        const DvbLogRecord& m_rec;
+
+        /**
+         * Position of the next argument
+         */
+        size_t m_pos;
+    };
+
+    /**
+     * Append a formatted value to a string
+     *
+     * @param text string
+     * @param spec conversion specification
+     * @param ... value
+     */
+    void appendFormatted(string& text, const char* spec, ...) __attribute__((format(printf, 2, 3)));
+
+    void appendFormatted(string& text, const char* spec, ...)
+    {
+        char buf[512];
+        va_list args;
+        va_start(args, spec);
+        int len = vsnprintf(buf, sizeof(buf), spec, args);
+        va_end(args);
+
+        if(len > 0)
+        {
+            text.append(buf, std::min(static_cast<size_t>(len), sizeof(buf) - 1));
+        }
+    }
+}
+
+std::atomic<int> DvbLog::s_maxVerbosity(DvbLog::getInitialVerbosity());
+thread_local DvbLog::ThreadRing DvbLog::s_threadRing;
+
+/**
+ * Get the process wide logger
+ *
+ * @return logger
+ */
+DvbLog& DvbLog::getInstance()
+{
+    static DvbLog log;
+    return log;
+}
+
+/**
+ * Constructor
+ */
+DvbLog::DvbLog()
+    : m_writer(new Writer),
+      m_dropCount(0)
+{
+    m_writer->thread = std::thread(&Writer::run, m_writer, this);
+}
+
+/**
+ * Destructor. Writes the pending records.
+ */
+DvbLog::~DvbLog()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_writer->mutex);
+        m_writer->running = false;
+    }
+    m_writer->cond.notify_all();
+    m_writer->thread.join();
+
+    s_destroyed.store(true);
+
+    // The rings of live threads are still referenced by them and are left alone
+    for(auto it = m_writer->rings.begin(), end = m_writer->rings.end(); it != end; ++it)
+    {
+        if((*it)->closed.load(std::memory_order_acquire))
+        {
+            delete *it;
+        }
+    }
+    delete m_writer;
+}
+
+/**
+ * Get the initial verbosity (FEATURE.DVB.LOG_LEVEL)
+ *
+ * @return verbosity
+ */
+int DvbLog::getInitialVerbosity()
+{
+    const char* value = OS_GETENV("FEATURE.DVB.LOG_LEVEL");
+    if(value && *value)
+    {
+        return getVerbosity(atoi(value));
+    }
+    return getVerbosity(DVB_INFO);
+}
+
+/**
+ * Set the run time level. Messages more verbose than the level are filtered out.
+ * Levels above the compile time level (DVB_LOG_MAX_LEVEL) have no effect.
+ *
+ * @param level DVB_* level
+ */
+void DvbLog::setLevel(int level)
+{
+    s_maxVerbosity.store(getVerbosity(level), std::memory_order_relaxed);
+}
+
+/**
+ * Get a free record of the calling thread's ring
+ *
+ * @return record, NULL if the ring is full
+ */
+DvbLogRecord* DvbLog::beginRecord()
+{
+    if(s_destroyed.load(std::memory_order_relaxed))
+    {
+        return NULL;
+    }
+
+    Ring* ring = s_threadRing.ring;
+    if(!ring)
+    {
+        ring = new Ring;
+        {
+            std::lock_guard<std::mutex> lock(m_writer->mutex);
+            m_writer->rings.push_back(ring);
+        }
+        s_threadRing.ring = ring;
+    }
+
+    uint32_t head = ring->head.load(std::memory_order_relaxed);
+    if(head - ring->tail.load(std::memory_order_acquire) >= RING_RECORDS)
+    {
+        m_dropCount.fetch_add(1, std::memory_order_relaxed);
+        return NULL;
+    }
+
+    DvbLogRecord* rec = &ring->records[head & (RING_RECORDS - 1)];
+    rec->timestamp = getTimestamp();
+    return rec;
+}
+
+/**
+ * Publish the record returned by beginRecord()
+ */
+void DvbLog::commitRecord()
+{
+    Ring* ring = s_threadRing.ring;
+    ring->head.store(ring->head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+/**
+ * Wait until the records logged so far are written
+ */
+void DvbLog::flush()
+{
+    std::unique_lock<std::mutex> lock(m_writer->mutex);
+
+    // A round started after this call has seen all the records committed before it
+    uint64_t target = m_writer->round + 2;
+    m_writer->cond.notify_all();
+    while(m_writer->running && m_writer->round < target)
+    {
+        m_writer->cond.wait(lock);
+    }
+}
+
+/**
+ * Thread main loop
+ *
+ * @param log logger
+ */
+void DvbLog::Writer::run(DvbLog* log)
+{
+    vector<DvbLogRecord> batch;
+    string text;
+
+    std::unique_lock<std::mutex> lock(mutex);
+    while(true)
+    {
+        bool stop = !running;
+
+        for(auto it = rings.begin(); it != rings.end();)
+        {
+            Ring* ring = *it;
+            bool closed = ring->closed.load(std::memory_order_acquire);
+            uint32_t tail = ring->tail.load(std::memory_order_relaxed);
+            uint32_t head = ring->head.load(std::memory_order_acquire);
+
+            for(; tail != head; tail++)
+            {
+                batch.push_back(ring->records[tail & (RING_RECORDS - 1)]);
+            }
+            ring->tail.store(tail, std::memory_order_release);
+
+            if(closed)
+            {
+                delete ring;
+                it = rings.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+
+        lock.unlock();
+
+        // Records of different threads are written in time order
+        std::stable_sort(batch.begin(), batch.end(),
+                [](const DvbLogRecord& a, const DvbLogRecord& b) { return a.timestamp < b.timestamp; });
+
+        for(auto it = batch.begin(), end = batch.end(); it != end; ++it)
+        {
+            format(*it, text);
+            fprintf(stderr, "%d:%s:%s", it->level, "INBSI", text.c_str());
+        }
+
+        uint64_t drops = log->getDropCount();
+        if(drops != reportedDrops)
+        {
+            fprintf(stderr, "%d:%s:<%s> %llu log records dropped\n", DVB_WARN, "INBSI", __FUNCTION__,
+                    static_cast<unsigned long long>(drops - reportedDrops));
+            reportedDrops = drops;
+        }
+
+        bool idle = batch.empty();
+        batch.clear();
+
+        lock.lock();
+        round++;
+        cond.notify_all();
+
+        if(stop)
+        {
+            break;
+        }
+
+        if(idle)
+        {
+            cond.wait_for(lock, std::chrono::milliseconds(IDLE_WAIT_MS));
+        }
+    }
+}
+
+/**
+ * Format a record
+ *
+ * @param rec record
+ * @param text formatted message
+ */
+void DvbLog::format(const DvbLogRecord& rec, string& text)
+{
+    ArgReader args(rec);
+    const char* p = rec.format;
+    string str;
+
+    text.clear();
+
+    while(*p)
+    {
+        if(*p != '%')
+        {
+            const char* next = strchr(p, '%');
+            size_t len = next ? static_cast<size_t>(next - p) : strlen(p);
+            text.append(p, len);
+            p += len;
+            continue;
+        }
+
+        if(p[1] == '%')
+        {
+            text += '%';
+            p += 2;
+            continue;
+        }
+
+        // Conversion specification: flags, width, precision, length modifier, conversion
+        string spec("%");
+        p++;
+        while(*p && strchr("-+ #0'", *p))
+        {
+            spec += *p++;
+        }
+        for(int field = 0; field < 2; field++)
+        {
+            if(field == 1)
+            {
+                if(*p != '.')
+                {
+                    break;
+                }
+                spec += *p++;
+            }
+            if(*p == '*')
+            {
+                uint64_t value = 0;
+                args.readInteger(value);
+                char num[24];
+                snprintf(num, sizeof(num), "%d", static_cast<int>(value));
+                spec += num;
+                p++;
+            }
+            while(*p >= '0' && *p <= '9')
+            {
+                spec += *p++;
+            }
+        }
+
+        int intSize = 4;
+        while(*p && strchr("hlLqjzt", *p))
+        {
+            if(*p == 'h')
+            {
+                intSize = (intSize == 2) ? 1 : 2;
+            }
+            else if(*p != 'L')
+            {
+                intSize = 8;
+            }
+            p++;
+        }
+
+        char conv = *p;
+        if(!conv)
+        {
+            break;
+        }
+        p++;
+
+        if(!args.peek())
+        {
+            text += rec.truncated ? "<truncated>" : "<missing>";
+            continue;
+        }
+
+        uint64_t value = 0;
+        switch(conv)
+        {
+        case 'd':
+        case 'i':
+            args.readInteger(value);
+            spec += "lld";
+            appendFormatted(text, spec.c_str(),
+                    intSize == 8 ? static_cast<long long>(value) :
+                    intSize == 2 ? static_cast<long long>(static_cast<int16_t>(value)) :
+                    intSize == 1 ? static_cast<long long>(static_cast<int8_t>(value)) :
+                                   static_cast<long long>(static_cast<int32_t>(value)));
+            break;
+        case 'o':
+        case 'u':
+        case 'x':
+        case 'X':
+            args.readInteger(value);
+            spec += "ll";
+            spec += conv;
+            appendFormatted(text, spec.c_str(),
+                    intSize == 8 ? static_cast<unsigned long long>(value) :
+                    intSize == 2 ? static_cast<unsigned long long>(static_cast<uint16_t>(value)) :
+                    intSize == 1 ? static_cast<unsigned long long>(static_cast<uint8_t>(value)) :
+                                   static_cast<unsigned long long>(static_cast<uint32_t>(value)));
+            break;
+        case 'c':
+            args.readInteger(value);
+            spec += 'c';
+            appendFormatted(text, spec.c_str(), static_cast<int>(static_cast<char>(value)));
+            break;
+        case 'e':
+        case 'E':
+        case 'f':
+        case 'F':
+        case 'g':
+        case 'G':
+        case 'a':
+        case 'A':
+        {
+            double d = 0;
+            if(args.peek() == DvbLogRecord::ARG_DOUBLE)
+            {
+                args.readValue(&d);
+            }
+            else if(args.readInteger(value))
+            {
+                d = static_cast<double>(static_cast<int64_t>(value));
+            }
+            spec += conv;
+            appendFormatted(text, spec.c_str(), d);
+            break;
+        }
+        case 's':
+            if(!args.readString(str))
+            {
+                args.skip();
+                str = "<not a string>";
+            }
+            spec += 's';
+            appendFormatted(text, spec.c_str(), str.c_str());
+            break;
+        case 'p':
+            args.readInteger(value);
+            spec += 'p';
+            appendFormatted(text, spec.c_str(), reinterpret_cast<void*>(static_cast<uintptr_t>(value)));
+            break;
+        default:
+            // Unknown conversion (or %n): the argument is skipped
+            args.skip();
+            break;
+        }
+    }
+}
@@ -30,6 +30,7 @@
 // Project's includes
 #include "oswrap.h"
 #include "DvbUtils.h"
+#include "TextDecoder.h"
 
 using std::string;
 
@@ -52,28 +53,8 @@ uint16_t BcdByteToDec(uint8_t bcd)
  */
 uint16_t BcdToDec(uint16_t bcd)
 {
-    uint16_t res = 0;
-    uint16_t multiplier = 1;
-    uint16_t digit = 0;
-
-    // Decoding the binary coded decimal
     // Each decimal digit is represented by a four-bit binary value
-    while (bcd > 0)
-    {
-        // Get the digit
-        digit = bcd & 0x0F;
-
-        // Shift to the next one
-        bcd >>= 4;
-
-        // Adding the digit to the result
-        res += multiplier * digit;
-
-        // Shift the multiplier
-        multiplier *= 10;
-    }
-
-    return res;
+    return ((bcd >> 12) & 0x0F) * 1000 + ((bcd >> 8) & 0x0F) * 100 + ((bcd >> 4) & 0x0F) * 10 + (bcd & 0x0F);
 }
 
 /**
@@ -92,78 +73,30 @@ void BcdToTime(int64_t encodedTime, uint32_t& hour, uint32_t& min, uint32_t& sec
 }
 
 /**
- * Convert Modified Julian Date to date
+ * Convert a batch of MJD + BCD times to seconds since the epoch (UTC)
  *
- * @param encodedTime
- * @return time_t
+ * @param encodedTimes 40 bit MJD + BCD times
+ * @param times converted times
+ * @param count number of times
  */
-time_t MjdToDate (int64_t encodedTime)
+void MjdBcdToEpoch(const uint64_t* encodedTimes, time_t* times, size_t count)
 {
-    int32_t J, C, Y, M;
-    int32_t mjd = encodedTime >> 24;
-    uint32_t hour = 0;
-    uint32_t min = 0;
-    uint32_t sec = 0;
-
-    // Let's decode the time first
-    BcdToTime(encodedTime, hour, min, sec);
-
-    // Decoding the date
-    // Adapted from Fliegel/van Flandern ACM 11/#10 p 657 Oct 1968
-    J = mjd + 2400001 + 68569;
-    C = 4 * J / 146097;
-    J = J - (146097 * C + 3) / 4;
-    Y = 4000 * (J + 1) / 1461001;
-    J = J - 1461 * Y / 4 + 31;
-    M = 80 * J / 2447;
-    int32_t day = J - 2447 * M / 80;
-    J = M / 11;
-    int32_t month = M + 2 - (12 * J);
-    int32_t year = 100 * (C - 49) + Y + J;
-
-    // Converting to time_t
-    struct tm time = {0};
-    time.tm_mday = day;
-    time.tm_mon = month - 1;
-    time.tm_year = year - 1900;
-    time.tm_hour = hour;
-    time.tm_min = min;
-    time.tm_sec = sec;
-
-    return mktime(&time);
+    for(size_t i = 0; i < count; i++)
+    {
+        times[i] = MjdBcdToEpoch(encodedTimes[i]);
+    }
 }
 
-
 /**
- * Convert an ISO-8859-1 string to a UTF-8 string
+ * Convert Modified Julian Date to date
  *
- * @param in input
- * @param len length
- * @return string in UTF-8
+ * @param encodedTime 40 bit MJD + BCD time (UTC)
+ * @return time_t
  */
-static string Iso8859ToUtf(const unsigned char *in, size_t len)
+time_t MjdToDate (int64_t encodedTime)
 {
-    string res;
-
-    // Let's convert each character from iso8859 to UTF-8 one by one
-    for(size_t i = 0; i < len; i++)
-    {
-        // If the value is greater than 0x80 then it requires 2 bytes in UTF-8
-        // Let's figure out whether we need one byte or two for the UTF-8 representation
-        if (in[i] < 0x80)
-        {
-            res += in[i];
-        }
-        else
-        {
-            // leading byte
-            res += 0xc0 | (in[i] & 0xc0) >> 6;
-            // trailing byte
-            res += 0x80 | (in[i] & 0x3f);
-        }
-    }
-
-    return res;
+    // The MJD counts days, the date is UTC: no calendar or time zone arithmetic needed
+    return MjdBcdToEpoch((uint64_t)encodedTime);
 }
 
 /**
@@ -188,10 +121,7 @@ string DecodeText(const unsigned char *str, size_t len)
     // A.2 Selection of character table:
     // Text fields can optionally start with non-spacing, non-displayed data which specifies the alternative character
     // table to be used for the remainder of the text item.
-
-    /// @TODO: Implement as per spec.
-    // Let's assume ISO-8859-1 for the time being.
-    string res = Iso8859ToUtf(str, len);
+    string res = TextDecoder::decode(str, len);
 
     return res;
 }
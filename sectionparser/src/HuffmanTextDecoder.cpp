@@ -0,0 +1,478 @@
+//
+// DVB_SI for Reference Design Kit (RDK)
+//
+// Copyright (C) 2015  Dmitry Barablin & Stan Partridge (stan.partridge@arris.com)
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+
+#include "HuffmanTextDecoder.h"
+
+// C system includes
+#include <string.h>
+#include <stdlib.h>
+#include <endian.h>
+
+// C++ system includes
+#include <fstream>
+
+// Other libraries' includes
+
+// Project's includes
+#include "oswrap.h"
+
+// Using declarations
+using std::string;
+using std::vector;
+
+/**
+ * MSB first bit reader, zero padded past the end of the data
+ */
+class BitReader
+{
+public:
+    /**
+     * Constructor
+     *
+     * @param data data
+     * @param len data length
+     */
+    BitReader(const uint8_t* data, size_t len)
+        : m_data(data),
+          m_len(len),
+          m_buffer(0),
+          m_available(0),
+          m_bytePos(0)
+    {
+        refill();
+    }
+
+    /**
+     * Make sure at least 32 bits are buffered
+     */
+    void refill()
+    {
+        if(m_available >= 32)
+        {
+            return;
+        }
+
+        if((m_bytePos + 8) <= m_len)
+        {
+            uint64_t word;
+            memcpy(&word, m_data + m_bytePos, 8);
+            m_buffer |= be64toh(word) >> m_available;
+            m_bytePos += (63 - m_available) >> 3;
+            m_available |= 56;
+        }
+        else
+        {
+            while(m_available <= 56)
+            {
+                m_buffer |= (uint64_t)((m_bytePos < m_len) ? m_data[m_bytePos] : 0) << (56 - m_available);
+                m_bytePos++;
+                m_available += 8;
+            }
+        }
+    }
+
+    /**
+     * Get the next bits without consuming them
+     *
+     * @param bits number of bits (1..32)
+     * @return bits, right aligned
+     */
+    uint32_t peek(uint8_t bits) const
+    {
+        return (uint32_t)(m_buffer >> (64 - bits));
+    }
+
+    /**
+     * Consume bits
+     *
+     * @param bits number of bits (up to the buffered ones)
+     */
+    void skip(uint8_t bits)
+    {
+        m_buffer <<= bits;
+        m_available -= bits;
+    }
+
+    /**
+     * Read 8 bits
+     *
+     * @return byte
+     */
+    uint8_t readByte()
+    {
+        refill();
+        uint8_t byte = (uint8_t)(m_buffer >> 56);
+        skip(8);
+        return byte;
+    }
+
+    /**
+     * Check if the bits consumed run past the end of the data
+     *
+     * @return true if past the end, false otherwise
+     */
+    bool isPastEnd() const
+    {
+        return ((m_bytePos * 8) - m_available) > (m_len * 8);
+    }
+
+private:
+    const uint8_t* m_data;
+    size_t m_len;
+    uint64_t m_buffer;          //!< buffered bits, left aligned
+    uint32_t m_available;       //!< number of buffered bits
+    size_t m_bytePos;           //!< next byte to buffer
+};
+
+/**
+ * Parse a character of a code table file
+ *
+ * @param token START, STOP, ESCAPE, 0xNN or a single character
+ * @param value character
+ * @return true if successful, false otherwise
+ */
+static bool parseCharacter(const string& token, uint8_t& value)
+{
+    if((token == "START") || (token == "STOP"))
+    {
+        value = HuffmanTextDecoder::STOP;
+    }
+    else if(token == "ESCAPE")
+    {
+        value = HuffmanTextDecoder::ESCAPE;
+    }
+    else if((token.size() > 2) && (token.compare(0, 2, "0x") == 0))
+    {
+        char* end = NULL;
+        unsigned long v = strtoul(token.c_str() + 2, &end, 16);
+        if(*end || (v > 0xff))
+        {
+            return false;
+        }
+        value = (uint8_t)v;
+    }
+    else if(token.size() == 1)
+    {
+        value = (uint8_t)token[0];
+    }
+    else
+    {
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * Constructor
+ */
+HuffmanTextDecoder::HuffmanTextDecoder()
+{
+    for(int i = 0; i < 256; i++)
+    {
+        m_roots[i] = -1;
+        m_rootBits[i] = 0;
+    }
+}
+
+/**
+ * Destructor
+ */
+HuffmanTextDecoder::~HuffmanTextDecoder()
+{
+}
+
+/**
+ * Load a code table file and build the lookup tables
+ *
+ * @param path file name
+ * @return true if successful, false otherwise
+ */
+bool HuffmanTextDecoder::load(const string& path)
+{
+    std::ifstream file(path.c_str());
+    if(!file)
+    {
+        OS_LOG(DVB_ERROR, "<%s> Unable to open %s\n", __FUNCTION__, path.c_str());
+        return false;
+    }
+
+    string line;
+    size_t lineNumber = 0;
+    while(std::getline(file, line))
+    {
+        lineNumber++;
+        if(line.empty() || (line[0] == '#') || (line[0] == '\r'))
+        {
+            continue;
+        }
+
+        // <previous>:<bits>:<next>:
+        size_t first = line.find(':');
+        size_t second = (first != string::npos) ? line.find(':', first + 1) : string::npos;
+        size_t third = (second != string::npos) ? line.find(':', second + 1) : string::npos;
+
+        uint8_t context = 0;
+        uint8_t symbol = 0;
+        if((third == string::npos) ||
+           !parseCharacter(line.substr(0, first), context) ||
+           !parseCharacter(line.substr(second + 1, third - second - 1), symbol) ||
+           !addCode(context, line.substr(first + 1, second - first - 1), symbol))
+        {
+            OS_LOG(DVB_ERROR, "<%s> %s:%d: invalid code\n", __FUNCTION__, path.c_str(), (int)lineNumber);
+            return false;
+        }
+    }
+
+    return build();
+}
+
+/**
+ * Add a code. build() must be called once all the codes are added.
+ *
+ * @param context previous character (START for the first one)
+ * @param bits code bits, '0' and '1' characters
+ * @param symbol next character (or STOP, ESCAPE)
+ * @return true if successful, false if the code is not valid
+ */
+bool HuffmanTextDecoder::addCode(uint8_t context, const string& bits, uint8_t symbol)
+{
+    if(bits.empty() || (bits.size() > 32))
+    {
+        return false;
+    }
+
+    Code code = { 0, (uint8_t)bits.size(), symbol };
+    for(size_t i = 0; i < bits.size(); i++)
+    {
+        if((bits[i] != '0') && (bits[i] != '1'))
+        {
+            return false;
+        }
+        code.bits = (code.bits << 1) | (bits[i] - '0');
+    }
+
+    m_codes[context].push_back(code);
+    return true;
+}
+
+/**
+ * Build the lookup tables from the codes added
+ *
+ * @return true if successful, false if the codes are not prefix free
+ */
+bool HuffmanTextDecoder::build()
+{
+    m_entries.clear();
+
+    for(int context = 0; context < 256; context++)
+    {
+        m_roots[context] = -1;
+        m_rootBits[context] = 0;
+
+        const vector<Code>& codes = m_codes[context];
+        if(codes.empty())
+        {
+            continue;
+        }
+
+        uint8_t maxLength = 0;
+        for(auto it = codes.begin(), end = codes.end(); it != end; ++it)
+        {
+            maxLength = (it->length > maxLength) ? it->length : maxLength;
+        }
+
+        uint8_t bits = (maxLength < LOOKUP_BITS) ? maxLength : (uint8_t)LOOKUP_BITS;
+        int32_t root = buildTable(codes, 0, bits);
+        if(root < 0)
+        {
+            OS_LOG(DVB_ERROR, "<%s> The codes of context 0x%x are not prefix free\n", __FUNCTION__, context);
+            m_entries.clear();
+            memset(m_roots, 0xff, sizeof(m_roots));
+            return false;
+        }
+
+        m_roots[context] = root;
+        m_rootBits[context] = bits;
+    }
+
+    // Link the codes to the table of the next context
+    for(auto it = m_entries.begin(), end = m_entries.end(); it != end; ++it)
+    {
+        if(it->type == Entry::SYMBOL)
+        {
+            it->next = m_roots[it->symbol];
+            it->nextBits = m_rootBits[it->symbol];
+        }
+    }
+
+    OS_LOG(DVB_INFO, "<%s> %d lookup table entries\n", __FUNCTION__, (int)m_entries.size());
+    return true;
+}
+
+/**
+ * Build the lookup table of a set of codes
+ *
+ * @param codes codes
+ * @param skip number of leading bits already decoded by the parent tables
+ * @param bits index bits of the table
+ * @return offset of the table, -1 if the codes are not prefix free
+ */
+int32_t HuffmanTextDecoder::buildTable(const vector<Code>& codes, uint8_t skip, uint8_t bits)
+{
+    size_t offset = m_entries.size();
+    size_t size = (size_t)1 << bits;
+    Entry invalid = { -1, 0, 0, 0, Entry::INVALID };
+    m_entries.resize(offset + size, invalid);
+
+    // Codes longer than the table's bits, by index
+    vector<vector<Code>> longer(size);
+
+    for(auto it = codes.begin(), end = codes.end(); it != end; ++it)
+    {
+        uint8_t remaining = it->length - skip;
+        uint32_t code = it->bits & (uint32_t)(((uint64_t)1 << remaining) - 1);
+
+        if(remaining <= bits)
+        {
+            // All the indexes starting with the code
+            size_t first = (size_t)code << (bits - remaining);
+            size_t count = (size_t)1 << (bits - remaining);
+            for(size_t i = first; i < (first + count); i++)
+            {
+                if((m_entries[offset + i].type != Entry::INVALID) || !longer[i].empty())
+                {
+                    return -1;
+                }
+
+                Entry entry = { -1, 0, remaining, it->symbol, Entry::SYMBOL };
+                m_entries[offset + i] = entry;
+            }
+        }
+        else
+        {
+            size_t index = code >> (remaining - bits);
+            if(m_entries[offset + index].type != Entry::INVALID)
+            {
+                return -1;
+            }
+            longer[index].push_back(*it);
+        }
+    }
+
+    // Sub-tables
+    for(size_t i = 0; i < size; i++)
+    {
+        if(longer[i].empty())
+        {
+            continue;
+        }
+
+        uint8_t maxRemaining = 0;
+        for(auto it = longer[i].begin(), end = longer[i].end(); it != end; ++it)
+        {
+            uint8_t remaining = it->length - skip - bits;
+            maxRemaining = (remaining > maxRemaining) ? remaining : maxRemaining;
+        }
+
+        uint8_t subBits = (maxRemaining < LOOKUP_BITS) ? maxRemaining : (uint8_t)LOOKUP_BITS;
+        int32_t sub = buildTable(longer[i], skip + bits, subBits);
+        if(sub < 0)
+        {
+            return -1;
+        }
+
+        Entry entry = { sub, subBits, 0, 0, Entry::TABLE };
+        m_entries[offset + i] = entry;
+    }
+
+    return (int32_t)offset;
+}
+
+/**
+ * Expand a compressed text
+ *
+ * @param data compressed data (after the encoding_type_id)
+ * @param len compressed data length
+ * @param out expanded text, appended to
+ * @return true if successful, false otherwise
+ */
+bool HuffmanTextDecoder::decompress(const uint8_t* data, size_t len, string& out) const
+{
+    BitReader reader(data, len);
+    int32_t table = m_roots[START];
+    uint8_t bits = m_rootBits[START];
+
+    out.reserve(out.size() + len * 2);
+
+    while(table >= 0)
+    {
+        reader.refill();
+
+        const Entry& entry = m_entries[table + reader.peek(bits)];
+        if(entry.type == Entry::TABLE)
+        {
+            reader.skip(bits);
+            table = entry.next;
+            bits = entry.nextBits;
+            continue;
+        }
+
+        if(entry.type == Entry::INVALID)
+        {
+            return false;
+        }
+
+        // A code running into the padding at the end ends the text
+        reader.skip(entry.length);
+        if(reader.isPastEnd() || (entry.symbol == STOP))
+        {
+            return true;
+        }
+
+        if(entry.symbol == ESCAPE)
+        {
+            // Uncompressed characters up to the first one below 0x80
+            uint8_t c;
+            do
+            {
+                c = reader.readByte();
+                if(reader.isPastEnd() || (c == STOP))
+                {
+                    return true;
+                }
+                out += (char)c;
+            }
+            while(c & 0x80);
+
+            table = m_roots[c];
+            bits = m_rootBits[c];
+            continue;
+        }
+
+        out += (char)entry.symbol;
+        table = entry.next;
+        bits = entry.nextBits;
+    }
+
+    // No code for the context
+    return false;
+}
@@ -19,6 +19,12 @@
 
 #include "MpegDescriptor.h"
 
+// C++ system includes
+#include <memory>
+
+// Project's includes
+#include "DescriptorList.h"
+
 using std::vector;
 
 /**
@@ -28,21 +34,53 @@ using std::vector;
  * @param data descriptor data
  * @param length data length
  */
-MpegDescriptor::MpegDescriptor(DescriptorTag tag, uint8_t* data, uint8_t length): m_tag(tag)
+MpegDescriptor::MpegDescriptor(DescriptorTag tag, uint8_t* data, uint8_t length)
+    : m_buffer(std::make_shared<DescriptorBuffer>(data, length)),
+      m_tag(tag)
+{
+    m_data = DescriptorData(m_buffer->data(), length);
+}
+
+/**
+ * Set the descriptor data
+ *
+ * @param data the descriptor data
+ */
+void MpegDescriptor::setData(const vector<uint8_t>& data)
 {
-    m_data.assign(data, data+length);
+    m_buffer = std::make_shared<DescriptorBuffer>(data.data(), data.size());
+    m_data = DescriptorData(m_buffer->data(), data.size());
 }
 
 /**
- * Parse descriptors
+ * Parse descriptors. The raw data is copied once into a buffer shared by the descriptors.
  *
  * @param p pointer to the raw data
  * @param length length of the raw data
- * @return vector of descriptors
+ * @return list of descriptors
  */
-vector<MpegDescriptor> MpegDescriptor::parseDescriptors(uint8_t* p, uint16_t length)
+DescriptorList MpegDescriptor::parseDescriptors(uint8_t* p, uint16_t length)
 {
-    vector<MpegDescriptor> ret;
+    if(!p || !length)
+    {
+        return DescriptorList();
+    }
+
+    DescriptorBufferPtr buffer = std::make_shared<DescriptorBuffer>(p, length);
+    return parseDescriptors(buffer->data(), length, buffer);
+}
+
+/**
+ * Parse descriptors without copying them: the descriptors refer to the given buffer
+ *
+ * @param p pointer to the raw data (must point into the buffer)
+ * @param length length of the raw data
+ * @param buffer buffer holding the raw data
+ * @return list of descriptors
+ */
+DescriptorList MpegDescriptor::parseDescriptors(uint8_t* p, uint16_t length, const DescriptorBufferPtr& buffer)
+{
+    DescriptorList ret;
 
     // Sanity check
     if(p)
@@ -59,7 +97,7 @@ vector<MpegDescriptor> MpegDescriptor::parseDescriptors(uint8_t* p, uint16_t len
             if((len + 2) <= (end - p))
             {
                 // Let's now add the descriptor (tag + data) to the vector
-                ret.emplace_back(tag, p + 2, len);
+                ret.push_back(MpegDescriptor(tag, p + 2, len, buffer));
             }
 
             p += len + 2;
@@ -0,0 +1,267 @@
+//
+// DVB_SI for Reference Design Kit (RDK)
+//
+// Copyright (C) 2015  Dmitry Barablin & Stan Partridge (stan.partridge@arris.com)
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+#include "ParallelSectionParser.h"
+
+// C system includes
+#include <string.h>
+
+// C++ system includes
+#include <chrono>
+
+// Other libraries' includes
+
+// Project's includes
+#include "oswrap.h"
+#include "SiTablePool.h"
+#include "SubTableMap.h"
+
+// Number of empty polls before a worker goes to sleep
+static const int WORKER_SPIN_COUNT = 64;
+
+// Longest time a sleeping worker waits before it polls its queue again
+static const std::chrono::milliseconds WORKER_SLEEP_TIME(10);
+
+/**
+ * Constructor
+ *
+ * @param owner parallel section parser
+ * @param queueSize queue size (power of two)
+ */
+ParallelSectionParser::Shard::Shard(ParallelSectionParser& owner, size_t queueSize)
+    : parser(&owner, sendEvent),
+      slots(queueSize),
+      mask(queueSize - 1),
+      tail(0),
+      head(0),
+      sleeping(false)
+{
+    for(size_t i = 0; i < queueSize; i++)
+    {
+        slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * Constructor
+ *
+ * @param context SendEvent's calling context
+ * @param callback SendEvent function pointer
+ * @param shards number of worker threads, 0 for one per CPU core
+ * @param queueSize number of sections each shard can queue (rounded up to a power of two)
+ */
+ParallelSectionParser::ParallelSectionParser(void* context, SendEventCallback callback, size_t shards, size_t queueSize)
+    : m_context(context),
+      m_sendEventCb(callback),
+      m_running(true)
+{
+    if(shards == 0)
+    {
+        shards = std::thread::hardware_concurrency();
+        if(shards == 0)
+        {
+            shards = 1;
+        }
+    }
+
+    size_t size = 2;
+    while(size < queueSize)
+    {
+        size <<= 1;
+    }
+
+    for(size_t i = 0; i < shards; i++)
+    {
+        m_shards.push_back(new Shard(*this, size));
+    }
+
+    // Start the workers once all the shards are in place
+    for(auto it = m_shards.begin(), end = m_shards.end(); it != end; ++it)
+    {
+        (*it)->thread = std::thread(&ParallelSectionParser::workerThread, this, *it);
+    }
+
+    OS_LOG(DVB_INFO, "<%s> %d shards, queue size %d\n", __FUNCTION__, (int)shards, (int)size);
+}
+
+/**
+ * Destructor. The queued sections are parsed before the workers stop.
+ */
+ParallelSectionParser::~ParallelSectionParser()
+{
+    m_running.store(false);
+
+    for(auto it = m_shards.begin(), end = m_shards.end(); it != end; ++it)
+    {
+        {
+            std::lock_guard<std::mutex> lock((*it)->mutex);
+            (*it)->condition.notify_one();
+        }
+
+        (*it)->thread.join();
+        delete *it;
+    }
+}
+
+/**
+ * SectionParser's SendEvent callback: serializes the calls of the shards
+ */
+void ParallelSectionParser::sendEvent(void* context, uint32_t tableId, void* tbl, size_t size)
+{
+    ParallelSectionParser* self = static_cast<ParallelSectionParser*>(context);
+
+    if(!self->m_sendEventCb)
+    {
+        SiTablePool::getInstance().release(static_cast<SiTable*>(tbl));
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(self->m_sendEventMutex);
+    self->m_sendEventCb(self->m_context, tableId, tbl, size);
+}
+
+/**
+ * Queue an SI section for parsing.
+ * Blocks (yields) if the shard's queue is full.
+ *
+ * @param data section data
+ * @param size data size
+ */
+void ParallelSectionParser::parse(uint8_t* data, uint32_t size)
+{
+    // Sanity check
+    if(!data || size < 3 || size > MAX_SECTION_SIZE)
+    {
+        OS_LOG(DVB_ERROR, "<%s> Invalid parameter passed(%p, 0x%x)\n", __FUNCTION__, data, size);
+        return;
+    }
+
+    // All the sections of a sub-table go to the same shard
+    uint64_t h = makeSubTableKey(data, size) * 0x9e3779b97f4a7c15ull;
+    Shard& shard = *m_shards[(h >> 32) % m_shards.size()];
+
+    // Claim a slot
+    Slot* slot;
+    size_t pos = shard.tail.load(std::memory_order_relaxed);
+    while(true)
+    {
+        slot = &shard.slots[pos & shard.mask];
+        size_t seq = slot->sequence.load(std::memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+
+        if(diff == 0)
+        {
+            if(shard.tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if(diff < 0)
+        {
+            // The queue is full, let the worker catch up
+            std::this_thread::yield();
+            pos = shard.tail.load(std::memory_order_relaxed);
+        }
+        else
+        {
+            // Another producer got the slot
+            pos = shard.tail.load(std::memory_order_relaxed);
+        }
+    }
+
+    memcpy(slot->data, data, size);
+    slot->size = size;
+    slot->sequence.store(pos + 1, std::memory_order_release);
+
+    // Only a sleeping worker needs the (locking) wake up
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if(shard.sleeping.load(std::memory_order_relaxed))
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.condition.notify_one();
+    }
+}
+
+/**
+ * Wait until all the sections queued so far have been parsed
+ */
+void ParallelSectionParser::flush()
+{
+    for(auto it = m_shards.begin(), end = m_shards.end(); it != end; ++it)
+    {
+        size_t tail = (*it)->tail.load(std::memory_order_acquire);
+        while((*it)->head.load(std::memory_order_acquire) < tail)
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+/**
+ * Worker thread main loop
+ *
+ * @param shard worker shard
+ */
+void ParallelSectionParser::workerThread(Shard* shard)
+{
+    int idle = 0;
+
+    while(true)
+    {
+        size_t pos = shard->head.load(std::memory_order_relaxed);
+        Slot& slot = shard->slots[pos & shard->mask];
+
+        if(slot.sequence.load(std::memory_order_acquire) == (pos + 1))
+        {
+            shard->parser.parse(slot.data, slot.size);
+
+            // Hand the slot back to the producers
+            slot.sequence.store(pos + shard->mask + 1, std::memory_order_release);
+            shard->head.store(pos + 1, std::memory_order_release);
+            idle = 0;
+            continue;
+        }
+
+        // The queue is empty
+        if(!m_running.load())
+        {
+            break;
+        }
+
+        if(++idle < WORKER_SPIN_COUNT)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(shard->mutex);
+        shard->sleeping.store(true);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        // Let's check again, a section may have been queued before the flag was seen
+        if(slot.sequence.load(std::memory_order_acquire) != (pos + 1) && m_running.load())
+        {
+            shard->condition.wait_for(lock, WORKER_SLEEP_TIME);
+        }
+
+        shard->sleeping.store(false);
+        idle = 0;
+    }
+}
@@ -0,0 +1,256 @@
+//
+// DVB_SI for Reference Design Kit (RDK)
+//
+// Copyright (C) 2015  Dmitry Barablin & Stan Partridge (stan.partridge@arris.com)
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+#include "ParserStats.h"
+
+// C system includes
+#include <time.h>
+
+// C++ system includes
+
+// Other libraries' includes
+
+// Project's includes
+
+/**
+ * Get a percentile. The value returned is the upper bound of the bucket the percentile
+ * falls into (at most 1/8 above the true value), capped by the maximum.
+ *
+ * @param percentile percentile, 0 to 100
+ * @return value in nanoseconds, 0 if the histogram is empty
+ */
+uint64_t HistogramSnapshot::getPercentile(double percentile) const
+{
+    if(count == 0 || buckets.empty())
+    {
+        return 0;
+    }
+
+    if(percentile <= 0)
+    {
+        return min;
+    }
+
+    // Rank of the value, 1 based
+    uint64_t rank = static_cast<uint64_t>(percentile / 100.0 * count + 0.5);
+    if(rank < 1)
+    {
+        rank = 1;
+    }
+
+    uint64_t seen = 0;
+    for(size_t i = 0; i < buckets.size(); i++)
+    {
+        seen += buckets[i];
+        if(seen >= rank)
+        {
+            uint64_t value = LatencyHistogram::getBucketMax(i);
+            return value < max ? value : max;
+        }
+    }
+
+    return max;
+}
+
+/**
+ * Constructor
+ */
+LatencyHistogram::LatencyHistogram()
+    : m_count(0),
+      m_sum(0),
+      m_min(UINT64_MAX),
+      m_max(0)
+{
+    for(size_t i = 0; i < BUCKET_COUNT; i++)
+    {
+        m_buckets[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * Take a snapshot
+ *
+ * @param snapshot filled with the current values
+ */
+void LatencyHistogram::load(HistogramSnapshot& snapshot) const
+{
+    snapshot.buckets.resize(BUCKET_COUNT);
+
+    // The count is taken from the buckets so that it matches them
+    snapshot.count = 0;
+    for(size_t i = 0; i < BUCKET_COUNT; i++)
+    {
+        snapshot.buckets[i] = m_buckets[i].load(std::memory_order_relaxed);
+        snapshot.count += snapshot.buckets[i];
+    }
+
+    snapshot.sum = m_sum.load(std::memory_order_relaxed);
+    snapshot.min = snapshot.count ? m_min.load(std::memory_order_relaxed) : 0;
+    snapshot.max = m_max.load(std::memory_order_relaxed);
+}
+
+/**
+ * Get the largest value of a bucket
+ *
+ * @param bucket bucket index
+ * @return value in nanoseconds
+ */
+uint64_t LatencyHistogram::getBucketMax(size_t bucket)
+{
+    if(bucket < SUB_BUCKETS)
+    {
+        return bucket;
+    }
+
+    if(bucket >= BUCKET_COUNT - 1)
+    {
+        return UINT64_MAX;
+    }
+
+    size_t shift = bucket / SUB_BUCKETS - 1;
+    uint64_t low = static_cast<uint64_t>(SUB_BUCKETS + bucket % SUB_BUCKETS) << shift;
+    return low + (1ull << shift) - 1;
+}
+
+/**
+ * Constructor
+ */
+ParserStats::Counters::Counters()
+    : received(0),
+      rejected(0),
+      duplicates(0),
+      completed(0),
+      versionChanges(0),
+      bytes(0)
+{
+}
+
+/**
+ * Take a snapshot
+ *
+ * @param snapshot filled with the current values
+ */
+void ParserStats::Counters::load(SectionCounters& snapshot) const
+{
+    snapshot.received = received.load(std::memory_order_relaxed);
+    snapshot.rejected = rejected.load(std::memory_order_relaxed);
+    snapshot.duplicates = duplicates.load(std::memory_order_relaxed);
+    snapshot.completed = completed.load(std::memory_order_relaxed);
+    snapshot.versionChanges = versionChanges.load(std::memory_order_relaxed);
+    snapshot.bytes = bytes.load(std::memory_order_relaxed);
+}
+
+/**
+ * Constructor
+ */
+ParserStats::ParserStats()
+    : m_subTableMap(256)
+{
+    for(size_t i = 0; i < 256; i++)
+    {
+        m_sectionLatency[i].store(NULL, std::memory_order_relaxed);
+        m_buildLatency[i].store(NULL, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * Destructor
+ */
+ParserStats::~ParserStats()
+{
+    for(size_t i = 0; i < 256; i++)
+    {
+        delete m_sectionLatency[i].load(std::memory_order_relaxed);
+        delete m_buildLatency[i].load(std::memory_order_relaxed);
+    }
+}
+
+/**
+ * Get the time of the monotonic clock
+ *
+ * @return nanoseconds
+ */
+uint64_t ParserStats::now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+}
+
+/**
+ * Create the counters of a new sub-table
+ *
+ * @param key sub-table key
+ * @return sub-table counters
+ */
+ParserStats::SubTable* ParserStats::addSubTable(SubTableKey key)
+{
+    std::unique_ptr<SubTable> entry(new SubTable(key));
+    SubTable* ret = entry.get();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_subTables.push_back(std::move(entry));
+    return ret;
+}
+
+/**
+ * Take a snapshot
+ *
+ * @param snapshot filled with the current statistics
+ */
+void ParserStats::getSnapshot(ParserStatsSnapshot& snapshot) const
+{
+    snapshot.tables.clear();
+    for(size_t i = 0; i < 256; i++)
+    {
+        if(m_tables[i].received.load(std::memory_order_relaxed) == 0)
+        {
+            continue;
+        }
+
+        snapshot.tables.push_back(TableIdStats());
+        TableIdStats& stats = snapshot.tables.back();
+        stats.tableId = static_cast<uint8_t>(i);
+        m_tables[i].load(stats.counters);
+
+        const LatencyHistogram* h = m_sectionLatency[i].load(std::memory_order_acquire);
+        if(h)
+        {
+            h->load(stats.sectionLatency);
+        }
+
+        h = m_buildLatency[i].load(std::memory_order_acquire);
+        if(h)
+        {
+            h->load(stats.buildLatency);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    snapshot.subTables.resize(m_subTables.size());
+    for(size_t i = 0; i < m_subTables.size(); i++)
+    {
+        const SubTable& entry = *m_subTables[i];
+        SubTableStats& stats = snapshot.subTables[i];
+        stats.key = entry.key;
+        stats.version = entry.version.load(std::memory_order_relaxed);
+        entry.counters.load(stats.counters);
+    }
+}
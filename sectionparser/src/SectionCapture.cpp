@@ -0,0 +1,540 @@
+//
+// DVB_SI for Reference Design Kit (RDK)
+//
+// Copyright (C) 2015  Dmitry Barablin & Stan Partridge (stan.partridge@arris.com)
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+#include "SectionCapture.h"
+
+// C system includes
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+
+// C++ system includes
+#include <algorithm>
+#include <chrono>
+
+// Other libraries' includes
+
+// Project's includes
+#include "sectionparser.h"
+#include "ParserStats.h"
+#include "oswrap.h"
+
+using std::string;
+
+namespace
+{
+    const char CAPTURE_MAGIC[8] = { 'D', 'V', 'B', 'S', 'I', 'C', 'A', 'P' };
+    const uint16_t CAPTURE_VERSION = 1;
+    const size_t CAPTURE_HEADER_SIZE = 20;
+
+    /**
+     * Largest private section (EIT included)
+     */
+    const uint32_t MAX_SECTION_SIZE = 4096;
+
+    /**
+     * Tuner, PID and section size of a record
+     */
+    const size_t RECORD_HEADER_SIZE = 5;
+
+    /**
+     * Longest LEB128 coding of a 64 bit number
+     */
+    const size_t MAX_VARINT_SIZE = 10;
+
+    const size_t READ_BUFFER_SIZE = 1024 * 1024;
+    const uint64_t NS_PER_SECOND = 1000000000;
+
+    /**
+     * Append a big endian number
+     *
+     * @param buffer buffer
+     * @param value number
+     * @param bytes size of the number
+     */
+    void appendNumber(std::vector<uint8_t>& buffer, uint64_t value, size_t bytes)
+    {
+        while(bytes--)
+        {
+            buffer.push_back(static_cast<uint8_t>(value >> (bytes * 8)));
+        }
+    }
+
+    /**
+     * Read a big endian number
+     *
+     * @param p data
+     * @param bytes size of the number
+     * @return number
+     */
+    uint64_t getNumber(const uint8_t* p, size_t bytes)
+    {
+        uint64_t value = 0;
+        while(bytes--)
+        {
+            value = (value << 8) | *p++;
+        }
+        return value;
+    }
+
+    /**
+     * Sleep until a CLOCK_MONOTONIC time
+     *
+     * @param time nanoseconds (ParserStats::now())
+     */
+    void sleepUntil(uint64_t time)
+    {
+        struct timespec ts;
+        ts.tv_sec = time / NS_PER_SECOND;
+        ts.tv_nsec = time % NS_PER_SECOND;
+        while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+        {
+        }
+    }
+}
+
+/**
+ * Constructor
+ */
+CaptureWriter::CaptureWriter()
+    : m_file(NULL),
+      m_running(false),
+      m_start(0),
+      m_lastTime(0),
+      m_recordCount(0),
+      m_dropCount(0)
+{
+}
+
+/**
+ * Destructor. Closes the capture.
+ */
+CaptureWriter::~CaptureWriter()
+{
+    close();
+}
+
+/**
+ * Create a capture file and start the capture
+ *
+ * @param filename file name, truncated if it exists
+ * @return false if the file could not be created, true otherwise
+ */
+bool CaptureWriter::open(const string& filename)
+{
+    close();
+
+    FILE* file = fopen(filename.c_str(), "wb");
+    if(!file)
+    {
+        OS_LOG(DVB_ERROR, "<%s> cannot create %s: %s\n", __FUNCTION__, filename.c_str(), strerror(errno));
+        return false;
+    }
+
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_file = file;
+    m_buffer.resize(sizeof(CAPTURE_MAGIC));
+    memcpy(m_buffer.data(), CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC));
+    appendNumber(m_buffer, CAPTURE_VERSION, 2);
+    appendNumber(m_buffer, 0, 2);
+    appendNumber(m_buffer, static_cast<uint64_t>(ts.tv_sec) * NS_PER_SECOND + ts.tv_nsec, 8);
+
+    m_start = ParserStats::now();
+    m_lastTime = m_start;
+    m_recordCount = 0;
+    m_dropCount = 0;
+    m_running = true;
+    m_thread = std::thread(&CaptureWriter::writerThread, this);
+
+    OS_LOG(DVB_INFO, "<%s> capturing sections to %s\n", __FUNCTION__, filename.c_str());
+    return true;
+}
+
+/**
+ * Write out the buffered sections and close the capture
+ */
+void CaptureWriter::close()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if(!m_running)
+        {
+            return;
+        }
+        m_running = false;
+    }
+    m_condition.notify_one();
+    m_thread.join();
+
+    fclose(m_file);
+    m_file = NULL;
+
+    OS_LOG(DVB_INFO, "<%s> %llu sections captured, %llu dropped\n", __FUNCTION__,
+           (unsigned long long)m_recordCount, (unsigned long long)m_dropCount);
+}
+
+/**
+ * Record a section. Ignored if no capture is open.
+ *
+ * @param data section data
+ * @param size section size
+ * @param tuner source tuner
+ * @param pid PID the section was carried on
+ * @param time arrival time (ParserStats::now())
+ */
+void CaptureWriter::write(const uint8_t* data, uint32_t size, uint8_t tuner, uint16_t pid, uint64_t time)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if(!m_running)
+    {
+        return;
+    }
+
+    size_t recordSize = MAX_VARINT_SIZE + RECORD_HEADER_SIZE + size;
+    if(!data || size == 0 || size > MAX_SECTION_SIZE || m_buffer.size() + recordSize > MAX_BUFFER_SIZE)
+    {
+        m_dropCount++;
+        return;
+    }
+
+    // Zigzag: small negative differences stay short
+    time = std::max(time, m_start);
+    int64_t delta = static_cast<int64_t>(time - m_lastTime);
+    uint64_t zigzag = (static_cast<uint64_t>(delta) << 1) ^ static_cast<uint64_t>(delta >> 63);
+    m_lastTime = time;
+
+    size_t before = m_buffer.size();
+    do
+    {
+        uint8_t byte = zigzag & 0x7f;
+        zigzag >>= 7;
+        m_buffer.push_back(zigzag ? (byte | 0x80) : byte);
+    }
+    while(zigzag);
+
+    m_buffer.push_back(tuner);
+    appendNumber(m_buffer, pid, 2);
+    appendNumber(m_buffer, size, 2);
+    m_buffer.insert(m_buffer.end(), data, data + size);
+    m_recordCount++;
+
+    if(before < FLUSH_SIZE && m_buffer.size() >= FLUSH_SIZE)
+    {
+        m_condition.notify_one();
+    }
+}
+
+/**
+ * Get the number of sections recorded
+ *
+ * @return count
+ */
+uint64_t CaptureWriter::getRecordCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_recordCount;
+}
+
+/**
+ * Get the number of sections dropped because the file could not be written fast enough
+ *
+ * @return count
+ */
+uint64_t CaptureWriter::getDropCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_dropCount;
+}
+
+/**
+ * Recorder callback (see SectionParser::setRecorder()): records a section of the tuner of a
+ * CaptureSource
+ *
+ * @param context CaptureSource
+ * @param data section data
+ * @param size section size
+ * @param pid PID the section was carried on
+ * @param time arrival time
+ */
+void CaptureWriter::record(void* context, const uint8_t* data, uint32_t size, uint16_t pid, uint64_t time)
+{
+    CaptureSource* source = static_cast<CaptureSource*>(context);
+    source->writer->write(data, size, source->tuner, pid, time);
+}
+
+/**
+ * Writes the buffer out until the capture is closed
+ */
+void CaptureWriter::writerThread()
+{
+    std::vector<uint8_t> pending;
+    bool failed = false;
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while(true)
+    {
+        // Written out at least once a second: little is lost if the process dies
+        m_condition.wait_for(lock, std::chrono::seconds(1),
+                [this] { return !m_running || m_buffer.size() >= FLUSH_SIZE; });
+
+        bool stop = !m_running;
+        pending.swap(m_buffer);
+        lock.unlock();
+
+        if(!pending.empty() && !failed)
+        {
+            if(fwrite(pending.data(), 1, pending.size(), m_file) != pending.size() || fflush(m_file) != 0)
+            {
+                OS_LOG(DVB_ERROR, "<%s> capture write failed: %s\n", __FUNCTION__, strerror(errno));
+                failed = true;
+            }
+        }
+        pending.clear();
+
+        lock.lock();
+        if(stop)
+        {
+            break;
+        }
+    }
+}
+
+/**
+ * Constructor
+ */
+CaptureReader::CaptureReader()
+    : m_file(NULL),
+      m_startTime(0),
+      m_time(0),
+      m_damaged(false)
+{
+}
+
+/**
+ * Destructor
+ */
+CaptureReader::~CaptureReader()
+{
+    close();
+}
+
+/**
+ * Open a capture file and check its header
+ *
+ * @param filename file name
+ * @return false if the file could not be opened or is not a capture, true otherwise
+ */
+bool CaptureReader::open(const string& filename)
+{
+    close();
+
+    m_file = fopen(filename.c_str(), "rb");
+    if(!m_file)
+    {
+        OS_LOG(DVB_ERROR, "<%s> cannot open %s: %s\n", __FUNCTION__, filename.c_str(), strerror(errno));
+        return false;
+    }
+    setvbuf(m_file, NULL, _IOFBF, READ_BUFFER_SIZE);
+
+    uint8_t header[CAPTURE_HEADER_SIZE];
+    if(fread(header, 1, sizeof(header), m_file) != sizeof(header) ||
+       memcmp(header, CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC)) != 0 ||
+       getNumber(header + 8, 2) != CAPTURE_VERSION)
+    {
+        OS_LOG(DVB_ERROR, "<%s> %s is not a section capture\n", __FUNCTION__, filename.c_str());
+        close();
+        return false;
+    }
+
+    m_startTime = getNumber(header + 12, 8);
+    m_time = 0;
+    m_damaged = false;
+    return true;
+}
+
+/**
+ * Close the capture
+ */
+void CaptureReader::close()
+{
+    if(m_file)
+    {
+        fclose(m_file);
+        m_file = NULL;
+    }
+}
+
+/**
+ * Read the next record
+ *
+ * @param record filled with the record
+ * @return false at the end of the capture or if the rest of it is damaged, true otherwise
+ */
+bool CaptureReader::next(CaptureRecord& record)
+{
+    if(!m_file || m_damaged)
+    {
+        return false;
+    }
+
+    uint64_t zigzag = 0;
+    size_t length = 0;
+    int c;
+    do
+    {
+        c = getc_unlocked(m_file);
+        if(c == EOF || length == MAX_VARINT_SIZE)
+        {
+            // The end of the capture is between two records
+            m_damaged = (length != 0);
+            break;
+        }
+        zigzag |= static_cast<uint64_t>(c & 0x7f) << (7 * length++);
+    }
+    while(c & 0x80);
+
+    uint8_t header[RECORD_HEADER_SIZE];
+    uint32_t size = 0;
+    if(c != EOF && !m_damaged)
+    {
+        size = (fread(header, 1, sizeof(header), m_file) == sizeof(header)) ? getNumber(header + 3, 2) : 0;
+        record.data.resize(size);
+        m_damaged = (size < 3 || size > MAX_SECTION_SIZE || fread(record.data.data(), 1, size, m_file) != size);
+    }
+
+    if(m_damaged)
+    {
+        OS_LOG(DVB_WARN, "<%s> damaged record at offset %ld, end of the capture\n", __FUNCTION__, ftell(m_file));
+    }
+    if(c == EOF || m_damaged)
+    {
+        return false;
+    }
+
+    int64_t delta = static_cast<int64_t>(zigzag >> 1) ^ -static_cast<int64_t>(zigzag & 1);
+    m_time += delta;
+    record.time = m_time;
+    record.tuner = header[0];
+    record.pid = getNumber(header + 1, 2);
+    return true;
+}
+
+/**
+ * Constructor: original timing, all tuners
+ */
+CaptureReplayer::CaptureReplayer()
+    : m_speed(1),
+      m_tuner(ALL_TUNERS)
+{
+}
+
+/**
+ * Replay a capture
+ *
+ * @param filename capture file
+ * @param callback called for every section
+ * @param context callback context
+ * @param stats filled with the replay statistics
+ * @return false if the capture could not be opened or is damaged (the sections before the
+ *         damage are replayed), true otherwise
+ */
+bool CaptureReplayer::replay(const string& filename, CaptureReplayCallback callback, void* context, ReplayStats& stats)
+{
+    memset(&stats, 0, sizeof(stats));
+
+    CaptureReader reader;
+    if(!reader.open(filename))
+    {
+        return false;
+    }
+
+    CaptureRecord record;
+    uint64_t first = 0;
+    uint64_t last = 0;
+    uint64_t start = ParserStats::now();
+    while(reader.next(record))
+    {
+        if(m_tuner != ALL_TUNERS && record.tuner != m_tuner)
+        {
+            continue;
+        }
+
+        if(stats.sections == 0)
+        {
+            first = record.time;
+        }
+        last = std::max(last, record.time);
+
+        if(m_speed > 0)
+        {
+            uint64_t due = start;
+            if(record.time > first)
+            {
+                due += static_cast<uint64_t>((record.time - first) / m_speed);
+            }
+
+            uint64_t now = ParserStats::now();
+            if(now < due)
+            {
+                sleepUntil(due);
+                now = ParserStats::now();
+            }
+
+            uint64_t lag = (now > due) ? now - due : 0;
+            stats.maxLag = std::max(stats.maxLag, lag);
+            stats.totalLag += lag;
+        }
+
+        callback(context, record);
+        stats.sections++;
+        stats.bytes += record.data.size();
+    }
+
+    stats.captureTime = (stats.sections > 0) ? last - first : 0;
+    stats.wallTime = ParserStats::now() - start;
+    return !reader.isDamaged();
+}
+
+/**
+ * Replay a capture into a parser
+ *
+ * @param filename capture file
+ * @param parser parser
+ * @param stats filled with the replay statistics
+ * @return false if the capture could not be opened or is damaged, true otherwise
+ */
+bool CaptureReplayer::replay(const string& filename, SectionParser& parser, ReplayStats& stats)
+{
+    return replay(filename, parseSection, &parser, stats);
+}
+
+/**
+ * Hands a section to a SectionParser
+ *
+ * @param context parser
+ * @param record section
+ */
+void CaptureReplayer::parseSection(void* context, CaptureRecord& record)
+{
+    static_cast<SectionParser*>(context)->parse(record.data.data(), record.data.size(), record.pid);
+}
@@ -0,0 +1,652 @@
+//
+// DVB_SI for Reference Design Kit (RDK)
+//
+// Copyright (C) 2015  Dmitry Barablin & Stan Partridge (stan.partridge@arris.com)
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+#include "SectionEncoder.h"
+
+// C system includes
+
+// C++ system includes
+#include <algorithm>
+
+// Other libraries' includes
+
+// Project's includes
+#include "oswrap.h"
+
+#include "NitTable.h"
+#include "BatTable.h"
+#include "SdtTable.h"
+#include "EitTable.h"
+#include "TotTable.h"
+#include "Crc32.h"
+#include "SiLayouts.h"
+
+// Using declarations
+using std::vector;
+
+using namespace SiLayout;
+
+namespace
+{
+    enum
+    {
+        CRC_SIZE = CRC_32_SIZE,
+        MAX_LOOP_LENGTH = 0xfff,
+        MAX_SECTIONS = 256
+    };
+
+    /**
+     * Append a structure to a section, all bits (reserved ones included) set to 1
+     *
+     * @param section section
+     * @return offset of the structure in the section
+     */
+    template<typename Layout>
+    size_t append(SectionData_t& section)
+    {
+        size_t offset = section.size();
+        section.resize(offset + Layout::SIZE, 0xff);
+        return offset;
+    }
+
+    /**
+     * Start a section with the long header
+     *
+     * @param section section, cleared
+     * @param table table the header fields are taken from
+     */
+    void beginSection(SectionData_t& section, const SiTable& table)
+    {
+        section.clear();
+        append<SyntaxSectionHeader>(section);
+
+        uint8_t* p = section.data();
+        SectionHeader::TableId::set(p, (uint8_t)table.getTableId());
+        SectionHeader::SectionSyntaxIndicator::set(p, true);
+        SyntaxSectionHeader::TableIdExtension::set(p, table.getExtensionId());
+        SyntaxSectionHeader::VersionNumber::set(p, table.getVersion());
+        SyntaxSectionHeader::CurrentNextIndicator::set(p, table.isCurrent());
+    }
+
+    /**
+     * Get the encoded size of a descriptor loop
+     *
+     * @param descriptors descriptors
+     * @return size
+     */
+    size_t getSize(const DescriptorList& descriptors)
+    {
+        size_t size = 0;
+        for(auto it = descriptors.begin(), end = descriptors.end(); it != end; ++it)
+        {
+            size += 2 + it->getData().size();
+        }
+        return size;
+    }
+
+    /**
+     * Append a descriptor
+     *
+     * @param section section
+     * @param descriptor descriptor
+     */
+    void appendDescriptor(SectionData_t& section, const MpegDescriptor& descriptor)
+    {
+        const DescriptorData& data = descriptor.getData();
+        section.push_back((uint8_t)descriptor.getTag());
+        section.push_back((uint8_t)data.size());
+        section.insert(section.end(), data.begin(), data.end());
+    }
+
+    /**
+     * Append a descriptor loop
+     *
+     * @param section section
+     * @param descriptors descriptors
+     */
+    void appendDescriptors(SectionData_t& section, const DescriptorList& descriptors)
+    {
+        for(auto it = descriptors.begin(), end = descriptors.end(); it != end; ++it)
+        {
+            appendDescriptor(section, *it);
+        }
+    }
+
+    /**
+     * Set a loop length
+     *
+     * @param section section
+     * @param offset offset of the loop length field
+     */
+    void setLoopLength(SectionData_t& section, size_t offset)
+    {
+        LoopLength::Length::set(&section[offset], section.size() - offset - LoopLength::SIZE);
+    }
+
+    /**
+     * Append a NIT/BAT transport stream loop entry
+     *
+     * @param section section
+     * @param ts transport stream
+     */
+    void appendEntry(SectionData_t& section, const TransportStream& ts)
+    {
+        size_t offset = append<TransportStreamEntry>(section);
+        appendDescriptors(section, ts.getTsDescriptors());
+
+        uint8_t* p = &section[offset];
+        TransportStreamEntry::TransportStreamId::set(p, ts.getTsId());
+        TransportStreamEntry::OriginalNetworkId::set(p, ts.getOriginalNetworkId());
+        TransportStreamEntry::DescriptorsLength::set(p, section.size() - offset - TransportStreamEntry::SIZE);
+    }
+
+    /**
+     * Append an SDT service loop entry
+     *
+     * @param section section
+     * @param service service
+     */
+    void appendEntry(SectionData_t& section, const DvbService& service)
+    {
+        size_t offset = append<SdtServiceEntry>(section);
+        appendDescriptors(section, service.getServiceDescriptors());
+
+        uint8_t* p = &section[offset];
+        SdtServiceEntry::ServiceId::set(p, service.getServiceId());
+        SdtServiceEntry::EitScheduleFlag::set(p, service.isEitSchedFlagSet());
+        SdtServiceEntry::EitPresentFollowingFlag::set(p, service.isEitPfFlagSet());
+        SdtServiceEntry::RunningStatus::set(p, service.getRunningStatus());
+        SdtServiceEntry::FreeCaMode::set(p, service.isScrambled());
+        SdtServiceEntry::DescriptorsLength::set(p, section.size() - offset - SdtServiceEntry::SIZE);
+    }
+
+    /**
+     * Append an EIT event loop entry
+     *
+     * @param section section
+     * @param event event
+     */
+    void appendEntry(SectionData_t& section, const DvbEvent& event)
+    {
+        size_t offset = append<EitEventEntry>(section);
+        appendDescriptors(section, event.getEventDescriptors());
+
+        uint8_t* p = &section[offset];
+        EitEventEntry::EventId::set(p, event.getEventId());
+        EitEventEntry::StartTime::set(p, event.getStartTimeBcd());
+        EitEventEntry::Duration::set(p, event.getDurationBcd());
+        EitEventEntry::RunningStatus::set(p, event.getRunningStatus());
+        EitEventEntry::FreeCaMode::set(p, event.isScrambled());
+        EitEventEntry::DescriptorsLength::set(p, section.size() - offset - EitEventEntry::SIZE);
+    }
+
+    /**
+     * Get the encoded size of a loop entry, 0 if its descriptor loop is too long
+     */
+    size_t getSize(const TransportStream& ts)
+    {
+        size_t size = getSize(ts.getTsDescriptors());
+        return (size <= MAX_LOOP_LENGTH) ? TransportStreamEntry::SIZE + size : 0;
+    }
+
+    size_t getSize(const DvbService& service)
+    {
+        size_t size = getSize(service.getServiceDescriptors());
+        return (size <= MAX_LOOP_LENGTH) ? SdtServiceEntry::SIZE + size : 0;
+    }
+
+    size_t getSize(const DvbEvent& event)
+    {
+        size_t size = getSize(event.getEventDescriptors());
+        return (size <= MAX_LOOP_LENGTH) ? EitEventEntry::SIZE + size : 0;
+    }
+
+    /**
+     * Fill a section with loop entries, as many as fit
+     *
+     * @param section section
+     * @param maxSize size limit of the section
+     * @param entries entries
+     * @param next [in/out] first entry to add
+     * @return true if an entry was added or there are no more entries, false otherwise
+     */
+    template<typename E>
+    bool fill(SectionData_t& section, size_t maxSize, const E& entries, size_t& next)
+    {
+        size_t first = next;
+        while(next < entries.size())
+        {
+            size_t size = getSize(*entries[next]);
+            if(size == 0 || section.size() + size + CRC_SIZE > maxSize)
+            {
+                break;
+            }
+            appendEntry(section, *entries[next]);
+            next++;
+        }
+        return (next > first) || (next == entries.size());
+    }
+
+    /**
+     * Number the sections of a sub-table and finish them
+     *
+     * @param sections sections without CRC_32
+     */
+    void finishSubTable(SubTableSections_t& sections)
+    {
+        for(size_t n = 0; n < sections.size(); n++)
+        {
+            SyntaxSectionHeader::SectionNumber::set(sections[n].data(), n);
+            SyntaxSectionHeader::LastSectionNumber::set(sections[n].data(), sections.size() - 1);
+            SectionEncoder::finishSection(sections[n]);
+        }
+    }
+
+    /**
+     * Pointers to the elements of a vector (the loops are filled from element pointers so that
+     * EIT segments can be encoded from a selection of the events)
+     */
+    template<typename T>
+    vector<const T*> getPointers(const vector<T>& v)
+    {
+        vector<const T*> pointers;
+        pointers.reserve(v.size());
+        for(auto it = v.begin(), end = v.end(); it != end; ++it)
+        {
+            pointers.push_back(&*it);
+        }
+        return pointers;
+    }
+}
+
+/**
+ * Constructor
+ */
+SectionEncoder::SectionEncoder()
+    : m_scheduleStart(0),
+      m_maxSectionSize(MAX_SECTION_SIZE),
+      m_maxEitSectionSize(MAX_EIT_SECTION_SIZE)
+{
+}
+
+/**
+ * Set the size limit of the sections. Smaller sections make more sections per sub-table.
+ *
+ * @param size size limit of all tables but EIT (at most MAX_SECTION_SIZE)
+ * @param eitSize size limit of EIT (at most MAX_EIT_SECTION_SIZE)
+ */
+void SectionEncoder::setMaxSectionSize(size_t size, size_t eitSize)
+{
+    m_maxSectionSize = std::min<size_t>(size, MAX_SECTION_SIZE);
+    m_maxEitSectionSize = std::min<size_t>(eitSize, MAX_EIT_SECTION_SIZE);
+}
+
+/**
+ * Encode a table, dispatching on its table_id
+ *
+ * @param table NIT, BAT, SDT, EIT or TDT/TOT
+ * @param sections filled with the sections of the sub-table
+ * @return true on success, false if the table_id is not supported or the table does not fit
+ *         in 256 sections (8 per EIT segment)
+ */
+bool SectionEncoder::encode(const SiTable& table, SubTableSections_t& sections) const
+{
+    TableId tableId = table.getTableId();
+
+    if((tableId == TableId::NIT) || (tableId == TableId::NIT_OTHER))
+    {
+        return encode(static_cast<const NitTable&>(table), sections);
+    }
+    if(tableId == TableId::BAT)
+    {
+        return encode(static_cast<const BatTable&>(table), sections);
+    }
+    if((tableId == TableId::SDT) || (tableId == TableId::SDT_OTHER))
+    {
+        return encode(static_cast<const SdtTable&>(table), sections);
+    }
+    if((tableId >= TableId::EIT_PF) && (tableId <= TableId::EIT_SCHED_OTHER_END))
+    {
+        return encode(static_cast<const EitTable&>(table), sections);
+    }
+    if((tableId == TableId::TDT) || (tableId == TableId::TOT))
+    {
+        return encode(static_cast<const TotTable&>(table), sections);
+    }
+
+    OS_LOG(DVB_ERROR, "<%s> table id 0x%x is not supported\n", __FUNCTION__, (uint8_t)tableId);
+    sections.clear();
+    return false;
+}
+
+/**
+ * Encode a NIT
+ *
+ * @param nit table
+ * @param sections filled with the sections of the sub-table
+ * @return true on success, false if the table does not fit
+ */
+bool SectionEncoder::encode(const NitTable& nit, SubTableSections_t& sections) const
+{
+    return encodeNetwork(nit, nit.getNetworkDescriptors(), nit.getTransportStreams(), sections);
+}
+
+/**
+ * Encode a BAT
+ *
+ * @param bat table
+ * @param sections filled with the sections of the sub-table
+ * @return true on success, false if the table does not fit
+ */
+bool SectionEncoder::encode(const BatTable& bat, SubTableSections_t& sections) const
+{
+    return encodeNetwork(bat, bat.getBouquetDescriptors(), bat.getTransportStreams(), sections);
+}
+
+/**
+ * Encode a NIT or BAT (same structure)
+ *
+ * @param table table
+ * @param descriptors network or bouquet descriptors
+ * @param transports transport stream loop
+ * @param sections filled with the sections
+ * @return true on success, false if the table does not fit
+ */
+template<typename T>
+bool SectionEncoder::encodeNetwork(const SiTable& table, const DescriptorList& descriptors, const T& transports,
+        SubTableSections_t& sections) const
+{
+    sections.clear();
+
+    vector<const TransportStream*> entries = getPointers(transports);
+    auto desc = descriptors.begin();
+    size_t next = 0;
+
+    // The first loop is split over as many sections as needed, the transport streams follow
+    do
+    {
+        sections.push_back(SectionData_t());
+        SectionData_t& section = sections.back();
+        beginSection(section, table);
+
+        size_t offset = append<LoopLength>(section);
+        size_t empty = section.size();
+        while(desc != descriptors.end() &&
+              section.size() + 2 + desc->getData().size() + LoopLength::SIZE + CRC_SIZE <= m_maxSectionSize)
+        {
+            appendDescriptor(section, *desc);
+            ++desc;
+        }
+        setLoopLength(section, offset);
+        bool added = section.size() > empty;
+
+        offset = append<LoopLength>(section);
+        if(desc == descriptors.end())
+        {
+            added = fill(section, m_maxSectionSize, entries, next) || added;
+        }
+        setLoopLength(section, offset);
+
+        if(!added || sections.size() > MAX_SECTIONS)
+        {
+            OS_LOG(DVB_ERROR, "<%s> 0x%x.0x%x does not fit in %d byte sections\n", __FUNCTION__,
+                    (uint8_t)table.getTableId(), table.getExtensionId(), (int)m_maxSectionSize);
+            sections.clear();
+            return false;
+        }
+    }
+    while(desc != descriptors.end() || next < entries.size());
+
+    finishSubTable(sections);
+    return true;
+}
+
+/**
+ * Encode an SDT
+ *
+ * @param sdt table
+ * @param sections filled with the sections of the sub-table
+ * @return true on success, false if the table does not fit
+ */
+bool SectionEncoder::encode(const SdtTable& sdt, SubTableSections_t& sections) const
+{
+    sections.clear();
+
+    vector<const DvbService*> entries = getPointers(sdt.getServices());
+    size_t next = 0;
+    do
+    {
+        sections.push_back(SectionData_t());
+        SectionData_t& section = sections.back();
+        beginSection(section, sdt);
+
+        size_t offset = append<SdtHeader>(section);
+        SdtHeader::OriginalNetworkId::set(&section[offset], sdt.getOriginalNetworkId());
+
+        if(!fill(section, m_maxSectionSize, entries, next) || sections.size() > MAX_SECTIONS)
+        {
+            OS_LOG(DVB_ERROR, "<%s> 0x%x.0x%x does not fit in %d byte sections\n", __FUNCTION__,
+                    (uint8_t)sdt.getTableId(), sdt.getExtensionId(), (int)m_maxSectionSize);
+            sections.clear();
+            return false;
+        }
+    }
+    while(next < entries.size());
+
+    finishSubTable(sections);
+    return true;
+}
+
+/**
+ * Encode an EIT (p/f or schedule)
+ *
+ * @param eit table
+ * @param sections filled with the sections of the sub-table
+ * @return true on success, false if the table does not fit
+ */
+bool SectionEncoder::encode(const EitTable& eit, SubTableSections_t& sections) const
+{
+    sections.clear();
+
+    uint8_t tableId = (uint8_t)eit.getTableId();
+    const vector<DvbEvent>& events = eit.getEvents();
+    bool pf = (tableId == (uint8_t)TableId::EIT_PF) || (tableId == (uint8_t)TableId::EIT_PF_OTHER);
+
+    // A segment published on its own does not tell the layout of the rest of the sub-table
+    if(eit.isPartial() || (pf && events.size() > 2))
+    {
+        OS_LOG(DVB_ERROR, "<%s> 0x%x.0x%x: %s cannot be encoded\n", __FUNCTION__, tableId, eit.getExtensionId(),
+                eit.isPartial() ? "partial table" : "more than 2 p/f events");
+        return false;
+    }
+
+    // Events per segment (p/f: present and following, one per section)
+    vector<vector<const DvbEvent*> > segments(pf ? 2 : SEGMENTS_PER_TABLE);
+    uint32_t segmentCount = pf ? 1 : 0;
+    if(pf)
+    {
+        for(size_t n = 0; n < events.size(); n++)
+        {
+            segments[n].push_back(&events[n]);
+        }
+    }
+    else
+    {
+        uint16_t scheduleStart = m_scheduleStart;
+        if(!scheduleStart && !events.empty())
+        {
+            uint64_t first = events[0].getStartTimeBcd();
+            for(auto it = events.begin(), end = events.end(); it != end; ++it)
+            {
+                first = std::min(first, it->getStartTimeBcd());
+            }
+            scheduleStart = (uint16_t)(first >> 24) - (tableId & 0x0f) * (SEGMENTS_PER_TABLE / 8);
+        }
+
+        for(auto it = events.begin(), end = events.end(); it != end; ++it)
+        {
+            uint32_t segment = getSegment(tableId, it->getStartTimeBcd(), scheduleStart);
+            segments[segment].push_back(&*it);
+            segmentCount = std::max(segmentCount, segment + 1);
+        }
+        segmentCount = std::max(segmentCount, 1u);
+    }
+
+    // Sections of every segment up to the last one that has events, numbered segment * 8 + n
+    vector<uint8_t> numbers;
+    for(uint32_t segment = 0; segment < (pf ? 2 : segmentCount); segment++)
+    {
+        const vector<const DvbEvent*>& entries = segments[segment];
+        size_t first = sections.size();
+        size_t next = 0;
+        do
+        {
+            sections.push_back(SectionData_t());
+            SectionData_t& section = sections.back();
+            beginSection(section, eit);
+
+            size_t offset = append<EitHeader>(section);
+            uint8_t* p = &section[offset];
+            EitHeader::TransportStreamId::set(p, eit.getTsId());
+            EitHeader::OriginalNetworkId::set(p, eit.getNetworkId());
+            EitHeader::LastTableId::set(p, eit.getLastTableId() ? eit.getLastTableId() : tableId);
+
+            uint32_t count = sections.size() - first;
+            bool added = fill(section, m_maxEitSectionSize, entries, next);
+            if(!added || (!pf && count > SECTIONS_PER_SEGMENT))
+            {
+                OS_LOG(DVB_ERROR, "<%s> 0x%x.0x%x: segment %d does not fit in %d sections of %d bytes\n",
+                        __FUNCTION__, tableId, eit.getExtensionId(), segment, SECTIONS_PER_SEGMENT,
+                        (int)m_maxEitSectionSize);
+                sections.clear();
+                return false;
+            }
+            numbers.push_back(pf ? segment : segment * SECTIONS_PER_SEGMENT + count - 1);
+        }
+        while(next < entries.size());
+
+        // segment_last_section_number (p/f: the two sections are one segment)
+        for(size_t n = first; n < sections.size(); n++)
+        {
+            EitHeader::SegmentLastSectionNumber::set(&sections[n][SyntaxSectionHeader::SIZE], pf ? 1 : numbers.back());
+        }
+    }
+
+    for(size_t n = 0; n < sections.size(); n++)
+    {
+        SyntaxSectionHeader::SectionNumber::set(sections[n].data(), numbers[n]);
+        SyntaxSectionHeader::LastSectionNumber::set(sections[n].data(), numbers.back());
+        finishSection(sections[n]);
+    }
+    return true;
+}
+
+/**
+ * Encode a TDT or TOT
+ *
+ * @param tot table
+ * @param sections filled with the section
+ * @return true on success, false if the descriptors do not fit
+ */
+bool SectionEncoder::encode(const TotTable& tot, SubTableSections_t& sections) const
+{
+    sections.assign(1, SectionData_t());
+    SectionData_t& section = sections.back();
+
+    append<SectionHeader>(section);
+    SectionHeader::TableId::set(section.data(), (uint8_t)tot.getTableId());
+    SectionHeader::SectionSyntaxIndicator::set(section.data(), false);
+
+    // TDT: UTC time only, no CRC_32
+    if(tot.getTableId() == TableId::TDT)
+    {
+        size_t offset = append<Tdt>(section);
+        Tdt::UtcTime::set(&section[offset], tot.getUtcTimeBcd());
+        SectionHeader::SectionLength::set(section.data(), Tdt::SIZE);
+        return true;
+    }
+
+    size_t offset = append<Tot>(section);
+    appendDescriptors(section, tot.getDescriptors());
+    Tot::UtcTime::set(&section[offset], tot.getUtcTimeBcd());
+    Tot::DescriptorsLoopLength::set(&section[offset], section.size() - offset - Tot::SIZE);
+
+    if(section.size() + CRC_SIZE > m_maxSectionSize)
+    {
+        OS_LOG(DVB_ERROR, "<%s> TOT descriptors do not fit in %d bytes\n", __FUNCTION__, (int)m_maxSectionSize);
+        sections.clear();
+        return false;
+    }
+
+    finishSection(section);
+    return true;
+}
+
+/**
+ * Get the segment of an EIT schedule event
+ *
+ * @param tableId table id
+ * @param start event start time (MJD and BCD time, see DvbEvent::getStartTimeBcd())
+ * @param scheduleStart MJD of the first day of table_id 0x50 (0x60)
+ * @return segment index within the table, clamped to 0..31
+ */
+uint32_t SectionEncoder::getSegment(uint8_t tableId, uint64_t start, uint16_t scheduleStart)
+{
+    int32_t day = (int32_t)(start >> 24) - scheduleStart;
+    uint8_t hourBcd = (start >> 16) & 0xff;
+    int32_t hour = (hourBcd >> 4) * 10 + (hourBcd & 0x0f);
+
+    int32_t segment = (day * 24 + hour) / SEGMENT_HOURS - (tableId & 0x0f) * SEGMENTS_PER_TABLE;
+    return (uint32_t)std::min(std::max(segment, 0), SEGMENTS_PER_TABLE - 1);
+}
+
+/**
+ * Change the version_number of an encoded section and update its CRC_32
+ *
+ * @param section section with the long header (others are left alone)
+ * @param version version number
+ */
+void SectionEncoder::setVersion(SectionData_t& section, uint8_t version)
+{
+    if(section.size() < SyntaxSectionHeader::SIZE + CRC_SIZE || !SectionHeader::SectionSyntaxIndicator::get(section.data()))
+    {
+        return;
+    }
+
+    SyntaxSectionHeader::VersionNumber::set(section.data(), version);
+    section.resize(section.size() - CRC_SIZE);
+    finishSection(section);
+}
+
+/**
+ * Set the section_length of a section and append its CRC_32
+ *
+ * @param section section without CRC_32
+ */
+void SectionEncoder::finishSection(SectionData_t& section)
+{
+    SectionHeader::SectionLength::set(section.data(), section.size() - SectionHeader::SIZE + CRC_SIZE);
+
+    uint32_t crc = Crc32::calculate(section.data(), section.size());
+    section.push_back(crc >> 24);
+    section.push_back(crc >> 16);
+    section.push_back(crc >> 8);
+    section.push_back(crc);
+}
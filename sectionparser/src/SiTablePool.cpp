@@ -0,0 +1,234 @@
+//
+// DVB_SI for Reference Design Kit (RDK)
+//
+// Copyright (C) 2015  Dmitry Barablin & Stan Partridge (stan.partridge@arris.com)
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+#include "SiTablePool.h"
+
+// C system includes
+
+// C++ system includes
+
+// Other libraries' includes
+
+// Project's includes
+#include "oswrap.h"
+#include "NitTable.h"
+#include "BatTable.h"
+#include "SdtTable.h"
+#include "EitTable.h"
+#include "TotTable.h"
+
+/**
+ * Get the process wide pool
+ *
+ * @return pool
+ */
+SiTablePool& SiTablePool::getInstance()
+{
+    static SiTablePool pool;
+    return pool;
+}
+
+/**
+ * Constructor
+ */
+SiTablePool::SiTablePool()
+    : m_maxFree(DEFAULT_MAX_FREE),
+      m_reuseCount(0),
+      m_allocCount(0)
+{
+}
+
+/**
+ * Destructor
+ */
+SiTablePool::~SiTablePool()
+{
+    for(int type = 0; type < TABLE_TYPE_COUNT; type++)
+    {
+        for(auto it = m_free[type].begin(), end = m_free[type].end(); it != end; ++it)
+        {
+            delete *it;
+        }
+    }
+}
+
+/**
+ * Get the table type of a table id
+ *
+ * @param id table identifier
+ * @return table type
+ */
+SiTablePool::TableType SiTablePool::getTableType(uint8_t id)
+{
+    TableId tableId = static_cast<TableId>(id);
+
+    if((tableId == TableId::NIT) || (tableId == TableId::NIT_OTHER))
+    {
+        return NIT_TABLE;
+    }
+    else if((tableId == TableId::SDT) || (tableId == TableId::SDT_OTHER))
+    {
+        return SDT_TABLE;
+    }
+    else if(tableId == TableId::BAT)
+    {
+        return BAT_TABLE;
+    }
+    else if((tableId >= TableId::EIT_PF) && (tableId <= TableId::EIT_SCHED_OTHER_END))
+    {
+        return EIT_TABLE;
+    }
+    else if((tableId == TableId::TDT) || (tableId == TableId::TOT))
+    {
+        return TOT_TABLE;
+    }
+
+    return UNKNOWN_TABLE;
+}
+
+/**
+ * Get a table object for the given table id, recycled if possible
+ *
+ * @param id table identifier (selects NitTable, BatTable, SdtTable, EitTable or TotTable)
+ * @param extId table identifier extension
+ * @param ver version number
+ * @param cur current/next indicator
+ * @return table, NULL if the table id is not supported
+ */
+SiTable* SiTablePool::acquire(uint8_t id, uint16_t extId, uint8_t ver, bool cur)
+{
+    TableType type = getTableType(id);
+    if(type == UNKNOWN_TABLE)
+    {
+        OS_LOG(DVB_ERROR, "<%s> Unknown table id: 0x%x\n", __FUNCTION__, id);
+        return NULL;
+    }
+
+    SiTable* tbl = NULL;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if(!m_free[type].empty())
+        {
+            tbl = m_free[type].back();
+            m_free[type].pop_back();
+            m_reuseCount++;
+        }
+        else
+        {
+            m_allocCount++;
+        }
+    }
+
+    if(tbl)
+    {
+        tbl->reset(id, extId, ver, cur);
+        return tbl;
+    }
+
+    switch(type)
+    {
+        case NIT_TABLE:
+            return new NitTable(id, extId, ver, cur);
+        case BAT_TABLE:
+            return new BatTable(id, extId, ver, cur);
+        case SDT_TABLE:
+            return new SdtTable(id, extId, ver, cur);
+        case EIT_TABLE:
+            return new EitTable(id, extId, ver, cur);
+        default:
+            return new TotTable(id, extId, ver, cur);
+    }
+}
+
+/**
+ * Give a table back to the pool
+ *
+ * @param tbl table (may be NULL)
+ */
+void SiTablePool::release(SiTable* tbl)
+{
+    if(!tbl)
+    {
+        return;
+    }
+
+    TableType type = getTableType((uint8_t)tbl->getTableId());
+    if(type != UNKNOWN_TABLE)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if(m_free[type].size() < m_maxFree)
+        {
+            m_free[type].push_back(tbl);
+            return;
+        }
+    }
+
+    delete tbl;
+}
+
+/**
+ * Set the number of free objects kept per table type. Extra objects are deleted.
+ *
+ * @param maxFree number of free objects
+ */
+void SiTablePool::setMaxFree(size_t maxFree)
+{
+    std::vector<SiTable*> extra;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_maxFree = maxFree;
+
+        for(int type = 0; type < TABLE_TYPE_COUNT; type++)
+        {
+            while(m_free[type].size() > m_maxFree)
+            {
+                extra.push_back(m_free[type].back());
+                m_free[type].pop_back();
+            }
+        }
+    }
+
+    for(auto it = extra.begin(), end = extra.end(); it != end; ++it)
+    {
+        delete *it;
+    }
+}
+
+/**
+ * Get the number of acquire() calls served from the free lists
+ *
+ * @return number of recycled objects handed out
+ */
+uint64_t SiTablePool::getReuseCount()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_reuseCount;
+}
+
+/**
+ * Get the number of acquire() calls that allocated a new object
+ *
+ * @return number of new objects
+ */
+uint64_t SiTablePool::getAllocCount()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_allocCount;
+}
@@ -0,0 +1,532 @@
+//
+// DVB_SI for Reference Design Kit (RDK)
+//
+// Copyright (C) 2015  Dmitry Barablin & Stan Partridge (stan.partridge@arris.com)
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+#include "TableDiff.h"
+
+// C system includes
+#include <string.h>
+
+// C++ system includes
+#include <unordered_map>
+
+// Other libraries' includes
+
+// Project's includes
+#include "NitTable.h"
+#include "BatTable.h"
+#include "SdtTable.h"
+#include "EitTable.h"
+
+using std::vector;
+using std::unordered_map;
+
+namespace
+{
+    /**
+     * Delivery system descriptors of a transport stream
+     */
+    const DescriptorTag DELIVERY_TAGS[] =
+    {
+        DescriptorTag::SATELLITE_DELIVERY,
+        DescriptorTag::CABLE_DELIVERY,
+        DescriptorTag::TERRESTRIAL_DELIVERY,
+        DescriptorTag::S2_SATELLITE_DELIVERY
+    };
+
+    /**
+     * Name descriptors of a service
+     */
+    const DescriptorTag SERVICE_NAME_TAGS[] =
+    {
+        DescriptorTag::SERVICE,
+        DescriptorTag::MULTILINGUAL_SERVICE_NAME
+    };
+
+    /**
+     * Title descriptors of an event
+     */
+    const DescriptorTag TITLE_TAGS[] =
+    {
+        DescriptorTag::SHORT_EVENT
+    };
+
+    const size_t DELIVERY_TAG_COUNT = sizeof(DELIVERY_TAGS) / sizeof(DELIVERY_TAGS[0]);
+    const size_t SERVICE_NAME_TAG_COUNT = sizeof(SERVICE_NAME_TAGS) / sizeof(SERVICE_NAME_TAGS[0]);
+    const size_t TITLE_TAG_COUNT = sizeof(TITLE_TAGS) / sizeof(TITLE_TAGS[0]);
+
+    /**
+     * Check if a tag is in a list of tags
+     *
+     * @param tag tag
+     * @param tags tags
+     * @param count number of tags
+     * @return true if found, false otherwise
+     */
+    bool hasTag(DescriptorTag tag, const DescriptorTag* tags, size_t count)
+    {
+        for(size_t i = 0; i < count; i++)
+        {
+            if(tags[i] == tag)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * Compare two descriptors byte by byte
+     *
+     * @param a descriptor
+     * @param b descriptor
+     * @return true if same tag and data, false otherwise
+     */
+    bool isSameDescriptor(const MpegDescriptor& a, const MpegDescriptor& b)
+    {
+        const DescriptorData& dataA = a.getData();
+        const DescriptorData& dataB = b.getData();
+
+        return a.getTag() == b.getTag() &&
+               dataA.size() == dataB.size() &&
+               (dataA.empty() || dataA.data() == dataB.data() || memcmp(dataA.data(), dataB.data(), dataA.size()) == 0);
+    }
+
+    /**
+     * Compare the descriptors of two lists selected by tag
+     *
+     * @param a descriptor list
+     * @param b descriptor list
+     * @param tags tags
+     * @param count number of tags
+     * @param select true to compare the descriptors with the given tags, false to compare the others
+     * @return true if the selected descriptors are the same, false otherwise
+     */
+    bool isEqualSelected(const DescriptorList& a, const DescriptorList& b, const DescriptorTag* tags, size_t count, bool select)
+    {
+        size_t i = 0;
+        size_t j = 0;
+
+        while(true)
+        {
+            while(i < a.size() && hasTag(a[i].getTag(), tags, count) != select)
+            {
+                i++;
+            }
+
+            while(j < b.size() && hasTag(b[j].getTag(), tags, count) != select)
+            {
+                j++;
+            }
+
+            if(i == a.size() || j == b.size())
+            {
+                return i == a.size() && j == b.size();
+            }
+
+            if(!isSameDescriptor(a[i], b[j]))
+            {
+                return false;
+            }
+
+            i++;
+            j++;
+        }
+    }
+
+    /**
+     * Key of a transport stream
+     *
+     * @param ts transport stream
+     * @return original_network_id and transport_stream_id
+     */
+    uint32_t transportKey(const TransportStream& ts)
+    {
+        return (static_cast<uint32_t>(ts.getOriginalNetworkId()) << 16) | ts.getTsId();
+    }
+
+    /**
+     * Compare two versions of a transport stream
+     *
+     * @param prev previous version
+     * @param next new version
+     * @return TransportDelta change flags
+     */
+    uint32_t compare(const TransportStream& prev, const TransportStream& next)
+    {
+        const DescriptorList& a = prev.getTsDescriptors();
+        const DescriptorList& b = next.getTsDescriptors();
+        uint32_t changes = 0;
+
+        if(!TableDiff::isEqual(a, b))
+        {
+            if(!TableDiff::isEqual(a, b, DELIVERY_TAGS, DELIVERY_TAG_COUNT))
+            {
+                changes |= TransportDelta::DELIVERY_CHANGED;
+            }
+            if(!TableDiff::isEqualExcept(a, b, DELIVERY_TAGS, DELIVERY_TAG_COUNT))
+            {
+                changes |= TransportDelta::DESCRIPTORS_CHANGED;
+            }
+        }
+
+        return changes;
+    }
+
+    /**
+     * Compare two versions of a service
+     *
+     * @param prev previous version
+     * @param next new version
+     * @return ServiceDelta change flags
+     */
+    uint32_t compare(const DvbService& prev, const DvbService& next)
+    {
+        const DescriptorList& a = prev.getServiceDescriptors();
+        const DescriptorList& b = next.getServiceDescriptors();
+        uint32_t changes = 0;
+
+        if(prev.getRunningStatus() != next.getRunningStatus())
+        {
+            changes |= ServiceDelta::RUNNING_STATUS_CHANGED;
+        }
+        if(prev.isScrambled() != next.isScrambled())
+        {
+            changes |= ServiceDelta::SCRAMBLING_CHANGED;
+        }
+        if(prev.isEitSchedFlagSet() != next.isEitSchedFlagSet() || prev.isEitPfFlagSet() != next.isEitPfFlagSet())
+        {
+            changes |= ServiceDelta::EIT_FLAGS_CHANGED;
+        }
+        if(!TableDiff::isEqual(a, b))
+        {
+            if(!TableDiff::isEqual(a, b, SERVICE_NAME_TAGS, SERVICE_NAME_TAG_COUNT))
+            {
+                changes |= ServiceDelta::NAME_CHANGED;
+            }
+            if(!TableDiff::isEqualExcept(a, b, SERVICE_NAME_TAGS, SERVICE_NAME_TAG_COUNT))
+            {
+                changes |= ServiceDelta::DESCRIPTORS_CHANGED;
+            }
+        }
+
+        return changes;
+    }
+
+    /**
+     * Compare two versions of an event
+     *
+     * @param prev previous version
+     * @param next new version
+     * @return EventDelta change flags
+     */
+    uint32_t compare(const DvbEvent& prev, const DvbEvent& next)
+    {
+        const DescriptorList& a = prev.getEventDescriptors();
+        const DescriptorList& b = next.getEventDescriptors();
+        uint32_t changes = 0;
+
+        if(prev.getStartTimeBcd() != next.getStartTimeBcd())
+        {
+            changes |= EventDelta::START_TIME_CHANGED;
+        }
+        if(prev.getDurationBcd() != next.getDurationBcd())
+        {
+            changes |= EventDelta::DURATION_CHANGED;
+        }
+        if(prev.getRunningStatus() != next.getRunningStatus())
+        {
+            changes |= EventDelta::RUNNING_STATUS_CHANGED;
+        }
+        if(prev.isScrambled() != next.isScrambled())
+        {
+            changes |= EventDelta::SCRAMBLING_CHANGED;
+        }
+        if(!TableDiff::isEqual(a, b))
+        {
+            if(!TableDiff::isEqual(a, b, TITLE_TAGS, TITLE_TAG_COUNT))
+            {
+                changes |= EventDelta::TITLE_CHANGED;
+            }
+            if(!TableDiff::isEqualExcept(a, b, TITLE_TAGS, TITLE_TAG_COUNT))
+            {
+                changes |= EventDelta::DESCRIPTORS_CHANGED;
+            }
+        }
+
+        return changes;
+    }
+
+    /**
+     * Compare two versions of a list of entries (transport streams, services or events)
+     *
+     * @param prev previous entries, may be NULL
+     * @param next new entries
+     * @param deltas filled with the differences
+     * @param key function returning the identity of an entry
+     */
+    template<typename Entry, typename Delta, typename Key>
+    void diffEntries(const vector<Entry>* prev, const vector<Entry>& next, vector<Delta>& deltas, Key key)
+    {
+        if(!prev || prev->empty())
+        {
+            deltas.reserve(deltas.size() + next.size());
+            for(auto it = next.begin(), end = next.end(); it != end; ++it)
+            {
+                deltas.push_back(Delta(DeltaKind::ADDED, *it, 0));
+            }
+            return;
+        }
+
+        // Index of the previous entries, marked off as they are matched
+        unordered_map<uint32_t, size_t> index(prev->size() * 2);
+        for(size_t i = 0; i < prev->size(); i++)
+        {
+            index[key((*prev)[i])] = i;
+        }
+
+        vector<bool> matched(prev->size(), false);
+
+        for(auto it = next.begin(), end = next.end(); it != end; ++it)
+        {
+            auto found = index.find(key(*it));
+            if(found == index.end())
+            {
+                deltas.push_back(Delta(DeltaKind::ADDED, *it, 0));
+                continue;
+            }
+
+            matched[found->second] = true;
+            uint32_t changes = compare((*prev)[found->second], *it);
+            if(changes)
+            {
+                deltas.push_back(Delta(DeltaKind::CHANGED, *it, changes));
+            }
+        }
+
+        for(size_t i = 0; i < prev->size(); i++)
+        {
+            if(!matched[i])
+            {
+                deltas.push_back(Delta(DeltaKind::REMOVED, (*prev)[i], 0));
+            }
+        }
+    }
+
+    /**
+     * Key of a service
+     *
+     * @param service service
+     * @return service_id
+     */
+    uint32_t serviceKey(const DvbService& service)
+    {
+        return service.getServiceId();
+    }
+
+    /**
+     * Key of an event
+     *
+     * @param event event
+     * @return event_id
+     */
+    uint32_t eventKey(const DvbEvent& event)
+    {
+        return event.getEventId();
+    }
+}
+
+/**
+ * Compare two descriptor lists byte by byte
+ *
+ * @param a descriptor list
+ * @param b descriptor list
+ * @return true if the lists are the same, false otherwise
+ */
+bool TableDiff::isEqual(const DescriptorList& a, const DescriptorList& b)
+{
+    if(a.size() != b.size())
+    {
+        return false;
+    }
+
+    for(size_t i = 0; i < a.size(); i++)
+    {
+        if(!isSameDescriptor(a[i], b[i]))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Compare the descriptors with the given tags of two lists
+ *
+ * @param a descriptor list
+ * @param b descriptor list
+ * @param tags tags to compare
+ * @param count number of tags
+ * @return true if the selected descriptors are the same, false otherwise
+ */
+bool TableDiff::isEqual(const DescriptorList& a, const DescriptorList& b, const DescriptorTag* tags, size_t count)
+{
+    return isEqualSelected(a, b, tags, count, true);
+}
+
+/**
+ * Compare the descriptors of two lists, ignoring the given tags
+ *
+ * @param a descriptor list
+ * @param b descriptor list
+ * @param tags tags to ignore
+ * @param count number of tags
+ * @return true if the remaining descriptors are the same, false otherwise
+ */
+bool TableDiff::isEqualExcept(const DescriptorList& a, const DescriptorList& b, const DescriptorTag* tags, size_t count)
+{
+    return isEqualSelected(a, b, tags, count, false);
+}
+
+/**
+ * Fill in the table identity of a delta
+ *
+ * @param prev previous version, may be NULL
+ * @param next new version
+ * @param delta delta
+ */
+void TableDiff::setHeader(const SiTable* prev, const SiTable& next, TableDelta& delta)
+{
+    delta.tableId = static_cast<uint8_t>(next.getTableId());
+    delta.extensionId = next.getExtensionId();
+    delta.oldVersion = prev ? prev->getVersion() : static_cast<uint8_t>(TableDelta::NO_VERSION);
+    delta.newVersion = next.getVersion();
+}
+
+/**
+ * Compare the transport stream loops of a NIT or BAT
+ *
+ * @param prev previous transport streams, may be NULL
+ * @param next new transport streams
+ * @param delta filled with the transport stream differences
+ */
+void TableDiff::diffTransports(const vector<TransportStream>* prev, const vector<TransportStream>& next, TableDelta& delta)
+{
+    diffEntries(prev, next, delta.transports, transportKey);
+}
+
+/**
+ * Compare two versions of a NIT
+ *
+ * @param prev previous version, may be NULL
+ * @param next new version
+ * @param delta filled with the differences
+ * @return true if the tables are versions of the same sub-table, false otherwise (delta left empty)
+ */
+bool TableDiff::diff(const NitTable* prev, const NitTable& next, TableDelta& delta)
+{
+    delta.clear();
+    if(prev && (prev->getTableId() != next.getTableId() || prev->getNetworkId() != next.getNetworkId()))
+    {
+        return false;
+    }
+
+    setHeader(prev, next, delta);
+    delta.descriptorsChanged = prev ? !isEqual(prev->getNetworkDescriptors(), next.getNetworkDescriptors())
+                                    : !next.getNetworkDescriptors().empty();
+    diffTransports(prev ? &prev->getTransportStreams() : NULL, next.getTransportStreams(), delta);
+
+    return true;
+}
+
+/**
+ * Compare two versions of a BAT
+ *
+ * @param prev previous version, may be NULL
+ * @param next new version
+ * @param delta filled with the differences
+ * @return true if the tables are versions of the same sub-table, false otherwise (delta left empty)
+ */
+bool TableDiff::diff(const BatTable* prev, const BatTable& next, TableDelta& delta)
+{
+    delta.clear();
+    if(prev && prev->getBouquetId() != next.getBouquetId())
+    {
+        return false;
+    }
+
+    setHeader(prev, next, delta);
+    delta.descriptorsChanged = prev ? !isEqual(prev->getBouquetDescriptors(), next.getBouquetDescriptors())
+                                    : !next.getBouquetDescriptors().empty();
+    diffTransports(prev ? &prev->getTransportStreams() : NULL, next.getTransportStreams(), delta);
+
+    return true;
+}
+
+/**
+ * Compare two versions of an SDT
+ *
+ * @param prev previous version, may be NULL
+ * @param next new version
+ * @param delta filled with the differences
+ * @return true if the tables are versions of the same sub-table, false otherwise (delta left empty)
+ */
+bool TableDiff::diff(const SdtTable* prev, const SdtTable& next, TableDelta& delta)
+{
+    delta.clear();
+    if(prev && (prev->getTableId() != next.getTableId() ||
+                prev->getExtensionId() != next.getExtensionId() ||
+                prev->getOriginalNetworkId() != next.getOriginalNetworkId()))
+    {
+        return false;
+    }
+
+    setHeader(prev, next, delta);
+    diffEntries(prev ? &prev->getServices() : NULL, next.getServices(), delta.services, serviceKey);
+
+    return true;
+}
+
+/**
+ * Compare two versions of an EIT. Partial tables (see EitTable::getSegment()) are only
+ * comparable with the same segment.
+ *
+ * @param prev previous version, may be NULL
+ * @param next new version
+ * @param delta filled with the differences
+ * @return true if the tables are versions of the same sub-table, false otherwise (delta left empty)
+ */
+bool TableDiff::diff(const EitTable* prev, const EitTable& next, TableDelta& delta)
+{
+    delta.clear();
+    if(prev && (prev->getTableId() != next.getTableId() ||
+                prev->getExtensionId() != next.getExtensionId() ||
+                prev->getTsId() != next.getTsId() ||
+                prev->getNetworkId() != next.getNetworkId() ||
+                prev->getSegment() != next.getSegment()))
+    {
+        return false;
+    }
+
+    setHeader(prev, next, delta);
+    diffEntries(prev ? &prev->getEvents() : NULL, next.getEvents(), delta.events, eventKey);
+
+    return true;
+}
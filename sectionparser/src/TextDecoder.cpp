@@ -0,0 +1,983 @@
+//
+// DVB_SI for Reference Design Kit (RDK)
+//
+// Copyright (C) 2015  Dmitry Barablin & Stan Partridge (stan.partridge@arris.com)
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+
+#include "TextDecoder.h"
+
+// C system includes
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define TEXT_HAVE_SSE2
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define TEXT_HAVE_NEON
+#endif
+
+// C++ system includes
+#include <mutex>
+
+// Other libraries' includes
+
+// Project's includes
+
+namespace TextDecoder
+{
+
+enum : uint32_t
+{
+    REPLACEMENT_CHARACTER = 0xFFFD,
+
+    // Control codes (table A.1), single byte tables
+    CONTROL_FIRST = 0x80,
+    CONTROL_LAST = 0x9F,
+    CR_LF = 0x8A,
+
+    // Control codes of the two byte tables: 0xE080..0xE09F
+    WIDE_CONTROL_BASE = 0xE000,
+
+    // ISO/IEC 6937 non-spacing diacritical marks, they precede the letter they apply to
+    DIACRITIC_FIRST = 0xC1,
+    DIACRITIC_LAST = 0xCF,
+
+    // First code of the tables below
+    UPPER_HALF = 0xA0
+};
+
+/**
+ * Table 00 (ISO/IEC 6937 with the euro sign), 0xA0..0xFF. 0 marks unused codes and diacritics.
+ */
+static const uint16_t ISO_6937_UPPER[96] =
+{
+    0x00a0, 0x00a1, 0x00a2, 0x00a3, 0x20ac, 0x00a5, 0x0023, 0x00a7,
+    0x00a4, 0x2018, 0x201c, 0x00ab, 0x2190, 0x2191, 0x2192, 0x2193,
+    0x00b0, 0x00b1, 0x00b2, 0x00b3, 0x00d7, 0x00b5, 0x00b6, 0x00b7,
+    0x00f7, 0x2019, 0x201d, 0x00bb, 0x00bc, 0x00bd, 0x00be, 0x00bf,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x2015, 0x00b9, 0x00ae, 0x00a9, 0x2122, 0x266a, 0x00ac, 0x00a6,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x215b, 0x215c, 0x215d, 0x215e,
+    0x2126, 0x00c6, 0x0110, 0x00aa, 0x0126, 0x0000, 0x0132, 0x013f,
+    0x0141, 0x00d8, 0x0152, 0x00ba, 0x00de, 0x0166, 0x014a, 0x0149,
+    0x0138, 0x00e6, 0x0111, 0x00f0, 0x0127, 0x0131, 0x0133, 0x0140,
+    0x0142, 0x00f8, 0x0153, 0x00df, 0x00fe, 0x0167, 0x014b, 0x00ad
+};
+
+/**
+ * Combining marks of the ISO/IEC 6937 diacritics 0xC1..0xCF (0: unused)
+ */
+static const uint16_t ISO_6937_DIACRITICS[15] =
+{
+    0x0300, 0x0301, 0x0302, 0x0303, 0x0304, 0x0306, 0x0307, 0x0308,
+    0x0000, 0x030a, 0x0327, 0x0000, 0x030b, 0x0328, 0x030c
+};
+
+/**
+ * Precomposed letters: diacritic 0xC1..0xCF x letter A..Z, a..z (0: no precomposed form)
+ */
+static const uint16_t ISO_6937_COMPOSED[15][52] =
+{
+    {
+        0x00c0, 0x0000, 0x0000, 0x0000, 0x00c8, 0x0000, 0x0000, 0x0000, 0x00cc, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x01f8, 0x00d2, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x00d9, 0x0000, 0x1e80, 0x0000, 0x1ef2, 0x0000,
+        0x00e0, 0x0000, 0x0000, 0x0000, 0x00e8, 0x0000, 0x0000, 0x0000, 0x00ec, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x01f9, 0x00f2, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x00f9, 0x0000, 0x1e81, 0x0000, 0x1ef3, 0x0000
+    },
+    {
+        0x00c1, 0x0000, 0x0106, 0x0000, 0x00c9, 0x0000, 0x01f4, 0x0000, 0x00cd, 0x0000, 0x1e30, 0x0139, 0x1e3e,
+        0x0143, 0x00d3, 0x1e54, 0x0000, 0x0154, 0x015a, 0x0000, 0x00da, 0x0000, 0x1e82, 0x0000, 0x00dd, 0x0179,
+        0x00e1, 0x0000, 0x0107, 0x0000, 0x00e9, 0x0000, 0x01f5, 0x0000, 0x00ed, 0x0000, 0x1e31, 0x013a, 0x1e3f,
+        0x0144, 0x00f3, 0x1e55, 0x0000, 0x0155, 0x015b, 0x0000, 0x00fa, 0x0000, 0x1e83, 0x0000, 0x00fd, 0x017a
+    },
+    {
+        0x00c2, 0x0000, 0x0108, 0x0000, 0x00ca, 0x0000, 0x011c, 0x0124, 0x00ce, 0x0134, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x00d4, 0x0000, 0x0000, 0x0000, 0x015c, 0x0000, 0x00db, 0x0000, 0x0174, 0x0000, 0x0176, 0x1e90,
+        0x00e2, 0x0000, 0x0109, 0x0000, 0x00ea, 0x0000, 0x011d, 0x0125, 0x00ee, 0x0135, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x00f4, 0x0000, 0x0000, 0x0000, 0x015d, 0x0000, 0x00fb, 0x0000, 0x0175, 0x0000, 0x0177, 0x1e91
+    },
+    {
+        0x00c3, 0x0000, 0x0000, 0x0000, 0x1ebc, 0x0000, 0x0000, 0x0000, 0x0128, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x00d1, 0x00d5, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0168, 0x1e7c, 0x0000, 0x0000, 0x1ef8, 0x0000,
+        0x00e3, 0x0000, 0x0000, 0x0000, 0x1ebd, 0x0000, 0x0000, 0x0000, 0x0129, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x00f1, 0x00f5, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0169, 0x1e7d, 0x0000, 0x0000, 0x1ef9, 0x0000
+    },
+    {
+        0x0100, 0x0000, 0x0000, 0x0000, 0x0112, 0x0000, 0x1e20, 0x0000, 0x012a, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x014c, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x016a, 0x0000, 0x0000, 0x0000, 0x0232, 0x0000,
+        0x0101, 0x0000, 0x0000, 0x0000, 0x0113, 0x0000, 0x1e21, 0x0000, 0x012b, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x014d, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x016b, 0x0000, 0x0000, 0x0000, 0x0233, 0x0000
+    },
+    {
+        0x0102, 0x0000, 0x0000, 0x0000, 0x0114, 0x0000, 0x011e, 0x0000, 0x012c, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x014e, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x016c, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0103, 0x0000, 0x0000, 0x0000, 0x0115, 0x0000, 0x011f, 0x0000, 0x012d, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x014f, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x016d, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000
+    },
+    {
+        0x0226, 0x1e02, 0x010a, 0x1e0a, 0x0116, 0x1e1e, 0x0120, 0x1e22, 0x0130, 0x0000, 0x0000, 0x0000, 0x1e40,
+        0x1e44, 0x022e, 0x1e56, 0x0000, 0x1e58, 0x1e60, 0x1e6a, 0x0000, 0x0000, 0x1e86, 0x1e8a, 0x1e8e, 0x017b,
+        0x0227, 0x1e03, 0x010b, 0x1e0b, 0x0117, 0x1e1f, 0x0121, 0x1e23, 0x0000, 0x0000, 0x0000, 0x0000, 0x1e41,
+        0x1e45, 0x022f, 0x1e57, 0x0000, 0x1e59, 0x1e61, 0x1e6b, 0x0000, 0x0000, 0x1e87, 0x1e8b, 0x1e8f, 0x017c
+    },
+    {
+        0x00c4, 0x0000, 0x0000, 0x0000, 0x00cb, 0x0000, 0x0000, 0x1e26, 0x00cf, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x00d6, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x00dc, 0x0000, 0x1e84, 0x1e8c, 0x0178, 0x0000,
+        0x00e4, 0x0000, 0x0000, 0x0000, 0x00eb, 0x0000, 0x0000, 0x1e27, 0x00ef, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x00f6, 0x0000, 0x0000, 0x0000, 0x0000, 0x1e97, 0x00fc, 0x0000, 0x1e85, 0x1e8d, 0x00ff, 0x0000
+    },
+    {
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000
+    },
+    {
+        0x00c5, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x016e, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x00e5, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x016f, 0x0000, 0x1e98, 0x0000, 0x1e99, 0x0000
+    },
+    {
+        0x0000, 0x0000, 0x00c7, 0x1e10, 0x0228, 0x0000, 0x0122, 0x1e28, 0x0000, 0x0000, 0x0136, 0x013b, 0x0000,
+        0x0145, 0x0000, 0x0000, 0x0000, 0x0156, 0x015e, 0x0162, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x00e7, 0x1e11, 0x0229, 0x0000, 0x0123, 0x1e29, 0x0000, 0x0000, 0x0137, 0x013c, 0x0000,
+        0x0146, 0x0000, 0x0000, 0x0000, 0x0157, 0x015f, 0x0163, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000
+    },
+    {
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000
+    },
+    {
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0150, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0170, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0151, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0171, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000
+    },
+    {
+        0x0104, 0x0000, 0x0000, 0x0000, 0x0118, 0x0000, 0x0000, 0x0000, 0x012e, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x01ea, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0172, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0105, 0x0000, 0x0000, 0x0000, 0x0119, 0x0000, 0x0000, 0x0000, 0x012f, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x01eb, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0173, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000
+    },
+    {
+        0x01cd, 0x0000, 0x010c, 0x010e, 0x011a, 0x0000, 0x01e6, 0x021e, 0x01cf, 0x0000, 0x01e8, 0x013d, 0x0000,
+        0x0147, 0x01d1, 0x0000, 0x0000, 0x0158, 0x0160, 0x0164, 0x01d3, 0x0000, 0x0000, 0x0000, 0x0000, 0x017d,
+        0x01ce, 0x0000, 0x010d, 0x010f, 0x011b, 0x0000, 0x01e7, 0x021f, 0x01d0, 0x01f0, 0x01e9, 0x013e, 0x0000,
+        0x0148, 0x01d2, 0x0000, 0x0000, 0x0159, 0x0161, 0x0165, 0x01d4, 0x0000, 0x0000, 0x0000, 0x0000, 0x017e
+    }
+};
+
+/**
+ * ISO/IEC 8859 part 1..15, 0xA0..0xFF. 0 marks unused codes.
+ */
+static const uint16_t ISO_8859_UPPER[16][96] =
+{
+    // unused
+    {
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000
+    },
+    // ISO/IEC 8859-1
+    {
+        0x00a0, 0x00a1, 0x00a2, 0x00a3, 0x00a4, 0x00a5, 0x00a6, 0x00a7,
+        0x00a8, 0x00a9, 0x00aa, 0x00ab, 0x00ac, 0x00ad, 0x00ae, 0x00af,
+        0x00b0, 0x00b1, 0x00b2, 0x00b3, 0x00b4, 0x00b5, 0x00b6, 0x00b7,
+        0x00b8, 0x00b9, 0x00ba, 0x00bb, 0x00bc, 0x00bd, 0x00be, 0x00bf,
+        0x00c0, 0x00c1, 0x00c2, 0x00c3, 0x00c4, 0x00c5, 0x00c6, 0x00c7,
+        0x00c8, 0x00c9, 0x00ca, 0x00cb, 0x00cc, 0x00cd, 0x00ce, 0x00cf,
+        0x00d0, 0x00d1, 0x00d2, 0x00d3, 0x00d4, 0x00d5, 0x00d6, 0x00d7,
+        0x00d8, 0x00d9, 0x00da, 0x00db, 0x00dc, 0x00dd, 0x00de, 0x00df,
+        0x00e0, 0x00e1, 0x00e2, 0x00e3, 0x00e4, 0x00e5, 0x00e6, 0x00e7,
+        0x00e8, 0x00e9, 0x00ea, 0x00eb, 0x00ec, 0x00ed, 0x00ee, 0x00ef,
+        0x00f0, 0x00f1, 0x00f2, 0x00f3, 0x00f4, 0x00f5, 0x00f6, 0x00f7,
+        0x00f8, 0x00f9, 0x00fa, 0x00fb, 0x00fc, 0x00fd, 0x00fe, 0x00ff
+    },
+    // ISO/IEC 8859-2
+    {
+        0x00a0, 0x0104, 0x02d8, 0x0141, 0x00a4, 0x013d, 0x015a, 0x00a7,
+        0x00a8, 0x0160, 0x015e, 0x0164, 0x0179, 0x00ad, 0x017d, 0x017b,
+        0x00b0, 0x0105, 0x02db, 0x0142, 0x00b4, 0x013e, 0x015b, 0x02c7,
+        0x00b8, 0x0161, 0x015f, 0x0165, 0x017a, 0x02dd, 0x017e, 0x017c,
+        0x0154, 0x00c1, 0x00c2, 0x0102, 0x00c4, 0x0139, 0x0106, 0x00c7,
+        0x010c, 0x00c9, 0x0118, 0x00cb, 0x011a, 0x00cd, 0x00ce, 0x010e,
+        0x0110, 0x0143, 0x0147, 0x00d3, 0x00d4, 0x0150, 0x00d6, 0x00d7,
+        0x0158, 0x016e, 0x00da, 0x0170, 0x00dc, 0x00dd, 0x0162, 0x00df,
+        0x0155, 0x00e1, 0x00e2, 0x0103, 0x00e4, 0x013a, 0x0107, 0x00e7,
+        0x010d, 0x00e9, 0x0119, 0x00eb, 0x011b, 0x00ed, 0x00ee, 0x010f,
+        0x0111, 0x0144, 0x0148, 0x00f3, 0x00f4, 0x0151, 0x00f6, 0x00f7,
+        0x0159, 0x016f, 0x00fa, 0x0171, 0x00fc, 0x00fd, 0x0163, 0x02d9
+    },
+    // ISO/IEC 8859-3
+    {
+        0x00a0, 0x0126, 0x02d8, 0x00a3, 0x00a4, 0x0000, 0x0124, 0x00a7,
+        0x00a8, 0x0130, 0x015e, 0x011e, 0x0134, 0x00ad, 0x0000, 0x017b,
+        0x00b0, 0x0127, 0x00b2, 0x00b3, 0x00b4, 0x00b5, 0x0125, 0x00b7,
+        0x00b8, 0x0131, 0x015f, 0x011f, 0x0135, 0x00bd, 0x0000, 0x017c,
+        0x00c0, 0x00c1, 0x00c2, 0x0000, 0x00c4, 0x010a, 0x0108, 0x00c7,
+        0x00c8, 0x00c9, 0x00ca, 0x00cb, 0x00cc, 0x00cd, 0x00ce, 0x00cf,
+        0x0000, 0x00d1, 0x00d2, 0x00d3, 0x00d4, 0x0120, 0x00d6, 0x00d7,
+        0x011c, 0x00d9, 0x00da, 0x00db, 0x00dc, 0x016c, 0x015c, 0x00df,
+        0x00e0, 0x00e1, 0x00e2, 0x0000, 0x00e4, 0x010b, 0x0109, 0x00e7,
+        0x00e8, 0x00e9, 0x00ea, 0x00eb, 0x00ec, 0x00ed, 0x00ee, 0x00ef,
+        0x0000, 0x00f1, 0x00f2, 0x00f3, 0x00f4, 0x0121, 0x00f6, 0x00f7,
+        0x011d, 0x00f9, 0x00fa, 0x00fb, 0x00fc, 0x016d, 0x015d, 0x02d9
+    },
+    // ISO/IEC 8859-4
+    {
+        0x00a0, 0x0104, 0x0138, 0x0156, 0x00a4, 0x0128, 0x013b, 0x00a7,
+        0x00a8, 0x0160, 0x0112, 0x0122, 0x0166, 0x00ad, 0x017d, 0x00af,
+        0x00b0, 0x0105, 0x02db, 0x0157, 0x00b4, 0x0129, 0x013c, 0x02c7,
+        0x00b8, 0x0161, 0x0113, 0x0123, 0x0167, 0x014a, 0x017e, 0x014b,
+        0x0100, 0x00c1, 0x00c2, 0x00c3, 0x00c4, 0x00c5, 0x00c6, 0x012e,
+        0x010c, 0x00c9, 0x0118, 0x00cb, 0x0116, 0x00cd, 0x00ce, 0x012a,
+        0x0110, 0x0145, 0x014c, 0x0136, 0x00d4, 0x00d5, 0x00d6, 0x00d7,
+        0x00d8, 0x0172, 0x00da, 0x00db, 0x00dc, 0x0168, 0x016a, 0x00df,
+        0x0101, 0x00e1, 0x00e2, 0x00e3, 0x00e4, 0x00e5, 0x00e6, 0x012f,
+        0x010d, 0x00e9, 0x0119, 0x00eb, 0x0117, 0x00ed, 0x00ee, 0x012b,
+        0x0111, 0x0146, 0x014d, 0x0137, 0x00f4, 0x00f5, 0x00f6, 0x00f7,
+        0x00f8, 0x0173, 0x00fa, 0x00fb, 0x00fc, 0x0169, 0x016b, 0x02d9
+    },
+    // ISO/IEC 8859-5
+    {
+        0x00a0, 0x0401, 0x0402, 0x0403, 0x0404, 0x0405, 0x0406, 0x0407,
+        0x0408, 0x0409, 0x040a, 0x040b, 0x040c, 0x00ad, 0x040e, 0x040f,
+        0x0410, 0x0411, 0x0412, 0x0413, 0x0414, 0x0415, 0x0416, 0x0417,
+        0x0418, 0x0419, 0x041a, 0x041b, 0x041c, 0x041d, 0x041e, 0x041f,
+        0x0420, 0x0421, 0x0422, 0x0423, 0x0424, 0x0425, 0x0426, 0x0427,
+        0x0428, 0x0429, 0x042a, 0x042b, 0x042c, 0x042d, 0x042e, 0x042f,
+        0x0430, 0x0431, 0x0432, 0x0433, 0x0434, 0x0435, 0x0436, 0x0437,
+        0x0438, 0x0439, 0x043a, 0x043b, 0x043c, 0x043d, 0x043e, 0x043f,
+        0x0440, 0x0441, 0x0442, 0x0443, 0x0444, 0x0445, 0x0446, 0x0447,
+        0x0448, 0x0449, 0x044a, 0x044b, 0x044c, 0x044d, 0x044e, 0x044f,
+        0x2116, 0x0451, 0x0452, 0x0453, 0x0454, 0x0455, 0x0456, 0x0457,
+        0x0458, 0x0459, 0x045a, 0x045b, 0x045c, 0x00a7, 0x045e, 0x045f
+    },
+    // ISO/IEC 8859-6
+    {
+        0x00a0, 0x0000, 0x0000, 0x0000, 0x00a4, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x060c, 0x00ad, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x061b, 0x0000, 0x0000, 0x0000, 0x061f,
+        0x0000, 0x0621, 0x0622, 0x0623, 0x0624, 0x0625, 0x0626, 0x0627,
+        0x0628, 0x0629, 0x062a, 0x062b, 0x062c, 0x062d, 0x062e, 0x062f,
+        0x0630, 0x0631, 0x0632, 0x0633, 0x0634, 0x0635, 0x0636, 0x0637,
+        0x0638, 0x0639, 0x063a, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0640, 0x0641, 0x0642, 0x0643, 0x0644, 0x0645, 0x0646, 0x0647,
+        0x0648, 0x0649, 0x064a, 0x064b, 0x064c, 0x064d, 0x064e, 0x064f,
+        0x0650, 0x0651, 0x0652, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000
+    },
+    // ISO/IEC 8859-7
+    {
+        0x00a0, 0x2018, 0x2019, 0x00a3, 0x20ac, 0x20af, 0x00a6, 0x00a7,
+        0x00a8, 0x00a9, 0x037a, 0x00ab, 0x00ac, 0x00ad, 0x0000, 0x2015,
+        0x00b0, 0x00b1, 0x00b2, 0x00b3, 0x0384, 0x0385, 0x0386, 0x00b7,
+        0x0388, 0x0389, 0x038a, 0x00bb, 0x038c, 0x00bd, 0x038e, 0x038f,
+        0x0390, 0x0391, 0x0392, 0x0393, 0x0394, 0x0395, 0x0396, 0x0397,
+        0x0398, 0x0399, 0x039a, 0x039b, 0x039c, 0x039d, 0x039e, 0x039f,
+        0x03a0, 0x03a1, 0x0000, 0x03a3, 0x03a4, 0x03a5, 0x03a6, 0x03a7,
+        0x03a8, 0x03a9, 0x03aa, 0x03ab, 0x03ac, 0x03ad, 0x03ae, 0x03af,
+        0x03b0, 0x03b1, 0x03b2, 0x03b3, 0x03b4, 0x03b5, 0x03b6, 0x03b7,
+        0x03b8, 0x03b9, 0x03ba, 0x03bb, 0x03bc, 0x03bd, 0x03be, 0x03bf,
+        0x03c0, 0x03c1, 0x03c2, 0x03c3, 0x03c4, 0x03c5, 0x03c6, 0x03c7,
+        0x03c8, 0x03c9, 0x03ca, 0x03cb, 0x03cc, 0x03cd, 0x03ce, 0x0000
+    },
+    // ISO/IEC 8859-8
+    {
+        0x00a0, 0x0000, 0x00a2, 0x00a3, 0x00a4, 0x00a5, 0x00a6, 0x00a7,
+        0x00a8, 0x00a9, 0x00d7, 0x00ab, 0x00ac, 0x00ad, 0x00ae, 0x00af,
+        0x00b0, 0x00b1, 0x00b2, 0x00b3, 0x00b4, 0x00b5, 0x00b6, 0x00b7,
+        0x00b8, 0x00b9, 0x00f7, 0x00bb, 0x00bc, 0x00bd, 0x00be, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x2017,
+        0x05d0, 0x05d1, 0x05d2, 0x05d3, 0x05d4, 0x05d5, 0x05d6, 0x05d7,
+        0x05d8, 0x05d9, 0x05da, 0x05db, 0x05dc, 0x05dd, 0x05de, 0x05df,
+        0x05e0, 0x05e1, 0x05e2, 0x05e3, 0x05e4, 0x05e5, 0x05e6, 0x05e7,
+        0x05e8, 0x05e9, 0x05ea, 0x0000, 0x0000, 0x200e, 0x200f, 0x0000
+    },
+    // ISO/IEC 8859-9
+    {
+        0x00a0, 0x00a1, 0x00a2, 0x00a3, 0x00a4, 0x00a5, 0x00a6, 0x00a7,
+        0x00a8, 0x00a9, 0x00aa, 0x00ab, 0x00ac, 0x00ad, 0x00ae, 0x00af,
+        0x00b0, 0x00b1, 0x00b2, 0x00b3, 0x00b4, 0x00b5, 0x00b6, 0x00b7,
+        0x00b8, 0x00b9, 0x00ba, 0x00bb, 0x00bc, 0x00bd, 0x00be, 0x00bf,
+        0x00c0, 0x00c1, 0x00c2, 0x00c3, 0x00c4, 0x00c5, 0x00c6, 0x00c7,
+        0x00c8, 0x00c9, 0x00ca, 0x00cb, 0x00cc, 0x00cd, 0x00ce, 0x00cf,
+        0x011e, 0x00d1, 0x00d2, 0x00d3, 0x00d4, 0x00d5, 0x00d6, 0x00d7,
+        0x00d8, 0x00d9, 0x00da, 0x00db, 0x00dc, 0x0130, 0x015e, 0x00df,
+        0x00e0, 0x00e1, 0x00e2, 0x00e3, 0x00e4, 0x00e5, 0x00e6, 0x00e7,
+        0x00e8, 0x00e9, 0x00ea, 0x00eb, 0x00ec, 0x00ed, 0x00ee, 0x00ef,
+        0x011f, 0x00f1, 0x00f2, 0x00f3, 0x00f4, 0x00f5, 0x00f6, 0x00f7,
+        0x00f8, 0x00f9, 0x00fa, 0x00fb, 0x00fc, 0x0131, 0x015f, 0x00ff
+    },
+    // ISO/IEC 8859-10
+    {
+        0x00a0, 0x0104, 0x0112, 0x0122, 0x012a, 0x0128, 0x0136, 0x00a7,
+        0x013b, 0x0110, 0x0160, 0x0166, 0x017d, 0x00ad, 0x016a, 0x014a,
+        0x00b0, 0x0105, 0x0113, 0x0123, 0x012b, 0x0129, 0x0137, 0x00b7,
+        0x013c, 0x0111, 0x0161, 0x0167, 0x017e, 0x2015, 0x016b, 0x014b,
+        0x0100, 0x00c1, 0x00c2, 0x00c3, 0x00c4, 0x00c5, 0x00c6, 0x012e,
+        0x010c, 0x00c9, 0x0118, 0x00cb, 0x0116, 0x00cd, 0x00ce, 0x00cf,
+        0x00d0, 0x0145, 0x014c, 0x00d3, 0x00d4, 0x00d5, 0x00d6, 0x0168,
+        0x00d8, 0x0172, 0x00da, 0x00db, 0x00dc, 0x00dd, 0x00de, 0x00df,
+        0x0101, 0x00e1, 0x00e2, 0x00e3, 0x00e4, 0x00e5, 0x00e6, 0x012f,
+        0x010d, 0x00e9, 0x0119, 0x00eb, 0x0117, 0x00ed, 0x00ee, 0x00ef,
+        0x00f0, 0x0146, 0x014d, 0x00f3, 0x00f4, 0x00f5, 0x00f6, 0x0169,
+        0x00f8, 0x0173, 0x00fa, 0x00fb, 0x00fc, 0x00fd, 0x00fe, 0x0138
+    },
+    // ISO/IEC 8859-11
+    {
+        0x00a0, 0x0e01, 0x0e02, 0x0e03, 0x0e04, 0x0e05, 0x0e06, 0x0e07,
+        0x0e08, 0x0e09, 0x0e0a, 0x0e0b, 0x0e0c, 0x0e0d, 0x0e0e, 0x0e0f,
+        0x0e10, 0x0e11, 0x0e12, 0x0e13, 0x0e14, 0x0e15, 0x0e16, 0x0e17,
+        0x0e18, 0x0e19, 0x0e1a, 0x0e1b, 0x0e1c, 0x0e1d, 0x0e1e, 0x0e1f,
+        0x0e20, 0x0e21, 0x0e22, 0x0e23, 0x0e24, 0x0e25, 0x0e26, 0x0e27,
+        0x0e28, 0x0e29, 0x0e2a, 0x0e2b, 0x0e2c, 0x0e2d, 0x0e2e, 0x0e2f,
+        0x0e30, 0x0e31, 0x0e32, 0x0e33, 0x0e34, 0x0e35, 0x0e36, 0x0e37,
+        0x0e38, 0x0e39, 0x0e3a, 0x0000, 0x0000, 0x0000, 0x0000, 0x0e3f,
+        0x0e40, 0x0e41, 0x0e42, 0x0e43, 0x0e44, 0x0e45, 0x0e46, 0x0e47,
+        0x0e48, 0x0e49, 0x0e4a, 0x0e4b, 0x0e4c, 0x0e4d, 0x0e4e, 0x0e4f,
+        0x0e50, 0x0e51, 0x0e52, 0x0e53, 0x0e54, 0x0e55, 0x0e56, 0x0e57,
+        0x0e58, 0x0e59, 0x0e5a, 0x0e5b, 0x0000, 0x0000, 0x0000, 0x0000
+    },
+    // unused
+    {
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000
+    },
+    // ISO/IEC 8859-13
+    {
+        0x00a0, 0x201d, 0x00a2, 0x00a3, 0x00a4, 0x201e, 0x00a6, 0x00a7,
+        0x00d8, 0x00a9, 0x0156, 0x00ab, 0x00ac, 0x00ad, 0x00ae, 0x00c6,
+        0x00b0, 0x00b1, 0x00b2, 0x00b3, 0x201c, 0x00b5, 0x00b6, 0x00b7,
+        0x00f8, 0x00b9, 0x0157, 0x00bb, 0x00bc, 0x00bd, 0x00be, 0x00e6,
+        0x0104, 0x012e, 0x0100, 0x0106, 0x00c4, 0x00c5, 0x0118, 0x0112,
+        0x010c, 0x00c9, 0x0179, 0x0116, 0x0122, 0x0136, 0x012a, 0x013b,
+        0x0160, 0x0143, 0x0145, 0x00d3, 0x014c, 0x00d5, 0x00d6, 0x00d7,
+        0x0172, 0x0141, 0x015a, 0x016a, 0x00dc, 0x017b, 0x017d, 0x00df,
+        0x0105, 0x012f, 0x0101, 0x0107, 0x00e4, 0x00e5, 0x0119, 0x0113,
+        0x010d, 0x00e9, 0x017a, 0x0117, 0x0123, 0x0137, 0x012b, 0x013c,
+        0x0161, 0x0144, 0x0146, 0x00f3, 0x014d, 0x00f5, 0x00f6, 0x00f7,
+        0x0173, 0x0142, 0x015b, 0x016b, 0x00fc, 0x017c, 0x017e, 0x2019
+    },
+    // ISO/IEC 8859-14
+    {
+        0x00a0, 0x1e02, 0x1e03, 0x00a3, 0x010a, 0x010b, 0x1e0a, 0x00a7,
+        0x1e80, 0x00a9, 0x1e82, 0x1e0b, 0x1ef2, 0x00ad, 0x00ae, 0x0178,
+        0x1e1e, 0x1e1f, 0x0120, 0x0121, 0x1e40, 0x1e41, 0x00b6, 0x1e56,
+        0x1e81, 0x1e57, 0x1e83, 0x1e60, 0x1ef3, 0x1e84, 0x1e85, 0x1e61,
+        0x00c0, 0x00c1, 0x00c2, 0x00c3, 0x00c4, 0x00c5, 0x00c6, 0x00c7,
+        0x00c8, 0x00c9, 0x00ca, 0x00cb, 0x00cc, 0x00cd, 0x00ce, 0x00cf,
+        0x0174, 0x00d1, 0x00d2, 0x00d3, 0x00d4, 0x00d5, 0x00d6, 0x1e6a,
+        0x00d8, 0x00d9, 0x00da, 0x00db, 0x00dc, 0x00dd, 0x0176, 0x00df,
+        0x00e0, 0x00e1, 0x00e2, 0x00e3, 0x00e4, 0x00e5, 0x00e6, 0x00e7,
+        0x00e8, 0x00e9, 0x00ea, 0x00eb, 0x00ec, 0x00ed, 0x00ee, 0x00ef,
+        0x0175, 0x00f1, 0x00f2, 0x00f3, 0x00f4, 0x00f5, 0x00f6, 0x1e6b,
+        0x00f8, 0x00f9, 0x00fa, 0x00fb, 0x00fc, 0x00fd, 0x0177, 0x00ff
+    },
+    // ISO/IEC 8859-15
+    {
+        0x00a0, 0x00a1, 0x00a2, 0x00a3, 0x20ac, 0x00a5, 0x0160, 0x00a7,
+        0x0161, 0x00a9, 0x00aa, 0x00ab, 0x00ac, 0x00ad, 0x00ae, 0x00af,
+        0x00b0, 0x00b1, 0x00b2, 0x00b3, 0x017d, 0x00b5, 0x00b6, 0x00b7,
+        0x017e, 0x00b9, 0x00ba, 0x00bb, 0x0152, 0x0153, 0x0178, 0x00bf,
+        0x00c0, 0x00c1, 0x00c2, 0x00c3, 0x00c4, 0x00c5, 0x00c6, 0x00c7,
+        0x00c8, 0x00c9, 0x00ca, 0x00cb, 0x00cc, 0x00cd, 0x00ce, 0x00cf,
+        0x00d0, 0x00d1, 0x00d2, 0x00d3, 0x00d4, 0x00d5, 0x00d6, 0x00d7,
+        0x00d8, 0x00d9, 0x00da, 0x00db, 0x00dc, 0x00dd, 0x00de, 0x00df,
+        0x00e0, 0x00e1, 0x00e2, 0x00e3, 0x00e4, 0x00e5, 0x00e6, 0x00e7,
+        0x00e8, 0x00e9, 0x00ea, 0x00eb, 0x00ec, 0x00ed, 0x00ee, 0x00ef,
+        0x00f0, 0x00f1, 0x00f2, 0x00f3, 0x00f4, 0x00f5, 0x00f6, 0x00f7,
+        0x00f8, 0x00f9, 0x00fa, 0x00fb, 0x00fc, 0x00fd, 0x00fe, 0x00ff
+    }
+};
+
+/**
+ * Output sink of the first pass: counts the UTF-8 bytes
+ */
+class SizeCounter
+{
+public:
+    /**
+     * Constructor
+     */
+    SizeCounter()
+        : m_size(0)
+    {
+    }
+
+    /**
+     * Add bytes that are copied as they are
+     *
+     * @param len number of bytes
+     */
+    void append(const uint8_t*, size_t len)
+    {
+        m_size += len;
+    }
+
+    /**
+     * Add a byte
+     */
+    void put(uint8_t)
+    {
+        m_size++;
+    }
+
+    /**
+     * Get the output size
+     *
+     * @return number of bytes
+     */
+    size_t getSize() const
+    {
+        return m_size;
+    }
+
+private:
+    /**
+     * Number of bytes
+     */
+    size_t m_size;
+};
+
+/**
+ * Output sink of the second pass: writes the UTF-8 bytes into a buffer of the counted size
+ */
+class Writer
+{
+public:
+    /**
+     * Constructor
+     *
+     * @param out output buffer
+     */
+    explicit Writer(char* out)
+        : m_out(out)
+    {
+    }
+
+    /**
+     * Copy bytes
+     *
+     * @param data bytes
+     * @param len number of bytes
+     */
+    void append(const uint8_t* data, size_t len)
+    {
+        memcpy(m_out, data, len);
+        m_out += len;
+    }
+
+    /**
+     * Write a byte
+     *
+     * @param c byte
+     */
+    void put(uint8_t c)
+    {
+        *m_out++ = (char)c;
+    }
+
+private:
+    /**
+     * Write position
+     */
+    char* m_out;
+};
+
+/**
+ * Protects the decompressors
+ */
+static std::mutex s_decompressorMutex;
+
+/**
+ * Decompressors by encoding_type_id
+ */
+static std::shared_ptr<const Decompressor> s_decompressors[256];
+
+/**
+ * Write a code point in UTF-8
+ */
+template<typename Sink>
+static inline void putCodePoint(Sink& sink, uint32_t cp)
+{
+    if(cp < 0x80)
+    {
+        sink.put(cp);
+    }
+    else if(cp < 0x800)
+    {
+        sink.put(0xC0 | (cp >> 6));
+        sink.put(0x80 | (cp & 0x3F));
+    }
+    else if(cp < 0x10000)
+    {
+        sink.put(0xE0 | (cp >> 12));
+        sink.put(0x80 | ((cp >> 6) & 0x3F));
+        sink.put(0x80 | (cp & 0x3F));
+    }
+    else
+    {
+        sink.put(0xF0 | (cp >> 18));
+        sink.put(0x80 | ((cp >> 12) & 0x3F));
+        sink.put(0x80 | ((cp >> 6) & 0x3F));
+        sink.put(0x80 | (cp & 0x3F));
+    }
+}
+
+/**
+ * Apply a control code (0x80..0x9F): CR/LF becomes a new line, the others
+ * (character emphasis on/off, reserved, user defined) are removed
+ */
+template<typename Sink>
+static inline void putControl(Sink& sink, uint32_t code)
+{
+    if(code == CR_LF)
+    {
+        sink.put('\n');
+    }
+}
+
+/**
+ * Convert a text coded in a single byte table
+ *
+ * @param str text
+ * @param len text length
+ * @param upper code points of 0xA0..0xFF
+ * @param diacritics true for ISO/IEC 6937
+ * @param sink output
+ */
+template<typename Sink>
+static void convertSingleByte(const uint8_t* str, size_t len, const uint16_t* upper, bool diacritics, Sink& sink)
+{
+    size_t i = 0;
+    while(i < len)
+    {
+        size_t run = getAsciiRun(str + i, len - i);
+        if(run)
+        {
+            sink.append(str + i, run);
+            i += run;
+            continue;
+        }
+
+        uint8_t c = str[i++];
+        if(c <= CONTROL_LAST)
+        {
+            putControl(sink, c);
+            continue;
+        }
+
+        if(diacritics && (c >= DIACRITIC_FIRST) && (c <= DIACRITIC_LAST))
+        {
+            // The diacritic applies to the next character, only letters take one
+            uint16_t mark = ISO_6937_DIACRITICS[c - DIACRITIC_FIRST];
+            uint8_t base = (i < len) ? str[i] : 0;
+            int letter = ((base >= 'A') && (base <= 'Z')) ? (base - 'A') :
+                         ((base >= 'a') && (base <= 'z')) ? (base - 'a' + 26) : -1;
+
+            if(mark && (letter >= 0))
+            {
+                uint16_t composed = ISO_6937_COMPOSED[c - DIACRITIC_FIRST][letter];
+                if(composed)
+                {
+                    putCodePoint(sink, composed);
+                }
+                else
+                {
+                    sink.put(base);
+                    putCodePoint(sink, mark);
+                }
+                i++;
+            }
+            continue;
+        }
+
+        uint16_t cp = upper[c - UPPER_HALF];
+        if(cp)
+        {
+            putCodePoint(sink, cp);
+        }
+    }
+}
+
+/**
+ * Convert a text coded in UTF-16 (ISO/IEC 10646 BMP, big endian)
+ */
+template<typename Sink>
+static void convertUtf16(const uint8_t* str, size_t len, Sink& sink)
+{
+    for(size_t i = 0; (i + 1) < len; i += 2)
+    {
+        uint32_t cp = ((uint32_t)str[i] << 8) | str[i + 1];
+
+        if((cp >= (WIDE_CONTROL_BASE + CONTROL_FIRST)) && (cp <= (WIDE_CONTROL_BASE + CONTROL_LAST)))
+        {
+            putControl(sink, cp - WIDE_CONTROL_BASE);
+            continue;
+        }
+
+        if((cp >= 0xD800) && (cp <= 0xDBFF))
+        {
+            // High surrogate, a low one must follow
+            uint32_t low = ((i + 3) < len) ? (((uint32_t)str[i + 2] << 8) | str[i + 3]) : 0;
+            if((low >= 0xDC00) && (low <= 0xDFFF))
+            {
+                cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                i += 2;
+            }
+            else
+            {
+                cp = REPLACEMENT_CHARACTER;
+            }
+        }
+        else if((cp >= 0xDC00) && (cp <= 0xDFFF))
+        {
+            cp = REPLACEMENT_CHARACTER;
+        }
+
+        putCodePoint(sink, cp);
+    }
+}
+
+/**
+ * Convert (validate) a text coded in UTF-8
+ */
+template<typename Sink>
+static void convertUtf8(const uint8_t* str, size_t len, Sink& sink)
+{
+    size_t i = 0;
+    while(i < len)
+    {
+        size_t run = getAsciiRun(str + i, len - i);
+        if(run)
+        {
+            sink.append(str + i, run);
+            i += run;
+            continue;
+        }
+
+        // Lead byte: sequence length, payload bits and the smallest code point of that length
+        uint8_t c = str[i];
+        size_t n;
+        uint32_t cp;
+        uint32_t min;
+        if((c >= 0xC2) && (c <= 0xDF))
+        {
+            n = 2;
+            cp = c & 0x1F;
+            min = 0x80;
+        }
+        else if((c >= 0xE0) && (c <= 0xEF))
+        {
+            n = 3;
+            cp = c & 0x0F;
+            min = 0x800;
+        }
+        else if((c >= 0xF0) && (c <= 0xF4))
+        {
+            n = 4;
+            cp = c & 0x07;
+            min = 0x10000;
+        }
+        else
+        {
+            putCodePoint(sink, REPLACEMENT_CHARACTER);
+            i++;
+            continue;
+        }
+
+        bool valid = (i + n) <= len;
+        for(size_t k = 1; valid && (k < n); k++)
+        {
+            valid = (str[i + k] & 0xC0) == 0x80;
+            cp = (cp << 6) | (str[i + k] & 0x3F);
+        }
+
+        if(!valid || (cp < min) || (cp > 0x10FFFF) || ((cp >= 0xD800) && (cp <= 0xDFFF)))
+        {
+            putCodePoint(sink, REPLACEMENT_CHARACTER);
+            i++;
+            continue;
+        }
+
+        if((cp >= (WIDE_CONTROL_BASE + CONTROL_FIRST)) && (cp <= (WIDE_CONTROL_BASE + CONTROL_LAST)))
+        {
+            putControl(sink, cp - WIDE_CONTROL_BASE);
+        }
+        else
+        {
+            sink.append(str + i, n);
+        }
+        i += n;
+    }
+}
+
+/**
+ * Convert a text coded in an unsupported table: ASCII is kept, other bytes are replaced
+ */
+template<typename Sink>
+static void convertUnsupported(const uint8_t* str, size_t len, Sink& sink)
+{
+    size_t i = 0;
+    while(i < len)
+    {
+        size_t run = getAsciiRun(str + i, len - i);
+        sink.append(str + i, run);
+        i += run;
+
+        if(i < len)
+        {
+            putCodePoint(sink, REPLACEMENT_CHARACTER);
+            i++;
+        }
+    }
+}
+
+/**
+ * Convert a text (without its selector bytes)
+ */
+template<typename Sink>
+static void convert(const Selection& sel, const uint8_t* str, size_t len, Sink& sink)
+{
+    switch(sel.charset)
+    {
+        case Charset::ISO_6937:
+            convertSingleByte(str, len, ISO_6937_UPPER, true, sink);
+            break;
+        case Charset::ISO_8859:
+            convertSingleByte(str, len, ISO_8859_UPPER[sel.part], false, sink);
+            break;
+        case Charset::UTF_16:
+            convertUtf16(str, len, sink);
+            break;
+        case Charset::UTF_8:
+            convertUtf8(str, len, sink);
+            break;
+        default:
+            convertUnsupported(str, len, sink);
+            break;
+    }
+}
+
+/**
+ * Get the length of the leading run of ASCII (< 0x80) bytes
+ *
+ * @param str data
+ * @param len data length
+ * @return number of ASCII bytes at the start of the data
+ */
+size_t getAsciiRun(const uint8_t* str, size_t len)
+{
+    size_t n = 0;
+
+#if defined(TEXT_HAVE_SSE2)
+    // The sign bits of 16 bytes at a time
+    while((n + 16) <= len)
+    {
+        int mask = _mm_movemask_epi8(_mm_loadu_si128((const __m128i*)(str + n)));
+        if(mask)
+        {
+            return n + __builtin_ctz(mask);
+        }
+        n += 16;
+    }
+#elif defined(TEXT_HAVE_NEON)
+    while((n + 16) <= len)
+    {
+        if(vmaxvq_u8(vld1q_u8(str + n)) >= 0x80)
+        {
+            break;
+        }
+        n += 16;
+    }
+#endif
+
+    while((n < len) && (str[n] < 0x80))
+    {
+        n++;
+    }
+
+    return n;
+}
+
+/**
+ * Get the character table selected by the first bytes of a text field (A.2)
+ *
+ * @param str text field
+ * @param len text field length
+ * @return character table selection
+ */
+Selection select(const uint8_t* str, size_t len)
+{
+    Selection sel = { Charset::ISO_6937, 0, 0, 0 };
+
+    // No selector, table 00
+    if(!len || (str[0] >= 0x20))
+    {
+        return sel;
+    }
+
+    uint8_t first = str[0];
+    sel.charset = Charset::UNSUPPORTED;
+    sel.headerSize = 1;
+
+    if((first >= 0x01) && (first <= 0x0B))
+    {
+        // ISO/IEC 8859-5..15, there is no part 12
+        sel.part = first + 4;
+        if(sel.part != 12)
+        {
+            sel.charset = Charset::ISO_8859;
+        }
+    }
+    else if(first == 0x10)
+    {
+        // 0x10 0x00 part
+        sel.headerSize = (len < 3) ? len : 3;
+        if((len >= 3) && (str[1] == 0x00) && (str[2] >= 1) && (str[2] <= 15) && (str[2] != 12))
+        {
+            sel.charset = Charset::ISO_8859;
+            sel.part = str[2];
+        }
+    }
+    else if(first == 0x11)
+    {
+        sel.charset = Charset::UTF_16;
+    }
+    else if(first == 0x15)
+    {
+        sel.charset = Charset::UTF_8;
+    }
+    else if((first == 0x1F) && (len >= 2))
+    {
+        // encoding_type_id follows
+        sel.charset = Charset::COMPRESSED;
+        sel.encodingTypeId = str[1];
+        sel.headerSize = 2;
+    }
+
+    return sel;
+}
+
+/**
+ * Register the decompressor of an encoding_type_id, replacing the previous one.
+ * Meant to be called at startup, but it is thread safe.
+ *
+ * @param encodingTypeId encoding_type_id
+ * @param decompressor decompressor, NULL to remove it
+ */
+void registerDecompressor(uint8_t encodingTypeId, const std::shared_ptr<const Decompressor>& decompressor)
+{
+    std::lock_guard<std::mutex> lock(s_decompressorMutex);
+    s_decompressors[encodingTypeId] = decompressor;
+}
+
+/**
+ * Get the decompressor of an encoding_type_id
+ *
+ * @param encodingTypeId encoding_type_id
+ * @return decompressor, NULL if none is registered
+ */
+std::shared_ptr<const Decompressor> getDecompressor(uint8_t encodingTypeId)
+{
+    std::lock_guard<std::mutex> lock(s_decompressorMutex);
+    return s_decompressors[encodingTypeId];
+}
+
+/**
+ * Decode a text field
+ *
+ * @param str text field
+ * @param len text field length
+ * @return decoded text in UTF-8
+ */
+std::string decode(const uint8_t* str, size_t len)
+{
+    if(!str || !len)
+    {
+        return std::string();
+    }
+
+    Selection sel = select(str, len);
+    str += sel.headerSize;
+    len -= sel.headerSize;
+
+    if(sel.charset == Charset::COMPRESSED)
+    {
+        // The expanded text is coded like any other text, but is not compressed again
+        std::shared_ptr<const Decompressor> decompressor = getDecompressor(sel.encodingTypeId);
+        std::string expanded;
+        if(decompressor && decompressor->decompress(str, len, expanded) &&
+           (select((const uint8_t*)expanded.data(), expanded.size()).charset != Charset::COMPRESSED))
+        {
+            return decode((const uint8_t*)expanded.data(), expanded.size());
+        }
+
+        sel.charset = Charset::UNSUPPORTED;
+    }
+
+    // Plain ASCII needs no conversion in any of the byte oriented tables
+    if((sel.charset != Charset::UTF_16) && (getAsciiRun(str, len) == len))
+    {
+        return std::string((const char*)str, len);
+    }
+
+    // First pass: output size, second pass: conversion
+    SizeCounter counter;
+    convert(sel, str, len, counter);
+
+    std::string res(counter.getSize(), '\0');
+    if(!res.empty())
+    {
+        Writer writer(&res[0]);
+        convert(sel, str, len, writer);
+    }
+
+    return res;
+}
+
+} // namespace TextDecoder
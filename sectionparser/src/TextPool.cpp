@@ -0,0 +1,185 @@
+//
+// DVB_SI for Reference Design Kit (RDK)
+//
+// Copyright (C) 2015  Dmitry Barablin & Stan Partridge (stan.partridge@arris.com)
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+
+#include "TextPool.h"
+
+// C system includes
+
+// C++ system includes
+#include <functional>
+
+// Other libraries' includes
+
+// Project's includes
+#include "DvbUtils.h"
+
+/**
+ * Get the process wide pool
+ *
+ * @return pool
+ */
+TextPool& TextPool::getInstance()
+{
+    static TextPool pool;
+    return pool;
+}
+
+/**
+ * Constructor
+ */
+TextPool::TextPool()
+    : m_hitCount(0),
+      m_missCount(0)
+{
+}
+
+/**
+ * Get the decoded text of a coded string (ETSI EN 300 468 annex A), decoding it
+ * only if it is not in the pool yet
+ *
+ * @param text first byte of the coded text
+ * @param len length of the coded text
+ * @return decoded text in UTF-8
+ */
+SharedText TextPool::decode(const uint8_t* text, size_t len)
+{
+    if(!text || len == 0)
+    {
+        return SharedText();
+    }
+
+    return get(CODED_KEY, text, len);
+}
+
+/**
+ * Get the pooled copy of an already decoded text
+ *
+ * @param text UTF-8 text
+ * @return shared text
+ */
+SharedText TextPool::intern(const std::string& text)
+{
+    if(text.empty())
+    {
+        return SharedText();
+    }
+
+    return get(DECODED_KEY, (const uint8_t*)text.data(), text.size());
+}
+
+/**
+ * Get the number of texts in the pool (including expired ones not swept yet)
+ *
+ * @return number of entries
+ */
+size_t TextPool::size()
+{
+    size_t total = 0;
+    for(int i = 0; i < SHARD_COUNT; i++)
+    {
+        std::lock_guard<std::mutex> lock(m_shards[i].mutex);
+        total += m_shards[i].texts.size();
+    }
+
+    return total;
+}
+
+/**
+ * Look a text up, adding it if it is not in the pool or has expired
+ *
+ * @param kind key kind
+ * @param data key bytes
+ * @param len number of key bytes
+ * @return shared text
+ */
+SharedText TextPool::get(KeyKind kind, const uint8_t* data, size_t len)
+{
+    // The key buffer is reused, so lookups of long texts do not allocate
+    static thread_local std::string key;
+    key.assign(1, kind);
+    key.append((const char*)data, len);
+
+    size_t hash = std::hash<std::string>()(key);
+    Shard& shard = m_shards[(hash ^ (hash >> 16)) % SHARD_COUNT];
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.texts.find(key);
+    if(it != shard.texts.end())
+    {
+        std::shared_ptr<const std::string> text = it->second.lock();
+        if(text)
+        {
+            m_hitCount.fetch_add(1, std::memory_order_relaxed);
+            return SharedText(text);
+        }
+    }
+    else
+    {
+        if(shard.texts.size() >= shard.sweepSize)
+        {
+            sweep(shard);
+        }
+
+        it = shard.texts.emplace(key, std::weak_ptr<const std::string>()).first;
+    }
+
+    std::shared_ptr<const std::string> text;
+    if(kind == CODED_KEY)
+    {
+        text = std::make_shared<const std::string>(DecodeText(data, len));
+    }
+    else
+    {
+        text = std::make_shared<const std::string>((const char*)data, len);
+    }
+
+    it->second = text;
+    m_missCount.fetch_add(1, std::memory_order_relaxed);
+
+    return SharedText(text);
+}
+
+/**
+ * Remove the expired entries of a shard (the shard must be locked)
+ *
+ * @param shard pool shard
+ */
+void TextPool::sweep(Shard& shard)
+{
+    for(auto it = shard.texts.begin(); it != shard.texts.end();)
+    {
+        if(it->second.expired())
+        {
+            it = shard.texts.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    // Let the shard double before the next sweep, so sweeping stays amortized O(1)
+    shard.sweepSize = shard.texts.size() * 2;
+    if(shard.sweepSize < MIN_SWEEP_SIZE)
+    {
+        shard.sweepSize = MIN_SWEEP_SIZE;
+    }
+}
@@ -0,0 +1,425 @@
+//
+// DVB_SI for Reference Design Kit (RDK)
+//
+// Copyright (C) 2015  Dmitry Barablin & Stan Partridge (stan.partridge@arris.com)
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+#include "TsDemux.h"
+
+// C system includes
+#include <stdio.h>
+#include <string.h>
+
+// C++ system includes
+
+// Other libraries' includes
+
+// Project's includes
+#include "oswrap.h"
+#include "sectionparser.h"
+
+/**
+ * Constructor. Sections are passed on to the given section parser.
+ *
+ * @param parser section parser
+ */
+TsDemux::TsDemux(SectionParser& parser)
+    : m_context(&parser),
+      m_sectionCb(parseSection),
+      m_packetCount(0),
+      m_sectionCount(0),
+      m_discontinuityCount(0)
+{
+    memset(m_pidIndex, 0, sizeof(m_pidIndex));
+    addSiPids();
+}
+
+/**
+ * Constructor. Sections are passed on to the given callback.
+ *
+ * @param context callback's calling context
+ * @param callback section callback
+ */
+TsDemux::TsDemux(void* context, SectionCallback callback)
+    : m_context(context),
+      m_sectionCb(callback),
+      m_packetCount(0),
+      m_sectionCount(0),
+      m_discontinuityCount(0)
+{
+    memset(m_pidIndex, 0, sizeof(m_pidIndex));
+    addSiPids();
+}
+
+/**
+ * Destructor
+ */
+TsDemux::~TsDemux()
+{
+    for(auto it = m_contexts.begin(), end = m_contexts.end(); it != end; ++it)
+    {
+        delete *it;
+    }
+}
+
+/**
+ * Add the standard DVB SI PIDs to the filter
+ */
+void TsDemux::addSiPids()
+{
+    addPid(static_cast<uint16_t>(SiPid::NIT));
+    addPid(static_cast<uint16_t>(SiPid::SDT_BAT));
+    addPid(static_cast<uint16_t>(SiPid::EIT));
+    addPid(static_cast<uint16_t>(SiPid::TDT_TOT));
+}
+
+/**
+ * SectionParser's section callback
+ */
+void TsDemux::parseSection(void* context, uint16_t pid, uint8_t* data, uint32_t size)
+{
+    static_cast<SectionParser*>(context)->parse(data, size, pid);
+}
+
+/**
+ * Add a PID to the PID filter
+ *
+ * @param pid PID
+ * @return true if the PID was added, false otherwise
+ */
+bool TsDemux::addPid(uint16_t pid)
+{
+    // Sanity check
+    if(pid > MAX_PID)
+    {
+        OS_LOG(DVB_ERROR, "<%s> Invalid pid: 0x%x\n", __FUNCTION__, pid);
+        return false;
+    }
+
+    // Already filtered?
+    if(m_pidIndex[pid])
+    {
+        return true;
+    }
+
+    // Let's reuse a free context first
+    size_t idx = 0;
+    while(idx < m_contexts.size() && m_contexts[idx]->pid <= MAX_PID)
+    {
+        idx++;
+    }
+
+    // The index table can address up to 255 contexts
+    if(idx >= 0xff)
+    {
+        OS_LOG(DVB_ERROR, "<%s> Too many pids, can't add 0x%x\n", __FUNCTION__, pid);
+        return false;
+    }
+
+    if(idx == m_contexts.size())
+    {
+        m_contexts.push_back(new PidContext);
+    }
+
+    PidContext* ctx = m_contexts[idx];
+    ctx->pid = pid;
+    ctx->lastCc = -1;
+    ctx->filled = 0;
+    ctx->expected = 0;
+
+    m_pidIndex[pid] = idx + 1;
+
+    OS_LOG(DVB_DEBUG, "<%s> pid 0x%x added\n", __FUNCTION__, pid);
+    return true;
+}
+
+/**
+ * Remove a PID from the PID filter
+ *
+ * @param pid PID
+ */
+void TsDemux::removePid(uint16_t pid)
+{
+    if(pid > MAX_PID || !m_pidIndex[pid])
+    {
+        return;
+    }
+
+    // Mark the context as free
+    m_contexts[m_pidIndex[pid] - 1]->pid = MAX_PID + 1;
+    m_pidIndex[pid] = 0;
+}
+
+/**
+ * Drop all partially reassembled sections and continuity counter state
+ */
+void TsDemux::reset()
+{
+    for(auto it = m_contexts.begin(), end = m_contexts.end(); it != end; ++it)
+    {
+        (*it)->lastCc = -1;
+        (*it)->filled = 0;
+        (*it)->expected = 0;
+    }
+}
+
+/**
+ * Demultiplex a buffer of TS packets.
+ *
+ * @param data TS data
+ * @param size data size
+ * @return number of bytes consumed
+ */
+size_t TsDemux::demux(uint8_t* data, size_t size)
+{
+    // Sanity check
+    if(!data)
+    {
+        return 0;
+    }
+
+    uint8_t* p = data;
+    uint8_t* end = data + size;
+
+    while((p + TS_PACKET_SIZE) <= end)
+    {
+        if(p[0] == TS_SYNC_BYTE)
+        {
+            demuxPacket(p);
+            p += TS_PACKET_SIZE;
+        }
+        else
+        {
+            // Lost sync. Let's look for the next sync byte that is followed by another one a packet later.
+            OS_LOG(DVB_WARN, "<%s> Sync lost at offset %lu\n", __FUNCTION__, (unsigned long)(p - data));
+            reset();
+
+            p++;
+            while((p + TS_PACKET_SIZE) < end && !(p[0] == TS_SYNC_BYTE && p[TS_PACKET_SIZE] == TS_SYNC_BYTE))
+            {
+                p++;
+            }
+
+            if((p + TS_PACKET_SIZE) >= end)
+            {
+                break;
+            }
+        }
+    }
+
+    return p - data;
+}
+
+/**
+ * Demultiplex a single TS packet
+ *
+ * @param packet TS packet (TS_PACKET_SIZE bytes)
+ */
+void TsDemux::demuxPacket(uint8_t* packet)
+{
+    m_packetCount++;
+
+    // PID filter first, most packets are dropped here
+    uint16_t pid = ((uint16_t)(packet[1] & 0x1f) << 8) | packet[2];
+    uint8_t idx = m_pidIndex[pid];
+    if(!idx)
+    {
+        return;
+    }
+
+    PidContext& ctx = *m_contexts[idx - 1];
+
+    // Transport error indicator
+    if(packet[1] & 0x80)
+    {
+        OS_LOG(DVB_DEBUG, "<%s> pid 0x%x: transport error\n", __FUNCTION__, pid);
+        ctx.filled = 0;
+        ctx.expected = 0;
+        ctx.lastCc = -1;
+        return;
+    }
+
+    bool pusi = packet[1] & 0x40;
+    uint8_t afc = (packet[3] >> 4) & 0x3;
+    int8_t cc = packet[3] & 0xf;
+
+    uint8_t* p = packet + 4;
+    uint8_t* end = packet + TS_PACKET_SIZE;
+    bool discontinuity = false;
+
+    // Adaptation field
+    if(afc & 0x2)
+    {
+        uint8_t afLength = p[0];
+        if(afLength > 0)
+        {
+            discontinuity = p[1] & 0x80;
+        }
+        p += afLength + 1;
+    }
+
+    // No payload (the continuity counter doesn't increment either)
+    if(!(afc & 0x1) || p >= end)
+    {
+        return;
+    }
+
+    // Continuity check
+    if(ctx.lastCc >= 0 && !discontinuity)
+    {
+        if(cc == ctx.lastCc)
+        {
+            // Duplicate packet
+            return;
+        }
+
+        if(cc != ((ctx.lastCc + 1) & 0xf))
+        {
+            OS_LOG(DVB_DEBUG, "<%s> pid 0x%x: cc error %d -> %d\n", __FUNCTION__, pid, ctx.lastCc, cc);
+            m_discontinuityCount++;
+            ctx.filled = 0;
+            ctx.expected = 0;
+        }
+    }
+    ctx.lastCc = cc;
+
+    if(pusi)
+    {
+        uint8_t pointer = p[0];
+        p++;
+
+        if((p + pointer) > end)
+        {
+            OS_LOG(DVB_DEBUG, "<%s> pid 0x%x: invalid pointer_field %d\n", __FUNCTION__, pid, pointer);
+            ctx.filled = 0;
+            ctx.expected = 0;
+            return;
+        }
+
+        // The bytes before the pointer complete the pending section
+        if(ctx.filled)
+        {
+            appendSection(ctx, p, pointer);
+            if(ctx.filled)
+            {
+                OS_LOG(DVB_DEBUG, "<%s> pid 0x%x: section truncated\n", __FUNCTION__, pid);
+                ctx.filled = 0;
+                ctx.expected = 0;
+            }
+        }
+
+        startSections(ctx, p + pointer, end);
+    }
+    else if(ctx.filled)
+    {
+        // The rest of the packet after a completed section is stuffing
+        appendSection(ctx, p, end - p);
+    }
+}
+
+/**
+ * Start new sections at the given position of a packet payload
+ *
+ * @param ctx PID context
+ * @param p payload pointer
+ * @param end end of the payload
+ */
+void TsDemux::startSections(PidContext& ctx, uint8_t* p, uint8_t* end)
+{
+    // 0xff table_id means the rest of the packet is stuffing
+    while(p < end && p[0] != 0xff)
+    {
+        if((end - p) < 3)
+        {
+            // Not even the section header fits into this packet
+            appendSection(ctx, p, end - p);
+            return;
+        }
+
+        uint16_t size = (((uint16_t)(p[1] & 0x0f) << 8) | p[2]) + 3;
+        if(size > MAX_SECTION_SIZE)
+        {
+            OS_LOG(DVB_DEBUG, "<%s> pid 0x%x: invalid section length %d\n", __FUNCTION__, ctx.pid, size);
+            return;
+        }
+
+        if(size <= (end - p))
+        {
+            // The whole section is in this packet, no need to copy it
+            emitSection(ctx.pid, p, size);
+            p += size;
+        }
+        else
+        {
+            appendSection(ctx, p, end - p);
+            return;
+        }
+    }
+}
+
+/**
+ * Append payload to a partially reassembled section
+ *
+ * @param ctx PID context
+ * @param p payload pointer
+ * @param len number of bytes available
+ * @return number of bytes used
+ */
+size_t TsDemux::appendSection(PidContext& ctx, uint8_t* p, size_t len)
+{
+    size_t used = 0;
+
+    // Let's complete the section header first
+    while(ctx.filled < 3 && used < len)
+    {
+        ctx.buffer[ctx.filled++] = p[used++];
+    }
+
+    if(ctx.filled < 3)
+    {
+        return used;
+    }
+
+    if(!ctx.expected)
+    {
+        ctx.expected = (((uint16_t)(ctx.buffer[1] & 0x0f) << 8) | ctx.buffer[2]) + 3;
+        if(ctx.expected > MAX_SECTION_SIZE)
+        {
+            OS_LOG(DVB_DEBUG, "<%s> pid 0x%x: invalid section length %d\n", __FUNCTION__, ctx.pid, ctx.expected);
+            ctx.filled = 0;
+            ctx.expected = 0;
+            return len;
+        }
+    }
+
+    size_t needed = ctx.expected - ctx.filled;
+    size_t count = (len - used) < needed ? (len - used) : needed;
+
+    memcpy(ctx.buffer + ctx.filled, p + used, count);
+    ctx.filled += count;
+    used += count;
+
+    if(ctx.filled == ctx.expected)
+    {
+        uint16_t size = ctx.expected;
+        ctx.filled = 0;
+        ctx.expected = 0;
+        emitSection(ctx.pid, ctx.buffer, size);
+    }
+
+    return used;
+}
@@ -0,0 +1,445 @@
+//
+// DVB_SI for Reference Design Kit (RDK)
+//
+// Copyright (C) 2015  Dmitry Barablin & Stan Partridge (stan.partridge@arris.com)
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+#include "TsFileIngest.h"
+
+// C system includes
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// C++ system includes
+#include <algorithm>
+#include <thread>
+
+// Other libraries' includes
+
+// Project's includes
+#include "sectionparser.h"
+#include "ParserStats.h"
+#include "oswrap.h"
+
+using std::string;
+using std::vector;
+
+namespace
+{
+    /**
+     * Round an address down to a page boundary
+     *
+     * @param p address
+     * @return page address
+     */
+    uint8_t* getPage(uint8_t* p)
+    {
+        static const uintptr_t pageSize = sysconf(_SC_PAGESIZE);
+        return reinterpret_cast<uint8_t*>(reinterpret_cast<uintptr_t>(p) & ~(pageSize - 1));
+    }
+}
+
+/**
+ * Chunk of the file and the sections demuxed out of it
+ */
+struct TsFileIngest::Chunk
+{
+    /**
+     * Section kept in the chunk
+     */
+    struct Section
+    {
+        size_t offset;
+        uint16_t pid;
+        uint16_t size;
+    };
+
+    uint8_t* start;
+    uint8_t* end;
+
+    /**
+     * Sections, back to back
+     */
+    vector<uint8_t> data;
+    vector<Section> sections;
+
+    uint64_t packets;
+    uint64_t discontinuities;
+
+    /**
+     * Set by the worker once demuxed, under m_mutex
+     */
+    bool done;
+};
+
+/**
+ * Constructor. The standard DVB SI PIDs are filtered, one worker per CPU core.
+ */
+TsFileIngest::TsFileIngest()
+    : m_threads(0),
+      m_chunkSize(DEFAULT_CHUNK_SIZE),
+      m_data(NULL),
+      m_size(0),
+      m_next(0),
+      m_handed(0)
+{
+    m_pids.push_back(static_cast<uint16_t>(SiPid::NIT));
+    m_pids.push_back(static_cast<uint16_t>(SiPid::SDT_BAT));
+    m_pids.push_back(static_cast<uint16_t>(SiPid::EIT));
+    m_pids.push_back(static_cast<uint16_t>(SiPid::TDT_TOT));
+    setThreadCount(0);
+}
+
+/**
+ * Destructor
+ */
+TsFileIngest::~TsFileIngest()
+{
+}
+
+/**
+ * Add a PID to the PID filter
+ *
+ * @param pid PID
+ * @return true if the PID was added, false otherwise
+ */
+bool TsFileIngest::addPid(uint16_t pid)
+{
+    if(pid > TsDemux::MAX_PID)
+    {
+        OS_LOG(DVB_ERROR, "<%s> Invalid pid: 0x%x\n", __FUNCTION__, pid);
+        return false;
+    }
+
+    if(std::find(m_pids.begin(), m_pids.end(), pid) == m_pids.end())
+    {
+        m_pids.push_back(pid);
+    }
+    return true;
+}
+
+/**
+ * Set the number of worker threads
+ *
+ * @param threads thread count, 0 for one per CPU core
+ */
+void TsFileIngest::setThreadCount(size_t threads)
+{
+    if(threads == 0)
+    {
+        threads = std::thread::hardware_concurrency();
+        if(threads == 0)
+        {
+            threads = 1;
+        }
+    }
+    m_threads = threads;
+}
+
+/**
+ * Set the chunk size
+ *
+ * @param bytes size of a chunk (a packet boundary is looked for from there on)
+ */
+void TsFileIngest::setChunkSize(size_t bytes)
+{
+    m_chunkSize = std::max(bytes, static_cast<size_t>(TsDemux::TS_PACKET_SIZE * RESYNC_PACKETS));
+}
+
+/**
+ * Ingest a capture file into a parser
+ *
+ * @param filename TS file
+ * @param parser parser
+ * @param stats filled with the ingest statistics
+ * @return false if the file could not be mapped, true otherwise
+ */
+bool TsFileIngest::ingest(const string& filename, SectionParser& parser, TsIngestStats& stats)
+{
+    return ingest(filename, parseSection, &parser, stats);
+}
+
+/**
+ * Ingest a capture file
+ *
+ * @param filename TS file
+ * @param callback called for every section, on the calling thread
+ * @param context callback context
+ * @param stats filled with the ingest statistics
+ * @return false if the file could not be mapped, true otherwise
+ */
+bool TsFileIngest::ingest(const string& filename, SectionCallback callback, void* context, TsIngestStats& stats)
+{
+    memset(&stats, 0, sizeof(stats));
+    uint64_t start = ParserStats::now();
+
+    int fd = open(filename.c_str(), O_RDONLY);
+    if(fd < 0)
+    {
+        OS_LOG(DVB_ERROR, "<%s> cannot open %s: %s\n", __FUNCTION__, filename.c_str(), strerror(errno));
+        return false;
+    }
+
+    struct stat st;
+    void* map = MAP_FAILED;
+    if(fstat(fd, &st) == 0 && st.st_size > 0)
+    {
+        // Private and writable: TsDemux takes non-const data, nothing is written back
+        map = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+
+    if(map == MAP_FAILED)
+    {
+        OS_LOG(DVB_ERROR, "<%s> cannot map %s: %s\n", __FUNCTION__, filename.c_str(), strerror(errno));
+        return false;
+    }
+
+    m_data = static_cast<uint8_t*>(map);
+    m_size = st.st_size;
+    madvise(m_data, m_size, MADV_SEQUENTIAL);
+
+    // Chunks start on packet boundaries
+    uint8_t* end = m_data + m_size;
+    for(uint8_t* p = findSync(m_data, end); p < end;)
+    {
+        uint8_t* next = (static_cast<size_t>(end - p) > m_chunkSize) ? findSync(p + m_chunkSize, end) : end;
+
+        std::unique_ptr<Chunk> chunk(new Chunk);
+        chunk->start = p;
+        chunk->end = next;
+        chunk->packets = 0;
+        chunk->discontinuities = 0;
+        chunk->done = false;
+        m_chunks.push_back(std::move(chunk));
+        p = next;
+    }
+
+    m_next = 0;
+    m_handed = 0;
+    vector<std::thread> workers;
+    for(size_t i = 0; i < std::min(m_threads, m_chunks.size()); i++)
+    {
+        workers.push_back(std::thread(&TsFileIngest::workerThread, this));
+    }
+
+    for(size_t i = 0; i < m_chunks.size(); i++)
+    {
+        Chunk& chunk = *m_chunks[i];
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [&chunk] { return chunk.done; });
+        }
+
+        for(auto it = chunk.sections.begin(), sectionsEnd = chunk.sections.end(); it != sectionsEnd; ++it)
+        {
+            callback(context, it->pid, chunk.data.data() + it->offset, it->size);
+        }
+
+        stats.packets += chunk.packets;
+        stats.sections += chunk.sections.size();
+        stats.discontinuities += chunk.discontinuities;
+        vector<uint8_t>().swap(chunk.data);
+        vector<Chunk::Section>().swap(chunk.sections);
+
+        // Every worker is past the chunk: its pages can go, the mapping of a multi-GB file does
+        // not have to stay resident
+        madvise(getPage(chunk.start), getPage(chunk.end) - getPage(chunk.start), MADV_DONTNEED);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_handed = i + 1;
+        }
+        m_condition.notify_all();
+    }
+
+    for(auto it = workers.begin(), workersEnd = workers.end(); it != workersEnd; ++it)
+    {
+        it->join();
+    }
+
+    stats.bytes = m_size;
+    stats.chunks = m_chunks.size();
+    m_chunks.clear();
+    munmap(m_data, m_size);
+    m_data = NULL;
+    m_size = 0;
+
+    stats.time = ParserStats::now() - start;
+    OS_LOG(DVB_INFO, "<%s> %s: %llu packets, %llu sections in %llu ms\n", __FUNCTION__, filename.c_str(),
+           (unsigned long long)stats.packets, (unsigned long long)stats.sections,
+           (unsigned long long)(stats.time / 1000000));
+    return true;
+}
+
+/**
+ * Find a packet boundary
+ *
+ * @param p where to start looking
+ * @param end end of the data
+ * @return first packet boundary at p or later, end if there is none
+ */
+uint8_t* TsFileIngest::findSync(uint8_t* p, uint8_t* end)
+{
+    while(p < end)
+    {
+        p = static_cast<uint8_t*>(memchr(p, TsDemux::TS_SYNC_BYTE, end - p));
+        if(!p)
+        {
+            return end;
+        }
+
+        // Confirmed by the next sync bytes, or by as many as there are before the end of the file
+        size_t n = 1;
+        while(n < RESYNC_PACKETS && (p + n * TsDemux::TS_PACKET_SIZE) < end &&
+              p[n * TsDemux::TS_PACKET_SIZE] == TsDemux::TS_SYNC_BYTE)
+        {
+            n++;
+        }
+        if(n == RESYNC_PACKETS || (p + n * TsDemux::TS_PACKET_SIZE) >= end)
+        {
+            return p;
+        }
+        p++;
+    }
+    return end;
+}
+
+/**
+ * Demuxes the chunks until there are none left
+ */
+void TsFileIngest::workerThread()
+{
+    // Demuxed sections are held until handed on: stay within a window of chunks ahead
+    size_t window = 2 * m_threads;
+
+    while(true)
+    {
+        size_t index = m_next.fetch_add(1);
+        if(index >= m_chunks.size())
+        {
+            return;
+        }
+
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this, index, window] { return index < m_handed + window; });
+        }
+
+        Chunk& chunk = *m_chunks[index];
+        demuxChunk(chunk);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            chunk.done = true;
+        }
+        m_condition.notify_all();
+    }
+}
+
+/**
+ * Demux a chunk
+ *
+ * @param chunk chunk
+ */
+void TsFileIngest::demuxChunk(Chunk& chunk)
+{
+    madvise(getPage(chunk.start), chunk.end - getPage(chunk.start), MADV_WILLNEED);
+
+    TsDemux demux(&chunk, keepSection);
+    for(auto it = m_pids.begin(), end = m_pids.end(); it != end; ++it)
+    {
+        demux.addPid(*it);
+    }
+
+    demux.demux(chunk.start, chunk.end - chunk.start);
+    chunk.packets = demux.getPacketCount();
+    chunk.discontinuities = demux.getDiscontinuityCount();
+
+    // Sections crossing the end of the chunk: demux on into the next one until they are
+    // complete. That chunk starts with the first section beginning in it, so the payload after
+    // the pointer_field of a packet starting a section is not this chunk's, it is stuffed.
+    vector<uint16_t> pending;
+    for(auto it = m_pids.begin(), end = m_pids.end(); it != end; ++it)
+    {
+        if(demux.hasPendingSection(*it))
+        {
+            pending.push_back(*it);
+        }
+    }
+
+    uint8_t* fileEnd = m_data + m_size;
+    uint8_t packet[TsDemux::TS_PACKET_SIZE];
+    uint8_t* packetEnd = packet + TsDemux::TS_PACKET_SIZE;
+    for(uint8_t* p = chunk.end; !pending.empty() && (p + TsDemux::TS_PACKET_SIZE) <= fileEnd &&
+        p[0] == TsDemux::TS_SYNC_BYTE; p += TsDemux::TS_PACKET_SIZE)
+    {
+        uint16_t pid = ((uint16_t)(p[1] & 0x1f) << 8) | p[2];
+        auto it = std::find(pending.begin(), pending.end(), pid);
+        if(it == pending.end())
+        {
+            continue;
+        }
+
+        memcpy(packet, p, TsDemux::TS_PACKET_SIZE);
+        if(packet[1] & 0x40)
+        {
+            uint8_t* payload = packet + 4;
+            if(packet[3] & 0x20)
+            {
+                payload += payload[0] + 1;
+            }
+            if(payload < packetEnd && (payload + 1 + payload[0]) < packetEnd)
+            {
+                memset(payload + 1 + payload[0], 0xff, packetEnd - (payload + 1 + payload[0]));
+            }
+        }
+
+        demux.demuxPacket(packet);
+        if(!demux.hasPendingSection(pid))
+        {
+            pending.erase(it);
+        }
+    }
+}
+
+/**
+ * TsDemux section callback: keeps the section in the chunk
+ */
+void TsFileIngest::keepSection(void* context, uint16_t pid, uint8_t* data, uint32_t size)
+{
+    Chunk* chunk = static_cast<Chunk*>(context);
+
+    Chunk::Section section;
+    section.offset = chunk->data.size();
+    section.pid = pid;
+    section.size = size;
+    chunk->sections.push_back(section);
+    chunk->data.insert(chunk->data.end(), data, data + size);
+}
+
+/**
+ * SectionParser's section callback
+ */
+void TsFileIngest::parseSection(void* context, uint16_t pid, uint8_t* data, uint32_t size)
+{
+    static_cast<SectionParser*>(context)->parse(data, size, pid);
+}
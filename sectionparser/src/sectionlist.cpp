@@ -20,8 +20,10 @@
 
 #include "sectionlist.h"
 
+// C system includes
+#include <string.h>
+
 // C++ system includes
-#include <algorithm>
 #include <sstream>
 
 // Other libraries' includes
@@ -34,24 +36,37 @@
 #include "SdtTable.h"
 #include "EitTable.h"
 #include "TotTable.h"
+#include "SiTablePool.h"
+#include "SiLayouts.h"
 
 // Using declarations
-using std::list;
 using std::string;
 using std::vector;
 
 /**
  * Constructor
- *
- * @param data section data
- * @param len data length
  */
-Section::Section(uint8_t* data, size_t len)
-    : extensionId(0),
+SectionHeader::SectionHeader()
+    : tableId(0),
+      syntax(false),
+      length(0),
+      extensionId(0),
       version(0),
       current(true),
       number(0),
       lastNumber(0)
+{
+}
+
+/**
+ * Constructor
+ *
+ * @param data section data
+ * @param len data length
+ */
+SectionView::SectionView(uint8_t* data, size_t len)
+    : payload(NULL),
+      payloadSize(0)
 {
     // Sanity check
     if(!data || len < 3)
@@ -61,44 +76,53 @@ Section::Section(uint8_t* data, size_t len)
         return;
     }
 
+    typedef SiLayout::SectionHeader Header;
+    typedef SiLayout::SyntaxSectionHeader SyntaxHeader;
+
     // Table Identifier
-    tableId = data[0];
+    tableId = Header::TableId::get(data);
 
     //Section syntax indicator
-    syntax = data[1] & 0x80;
+    syntax = Header::SectionSyntaxIndicator::get(data);
 
     // Section length
-    length = ((uint16_t)(data[1] & 0xf)) << 8 | data[2];
+    length = Header::SectionLength::get(data);
 
-    uint8_t offset = 3;
+    uint8_t offset = Header::SIZE;
 
     // Let's check the syntax
     if(syntax)
     {
-        // Table ID extension
-        extensionId = (data[3] << 8) | data[4];
+        // The payload check below rejects truncated headers
+        if(SyntaxHeader::fits(data, data + len))
+        {
+            // Table ID extension
+            extensionId = SyntaxHeader::TableIdExtension::get(data);
 
-        // Version number
-        version = (data[5] >> 1) & 0x1f;
+            // Version number
+            version = SyntaxHeader::VersionNumber::get(data);
 
-        // Current/next indicator
-        current = data[5] & 1;
+            // Current/next indicator
+            current = SyntaxHeader::CurrentNextIndicator::get(data);
 
-        // Section number
-        number = data[6];
+            // Section number
+            number = SyntaxHeader::SectionNumber::get(data);
 
-        // Last section number
-        lastNumber = data[7];
-        offset = 8;
+            // Last section number
+            lastNumber = SyntaxHeader::LastSectionNumber::get(data);
+        }
+        offset = SyntaxHeader::SIZE;
     }
 
     OS_LOG(DVB_TRACE3, "<%s> tableId = 0x%x, extId = 0x%x, length = %d, len = %d\n",
             __FUNCTION__, tableId, extensionId, length, len);
 
-    // Let's read the payload
-    if((offset < len) && ((length + 3) <= len))
+    // Let's locate the payload
+    size_t sectionSize = static_cast<size_t>(length) + 3;
+    if((offset < len) && (offset <= sectionSize) && (sectionSize <= len))
     {
-        payload.assign(data + offset, data + length + 3);
+        payload = data + offset;
+        payloadSize = sectionSize - offset;
     }
     else
     {
@@ -112,8 +136,14 @@ Section::Section(uint8_t* data, size_t len)
  */
 SectionList::SectionList()
     : m_complete(false),
-      m_firstReceivedNumber(0)
+      m_receivedCount(0),
+      m_expectedCount(0),
+      m_knownSegments(0),
+      m_neededSegments(0),
+      m_builtSegments(0)
 {
+    memset(m_received, 0, sizeof(m_received));
+    memset(m_expected, 0, sizeof(m_expected));
 }
 
 /**
@@ -128,25 +158,41 @@ SectionList::~SectionList()
  *
  * @param section SI section
  */
-void SectionList::init(Section& section)
+void SectionList::init(const SectionView& section)
 {
-    // Let's init the list
-    m_sectionList.clear();
-    m_sectionList.push_front(section);
+    // Let's init the list (the buffers keep their capacity)
+    m_header = section;
+    m_payloadBuffer.clear();
+    m_slots.resize((size_t)section.lastNumber + 1);
 
-    // Let's set the new section number
-    m_firstReceivedNumber = section.number;
+    memset(m_received, 0, sizeof(m_received));
+    memset(m_expected, 0, sizeof(m_expected));
+    m_receivedCount = 0;
+    m_expectedCount = 0;
+    m_builtSegments = 0;
 
-    // We need to handle EIT sections differently
     if(!isEit(section.tableId))
     {
-        m_complete = complete(section);
+        // Every section up to last_section_number is needed
+        for(uint32_t n = 0; n <= section.lastNumber; n++)
+        {
+            m_expected[n >> 5] |= 1u << (n & 0x1f);
+        }
+        m_expectedCount = section.lastNumber + 1;
+        m_knownSegments = 0;
+        m_neededSegments = 0;
     }
     else
     {
-        // Don't check after receiving the first EIT section
-        m_complete =  false;
+        // EIT sections are grouped in segments of 8. A segment contributes sections up to its
+        // segment_last_section_number, which is known once a section of the segment is received.
+        uint32_t segments = (section.lastNumber >> 3) + 1;
+        m_knownSegments = 0;
+        m_neededSegments = (segments == 32) ? 0xffffffff : ((1u << segments) - 1);
     }
+
+    insert(section);
+    m_complete = complete();
 }
 
 /**
@@ -155,16 +201,16 @@ void SectionList::init(Section& section)
  * @param section
  * @return true if the section was added successfully
  */
-bool SectionList::add(Section& section)
+bool SectionList::add(const SectionView& section)
 {
     // empty?
-    if(!m_sectionList.empty())
+    if(m_receivedCount)
     {
         // Let's check if syntax indicator is on or not
-        if(m_sectionList.front().syntax)
+        if(m_header.syntax)
         {
             // Table ID extenstion should match
-            if(m_sectionList.front().extensionId != section.extensionId)
+            if(m_header.extensionId != section.extensionId)
             {
                 OS_LOG(DVB_DEBUG, "<%s> 0x%x.0x%x: ext_id mismatch\n", __FUNCTION__, section.tableId, section.extensionId);
                 // Ext id doesn't match
@@ -172,8 +218,8 @@ bool SectionList::add(Section& section)
             }
 
             // Let's check for version and/or last section number mismatch
-            if((m_sectionList.front().version != section.version) ||
-               (m_sectionList.front().lastNumber != section.lastNumber))
+            if((m_header.version != section.version) ||
+               (m_header.lastNumber != section.lastNumber))
             {
                 OS_LOG(DVB_DEBUG, "<%s> 0x%x.0x%x: version or last section number mismatch\n", __FUNCTION__, section.tableId, section.extensionId);
                 init(section);
@@ -181,7 +227,7 @@ bool SectionList::add(Section& section)
             }
 
             // If we have an already complete version of the table, we can ignore the incoming section
-            if(m_complete && (m_sectionList.front().version == section.version))
+            if(m_complete)
             {
                 OS_LOG(DVB_DEBUG, "<%s> 0x%x.0x%x: ignoring (same version, table already complete)\n", __FUNCTION__, section.tableId, section.extensionId);
                 // Ignore
@@ -206,7 +252,7 @@ bool SectionList::add(Section& section)
     insert(section);
 
     // Let's update the completeness flag
-    m_complete = complete(section);
+    m_complete = complete();
 
     return true;
 }
@@ -216,29 +262,130 @@ bool SectionList::add(Section& section)
  *
  * @param section SI section
  */
-void SectionList::insert(Section& section)
+void SectionList::insert(const SectionView& section)
 {
-    auto it = m_sectionList.begin();
-    auto end = m_sectionList.end();
+    // Duplicates and section numbers beyond last_section_number are ignored
+    if((section.number >= m_slots.size()) || isReceived(section.number))
+    {
+        return;
+    }
+
+    m_slots[section.number] = store(section);
+    m_received[section.number >> 5] |= 1u << (section.number & 0x1f);
+    m_receivedCount++;
 
-    // Let's keep the section numbers sorted in the list
-    while(it != end)
+    if(isEit(section.tableId) && !(m_knownSegments & (1u << (section.number >> 3))))
     {
-        if(it->number == section.number)
+        addSegment(section);
+    }
+}
+
+/**
+ * Mark the sections of an EIT segment as expected
+ *
+ * @param section first section received from the segment
+ */
+void SectionList::addSegment(const SectionView& section)
+{
+    uint8_t segment = section.number >> 3;
+    uint8_t first = segment << 3;
+    uint8_t last = section.number;
+
+    // segment_last_section_number
+    if(section.payload && section.payloadSize > 4)
+    {
+        last = section.payload[4];
+    }
+
+    // It must point into the same segment and within the table
+    if((last >> 3) != segment || last < section.number || last > m_header.lastNumber)
+    {
+        OS_LOG(DVB_DEBUG, "<%s> 0x%x.0x%x: invalid segment_last_section_number %d in section %d\n",
+                __FUNCTION__, section.tableId, section.extensionId, last, section.number);
+        last = section.number;
+    }
+
+    for(uint32_t n = first; n <= last; n++)
+    {
+        m_expected[n >> 5] |= 1u << (n & 0x1f);
+    }
+
+    m_expectedCount += last - first + 1;
+    m_knownSegments |= 1u << segment;
+}
+
+/**
+ * Copy the section into the payload buffer
+ *
+ * @param section SI section
+ * @return the stored section
+ */
+Section SectionList::store(const SectionView& section)
+{
+    Section stored;
+    static_cast<SectionHeader&>(stored) = section;
+    stored.payloadOffset = m_payloadBuffer.size();
+    stored.payloadSize = section.payloadSize;
+
+    if(section.payloadSize)
+    {
+        m_payloadBuffer.insert(m_payloadBuffer.end(), section.payload, section.payload + section.payloadSize);
+    }
+
+    return stored;
+}
+
+/**
+ * Copy the table data of the received sections firstNumber..lastNumber into a descriptor buffer,
+ * in section number order, so the table's descriptors can refer to it
+ *
+ * @param buffer descriptor buffer
+ * @param firstNumber first section number
+ * @param lastNumber last section number
+ * @return copy of the first section's table data, followed by the others
+ */
+uint8_t* SectionList::copyPayloads(DescriptorBuffer& buffer, uint32_t firstNumber, uint32_t lastNumber)
+{
+    size_t count = (lastNumber < m_slots.size()) ? (lastNumber + 1) : m_slots.size();
+
+    size_t size = 0;
+    for(size_t n = firstNumber; n < count; n++)
+    {
+        if(isReceived(n))
         {
-            // Do nothing
-            return;
+            size += m_slots[n].payloadSize;
         }
-        else if(it->number > section.number)
+    }
+
+    uint8_t *data = buffer.allocate(size);
+    uint8_t *p = data;
+    for(size_t n = firstNumber; n < count; n++)
+    {
+        if(isReceived(n) && m_slots[n].payloadSize)
         {
-            m_sectionList.insert(it, section);
-            return;
+            memcpy(p, getPayload(m_slots[n]), m_slots[n].payloadSize);
+            p += m_slots[n].payloadSize;
         }
+    }
+
+    return data;
+}
 
-        ++it;
+/**
+ * Get the size of the table data of a stored section, without the CRC_32
+ *
+ * @param section stored section
+ * @return table data size
+ */
+uint16_t SectionList::getTableDataSize(const Section& section)
+{
+    // Syntax sections and the TOT end with a CRC_32
+    if(section.syntax || (static_cast<TableId>(section.tableId) == TableId::TOT))
+    {
+        return (section.payloadSize > SiLayout::CRC_32_SIZE) ? (section.payloadSize - SiLayout::CRC_32_SIZE) : 0;
     }
 
-    m_sectionList.push_back(section);
+    return section.payloadSize;
 }
 
 /**
@@ -248,43 +395,81 @@ void SectionList::insert(Section& section)
  */
 NitTable* SectionList::buildNit()
 {
-    // Let's create the table object
-    NitTable *nit = new NitTable(m_sectionList.front().tableId, m_sectionList.front().extensionId,
-                                 m_sectionList.front().version, m_sectionList.front().current);
+    typedef SiLayout::LoopLength LoopLength;
+    typedef SiLayout::TransportStreamEntry TsEntry;
+
+    // Let's get a table object from the pool
+    NitTable *nit = static_cast<NitTable*>(SiTablePool::getInstance().acquire(m_header.tableId, m_header.extensionId,
+                                 m_header.version, m_header.current));
+
+    // The descriptors refer to the table's own copy of the section data
+    DescriptorBufferPtr buffer = nit->getDescriptorBuffer();
+    uint8_t *data = copyPayloads(*buffer);
 
     // Time to parse the sections one by one
-    for(auto it = m_sectionList.begin(), end = m_sectionList.end(); it != end; ++it)
+    for(size_t n = 0, count = m_slots.size(); n < count; n++)
     {
+        if(!isReceived(n))
+        {
+            continue;
+        }
+
+        const Section& sec = m_slots[n];
+
         // Network descriptors
-        uint8_t *p = it->payload.data();
+        uint8_t *p = sec.payloadSize ? data : NULL;
+        data += sec.payloadSize;
         if(!p)
         {
             continue;
         }
 
-        uint16_t netDescLength = (((uint16_t)(p[0] & 0x0f) << 8) | p[1]);
-        p += 2;
+        uint8_t *payloadEnd = p + getTableDataSize(sec);
+        if(!LoopLength::fits(p, payloadEnd))
+        {
+            continue;
+        }
+
+        uint16_t netDescLength = LoopLength::Length::get(p);
+        p += LoopLength::SIZE;
+
+        // Boundary check
+        if((p + netDescLength) > payloadEnd)
+        {
+            continue;
+        }
 
-        nit->addNetworkDescriptors(MpegDescriptor::parseDescriptors(p, netDescLength));
+        nit->addNetworkDescriptors(MpegDescriptor::parseDescriptors(p, netDescLength, buffer));
 
         p += netDescLength;
 
         // Transport streams
-        uint16_t tsLoopLength = (((uint16_t)(p[0] & 0x0f) << 8) | p[1]);
+        if(!LoopLength::fits(p, payloadEnd))
+        {
+            continue;
+        }
 
-        p += 2;
-        uint8_t *end = p + tsLoopLength;
+        uint16_t tsLoopLength = LoopLength::Length::get(p);
+
+        p += LoopLength::SIZE;
+        uint8_t *loopEnd = (tsLoopLength <= (payloadEnd - p)) ? (p + tsLoopLength) : payloadEnd;
 
         // ts_id(2 bytes) + orig_net_id(2 bytes) + ts_desc_len(2 bytes)
-        while((p + 6) <= end)
+        while(TsEntry::fits(p, loopEnd))
         {
-            // TS constructor takes ts_id(2 bytes) and orig_net_id(2 bytes) parameters
-            TransportStream ts(((uint16_t)p[0] << 8) | p[1], ((uint16_t)p[2] << 8) | p[3]);
+            TransportStream ts(TsEntry::TransportStreamId::get(p), TsEntry::OriginalNetworkId::get(p));
+
+            uint16_t tsDescLength = TsEntry::DescriptorsLength::get(p);
+
+            p += TsEntry::SIZE;
 
-            uint16_t tsDescLength = ((uint16_t)(p[4] & 0x0f) << 8) | p[5];
+            // Boundary check
+            if((p + tsDescLength) > loopEnd)
+            {
+                break;
+            }
 
-            p += 6;
-            ts.addDescriptors(MpegDescriptor::parseDescriptors(p, tsDescLength));
+            ts.addDescriptors(MpegDescriptor::parseDescriptors(p, tsDescLength, buffer));
             nit->addTransportStream(ts);
 
             p += tsDescLength;
@@ -301,43 +486,81 @@ NitTable* SectionList::buildNit()
  */
 BatTable* SectionList::buildBat()
 {
-    // Let's create the table object
-    BatTable *bat = new BatTable(m_sectionList.front().tableId, m_sectionList.front().extensionId,
-                                 m_sectionList.front().version, m_sectionList.front().current);
+    typedef SiLayout::LoopLength LoopLength;
+    typedef SiLayout::TransportStreamEntry TsEntry;
+
+    // Let's get a table object from the pool
+    BatTable *bat = static_cast<BatTable*>(SiTablePool::getInstance().acquire(m_header.tableId, m_header.extensionId,
+                                 m_header.version, m_header.current));
+
+    // The descriptors refer to the table's own copy of the section data
+    DescriptorBufferPtr buffer = bat->getDescriptorBuffer();
+    uint8_t *data = copyPayloads(*buffer);
 
     // Time to parse the sections one by one
-    for(auto it = m_sectionList.begin(), end = m_sectionList.end(); it != end; ++it)
+    for(size_t n = 0, count = m_slots.size(); n < count; n++)
     {
+        if(!isReceived(n))
+        {
+            continue;
+        }
+
+        const Section& sec = m_slots[n];
+
         // Bouquet descriptors
-        uint8_t *p = it->payload.data();
+        uint8_t *p = sec.payloadSize ? data : NULL;
+        data += sec.payloadSize;
         if(!p)
         {
             continue;
         }
 
-        uint16_t bouquetDescLength = (((uint16_t)(p[0] & 0x0f) << 8) | p[1]);
-        p += 2;
+        uint8_t *payloadEnd = p + getTableDataSize(sec);
+        if(!LoopLength::fits(p, payloadEnd))
+        {
+            continue;
+        }
 
-        bat->addBouquetDescriptors(MpegDescriptor::parseDescriptors(p, bouquetDescLength));
+        uint16_t bouquetDescLength = LoopLength::Length::get(p);
+        p += LoopLength::SIZE;
+
+        // Boundary check
+        if((p + bouquetDescLength) > payloadEnd)
+        {
+            continue;
+        }
+
+        bat->addBouquetDescriptors(MpegDescriptor::parseDescriptors(p, bouquetDescLength, buffer));
 
         p += bouquetDescLength;
 
         // Transport streams
-        uint16_t tsLoopLength = (((uint16_t)(p[0] & 0x0f) << 8) | p[1]);
+        if(!LoopLength::fits(p, payloadEnd))
+        {
+            continue;
+        }
+
+        uint16_t tsLoopLength = LoopLength::Length::get(p);
 
-        p += 2;
-        uint8_t *end = p + tsLoopLength;
+        p += LoopLength::SIZE;
+        uint8_t *loopEnd = (tsLoopLength <= (payloadEnd - p)) ? (p + tsLoopLength) : payloadEnd;
 
         // ts_id(2 bytes) + orig_net_id(2 bytes) + ts_desc_len(2 bytes)
-        while((p + 6) <= end)
+        while(TsEntry::fits(p, loopEnd))
         {
-            // TS constructor takes ts_id(2 bytes) and orig_net_id(2 bytes) parameters
-            TransportStream ts(((uint16_t)p[0] << 8) | p[1], ((uint16_t)p[2] << 8) | p[3]);
+            TransportStream ts(TsEntry::TransportStreamId::get(p), TsEntry::OriginalNetworkId::get(p));
 
-            uint16_t tsDescLength = ((uint16_t)(p[4] & 0x0f) << 8) | p[5];
+            uint16_t tsDescLength = TsEntry::DescriptorsLength::get(p);
+
+            p += TsEntry::SIZE;
+
+            // Boundary check
+            if((p + tsDescLength) > loopEnd)
+            {
+                break;
+            }
 
-            p += 6;
-            ts.addDescriptors(MpegDescriptor::parseDescriptors(p, tsDescLength));
+            ts.addDescriptors(MpegDescriptor::parseDescriptors(p, tsDescLength, buffer));
             bat->addTransportStream(ts);
 
             p += tsDescLength;
@@ -354,43 +577,63 @@ BatTable* SectionList::buildBat()
  */
 SdtTable* SectionList::buildSdt()
 {
-    // Let's create the table object
-    SdtTable *sdt = new SdtTable(m_sectionList.front().tableId, m_sectionList.front().extensionId,
-                                 m_sectionList.front().version, m_sectionList.front().current);
+    typedef SiLayout::SdtHeader Header;
+    typedef SiLayout::SdtServiceEntry ServiceEntry;
+
+    // Let's get a table object from the pool
+    SdtTable *sdt = static_cast<SdtTable*>(SiTablePool::getInstance().acquire(m_header.tableId, m_header.extensionId,
+                                 m_header.version, m_header.current));
+
+    const Section& firstSec = m_slots[getFirstNumber()];
+    const uint8_t *first = getPayload(firstSec);
+    if(first && Header::fits(first, first + getTableDataSize(firstSec)))
+    {
+        sdt->setOriginalNetworkId(Header::OriginalNetworkId::get(first));
+    }
 
-    sdt->setOriginalNetworkId(((uint16_t)(m_sectionList.front().payload[0]) << 8) | m_sectionList.front().payload[1]);
+    OS_LOG(DVB_DEBUG, "<%s> SDT: orig_net_id = 0x%x, payload size = %d\n", __FUNCTION__, sdt->getOriginalNetworkId(), firstSec.payloadSize);
 
-    OS_LOG(DVB_DEBUG, "<%s> SDT: orig_net_id = 0x%x, payload size = %d\n", __FUNCTION__, sdt->getOriginalNetworkId(), m_sectionList.front().payload.size());
+    // The descriptors refer to the table's own copy of the section data
+    DescriptorBufferPtr buffer = sdt->getDescriptorBuffer();
+    uint8_t *data = copyPayloads(*buffer);
 
     // Time to parse the sections one by one
-    for(auto it = m_sectionList.begin(), end = m_sectionList.end(); it != end; ++it)
+    for(size_t n = 0, count = m_slots.size(); n < count; n++)
     {
-        uint8_t *p = it->payload.data();
+        if(!isReceived(n))
+        {
+            continue;
+        }
+
+        const Section& sec = m_slots[n];
+
+        uint8_t *p = sec.payloadSize ? data : NULL;
+        data += sec.payloadSize;
         if(!p)
         {
             // let's ignore "empty" sections
             continue;
         }
 
-        uint8_t *payloadEnd = p + it->payload.size();
+        uint8_t *payloadEnd = p + getTableDataSize(sec);
 
         // Skip original_network_id bytes and reserved byte
-        p += 3;
-        while((p + 4) < payloadEnd)
+        p += Header::SIZE;
+        while(ServiceEntry::fits(p, payloadEnd))
         {
             // Let's extract the data out of the section
-            uint16_t serviceId    = ((uint16_t)(p[0]) << 8) | p[1];
-            bool eitSchedule      = ((p[2] & 0x2) >> 1);
-            bool eitPresent       =  ((p[2]) & 0x1);
-            uint8_t runningStatus = (uint8_t)(p[3]) >> 5;
-            bool isScrambled      = ((p[3] & 0x10) >> 4);
-            uint16_t descLength   = ((uint16_t)(p[3] & 0xf) << 8) | p[4];
+            uint16_t serviceId    = ServiceEntry::ServiceId::get(p);
+            bool eitSchedule      = ServiceEntry::EitScheduleFlag::get(p);
+            bool eitPresent       = ServiceEntry::EitPresentFollowingFlag::get(p);
+            uint8_t runningStatus = ServiceEntry::RunningStatus::get(p);
+            bool isScrambled      = ServiceEntry::FreeCaMode::get(p);
+            uint16_t descLength   = ServiceEntry::DescriptorsLength::get(p);
 
             // Let's now make a DvbService object using the extracted data
             DvbService service(serviceId, eitSchedule, eitPresent, runningStatus, isScrambled);
             OS_LOG(DVB_DEBUG, "<%s> SDT: service_id = 0x%x, desc len = %d, run_st = %d, isScrambled = %d, eitSchedule = %d\n",
                     __FUNCTION__, serviceId, descLength, runningStatus, isScrambled, eitSchedule);
-            p += 5;
+            p += ServiceEntry::SIZE;
 
             // Boundary check
             if((p + descLength) > payloadEnd)
@@ -398,7 +641,7 @@ SdtTable* SectionList::buildSdt()
                 break;
             }
 
-            service.addDescriptors(MpegDescriptor::parseDescriptors(p, descLength));
+            service.addDescriptors(MpegDescriptor::parseDescriptors(p, descLength, buffer));
             sdt->addService(service);
 
             p += descLength;
@@ -411,43 +654,64 @@ SdtTable* SectionList::buildSdt()
 /**
  * Build an EIT table
  *
+ * @param firstNumber first section number to include
+ * @param lastNumber last section number to include
  * @return EitTable if successful, NULL otherwise
  */
-EitTable* SectionList::buildEit()
+EitTable* SectionList::buildEit(uint32_t firstNumber, uint32_t lastNumber)
 {
-    // Let's create the table object
-    EitTable *eit = new EitTable(m_sectionList.front().tableId, m_sectionList.front().extensionId,
-                                 m_sectionList.front().version, m_sectionList.front().current);
+    typedef SiLayout::EitHeader Header;
+    typedef SiLayout::EitEventEntry EventEntry;
+
+    // Let's get a table object from the pool
+    EitTable *eit = static_cast<EitTable*>(SiTablePool::getInstance().acquire(m_header.tableId, m_header.extensionId,
+                                 m_header.version, m_header.current));
 
-    eit->setTsId(((uint16_t)(m_sectionList.front().payload[0]) << 8) | m_sectionList.front().payload[1]);
-    eit->setNetworkId(((uint16_t)(m_sectionList.front().payload[2]) << 8) | m_sectionList.front().payload[3]);
-    eit->setLastTableId(m_sectionList.front().payload[5]);
+    const Section& firstSec = m_slots[getFirstNumber()];
+    const uint8_t *first = getPayload(firstSec);
+    if(first && Header::fits(first, first + getTableDataSize(firstSec)))
+    {
+        eit->setTsId(Header::TransportStreamId::get(first));
+        eit->setNetworkId(Header::OriginalNetworkId::get(first));
+        eit->setLastTableId(Header::LastTableId::get(first));
+    }
+
+    // The descriptors refer to the table's own copy of the section data
+    DescriptorBufferPtr buffer = eit->getDescriptorBuffer();
+    uint8_t *data = copyPayloads(*buffer, firstNumber, lastNumber);
 
     // Time to parse the sections one by one
-    for(auto it = m_sectionList.begin(), end = m_sectionList.end(); it != end; ++it)
+    size_t count = (lastNumber < m_slots.size()) ? (lastNumber + 1) : m_slots.size();
+    for(size_t n = firstNumber; n < count; n++)
     {
-        uint8_t *p = it->payload.data();
+        if(!isReceived(n))
+        {
+            continue;
+        }
+
+        const Section& sec = m_slots[n];
+
+        uint8_t *p = sec.payloadSize ? data : NULL;
+        data += sec.payloadSize;
         if(!p)
         {
             // let's ignore "empty" sections
             continue;
         }
 
-        uint8_t *payloadEnd = p + it->payload.size();
+        uint8_t *payloadEnd = p + getTableDataSize(sec);
 
         // Skip ts_id, network_id etc
-        p += 6;
-        while((p + 12) < payloadEnd)
+        p += Header::SIZE;
+        while(EventEntry::fits(p, payloadEnd))
         {
             // Let's extract the data out of the section
-            uint16_t eventId      = ((uint16_t)(p[0]) << 8) | p[1];
-            uint64_t startTime    = ((uint64_t)(p[2]) << 32) | ((uint64_t)(p[3]) << 24) |
-                                    ((uint64_t)(p[4]) << 16) | ((uint64_t)(p[5]) << 8) |
-                                    ((uint64_t)(p[6]));
-            uint32_t duration     = ((uint32_t)(p[7]) << 16) | ((uint32_t)(p[8]) << 8) | p[9];
-            uint8_t runningStatus = (uint8_t)(p[10]) >> 5;
-            bool isScrambled      = ((p[10] & 0x8) == 0x8) ? false : true;
-            uint16_t descLength   = ((uint16_t)(p[10] & 0xf) << 8) | p[11];
+            uint16_t eventId      = EventEntry::EventId::get(p);
+            uint64_t startTime    = EventEntry::StartTime::get(p);
+            uint32_t duration     = EventEntry::Duration::get(p);
+            uint8_t runningStatus = EventEntry::RunningStatus::get(p);
+            bool isScrambled      = EventEntry::FreeCaMode::get(p);
+            uint16_t descLength   = EventEntry::DescriptorsLength::get(p);
 
             OS_LOG(DVB_DEBUG, "<%s> EIT: event_id = 0x%x, dur = 0x%x, run_st = %d, des_len = %d\n",
                                         __FUNCTION__, eventId, duration, runningStatus, descLength);
@@ -455,8 +719,15 @@ EitTable* SectionList::buildEit()
             // Let's now make a DvbEvent object using the extracted data
             DvbEvent event(eventId, startTime, duration, runningStatus, isScrambled);
 
-            p += 12;
-            event.addDescriptors(MpegDescriptor::parseDescriptors(p, descLength));
+            p += EventEntry::SIZE;
+
+            // Boundary check
+            if((p + descLength) > payloadEnd)
+            {
+                break;
+            }
+
+            event.addDescriptors(MpegDescriptor::parseDescriptors(p, descLength, buffer));
             eit->addEvent(event);
 
             p += descLength;
@@ -473,29 +744,38 @@ EitTable* SectionList::buildEit()
  */
 TotTable* SectionList::buildTot()
 {
-    // Let's create the table object
-    TotTable *tot = new TotTable(m_sectionList.front().tableId, m_sectionList.front().extensionId,
-                                 m_sectionList.front().version, m_sectionList.front().current);
-    uint8_t *p = m_sectionList.front().payload.data();
-    if(p)
-    {
-        uint8_t *payloadEnd = p + m_sectionList.front().payload.size();
-        if ((p + 5) <= payloadEnd)
+    typedef SiLayout::Tdt Tdt;
+    typedef SiLayout::Tot Tot;
+
+    // Let's get a table object from the pool
+    TotTable *tot = static_cast<TotTable*>(SiTablePool::getInstance().acquire(m_header.tableId, m_header.extensionId,
+                                 m_header.version, m_header.current));
+
+    // The descriptors refer to the table's own copy of the section data
+    DescriptorBufferPtr buffer = tot->getDescriptorBuffer();
+    uint32_t number = getFirstNumber();
+    uint8_t *p = copyPayloads(*buffer, number, number);
+    if(m_slots[number].payloadSize)
+    {
+        uint8_t *payloadEnd = p + getTableDataSize(m_slots[number]);
+        if(Tdt::fits(p, payloadEnd))
         {
             /* 16-bit MJD and 24 bits coded as 6 digits in 4-bit BCD */
-            tot->setUtcTime( ((uint64_t)p[0] << 32) | ((uint64_t)p[1] << 24) | ((uint64_t)p[2] << 16) |
-                             ((uint64_t)p[3] << 8) | (uint64_t)p[4] );
-            p += 5;
+            tot->setUtcTime(Tdt::UtcTime::get(p));
         }
 
         // Parse descriptors (for TOTs only)
-        if(m_sectionList.front().tableId == 0x73)
+        if((static_cast<TableId>(m_header.tableId) == TableId::TOT) && Tot::fits(p, payloadEnd))
         {
-            uint16_t descLength = ((uint16_t)(p[0] & 0xf) << 8) | p[1];
+            uint16_t descLength = Tot::DescriptorsLoopLength::get(p);
 
-            p += 2;
+            p += Tot::SIZE;
 
-            tot->addDescriptors(MpegDescriptor::parseDescriptors(p, descLength));
+            // Boundary check
+            if((p + descLength) <= payloadEnd)
+            {
+                tot->addDescriptors(MpegDescriptor::parseDescriptors(p, descLength, buffer));
+            }
         }
     }
 
@@ -512,12 +792,12 @@ SiTable* SectionList::buildTable()
     SiTable *tbl = NULL;
 
     // Sanity check
-    if(m_sectionList.empty())
+    if(!m_receivedCount)
     {
         return tbl;
     }
 
-    TableId tableId = static_cast<TableId>(m_sectionList.front().tableId);
+    TableId tableId = static_cast<TableId>(m_header.tableId);
 
     // Time to build an SI table based on the table identifier
     if((tableId == TableId::NIT) || (tableId == TableId::NIT_OTHER))
@@ -549,10 +829,10 @@ SiTable* SectionList::buildTable()
 }
 
 /**
- * Check if the list is for EIT sections
+ * Check if a table id is an EIT table id
  *
  * @param tableId
- * @return true if the list contains EIT sections, false otherwise
+ * @return true if the table id is for EIT sections, false otherwise
  */
 bool SectionList::isEit(uint8_t id)
 {
@@ -566,6 +846,59 @@ bool SectionList::isEit(uint8_t id)
     return false;
 }
 
+/**
+ * Check if all the sections of an EIT segment are in place
+ *
+ * @param segment segment index (section_number / 8)
+ * @return true if the segment is complete, false otherwise
+ */
+bool SectionList::isSegmentComplete(uint8_t segment) const
+{
+    // Sanity check
+    if(segment >= 32 || !isEit(m_header.tableId) || !(m_knownSegments & (1u << segment)))
+    {
+        return false;
+    }
+
+    // A segment is one byte of the bitmaps
+    uint32_t shift = (segment & 0x3) << 3;
+    uint32_t expected = (m_expected[segment >> 2] >> shift) & 0xff;
+    uint32_t received = (m_received[segment >> 2] >> shift) & 0xff;
+
+    return (received & expected) == expected;
+}
+
+/**
+ * Build a partial EIT table out of the sections of one segment
+ *
+ * @param segment segment index (section_number / 8)
+ * @return EitTable* if table was built successfully, NULL otherwise
+ */
+EitTable* SectionList::buildSegment(uint8_t segment)
+{
+    // Sanity check
+    if(!isSegmentComplete(segment))
+    {
+        return NULL;
+    }
+
+    EitTable* eit = buildEit(segment << 3, (segment << 3) + 7);
+    eit->setSegment(segment);
+    m_builtSegments |= 1u << segment;
+
+    return eit;
+}
+
+/**
+ * Get the section numbers in the list as a bitmap
+ *
+ * @param bitmap [out] one bit per section number
+ */
+void SectionList::getSectionBitmap(uint32_t (&bitmap)[8]) const
+{
+    memcpy(bitmap, m_received, sizeof(bitmap));
+}
+
 /**
  * Get a string with debug data such as table id, section numbers etc
  *
@@ -575,15 +908,18 @@ string SectionList::toString() const
 {
     std::stringstream ss;
 
-    if(!m_sectionList.empty())
+    if(m_receivedCount)
     {
-        ss << "TableId = " << (int) m_sectionList.front().tableId << ", TableExtId = "
-           << (int) m_sectionList.front().extensionId << ", ";
+        ss << "TableId = " << (int) m_header.tableId << ", TableExtId = "
+           << (int) m_header.extensionId << ", ";
         ss << "Section numbers:";
-        std::for_each(m_sectionList.begin(), m_sectionList.end(), [&ss](const Section& sec)
+        for(size_t n = 0, count = m_slots.size(); n < count; n++)
         {
-            ss << " " << (int)sec.number;
-        });
+            if(isReceived(n))
+            {
+                ss << " " << (int)n;
+            }
+        }
     }
     else
     {
@@ -595,81 +931,57 @@ string SectionList::toString() const
 /**
  * Check if the section list is complete (all sections of the table are in place)
  *
- * @param lastRcvdSect
  * @return true if the list is complete, false otherwise
  */
-bool SectionList::complete(Section& lastRcvdSect)
+bool SectionList::complete() const
 {
     // Sanity check
-    if(m_sectionList.empty())
+    if(!m_receivedCount)
     {
         return false;
     }
 
     // If syntax indicator is off, then we can say that the table is complete right away
-    if(!m_sectionList.front().syntax)
+    if(!m_header.syntax)
     {
         return true;
     }
 
-    bool complete = false;
-
-    // We need to handle EIT tables differently
-    if(isEit(m_sectionList.front().tableId))
+    // EIT: every segment's segment_last_section_number has to be known
+    if((m_knownSegments & m_neededSegments) != m_neededSegments)
     {
-        // Check only if we received the same section second time (full cycle passed)
-        // to make sure we got all the sections.
-        if(m_firstReceivedNumber == lastRcvdSect.number)
-        {
-            uint8_t lastSectionNumber = m_sectionList.front().lastNumber;
-            auto it = m_sectionList.begin();
-            auto end = m_sectionList.end();
-            while(it != end)
-            {
-                if(it->number == lastSectionNumber)
-                {
-                    complete = true;
-                    break;
-                }
-
-                // Compare to the segment_last_section_number
-                if(it->number == it->payload[4])
-                {
-                    while((std::next(it) != end) && std::next(it)->number < lastSectionNumber)
-                    {
-                        ++it;
-                    }
-                }
-
-                ++it;
-            }
-        }
-        else
-        {
-            complete = false;
-        }
+        return false;
     }
-    else // non-EIT table
+
+    if(m_receivedCount < m_expectedCount)
     {
-        uint8_t prev = 0;
+        return false;
+    }
 
-        // Let's iterate through the section list and see if the order checks out or not
-        for(auto it = m_sectionList.begin(), end = m_sectionList.end(); it != end; ++it)
-        {
-            if(prev != it->number)
-            {
-                complete = false;
-                break;
-            }
+    // All the expected sections have to be in place
+    uint32_t count = 0;
+    for(int i = 0; i < 8; i++)
+    {
+        count += __builtin_popcount(m_received[i] & m_expected[i]);
+    }
 
-            if(it->lastNumber == it->number)
-            {
-                complete = true;
-            }
+    return count == m_expectedCount;
+}
 
-            prev++;
+/**
+ * Get the lowest section number in the list
+ *
+ * @return section number
+ */
+uint8_t SectionList::getFirstNumber() const
+{
+    for(int i = 0; i < 8; i++)
+    {
+        if(m_received[i])
+        {
+            return (i << 5) + __builtin_ctz(m_received[i]);
         }
     }
 
-    return complete;
+    return 0;
 }
@@ -34,8 +34,12 @@
 
 // Project's includes
 #include <oswrap.h>
+#include "Crc32.h"
+#include "SiTablePool.h"
 
+#if DVB_LOG_COMPILED(DVB_TRACE)
 #define DVB_TABLE_DEBUG
+#endif
 #ifdef DVB_TABLE_DEBUG
 #include "NitTable.h"
 #include "SdtTable.h"
@@ -58,10 +62,9 @@
 #include "ContentDescriptor.h"
 #else
 #include "SiTable.h"
+#include "EitTable.h"
 #endif
 
-using std::map;
-using std::pair;
 
 /**
  * Constructor
@@ -70,7 +73,15 @@ using std::pair;
  */
 SectionParser::SectionParser(void* context, SendEventCallback callback)
   : m_context(context),
-    m_sendEventCb(callback)
+    m_sendEventCb(callback),
+    m_eitSegmentMode(false),
+    m_crcErrorCount(0),
+    m_repeatCount(0),
+    m_latencyStatsEnabled(false),
+    m_carouselMonitorEnabled(false),
+    m_callbackTime(0),
+    m_recorderContext(NULL),
+    m_recorderCb(NULL)
 {
 }
 
@@ -106,6 +117,106 @@ bool SectionParser::isTableSupported(uint8_t id)
     }
 }
 
+/**
+ * Check the section length and CRC_32 of a section
+ *
+ * @param data section data
+ * @param size data size
+ * @return true if the section is valid, false otherwise
+ */
+bool SectionParser::isSectionValid(uint8_t* data, uint32_t size)
+{
+    // table_id + section_syntax_indicator/section_length
+    if(size < 3)
+    {
+        return false;
+    }
+
+    uint32_t length = (((uint32_t)(data[1] & 0x0f) << 8) | data[2]) + 3;
+    if(length > size)
+    {
+        OS_LOG(DVB_ERROR, "<%s> 0x%x: section length %d exceeds data size %d\n", __FUNCTION__, data[0], length, size);
+        return false;
+    }
+
+    // Syntax sections and the TOT (syntax indicator is 0, but it has a CRC) end with a CRC_32
+    if((data[1] & 0x80) || (static_cast<TableId>(data[0]) == TableId::TOT))
+    {
+        // Long header (8 bytes) + CRC_32 for syntax sections
+        if(length < ((data[1] & 0x80) ? 12u : 7u))
+        {
+            OS_LOG(DVB_ERROR, "<%s> 0x%x: section too short (%d)\n", __FUNCTION__, data[0], length);
+            return false;
+        }
+
+        // The CRC over the whole section including the CRC_32 field is 0
+        if(Crc32::calculate(data, length) != 0)
+        {
+            OS_LOG(DVB_ERROR, "<%s> 0x%x: CRC_32 mismatch\n", __FUNCTION__, data[0]);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Check if a section repeats a sub-table version that is already complete.
+ * Only the section header is read.
+ *
+ * @param key sub-table key
+ * @param data section data
+ * @param size data size
+ * @return fingerprint of the sub-table if the section can be dropped, NULL otherwise
+ */
+const SectionFingerprint* SectionParser::findRepeat(SubTableKey key, const uint8_t* data, uint32_t size)
+{
+    // Only sections with the long header can be recognized as repeats
+    if(size < 8 || !(data[1] & 0x80))
+    {
+        return NULL;
+    }
+
+    const SectionFingerprint* fp = m_fingerprints.find(key);
+    if(!fp)
+    {
+        return NULL;
+    }
+
+    uint8_t version = (data[5] >> 1) & 0x1f;
+    uint8_t number = data[6];
+
+    if((fp->version == version) && (fp->lastNumber == data[7]) &&
+       (fp->received[number >> 5] & (1u << (number & 0x1f))))
+    {
+        return fp;
+    }
+    return NULL;
+}
+
+/**
+ * Record the fingerprint of a completed sub-table
+ *
+ * @param key sub-table key
+ * @param data data of the section that completed the sub-table
+ * @param secList completed section list
+ * @param stats counters of the sub-table
+ */
+void SectionParser::addFingerprint(SubTableKey key, const uint8_t* data, const SectionList& secList, ParserStats::SubTable* stats)
+{
+    // Sections without the long header are never repeats
+    if(!(data[1] & 0x80))
+    {
+        return;
+    }
+
+    SectionFingerprint& fp = m_fingerprints[key];
+    fp.version = (data[5] >> 1) & 0x1f;
+    fp.lastNumber = data[7];
+    secList.getSectionBitmap(fp.received);
+    fp.stats = stats;
+}
+
 /**
  * Parse SI Section
  *
@@ -113,6 +224,78 @@ bool SectionParser::isTableSupported(uint8_t id)
  * @param size data size
  */
 void SectionParser::parse(uint8_t *data, uint32_t size)
+{
+    parse(data, size, CarouselMonitor::UNKNOWN_PID);
+}
+
+/**
+ * Parse SI Section
+ *
+ * @param data section data
+ * @param size data size
+ * @param pid PID the section was carried on
+ */
+void SectionParser::parse(uint8_t *data, uint32_t size, uint16_t pid)
+{
+    if(m_recorderCb && data && size != 0)
+    {
+        m_recorderCb(m_recorderContext, data, size, pid, ParserStats::now());
+    }
+
+    if((!m_latencyStatsEnabled && !m_carouselMonitorEnabled) || !data || size == 0)
+    {
+        handleSection(data, size, pid, 0);
+        return;
+    }
+
+    uint64_t start = ParserStats::now();
+    m_callbackTime = 0;
+
+    handleSection(data, size, pid, start);
+
+    if(!m_latencyStatsEnabled)
+    {
+        return;
+    }
+
+    // The time the consumer spends in the callback is not the parser's
+    uint64_t elapsed = ParserStats::now() - start;
+    m_stats.recordSection(data[0], elapsed > m_callbackTime ? elapsed - m_callbackTime : 0);
+}
+
+/**
+ * Hand a table to the SendEvent callback, release it if there is none
+ *
+ * @param tbl table
+ */
+void SectionParser::publish(SiTable* tbl)
+{
+    if(!m_context || !m_sendEventCb)
+    {
+        SiTablePool::getInstance().release(tbl);
+        return;
+    }
+
+    if(!m_latencyStatsEnabled)
+    {
+        m_sendEventCb(m_context, (uint32_t)tbl->getTableId(), tbl, 0);
+        return;
+    }
+
+    uint64_t start = ParserStats::now();
+    m_sendEventCb(m_context, (uint32_t)tbl->getTableId(), tbl, 0);
+    m_callbackTime += ParserStats::now() - start;
+}
+
+/**
+ * Handle an SI section
+ *
+ * @param data section data
+ * @param size data size
+ * @param pid PID the section was carried on
+ * @param now arrival time (ParserStats::now()), 0 if neither latency nor carousel statistics are enabled
+ */
+void SectionParser::handleSection(uint8_t *data, uint32_t size, uint16_t pid, uint64_t now)
 {
     OS_LOG(DVB_TRACE3, "<%s> data: %p, size: 0x%x\n", __FUNCTION__, data, size);
 
@@ -127,282 +310,363 @@ void SectionParser::parse(uint8_t *data, uint32_t size)
     if(!isTableSupported(data[0]))
     {
         OS_LOG(DVB_WARN, "<%s> Table id 0x%x is not supported\n", __FUNCTION__, data[0]);
+        m_stats.onReceived(NULL, data[0], size);
+        m_stats.onRejected(NULL, data[0]);
         return;
     }
 
-    Section* section = new Section(data, size);
+    SubTableKey key = makeSubTableKey(data, size);
+
+    // Repeats of complete sub-tables are dropped before anything else is done with them
+    const SectionFingerprint* repeat = findRepeat(key, data, size);
+    if(repeat)
+    {
+        m_repeatCount++;
+        m_stats.onReceived(repeat->stats, data[0], size);
+        m_stats.onDuplicate(repeat->stats, data[0]);
+
+        // The carousel timing is measured on repeats too
+        if(m_carouselMonitorEnabled)
+        {
+            m_carousel.onSection(key, pid, data, size, now);
+        }
+        return;
+    }
+
+    // Corrupt sections must not get into the section lists, nor their headers into the sub-table counters
+    if(!isSectionValid(data, size))
+    {
+        m_crcErrorCount++;
+        m_stats.onReceived(NULL, data[0], size);
+        m_stats.onRejected(NULL, data[0]);
+        return;
+    }
+
+    ParserStats::SubTable* stats = m_stats.getSubTable(key);
+    m_stats.onReceived(stats, data[0], size);
+
+    // Only valid sections get to the carousel monitor: a corrupted header would add a sub-table
+    // that is never seen again, a corrupted section_number would stall the cycle estimate
+    if(m_carouselMonitorEnabled)
+    {
+        m_carousel.onSection(key, pid, data, size, now);
+    }
+
+    // Header decoding only, the payload is copied by the section list if the section is kept
+    SectionView section(data, size);
 
     OS_LOG(DVB_DEBUG, "<%s> Handling id = 0x%x, syntax = %d, extId = 0x%x, ver = %d %d/%d\n", __FUNCTION__,
-            section->tableId, section->syntax, section->extensionId, section->version, section->number, section->lastNumber);
+            section.tableId, section.syntax, section.extensionId, section.version, section.number, section.lastNumber);
 
     // Find the list in the section map
-    pair<uint8_t, uint16_t> key(section->tableId, section->extensionId);
     SectionList& secList = m_sectionMap[key];
 
+    // A section of the current version that is in the list already is a duplicate
+    bool duplicate = false;
+    if(section.syntax)
+    {
+        duplicate = m_stats.onVersion(stats, section.tableId, section.version) && secList.isReceived(section.number);
+    }
+
     // Adding the section to the list
-    if(secList.add(*section))
+    bool added = secList.add(section);
+    if(duplicate || !added)
+    {
+        m_stats.onDuplicate(stats, section.tableId);
+    }
+
+    if(added)
     {
         OS_LOG(DVB_TRACE3, "<%s> Add() returned true\n", __FUNCTION__);
 
+        // In per-segment mode EIT segments are published as soon as they are complete
+        uint8_t segment = section.number >> 3;
+        if(m_eitSegmentMode && secList.isSegmentComplete(segment) && !secList.isSegmentBuilt(segment))
+        {
+            uint64_t start = m_latencyStatsEnabled ? ParserStats::now() : 0;
+            EitTable* eit = secList.buildSegment(segment);
+            if(m_latencyStatsEnabled)
+            {
+                m_stats.recordBuild(section.tableId, ParserStats::now() - start);
+            }
+            OS_LOG(DVB_DEBUG, "<%s> EIT 0x%x.0x%x segment %d is complete, %d events\n", __FUNCTION__,
+                    section.tableId, section.extensionId, segment, (int)eit->getEvents().size());
+
+            publish(eit);
+        }
+
         // Let's check if the table became complete
         if(secList.isComplete())
         {
             OS_LOG(DVB_DEBUG, "<%s> table is complete\n", __FUNCTION__);
             OS_LOG(DVB_DEBUG, "<%s> SectionList: %s\n", __FUNCTION__, secList.toString().c_str());
 
-            // Time to build the table
-            SiTable* tbl = secList.buildTable();
+            // From now on the sections of this version can be dropped early
+            addFingerprint(key, data, secList, stats);
+            m_stats.onCompleted(stats, section.tableId);
+
+            // Time to build the table (EIT segments have been published already in per-segment mode)
+            SiTable* tbl = NULL;
+            if(!m_eitSegmentMode || !SectionList::isEit(section.tableId))
+            {
+                uint64_t start = m_latencyStatsEnabled ? ParserStats::now() : 0;
+                tbl = secList.buildTable();
+                if(m_latencyStatsEnabled)
+                {
+                    m_stats.recordBuild(section.tableId, ParserStats::now() - start);
+                }
+            }
             if(tbl)
             {
 // This block parses certain tables and logs the results. Used for debugging purposes only.
 #ifdef DVB_TABLE_DEBUG
-                if(tbl->getTableId() == TableId::NIT)
+                // The dump decodes descriptors, skip it unless its messages are enabled
+                if(DvbLog::isEnabled(DVB_LOG_VERBOSITY(DVB_TRACE)))
                 {
-                    OS_LOG(DVB_DEBUG, "<%s> NIT table received, id: 0x%x, extId: 0x%x\n", __FUNCTION__, tbl->getTableId(), tbl->getExtensionId());
-                    NitTable* nit = static_cast<NitTable*>(tbl);
-                    const std::vector<MpegDescriptor>& descriptors = nit->getNetworkDescriptors();
-                    const MpegDescriptor* desc = MpegDescriptor::find(descriptors, DescriptorTag::NETWORK_NAME);
-                    if(desc)
-                    {
-                        NetworkNameDescriptor netName(*desc);
-                        OS_LOG(DVB_DEBUG, "<%s> NIT table, network name: %s\n", __FUNCTION__, netName.getName().c_str());
-                    }
-                    else
+                    if(tbl->getTableId() == TableId::NIT)
                     {
-                        OS_LOG(DVB_DEBUG, "<%s> NIT table: network name descriptor not found\n", __FUNCTION__);
-                    }
-
-                    const std::vector<TransportStream>& tsList = nit->getTransportStreams();
-
-                    // Let's iterate through the list of transport streams in order to extract certain ts descriptors
-                    for(auto it = tsList.begin(), end = tsList.end(); it != end; ++it)
-                    {
-                        const std::vector<MpegDescriptor>& tsDescriptors = it->getTsDescriptors();
-                        const MpegDescriptor* desc = MpegDescriptor::find(tsDescriptors, DescriptorTag::CABLE_DELIVERY);
+                        OS_LOG(DVB_TRACE, "<%s> NIT table received, id: 0x%x, extId: 0x%x\n", __FUNCTION__, tbl->getTableId(), tbl->getExtensionId());
+                        NitTable* nit = static_cast<NitTable*>(tbl);
+                        const DescriptorList& descriptors = nit->getNetworkDescriptors();
+                        const MpegDescriptor* desc = descriptors.find(DescriptorTag::NETWORK_NAME);
                         if(desc)
                         {
-                            CableDeliverySystemDescriptor cable(*desc);
-                            OS_LOG(DVB_DEBUG, "<%s> NIT table: freq = 0x%x(%d), mod = 0x%x, symbol_rate = 0x%x(%d)\n",
-                                    __FUNCTION__, cable.getFrequencyBcd(), cable.getFrequency(), cable.getModulation(), cable.getSymbolRateBcd(), cable.getSymbolRate());
+                            NetworkNameDescriptor netName(*desc);
+                            OS_LOG(DVB_TRACE, "<%s> NIT table, network name: %s\n", __FUNCTION__, netName.getName().c_str());
                         }
                         else
                         {
-                            OS_LOG(DVB_DEBUG, "<%s> NIT table: cable delivery descriptor not found\n", __FUNCTION__);
+                            OS_LOG(DVB_TRACE, "<%s> NIT table: network name descriptor not found\n", __FUNCTION__);
                         }
-                    }
 
-                    std::vector<MpegDescriptor> netList = MpegDescriptor::findAll(descriptors, DescriptorTag::MULTILINGUAL_NETWORK_NAME);
+                        const std::vector<TransportStream>& tsList = nit->getTransportStreams();
 
-                    // Let's dump all the multilingual network name descriptors to the log
-                    for(auto ext_it = netList.begin(), ext_end = netList.end(); ext_it != ext_end; ++ext_it)
-                    {
-                        MultilingualNetworkNameDescriptor netDesc(*ext_it);
-                        for(uint8_t i = 0; i < netDesc.getCount(); i++)
+                        // Let's iterate through the list of transport streams in order to extract certain ts descriptors
+                        for(auto it = tsList.begin(), end = tsList.end(); it != end; ++it)
                         {
-                            OS_LOG(DVB_DEBUG, "<%s> NIT table: multilingual network name[%d] (%s): %s\n",
-                                    __FUNCTION__, i, netDesc.getLanguageCode(i).c_str(), netDesc.getNetworkName(i).c_str());
+                            const DescriptorList& tsDescriptors = it->getTsDescriptors();
+                            const MpegDescriptor* desc = tsDescriptors.find(DescriptorTag::CABLE_DELIVERY);
+                            if(desc)
+                            {
+                                CableDeliverySystemDescriptor cable(*desc);
+                                OS_LOG(DVB_TRACE, "<%s> NIT table: freq = 0x%x(%d), mod = 0x%x, symbol_rate = 0x%x(%d)\n",
+                                        __FUNCTION__, cable.getFrequencyBcd(), cable.getFrequency(), cable.getModulation(), cable.getSymbolRateBcd(), cable.getSymbolRate());
+                            }
+                            else
+                            {
+                                OS_LOG(DVB_TRACE, "<%s> NIT table: cable delivery descriptor not found\n", __FUNCTION__);
+                            }
                         }
-                    }
-                }
-                else if(tbl->getTableId() == TableId::SDT || tbl->getTableId() == TableId::SDT_OTHER)
-                {
-                    OS_LOG(DVB_DEBUG, "<%s> SDT table received, id: 0x%x, extId: 0x%x\n", __FUNCTION__, tbl->getTableId(), tbl->getExtensionId());
-                    SdtTable* sdt = static_cast<SdtTable*>(tbl);
 
-                    const std::vector<DvbService>& serviceList = sdt->getServices();
+                        DescriptorRange netList = descriptors.findAll(DescriptorTag::MULTILINGUAL_NETWORK_NAME);
 
-                    // Let's iterate through the list of services in order to extract certain service descriptors
-                    for(auto it = serviceList.begin(), end = serviceList.end(); it != end; ++it)
-                    {
-                        const std::vector<MpegDescriptor>& serviceDescriptors = it->getServiceDescriptors();
-                        const MpegDescriptor* desc = MpegDescriptor::find(serviceDescriptors, DescriptorTag::SERVICE);
-                        if(desc)
+                        // Let's dump all the multilingual network name descriptors to the log
+                        for(auto ext_it = netList.begin(), ext_end = netList.end(); ext_it != ext_end; ++ext_it)
                         {
-                            ServiceDescriptor servDesc(*desc);
-                            OS_LOG(DVB_DEBUG, "<%s> SDT table: type = 0x%x, provider = %s, name = %s\n",
-                                    __FUNCTION__, servDesc.getServiceType(), servDesc.getServiceProviderName().c_str(), servDesc.getServiceName().c_str());
-                        }
-                        else
-                        {
-                            OS_LOG(DVB_DEBUG, "<%s> SDT table: service descriptor not found\n", __FUNCTION__);
+                            MultilingualNetworkNameDescriptor netDesc(*ext_it);
+                            for(uint8_t i = 0; i < netDesc.getCount(); i++)
+                            {
+                                OS_LOG(DVB_TRACE, "<%s> NIT table: multilingual network name[%d] (%s): %s\n",
+                                        __FUNCTION__, i, netDesc.getLanguageCode(i).c_str(), netDesc.getNetworkName(i).c_str());
+                            }
                         }
+                    }
+                    else if(tbl->getTableId() == TableId::SDT || tbl->getTableId() == TableId::SDT_OTHER)
+                    {
+                        OS_LOG(DVB_TRACE, "<%s> SDT table received, id: 0x%x, extId: 0x%x\n", __FUNCTION__, tbl->getTableId(), tbl->getExtensionId());
+                        SdtTable* sdt = static_cast<SdtTable*>(tbl);
 
-                        std::vector<MpegDescriptor> nameList = MpegDescriptor::findAll(serviceDescriptors, DescriptorTag::MULTILINGUAL_SERVICE_NAME);
-                        for(auto ext_it = nameList.begin(), ext_end = nameList.end(); ext_it != ext_end; ++ext_it)
+                        const std::vector<DvbService>& serviceList = sdt->getServices();
+
+                        // Let's iterate through the list of services in order to extract certain service descriptors
+                        for(auto it = serviceList.begin(), end = serviceList.end(); it != end; ++it)
                         {
-                            MultilingualServiceNameDescriptor nameDesc(*ext_it);
+                            const DescriptorList& serviceDescriptors = it->getServiceDescriptors();
+                            const MpegDescriptor* desc = serviceDescriptors.find(DescriptorTag::SERVICE);
+                            if(desc)
+                            {
+                                ServiceDescriptor servDesc(*desc);
+                                OS_LOG(DVB_TRACE, "<%s> SDT table: type = 0x%x, provider = %s, name = %s\n",
+                                        __FUNCTION__, servDesc.getServiceType(), servDesc.getServiceProviderName().c_str(), servDesc.getServiceName().c_str());
+                            }
+                            else
+                            {
+                                OS_LOG(DVB_TRACE, "<%s> SDT table: service descriptor not found\n", __FUNCTION__);
+                            }
 
-                            // Let's dump the service information in all available languages
-                            for(uint8_t i = 0; i < nameDesc.getCount(); i++)
+                            DescriptorRange nameList = serviceDescriptors.findAll(DescriptorTag::MULTILINGUAL_SERVICE_NAME);
+                            for(auto ext_it = nameList.begin(), ext_end = nameList.end(); ext_it != ext_end; ++ext_it)
                             {
-                                OS_LOG(DVB_DEBUG, "<%s> SDT table: multilingual service name[%d] (%s): provider = %s, name = %s\n",
-                                        __FUNCTION__, i, nameDesc.getLanguageCode(i).c_str(), nameDesc.getServiceProviderName(i).c_str(),  nameDesc.getServiceName(i).c_str());
+                                MultilingualServiceNameDescriptor nameDesc(*ext_it);
+
+                                // Let's dump the service information in all available languages
+                                for(uint8_t i = 0; i < nameDesc.getCount(); i++)
+                                {
+                                    OS_LOG(DVB_TRACE, "<%s> SDT table: multilingual service name[%d] (%s): provider = %s, name = %s\n",
+                                            __FUNCTION__, i, nameDesc.getLanguageCode(i).c_str(), nameDesc.getServiceProviderName(i).c_str(),  nameDesc.getServiceName(i).c_str());
+                                }
                             }
                         }
                     }
-                }
-                else if((tbl->getTableId() >= TableId::EIT_PF) && (tbl->getTableId() <= TableId::EIT_SCHED_OTHER_END))
-                {
-                    OS_LOG(DVB_DEBUG, "<%s> EIT table received, id: 0x%x, extId: 0x%x\n", __FUNCTION__, tbl->getTableId(), tbl->getExtensionId());
-                    EitTable* eit = static_cast<EitTable*>(tbl);
-
-                    const std::vector<DvbEvent>& eventList = eit->getEvents();
-                    for(auto it = eventList.begin(), end = eventList.end(); it != end; ++it)
+                    else if((tbl->getTableId() >= TableId::EIT_PF) && (tbl->getTableId() <= TableId::EIT_SCHED_OTHER_END))
                     {
-                        OS_LOG(DVB_DEBUG, "<%s> EIT table: event_id = 0x%x, duration = 0x%x(%d), status = %d\n",
-                                __FUNCTION__, it->getEventId(), it->getDurationBcd(), it->getDuration(), it->getRunningStatus());
-                        const std::vector<MpegDescriptor>& eventDescriptors = it->getEventDescriptors();
-                        std::vector<MpegDescriptor> shortList = MpegDescriptor::findAll(eventDescriptors, DescriptorTag::SHORT_EVENT);
+                        OS_LOG(DVB_TRACE, "<%s> EIT table received, id: 0x%x, extId: 0x%x\n", __FUNCTION__, tbl->getTableId(), tbl->getExtensionId());
+                        EitTable* eit = static_cast<EitTable*>(tbl);
 
-                        // Let's dump all short event descriptors to the log
-                        for(auto ext_it = shortList.begin(), ext_end = shortList.end(); ext_it != ext_end; ++ext_it)
+                        const std::vector<DvbEvent>& eventList = eit->getEvents();
+                        for(auto it = eventList.begin(), end = eventList.end(); it != end; ++it)
                         {
-                            ShortEventDescriptor eventDesc(*ext_it);
-                            OS_LOG(DVB_DEBUG, "<%s> EIT table: lang_code = %s, name = %s, text = %s\n",
-                                    __FUNCTION__, eventDesc.getLanguageCode().c_str(), eventDesc.getEventName().c_str(), eventDesc.getText().c_str());
-                        }
-
-                        std::vector<MpegDescriptor> extList = MpegDescriptor::findAll(eventDescriptors, DescriptorTag::EXTENDED_EVENT);
+                            OS_LOG(DVB_TRACE, "<%s> EIT table: event_id = 0x%x, duration = 0x%x(%d), status = %d\n",
+                                    __FUNCTION__, it->getEventId(), it->getDurationBcd(), it->getDuration(), it->getRunningStatus());
+                            const DescriptorList& eventDescriptors = it->getEventDescriptors();
+                            DescriptorRange shortList = eventDescriptors.findAll(DescriptorTag::SHORT_EVENT);
 
-                        // Let's dump all extended event descriptors to the log
-                        for(auto ext_it = extList.begin(), ext_end = extList.end(); ext_it != ext_end; ++ext_it)
-                        {
-                            ExtendedEventDescriptor eventDesc(*ext_it);
-                            OS_LOG(DVB_DEBUG, "<%s> EIT table: %d/%d, lang_code = %s, text = %s\n",
-                                    __FUNCTION__, eventDesc.getNumber(), eventDesc.getLastNumber(), eventDesc.getLanguageCode().c_str(), eventDesc.getText().c_str());
-                            for(uint8_t i = 0; i < eventDesc.getNumberOfItems(); i++)
+                            // Let's dump all short event descriptors to the log
+                            for(auto ext_it = shortList.begin(), ext_end = shortList.end(); ext_it != ext_end; ++ext_it)
                             {
-                                OS_LOG(DVB_DEBUG, "<%s> EIT table: item[%d] %s: %s\n", __FUNCTION__, i, eventDesc.getItemDescription(i).c_str(), eventDesc.getItem(i).c_str());
+                                ShortEventDescriptor eventDesc(*ext_it);
+                                OS_LOG(DVB_TRACE, "<%s> EIT table: lang_code = %s, name = %s, text = %s\n",
+                                        __FUNCTION__, eventDesc.getLanguageCode().c_str(), eventDesc.getEventName().c_str(), eventDesc.getText().c_str());
                             }
-                        }
 
-                        const MpegDescriptor* desc = MpegDescriptor::find(eventDescriptors, DescriptorTag::PARENTAL_RATING);
-                        if(desc)
-                        {
-                            ParentalRatingDescriptor prDesc(*desc);
+                            DescriptorRange extList = eventDescriptors.findAll(DescriptorTag::EXTENDED_EVENT);
 
-                            // Let's dump the rating value for all available countries
-                            for(uint8_t i = 0; i < prDesc.getCount(); i++)
+                            // Let's dump all extended event descriptors to the log
+                            for(auto ext_it = extList.begin(), ext_end = extList.end(); ext_it != ext_end; ++ext_it)
                             {
-                                OS_LOG(DVB_DEBUG, "<%s> EIT table: PR[%d] country_code = %s, rating = 0x%x\n",
-                                        __FUNCTION__, i, prDesc.getCountryCode(i).c_str(), prDesc.getRating(i));
+                                ExtendedEventDescriptor eventDesc(*ext_it);
+                                OS_LOG(DVB_TRACE, "<%s> EIT table: %d/%d, lang_code = %s, text = %s\n",
+                                        __FUNCTION__, eventDesc.getNumber(), eventDesc.getLastNumber(), eventDesc.getLanguageCode().c_str(), eventDesc.getText().c_str());
+                                for(uint8_t i = 0; i < eventDesc.getNumberOfItems(); i++)
+                                {
+                                    OS_LOG(DVB_TRACE, "<%s> EIT table: item[%d] %s: %s\n", __FUNCTION__, i, eventDesc.getItemDescription(i).c_str(), eventDesc.getItem(i).c_str());
+                                }
                             }
-                        }
-                        else
-                        {
-                            OS_LOG(DVB_DEBUG, "<%s> EIT table: parental rating descriptor not found\n", __FUNCTION__);
-                        }
 
-                        desc = MpegDescriptor::find(eventDescriptors, DescriptorTag::CONTENT_DESCRIPTOR);
-                        if(desc)
-                        {
-                            ContentDescriptor contentDesc(*desc);
-
-                            // Let's dump all the available content identifiers to the log
-                            for(uint8_t i = 0; i < contentDesc.getCount(); i++)
+                            const MpegDescriptor* desc = eventDescriptors.find(DescriptorTag::PARENTAL_RATING);
+                            if(desc)
                             {
-                                OS_LOG(DVB_DEBUG, "<%s> EIT table: [%d] nibble_lvl_1 = 0x%x, nibble_lvl_2 = 0x%x, user_byte = 0x%x\n",
-                                        __FUNCTION__, i, contentDesc.getNibbleLvl1(i), contentDesc.getNibbleLvl2(i), contentDesc.getUserByte(i));
+                                ParentalRatingDescriptor prDesc(*desc);
+
+                                // Let's dump the rating value for all available countries
+                                for(uint8_t i = 0; i < prDesc.getCount(); i++)
+                                {
+                                    OS_LOG(DVB_TRACE, "<%s> EIT table: PR[%d] country_code = %s, rating = 0x%x\n",
+                                            __FUNCTION__, i, prDesc.getCountryCode(i).c_str(), prDesc.getRating(i));
+                                }
+                            }
+                            else
+                            {
+                                OS_LOG(DVB_TRACE, "<%s> EIT table: parental rating descriptor not found\n", __FUNCTION__);
                             }
-                        }
-                        else
-                        {
-                            OS_LOG(DVB_DEBUG, "<%s> EIT table: content descriptor not found\n", __FUNCTION__);
-                        }
 
-                        std::vector<MpegDescriptor> compList = MpegDescriptor::findAll(eventDescriptors, DescriptorTag::MULTILINGUAL_COMPONENT);
-                        for(auto ext_it = compList.begin(), ext_end = compList.end(); ext_it != ext_end; ++ext_it)
-                        {
-                            MultilingualComponentDescriptor compDesc(*ext_it);
+                            desc = eventDescriptors.find(DescriptorTag::CONTENT_DESCRIPTOR);
+                            if(desc)
+                            {
+                                ContentDescriptor contentDesc(*desc);
+
+                                // Let's dump all the available content identifiers to the log
+                                for(uint8_t i = 0; i < contentDesc.getCount(); i++)
+                                {
+                                    OS_LOG(DVB_TRACE, "<%s> EIT table: [%d] nibble_lvl_1 = 0x%x, nibble_lvl_2 = 0x%x, user_byte = 0x%x\n",
+                                            __FUNCTION__, i, contentDesc.getNibbleLvl1(i), contentDesc.getNibbleLvl2(i), contentDesc.getUserByte(i));
+                                }
+                            }
+                            else
+                            {
+                                OS_LOG(DVB_TRACE, "<%s> EIT table: content descriptor not found\n", __FUNCTION__);
+                            }
 
-                            // Let's dump the component information in all available languages
-                            for(uint8_t i = 0; i < compDesc.getCount(); i++)
+                            DescriptorRange compList = eventDescriptors.findAll(DescriptorTag::MULTILINGUAL_COMPONENT);
+                            for(auto ext_it = compList.begin(), ext_end = compList.end(); ext_it != ext_end; ++ext_it)
                             {
-                                OS_LOG(DVB_DEBUG, "<%s> EIT table: multilingual component descriptor[%d] tag = 0x%x, (%s): text = %s\n",
-                                        __FUNCTION__, i, compDesc.getComponentTag(), compDesc.getLanguageCode(i).c_str(), compDesc.getText(i).c_str());
+                                MultilingualComponentDescriptor compDesc(*ext_it);
+
+                                // Let's dump the component information in all available languages
+                                for(uint8_t i = 0; i < compDesc.getCount(); i++)
+                                {
+                                    OS_LOG(DVB_TRACE, "<%s> EIT table: multilingual component descriptor[%d] tag = 0x%x, (%s): text = %s\n",
+                                            __FUNCTION__, i, compDesc.getComponentTag(), compDesc.getLanguageCode(i).c_str(), compDesc.getText(i).c_str());
+                                }
                             }
                         }
                     }
-                }
-                else if((tbl->getTableId() == TableId::TDT) || (tbl->getTableId() == TableId::TOT))
-                {
-                    TotTable* tot = static_cast<TotTable*>(tbl);
-                    OS_LOG(DVB_DEBUG, "<%s> TDT/TOT table received, id: 0x%x, UTC: %"PRId64"\n", __FUNCTION__, tot->getTableId(), tot->getUtcTimeBcd());
-                    if(tot->getTableId() == TableId::TOT)
+                    else if((tbl->getTableId() == TableId::TDT) || (tbl->getTableId() == TableId::TOT))
                     {
-                        std::vector<MpegDescriptor>& timeDescriptors = tot->getDescriptors();
-                        const MpegDescriptor* desc = MpegDescriptor::find(timeDescriptors, DescriptorTag::LOCAL_TIME_OFFSET);
-                        if(desc)
+                        TotTable* tot = static_cast<TotTable*>(tbl);
+                        OS_LOG(DVB_TRACE, "<%s> TDT/TOT table received, id: 0x%x, UTC: %"PRId64"\n", __FUNCTION__, tot->getTableId(), tot->getUtcTimeBcd());
+                        if(tot->getTableId() == TableId::TOT)
                         {
-                            LocalTimeOffsetDescriptor offsetDesc(*desc);
-                            for(uint8_t i = 0; i < offsetDesc.getCount(); i++)
+                            const DescriptorList& timeDescriptors = tot->getDescriptors();
+                            const MpegDescriptor* desc = timeDescriptors.find(DescriptorTag::LOCAL_TIME_OFFSET);
+                            if(desc)
                             {
-                                OS_LOG(DVB_DEBUG, "<%s> TOT table: time_offset[%d] code = %s, reg_id = 0x%x, pol = %d, offset = 0x%x, ToC = %"PRId64", next offset = 0x%x\n",
-                                        __FUNCTION__, i, offsetDesc.getCountryCode(i).c_str(), offsetDesc.getCountryRegionId(i), offsetDesc.getPolarity(i),
-                                        offsetDesc.getLocalTimeOffset(i), offsetDesc.getTimeOfChange(i), offsetDesc.getNextTimeOffset(i));
+                                LocalTimeOffsetDescriptor offsetDesc(*desc);
+                                for(uint8_t i = 0; i < offsetDesc.getCount(); i++)
+                                {
+                                    OS_LOG(DVB_TRACE, "<%s> TOT table: time_offset[%d] code = %s, reg_id = 0x%x, pol = %d, offset = 0x%x, ToC = %"PRId64", next offset = 0x%x\n",
+                                            __FUNCTION__, i, offsetDesc.getCountryCode(i).c_str(), offsetDesc.getCountryRegionId(i), offsetDesc.getPolarity(i),
+                                            offsetDesc.getLocalTimeOffset(i), offsetDesc.getTimeOfChange(i), offsetDesc.getNextTimeOffset(i));
+                                }
+                            }
+                            else
+                            {
+                                OS_LOG(DVB_TRACE, "<%s> TOT table: local time offset descriptor not found\n", __FUNCTION__);
                             }
-                        }
-                        else
-                        {
-                            OS_LOG(DVB_DEBUG, "<%s> TOT table: local time offset descriptor not found\n", __FUNCTION__);
                         }
                     }
-                }
-                else if(tbl->getTableId() == TableId::BAT)
-                {
-                    BatTable* bat = static_cast<BatTable*>(tbl);
-                    OS_LOG(DVB_DEBUG, "<%s> BAT table received, id: 0x%x, bouquet_id: 0x%x\n", __FUNCTION__, bat->getTableId(), bat->getBouquetId());
-
-                    const std::vector<MpegDescriptor>& bouquetDesc = bat->getBouquetDescriptors();
-                    const MpegDescriptor* d = MpegDescriptor::find(bouquetDesc, DescriptorTag::LOGICAL_CHANNEL);
-                    if(d)
+                    else if(tbl->getTableId() == TableId::BAT)
                     {
-                        LogicalChannelDescriptor lcnDesc(*d);
-                        for(uint8_t i = 0; i < lcnDesc.getCount(); i++)
+                        BatTable* bat = static_cast<BatTable*>(tbl);
+                        OS_LOG(DVB_TRACE, "<%s> BAT table received, id: 0x%x, bouquet_id: 0x%x\n", __FUNCTION__, bat->getTableId(), bat->getBouquetId());
+
+                        const DescriptorList& bouquetDesc = bat->getBouquetDescriptors();
+                        const MpegDescriptor* d = bouquetDesc.find(DescriptorTag::LOGICAL_CHANNEL);
+                        if(d)
+                        {
+                            LogicalChannelDescriptor lcnDesc(*d);
+                            for(uint8_t i = 0; i < lcnDesc.getCount(); i++)
+                            {
+                                OS_LOG(DVB_TRACE, "<%s> BAT table: [%d] service_id = 0x%x, visible = %d, lcn = %d\n",
+                                        __FUNCTION__, i, lcnDesc.getServiceId(i), lcnDesc.isVisible(i), lcnDesc.getLcn(i));
+                            }
+                        }
+                        else
                         {
-                            OS_LOG(DVB_DEBUG, "<%s> BAT table: [%d] service_id = 0x%x, visible = %d, lcn = %d\n",
-                                    __FUNCTION__, i, lcnDesc.getServiceId(i), lcnDesc.isVisible(i), lcnDesc.getLcn(i));
+                            OS_LOG(DVB_TRACE, "<%s> BAT table: logical channel descriptor not found\n", __FUNCTION__);
                         }
-                    }
-                    else
-                    {
-                        OS_LOG(DVB_DEBUG, "<%s> BAT table: logical channel descriptor not found\n", __FUNCTION__);
-                    }
 
 
-                    const std::vector<TransportStream>& tsList = bat->getTransportStreams();
+                        const std::vector<TransportStream>& tsList = bat->getTransportStreams();
 
-                    // Let's iterate through the list of transport streams in order to extract certain ts descriptors
-                    for(auto it = tsList.begin(), end = tsList.end(); it != end; ++it)
-                    {
-                        const std::vector<MpegDescriptor>& tsDescriptors = it->getTsDescriptors();
-                        const MpegDescriptor* desc = MpegDescriptor::find(tsDescriptors, DescriptorTag::SERVICE_LIST);
-                        if(desc)
+                        // Let's iterate through the list of transport streams in order to extract certain ts descriptors
+                        for(auto it = tsList.begin(), end = tsList.end(); it != end; ++it)
                         {
-                            ServiceListDescriptor serviceList(*desc);
-
-                            // Let's dump all the information about all services to the log
-                            for(uint8_t i = 0; i < serviceList.getCount(); i++)
+                            const DescriptorList& tsDescriptors = it->getTsDescriptors();
+                            const MpegDescriptor* desc = tsDescriptors.find(DescriptorTag::SERVICE_LIST);
+                            if(desc)
                             {
-                                OS_LOG(DVB_DEBUG, "<%s> BAT table: service_id = 0x%x, service_type = 0x%x\n",
-                                        __FUNCTION__, serviceList.getServiceId(i), serviceList.getServiceType(i));
+                                ServiceListDescriptor serviceList(*desc);
+
+                                // Let's dump all the information about all services to the log
+                                for(uint8_t i = 0; i < serviceList.getCount(); i++)
+                                {
+                                    OS_LOG(DVB_TRACE, "<%s> BAT table: service_id = 0x%x, service_type = 0x%x\n",
+                                            __FUNCTION__, serviceList.getServiceId(i), serviceList.getServiceType(i));
+                                }
+                            }
+                            else
+                            {
+                                OS_LOG(DVB_TRACE, "<%s> BAT table: service list descriptor not found\n", __FUNCTION__);
                             }
                         }
-                        else
-                        {
-                            OS_LOG(DVB_DEBUG, "<%s> BAT table: service list descriptor not found\n", __FUNCTION__);
-                        }
-                    }
 
+                    }
                 }
 #endif // DVB_TABLE_DEBUG
 
                 // Call platform ipc mechinism (callback)
-                if(m_context && m_sendEventCb)
-                {
-                    // Let's publish the event
-                    m_sendEventCb(m_context, (uint32_t)tbl->getTableId(), tbl, 0);
-                }
+                publish(tbl);
             }
         }
         else // isComplete()
@@ -414,8 +678,5 @@ void SectionParser::parse(uint8_t *data, uint32_t size)
     {
         OS_LOG(DVB_DEBUG, "<%s> Add() returned false\n", __FUNCTION__);
     }
-
-    // clean up
-    delete section;
 }
 
@@ -0,0 +1,142 @@
+//
+// DVB_SI for Reference Design Kit (RDK)
+//
+// Copyright (C) 2015  Dmitry Barablin & Stan Partridge (stan.partridge@arris.com)
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+// End to end replay of a section capture (see SectionCapture.h): the sections go through
+// SectionParser into DvbSiStorage::handleTableEvent() with their original timing, N times faster,
+// or as fast as they go.
+//
+// Usage: replaybench capture [speed [tuner]]
+//
+//   speed  1 for the original timing (default), N for N times faster, 0 for as fast as it goes
+//   tuner  replay the sections of one tuner only
+//
+// The database is FEATURE.DVB.DB_FILENAME; replaybench.db, recreated on every run, if it is not set.
+
+// C system includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <unistd.h>
+
+// C++ system includes
+#include <memory>
+
+// Other libraries' includes
+
+// Project's includes
+#include "dvbsistorage.h"
+#include "sectionparser.h"
+#include "SectionCapture.h"
+#include "SiTablePool.h"
+#include "ParserStats.h"
+
+namespace
+{
+    const double NS_PER_MS = 1e6;
+    const double NS_PER_SECOND = 1e9;
+
+    /**
+     * Storage and its latency per table_id
+     */
+    struct Sink
+    {
+        DvbSiStorage* storage;
+        LatencyHistogram latency[256];
+    };
+
+    /**
+     * Hands the tables published by the parser to the storage
+     */
+    void storeTable(void* context, uint32_t tableId, void* tbl, size_t)
+    {
+        Sink* sink = static_cast<Sink*>(context);
+        SiTablePtr table(static_cast<SiTable*>(tbl));
+
+        uint64_t start = ParserStats::now();
+        sink->storage->handleTableEvent(*table);
+        sink->latency[tableId & 0xff].record(ParserStats::now() - start);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if(argc < 2)
+    {
+        printf("usage: %s capture [speed [tuner]]\n", argv[0]);
+        return 1;
+    }
+    double speed = argc > 2 ? atof(argv[2]) : 1;
+
+    if(!getenv("FEATURE.DVB.DB_FILENAME"))
+    {
+        unlink("replaybench.db");
+        setenv("FEATURE.DVB.DB_FILENAME", "replaybench.db", 1);
+    }
+
+    DvbSiStorage storage;
+    std::unique_ptr<Sink> sink(new Sink);
+    sink->storage = &storage;
+    SectionParser parser(sink.get(), storeTable);
+    parser.setLatencyStatsEnabled(true);
+
+    CaptureReplayer replayer;
+    replayer.setSpeed(speed);
+    if(argc > 3)
+    {
+        replayer.setTuner(atoi(argv[3]));
+    }
+
+    ReplayStats stats;
+    bool ok = replayer.replay(argv[1], parser, stats);
+    if(stats.sections == 0)
+    {
+        printf("%s: no sections replayed\n", argv[1]);
+        return 1;
+    }
+
+    double wall = stats.wallTime / NS_PER_SECOND;
+    printf("replayed %llu sections, %.1f MB%s\n", (unsigned long long)stats.sections, stats.bytes / 1e6,
+           ok ? "" : " (capture damaged, stopped early)");
+    printf("capture %.2f s, replay %.2f s at speed %g: %.1fx real time, %.0f sections/s\n",
+           stats.captureTime / NS_PER_SECOND, wall, speed, stats.captureTime / NS_PER_SECOND / wall,
+           stats.sections / wall);
+    if(speed > 0)
+    {
+        printf("lag behind the capture timing: mean %.3f ms, max %.3f ms\n",
+               stats.totalLag / NS_PER_MS / stats.sections, stats.maxLag / NS_PER_MS);
+    }
+
+    ParserStatsSnapshot parserStats;
+    parser.getStats(parserStats);
+
+    printf("\ntable_id  sections  tables  parse p50/p99 us  store count  store mean/p99/max ms\n");
+    for(auto it = parserStats.tables.begin(), end = parserStats.tables.end(); it != end; ++it)
+    {
+        HistogramSnapshot store;
+        sink->latency[it->tableId].load(store);
+        printf("    0x%02x  %8llu  %6llu  %7.1f / %6.1f  %11llu  %7.3f / %7.3f / %7.3f\n", it->tableId,
+               (unsigned long long)it->counters.received, (unsigned long long)it->counters.completed,
+               it->sectionLatency.getPercentile(50) / 1e3, it->sectionLatency.getPercentile(99) / 1e3,
+               (unsigned long long)store.count, store.getMean() / NS_PER_MS, store.getPercentile(99) / NS_PER_MS,
+               store.max / NS_PER_MS);
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,120 @@
+//
+// DVB_SI for Reference Design Kit (RDK)
+//
+// Copyright (C) 2015  Dmitry Barablin & Stan Partridge (stan.partridge@arris.com)
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+// Fills the SI database from transport stream captures (see TsFileIngest.h): the SI of the
+// captures goes through SectionParser into DvbSiStorage::handleTableEvent(), as if tuned.
+//
+// Usage: tsprefill capture.ts... [-t threads]
+//
+// The database is FEATURE.DVB.DB_FILENAME.
+
+// C system includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+// C++ system includes
+#include <memory>
+
+// Other libraries' includes
+
+// Project's includes
+#include "dvbsistorage.h"
+#include "sectionparser.h"
+#include "TsFileIngest.h"
+#include "SiTablePool.h"
+#include "ParserStats.h"
+
+namespace
+{
+    const double NS_PER_MS = 1e6;
+
+    /**
+     * Storage and its latency per table_id
+     */
+    struct Sink
+    {
+        DvbSiStorage* storage;
+        LatencyHistogram latency[256];
+    };
+
+    /**
+     * Hands the tables published by the parser to the storage
+     */
+    void storeTable(void* context, uint32_t tableId, void* tbl, size_t)
+    {
+        Sink* sink = static_cast<Sink*>(context);
+        SiTablePtr table(static_cast<SiTable*>(tbl));
+
+        uint64_t start = ParserStats::now();
+        sink->storage->handleTableEvent(*table);
+        sink->latency[tableId & 0xff].record(ParserStats::now() - start);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if(argc < 2 || !getenv("FEATURE.DVB.DB_FILENAME"))
+    {
+        printf("usage: FEATURE.DVB.DB_FILENAME=file.db %s capture.ts... [-t threads]\n", argv[0]);
+        return 1;
+    }
+
+    DvbSiStorage storage;
+    std::unique_ptr<Sink> sink(new Sink);
+    sink->storage = &storage;
+    SectionParser parser(sink.get(), storeTable);
+
+    TsFileIngest ingest;
+    int result = 0;
+    for(int i = 1; i < argc; i++)
+    {
+        if(strcmp(argv[i], "-t") == 0 && i + 1 < argc)
+        {
+            ingest.setThreadCount(atoi(argv[++i]));
+            continue;
+        }
+
+        TsIngestStats stats;
+        if(!ingest.ingest(argv[i], parser, stats))
+        {
+            result = 1;
+            continue;
+        }
+        printf("%s: %.1f MB, %llu sections, %llu cc errors in %.2f s\n", argv[i], stats.bytes / 1e6,
+               (unsigned long long)stats.sections, (unsigned long long)stats.discontinuities, stats.time / 1e9);
+    }
+
+    ParserStatsSnapshot parserStats;
+    parser.getStats(parserStats);
+
+    printf("\ntable_id  sections  tables  store mean/p99/max ms\n");
+    for(auto it = parserStats.tables.begin(), end = parserStats.tables.end(); it != end; ++it)
+    {
+        HistogramSnapshot store;
+        sink->latency[it->tableId].load(store);
+        printf("    0x%02x  %8llu  %6llu  %7.3f / %7.3f / %7.3f\n", it->tableId,
+               (unsigned long long)it->counters.received, (unsigned long long)it->counters.completed,
+               store.getMean() / NS_PER_MS, store.getPercentile(99) / NS_PER_MS, store.max / NS_PER_MS);
+    }
+
+    return result;
+}
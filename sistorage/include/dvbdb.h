@@ -26,6 +26,7 @@
 // C++ system includes
 #include <string>
 #include <list>
+#include <vector>
 #include <mutex>
 
 // Other libraries' includes
@@ -34,6 +35,7 @@
 
 // Forward declarations
 class MpegDescriptor;
+class DescriptorList;
 
 /**
  * ElapseTime class. Debug class used for runtime performance measurements.
@@ -269,20 +271,20 @@ class DvbDb
      *
      * @param tablename const char pointer of the name of the descriptor table
      * @param fkey int64_t parent foreign key value
-     * @param descList vector of MpegDescriptors
+     * @param descList list of MpegDescriptors
      * @return int32_t returns the status of the operation 0 if successful, -1 for failure
      */
-    int32_t insertDescriptor(const char* tableName, const int64_t& fkey, const std::vector<MpegDescriptor>& descList);
+    int32_t insertDescriptor(const char* tableName, const int64_t& fkey, const DescriptorList& descList);
 
     /**
      * Insert Component vector of descriptors 
      *
      * @param tablename const char pointer of the name of the descriptor table
      * @param fkey int64_t parent foreign key value
-     * @param descList vector of Component descriptors
+     * @param descList list of Component descriptors
      * @return int32_t returns the status of the operation 0 if successful, -1 for failure
      */
-    int32_t insertComponent(const char* tableName, const int64_t& fkey, const std::vector<MpegDescriptor>& descList);
+    int32_t insertComponent(const char* tableName, const int64_t& fkey, const DescriptorList& descList);
 
     /**
      * Add an update command for processing at a later time.
@@ -39,6 +39,8 @@
 // Project's includes
 #include "dvbdb.h"
 #include "dvbtuner.h"
+#include "TextPool.h"
+#include "TableDiff.h"
 
 /**
  * DvbStorage namespace
@@ -93,20 +95,21 @@ namespace DvbStorage
         Service(uint16_t net,
                 uint16_t ts,
                 uint16_t id,
-                std::string name)
+                const SharedText& name)
           : networkId(net),
             tsId(ts),
             serviceId(id),
-            serviceName(std::move(name))
+            serviceName(name)
         {};
         uint16_t networkId;
         uint16_t tsId;
         uint16_t serviceId;
-        std::string serviceName;
+        SharedText serviceName;
     } Service_t;
 
     /**
      * Event structure. Used to represent an Event from the storage collections.
+     * The texts are shared through the TextPool, repeated titles are stored once.
      */
     typedef struct Event
     {
@@ -116,8 +119,8 @@ namespace DvbStorage
         uint16_t eventId;
         uint64_t startTime;
         uint32_t duration;
-        std::string name;
-        std::string text;
+        SharedText name;
+        SharedText text;
     } Event_t;
 }
 
@@ -129,6 +132,17 @@ class EitTable;
 class TotTable;
 class BatTable;
 class TransportStream;
+class DescriptorList;
+
+/**
+ * TableDelta callback. Called with the differences between a new version of a NIT, BAT, SDT or
+ * EIT and the cached version (all entries added for a table seen for the first time).
+ * Called from the thread handling the table, the delta is only valid during the call.
+ *
+ * @param context calling context
+ * @param delta differences
+ */
+typedef void (*TableDeltaCallback) (void*, const TableDelta&);
 
 /**
  * DvbSiStorage class. Main controller class for collecting and storing DVB SI data.
@@ -262,6 +276,18 @@ public:
      */
     void handleTableEvent(const SiTable& tbl);
 
+    /**
+     * Set the callback receiving the table deltas
+     *
+     * @param context calling context
+     * @param callback callback, NULL to disable
+     */
+    void setDeltaCallback(void* context, TableDeltaCallback callback)
+    {
+        m_deltaContext = context;
+        m_deltaCb = callback;
+    }
+
 private:
     /** 
      * Copy Constructor
@@ -312,29 +338,37 @@ private:
      * Process Nit table for cache storage
      *
      * @param nit Nit table
+     * @param delta filled with the differences to the cached version
+     * @return true if the table is new or a new version (delta is valid), false otherwise
      */
-    void processNitEventCache(const NitTable& nit);
+    bool processNitEventCache(const NitTable& nit, TableDelta& delta);
 
     /**
      * Process Sdt table for cache storage
      *
      * @param sdt Sdt table
+     * @param delta filled with the differences to the cached version
+     * @return true if the table is new or a new version (delta is valid), false otherwise
      */
-    void processSdtEventCache(const SdtTable& sdt);
+    bool processSdtEventCache(const SdtTable& sdt, TableDelta& delta);
 
     /**
      * Process Eit table for cache storage
      *
      * @param eit Eit table
+     * @param delta filled with the differences to the cached version
+     * @return true if the table is new or a new version (delta is valid), false otherwise
      */
-    void processEitEventCache(const EitTable& eit);
+    bool processEitEventCache(const EitTable& eit, TableDelta& delta);
 
     /**
      * Process Bat table for cache storage
      *
      * @param bat Bat table
+     * @param delta filled with the differences to the cached version
+     * @return true if the table is new or a new version (delta is valid), false otherwise
      */
-    void processBatEventCache(const BatTable& bat);
+    bool processBatEventCache(const BatTable& bat, TableDelta& delta);
 
     /**
      * Process Nit table for database storage
@@ -357,6 +391,21 @@ private:
      */
     void processEitEventDb(const EitTable& eit);
 
+    /**
+     * Apply the differences between two versions of an Sdt table to the database
+     *
+     * @param sdt new version of the Sdt table
+     * @param delta differences to the previous version
+     */
+    void applySdtDeltaDb(const SdtTable& sdt, const TableDelta& delta);
+
+    /**
+     * Pass a delta on to the delta callback
+     *
+     * @param delta differences
+     */
+    void notifyDelta(const TableDelta& delta);
+
     /**
      * Process Bat table for database storage
      *
@@ -408,11 +457,11 @@ private:
     /**
      * Process Event Items for parsed database storage
      *
-     * @param descList vector of eit descriptors
+     * @param descList list of eit descriptors
      * @param event_fk foreign key to event
      * @return foreign key
      */
-    int64_t processEventItem(const std::vector<MpegDescriptor>& descList, int64_t event_fk);
+    int64_t processEventItem(const DescriptorList& descList, int64_t event_fk);
 
     /**
      * Start function for monitor thread
@@ -471,6 +520,11 @@ private:
      */
     bool loadSettings();
 
+    /**
+     * Load the code tables of compressed EPG text, if configured
+     */
+    void loadTextTables();
+
     /**
      * Clear out cach collections
      */
@@ -498,9 +552,9 @@ private:
     /** 
      * Sdt map collection
      *
-     * key: onid, tsid, sid, pf
+     * key: onid, tsid, sid, table_id
      */
-    std::map<std::tuple<uint16_t, uint16_t, uint16_t, bool>, std::shared_ptr<EitTable>> m_eitMap;
+    std::map<std::tuple<uint16_t, uint16_t, uint16_t, uint8_t>, std::shared_ptr<EitTable>> m_eitMap;
 
     /** 
      * Sdt map collection
@@ -514,6 +568,16 @@ private:
      */
     std::mutex m_dataMutex;
 
+    /**
+     * TableDelta callback's calling context
+     */
+    void* m_deltaContext;
+
+    /**
+     * TableDelta callback
+     */
+    TableDeltaCallback m_deltaCb;
+
     // DvbScan timeout values
     enum
     {
@@ -30,6 +30,7 @@
 // Project's includes
 #include "oswrap.h"
 #include "MpegDescriptor.h"
+#include "DescriptorList.h"
 #include "ComponentDescriptor.h"
 
 using namespace std;
@@ -927,10 +928,10 @@ vector<shared_ptr<MpegDescriptor>>  DvbDb::findDescriptor(string queryStr)
  *
  * @param tablename const char pointer of the name of the descriptor table
  * @param fkey int64_t parent foreign key value
- * @param descList vector of MpegDescriptors
+ * @param descList list of MpegDescriptors
  * @return int32_t returns the status of the operation 0 if successful, -1 for failure
  */
-int32_t  DvbDb::insertDescriptor(const char* tableName, const int64_t& fkey, const std::vector<MpegDescriptor>& descList)
+int32_t  DvbDb::insertDescriptor(const char* tableName, const int64_t& fkey, const DescriptorList& descList)
 {
     std::lock_guard<std::mutex> lock(m_mutex);
 
@@ -954,7 +955,7 @@ int32_t  DvbDb::insertDescriptor(const char* tableName, const int64_t& fkey, con
 
                 cmd.binder() << static_cast<long long int>(fkey) << static_cast<uint8_t>(md.getTag());
 
-                const std::vector<uint8_t>& descData = md.getData();
+                const DescriptorData& descData = md.getData();
                 cmd.bind(3, static_cast<const void*>(descData.data()), descData.size());
 
                 cmd.execute();
@@ -982,59 +983,57 @@ int32_t  DvbDb::insertDescriptor(const char* tableName, const int64_t& fkey, con
  *
  * @param tablename const char pointer of the name of the descriptor table
  * @param fkey int64_t parent foreign key value
- * @param descList vector of Component descriptors
+ * @param descList list of Component descriptors
  * @return int32_t returns the status of the operation 0 if successful, -1 for failure
  */
-int32_t  DvbDb::insertComponent(const char* tableName, const int64_t& fkey, const std::vector<MpegDescriptor>& descList)
+int32_t  DvbDb::insertComponent(const char* tableName, const int64_t& fkey, const DescriptorList& descList)
 {
     std::lock_guard<std::mutex> lock(m_mutex);
 
     int32_t rc = -1;
 
-    for(auto it = descList.cbegin(); it != descList.cend(); ++it)
+    DescriptorRange components = descList.findAll(DescriptorTag::COMPONENT);
+    for(auto it = components.begin(), end = components.end(); it != end; ++it)
     {
         const MpegDescriptor& md = *it;
-        if(md.getTag() == DescriptorTag::COMPONENT)
-        {
-            ComponentDescriptor cd(md);
-
-            OS_LOG(DVB_DEBUG, "<%s> %s COMPONENT fkey %lld con: %d type: %d tag: %d lang: %s text: %s\n",
-                __FUNCTION__, tableName, fkey, static_cast<int>(cd.getStreamContent()), static_cast<int>(cd.getComponentType()), 
-                static_cast<int>(cd.getComponentTag()), cd.getLanguageCode().c_str(), cd.getText().c_str());
+        ComponentDescriptor cd(md);
 
-            string cmdStr = "INSERT OR IGNORE INTO ";
-            cmdStr += tableName;
-            cmdStr += " (fkey, stream_content, component_type, component_tag, iso_639_language_code, description) " \
-                      " VALUES (?, ?, ?, ?, ?, ?);";
+        OS_LOG(DVB_DEBUG, "<%s> %s COMPONENT fkey %lld con: %d type: %d tag: %d lang: %s text: %s\n",
+            __FUNCTION__, tableName, fkey, static_cast<int>(cd.getStreamContent()), static_cast<int>(cd.getComponentType()), 
+            static_cast<int>(cd.getComponentTag()), cd.getLanguageCode().c_str(), cd.getText().c_str());
 
-            try
-            {
-                command cmd(m_sqlDb, cmdStr.c_str());
+        string cmdStr = "INSERT OR IGNORE INTO ";
+        cmdStr += tableName;
+        cmdStr += " (fkey, stream_content, component_type, component_tag, iso_639_language_code, description) " \
+                  " VALUES (?, ?, ?, ?, ?, ?);";
 
-                cmd.binder() << static_cast<long long int>(fkey)
-                             << static_cast<int>(cd.getStreamContent())
-                             << static_cast<int>(cd.getComponentType())
-                             << static_cast<int>(cd.getComponentTag())
-                             << cd.getLanguageCode()
-                             << cd.getText();
+        try
+        {
+            command cmd(m_sqlDb, cmdStr.c_str());
 
-                cmd.execute();
+            cmd.binder() << static_cast<long long int>(fkey)
+                         << static_cast<int>(cd.getStreamContent())
+                         << static_cast<int>(cd.getComponentType())
+                         << static_cast<int>(cd.getComponentTag())
+                         << cd.getLanguageCode()
+                         << cd.getText();
 
-                int64_t component_fk = last_insert_rowid();
-                OS_LOG(DVB_DEBUG, "<%s> %s component_fk : %lld\n", __FUNCTION__, tableName, component_fk);
-            }
+            cmd.execute();
 
-            catch(std::exception& ex)
-            {
-                OS_LOG(DVB_ERROR, "<%s> - Exception: %s, %s\n", __FUNCTION__, ex.what(), cmdStr.c_str());
-            }
+            int64_t component_fk = last_insert_rowid();
+            OS_LOG(DVB_DEBUG, "<%s> %s component_fk : %lld\n", __FUNCTION__, tableName, component_fk);
+        }
 
-            catch(...)
-            {
-                OS_LOG(DVB_ERROR, "<%s> - Unknown Exception: cmd: %s\n", __FUNCTION__, cmdStr.c_str());
-            }
+        catch(std::exception& ex)
+        {
+            OS_LOG(DVB_ERROR, "<%s> - Exception: %s, %s\n", __FUNCTION__, ex.what(), cmdStr.c_str());
+        }
 
+        catch(...)
+        {
+            OS_LOG(DVB_ERROR, "<%s> - Unknown Exception: cmd: %s\n", __FUNCTION__, cmdStr.c_str());
         }
+
     }
 
     return rc;
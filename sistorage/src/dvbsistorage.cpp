@@ -34,6 +34,7 @@
 #include <sstream>
 #include <chrono>
 #include <string>
+#include <unordered_set>
 
 // Other libraries' includes
 
@@ -55,6 +56,8 @@
 #include "LogicalChannelDescriptor.h"
 #include "ParentalRatingDescriptor.h"
 #include "ContentDescriptor.h"
+#include "DescriptorRegistry.h"
+#include "HuffmanTextDecoder.h"
 
 
 using std::map;
@@ -64,11 +67,44 @@ using std::tuple;
 using std::shared_ptr;
 using std::string;
 
+namespace
+{
+    /**
+     * Compare a table with its cached version. A cached table that only shares the cache key
+     * (e.g. an EIT partial table of another segment) is not a previous version: the new table
+     * is compared with nothing then.
+     *
+     * @param cached cached table, may be NULL
+     * @param tbl new table
+     * @param delta filled with the differences
+     * @param listAdded list the entries of a table without a previous version as added
+     */
+    template<typename Table>
+    void diffWithCache(const Table* cached, const Table& tbl, TableDelta& delta, bool listAdded)
+    {
+        if(cached && TableDiff::diff(cached, tbl, delta))
+        {
+            return;
+        }
+
+        if(listAdded)
+        {
+            TableDiff::diff(static_cast<const Table*>(NULL), tbl, delta);
+        }
+        else
+        {
+            delta.clear();
+        }
+    }
+}
+
 /** 
  * Default Constructor
  */
 DvbSiStorage::DvbSiStorage()
-  : m_preferredNetworkId(0),
+  : m_deltaContext(NULL),
+    m_deltaCb(NULL),
+    m_preferredNetworkId(0),
     m_homeFrequency(0),
     m_homeModulation(DVB_MODULATION_UNKNOWN),
     m_homeSymbolRate(0),
@@ -90,6 +126,8 @@ DvbSiStorage::DvbSiStorage()
         // TODO: Consider throwing an exception here. We can go on without the DB. 
     }
 
+    loadTextTables();
+
     bool changed = loadSettings();
     if(changed)
     {
@@ -134,6 +172,43 @@ DvbSiStorage::DvbSiStorage()
     }
 }
 
+/**
+ * Load the code tables of compressed EPG text, if configured
+ */
+void DvbSiStorage::loadTextTables()
+{
+    // Huffman code tables by encoding_type_id
+    static const struct
+    {
+        uint8_t encodingTypeId;
+        const char* variable;
+    } tables[] =
+    {
+        { 0x01, "FEATURE.DVB.HUFFMAN_TABLE_1" },
+        { 0x02, "FEATURE.DVB.HUFFMAN_TABLE_2" }
+    };
+
+    for(size_t i = 0; i < sizeof(tables) / sizeof(tables[0]); i++)
+    {
+        const char* path = OS_GETENV(tables[i].variable);
+        if(!path || !*path)
+        {
+            continue;
+        }
+
+        shared_ptr<HuffmanTextDecoder> decoder = std::make_shared<HuffmanTextDecoder>();
+        if(decoder->load(path))
+        {
+            TextDecoder::registerDecompressor(tables[i].encodingTypeId, decoder);
+            OS_LOG(DVB_INFO, "<%s> encoding_type_id 0x%x: %s\n", __FUNCTION__, tables[i].encodingTypeId, path);
+        }
+        else
+        {
+            OS_LOG(DVB_ERROR, "<%s> Unable to load %s\n", __FUNCTION__, path);
+        }
+    }
+}
+
 /**
  * Load environmental runtime settings
  *
@@ -357,8 +432,8 @@ vector<shared_ptr<DvbStorage::TransportStream_t>> DvbSiStorage::getTsListByNetId
     const vector<TransportStream>& tsList = it->second->getTransportStreams();
     for(auto it = tsList.begin(), end = tsList.end(); it != end; ++it)
     {
-        const std::vector<MpegDescriptor>& tsDescriptors = it->getTsDescriptors();
-        const MpegDescriptor* desc = MpegDescriptor::find(tsDescriptors, DescriptorTag::CABLE_DELIVERY);
+        const DescriptorList& tsDescriptors = it->getTsDescriptors();
+        const MpegDescriptor* desc = tsDescriptors.find(DescriptorTag::CABLE_DELIVERY);
         if(desc)
         {
             CableDeliverySystemDescriptor cable(*desc);
@@ -477,8 +552,8 @@ vector<shared_ptr<DvbStorage::Service_t>> DvbSiStorage::getServiceListByTsIdCach
     const std::vector<DvbService>& serviceList = it->second->getServices();
     for(auto srv = serviceList.begin(), end = serviceList.end(); srv != end; ++srv)
     {
-        const std::vector<MpegDescriptor>& serviceDescriptors = srv->getServiceDescriptors();
-        const MpegDescriptor* desc = MpegDescriptor::find(serviceDescriptors, DescriptorTag::SERVICE);
+        const DescriptorList& serviceDescriptors = srv->getServiceDescriptors();
+        const MpegDescriptor* desc = serviceDescriptors.find(DescriptorTag::SERVICE);
         if(desc)
         {
             ServiceDescriptor servDesc(*desc);
@@ -542,7 +617,7 @@ vector<shared_ptr<DvbStorage::Service_t>> DvbSiStorage::getServiceListByTsId(uin
             std::stringstream(row.at(0)) >> onId;
             std::stringstream(row.at(1)) >> tsId;
             std::stringstream(row.at(2)) >> serviceId;
-            string serviceName = row.at(3);
+            SharedText serviceName = TextPool::getInstance().intern(row.at(3));
 
             OS_LOG(DVB_DEBUG, "<%s> onId: %d tsId: %d serviceId: %d %s\n", __FUNCTION__, onId, tsId, serviceId, serviceName.c_str());
 
@@ -572,47 +647,58 @@ vector<shared_ptr<DvbStorage::Event_t>> DvbSiStorage::getEventListByServiceIdCac
 
     OS_LOG(DVB_DEBUG, "<%s> called: nid.tsid.sid = 0x%x.0x%x.0x%x\n", __FUNCTION__, nId, tsId, sId);
 
-    tuple<uint16_t, uint16_t, uint16_t, bool> key(nId, tsId, sId, false);
-    auto it = m_eitMap.find(key);
-    if(it == m_eitMap.end())
-    {
-        OS_LOG(DVB_ERROR, "<%s> No EIT found for nid.tsid.sid = 0x%x.0x%x.0x%x\n", __FUNCTION__, nId, tsId, sId);
-        return ret;
-    }
-
-    const std::vector<DvbEvent>& eventList = it->second->getEvents();
-    for(auto e = eventList.begin(), end = eventList.end(); e != end; ++e)
+    // The schedule tables of the service, one per table_id
+    auto it = m_eitMap.lower_bound(tuple<uint16_t, uint16_t, uint16_t, uint8_t>(nId, tsId, sId, 0));
+    auto last = m_eitMap.upper_bound(tuple<uint16_t, uint16_t, uint16_t, uint8_t>(nId, tsId, sId, 0xff));
+    bool found = false;
+    for(; it != last; ++it)
     {
-        OS_LOG(DVB_DEBUG, "<%s> EIT table: event_id = 0x%x, duration = %d, status = %d\n",
-                __FUNCTION__, e->getEventId(), e->getDuration(), e->getRunningStatus());
-
-        const std::vector<MpegDescriptor>& eventDescriptors = e->getEventDescriptors();
-        std::vector<MpegDescriptor> shortList = MpegDescriptor::findAll(eventDescriptors, DescriptorTag::SHORT_EVENT);
+        TableId tableId = it->second->getTableId();
+        if(tableId == TableId::EIT_PF || tableId == TableId::EIT_PF_OTHER)
+        {
+            continue;
+        }
+        found = true;
 
-        for(auto ext_it = shortList.begin(), ext_end = shortList.end(); ext_it != ext_end; ++ext_it)
+        const std::vector<DvbEvent>& eventList = it->second->getEvents();
+        for(auto e = eventList.begin(), end = eventList.end(); e != end; ++e)
         {
-            ShortEventDescriptor eventDesc(*ext_it);
-            OS_LOG(DVB_DEBUG, "<%s> EIT table: lang_code = %s, name = %s, text = %s\n",
-                    __FUNCTION__, eventDesc.getLanguageCode().c_str(), eventDesc.getEventName().c_str(), eventDesc.getText().c_str());
+            OS_LOG(DVB_DEBUG, "<%s> EIT table: event_id = 0x%x, duration = %d, status = %d\n",
+                    __FUNCTION__, e->getEventId(), e->getDuration(), e->getRunningStatus());
 
-            std::shared_ptr<DvbStorage::Event> event(new DvbStorage::Event);
-            event->networkId = it->second->getNetworkId();
-            event->tsId = it->second->getTsId();
-            event->serviceId = it->second->getExtensionId();
-            event->eventId = e->getEventId();
-            event->startTime = e->getStartTime();
-            event->duration = e->getDuration();
-            event->name = eventDesc.getEventName();
-            event->text = eventDesc.getText();
-
-            OS_LOG(DVB_TRACE1, "<%s> nid.tsid.sid = 0x%x.0x%x.0x%x, event id: %d, start time: %"PRId64", duration: %d\n",
-                    __FUNCTION__, nId, tsId, sId, event->eventId, event->startTime, event->duration);
-            OS_LOG(DVB_TRACE1, "<%s> nid.tsid.sid = 0x%x.0x%x.0x%x, event id: %d, event name: %s, text: %s\n",
-                    __FUNCTION__, nId, tsId, sId, event->eventId, event->name.c_str(), event->text.c_str());
-            ret.push_back(event);
+            const DescriptorList& eventDescriptors = e->getEventDescriptors();
+            DescriptorRange shortList = eventDescriptors.findAll(DescriptorTag::SHORT_EVENT);
+
+            for(auto ext_it = shortList.begin(), ext_end = shortList.end(); ext_it != ext_end; ++ext_it)
+            {
+                ShortEventDescriptor eventDesc(*ext_it);
+                OS_LOG(DVB_DEBUG, "<%s> EIT table: lang_code = %s, name = %s, text = %s\n",
+                        __FUNCTION__, eventDesc.getLanguageCode().c_str(), eventDesc.getEventName().c_str(), eventDesc.getText().c_str());
+
+                std::shared_ptr<DvbStorage::Event> event(new DvbStorage::Event);
+                event->networkId = it->second->getNetworkId();
+                event->tsId = it->second->getTsId();
+                event->serviceId = it->second->getExtensionId();
+                event->eventId = e->getEventId();
+                event->startTime = e->getStartTime();
+                event->duration = e->getDuration();
+                event->name = eventDesc.getSharedEventName();
+                event->text = eventDesc.getSharedText();
+
+                OS_LOG(DVB_TRACE1, "<%s> nid.tsid.sid = 0x%x.0x%x.0x%x, event id: %d, start time: %"PRId64", duration: %d\n",
+                        __FUNCTION__, nId, tsId, sId, event->eventId, event->startTime, event->duration);
+                OS_LOG(DVB_TRACE1, "<%s> nid.tsid.sid = 0x%x.0x%x.0x%x, event id: %d, event name: %s, text: %s\n",
+                        __FUNCTION__, nId, tsId, sId, event->eventId, event->name.c_str(), event->text.c_str());
+                ret.push_back(event);
+            }
         }
     }
 
+    if(!found)
+    {
+        OS_LOG(DVB_ERROR, "<%s> No EIT found for nid.tsid.sid = 0x%x.0x%x.0x%x\n", __FUNCTION__, nId, tsId, sId);
+    }
+
     return ret;
 }
 
@@ -672,8 +758,8 @@ vector<shared_ptr<DvbStorage::Event_t>> DvbSiStorage::getEventListByServiceId(ui
             std::stringstream(row.at(3)) >> eventId;
             std::stringstream(row.at(4)) >> startTime;
             std::stringstream(row.at(5)) >> duration;
-            string title = row.at(6);
-            string description = row.at(7);
+            const string& title = row.at(6);
+            const string& description = row.at(7);
 
             OS_LOG(DVB_DEBUG, "<%s> nId: %d tsId: %d serviceId: %d eventId: %d startTime: %lld " \
                                    "duration: %d title length: %u description length: %u\n", __FUNCTION__, nId, tsId, serviceId, 
@@ -686,8 +772,8 @@ vector<shared_ptr<DvbStorage::Event_t>> DvbSiStorage::getEventListByServiceId(ui
             event->eventId = eventId;
             event->startTime = startTime;
             event->duration = duration;
-            event->name = title;
-            event->text = description;
+            event->name = TextPool::getInstance().intern(title);
+            event->text = TextPool::getInstance().intern(description);
 
             ret.push_back(event);
         }
@@ -704,17 +790,27 @@ vector<shared_ptr<DvbStorage::Event_t>> DvbSiStorage::getEventListByServiceId(ui
 void DvbSiStorage::handleNitEvent(const NitTable& nit)
 {
     // TODO: Consider removing one level of handle methods.
-    processNitEventCache(nit);
+    TableDelta delta;
+
+    bool isNew = processNitEventCache(nit, delta);
 
+    // A new NIT version resets the database
     processNitEventDb(nit);
+
+    if(isNew)
+    {
+        notifyDelta(delta);
+    }
 }
 
 /**
  * Process Nit table for cache storage
  *
  * @param nit Nit table
+ * @param delta filled with the differences to the cached version
+ * @return true if the table is new or a new version (delta is valid), false otherwise
  */
-void DvbSiStorage::processNitEventCache(const NitTable& nit)
+bool DvbSiStorage::processNitEventCache(const NitTable& nit, TableDelta& delta)
 {
     std::lock_guard<std::mutex> lock(m_dataMutex);
 
@@ -722,7 +818,9 @@ void DvbSiStorage::processNitEventCache(const NitTable& nit)
     if(it == m_nitMap.end())
     {
         OS_LOG(DVB_DEBUG, "<%s> Adding NIT table to the map. Network id: 0x%x\n", __FUNCTION__, nit.getNetworkId());
+        diffWithCache<NitTable>(NULL, nit, delta, m_deltaCb != NULL);
         m_nitMap.insert(std::make_pair(nit.getNetworkId(), std::make_shared<NitTable>(nit)));
+        return true;
     }
     else
     {
@@ -730,11 +828,14 @@ void DvbSiStorage::processNitEventCache(const NitTable& nit)
         if(nit.getVersion() == it->second->getVersion())
         {
             OS_LOG(DVB_DEBUG, "<%s> NIT version matches (%d). Skipping\n", __FUNCTION__, nit.getVersion());
+            return false;
         }
         else
         {
             OS_LOG(DVB_DEBUG, "<%s> Current version: 0x%x, new version: 0x%x\n", __FUNCTION__, it->second->getVersion(), nit.getVersion());
+            diffWithCache(it->second.get(), nit, delta, m_deltaCb != NULL);
             it->second = std::make_shared<NitTable>(nit);
+            return true;
         }
     }
 
@@ -843,17 +944,26 @@ void DvbSiStorage::processNitEventDb(const NitTable& nit)
  */
 void DvbSiStorage::handleBatEvent(const BatTable& bat)
 {
-    processBatEventCache(bat);
+    TableDelta delta;
+
+    bool isNew = processBatEventCache(bat, delta);
 
     processBatEventDb(bat);
+
+    if(isNew)
+    {
+        notifyDelta(delta);
+    }
 }
 
 /**
  * Process Bat table for cache storage
  *
  * @param bat Bat table
+ * @param delta filled with the differences to the cached version
+ * @return true if the table is new or a new version (delta is valid), false otherwise
  */
-void DvbSiStorage::processBatEventCache(const BatTable& bat)
+bool DvbSiStorage::processBatEventCache(const BatTable& bat, TableDelta& delta)
 {
     std::lock_guard<std::mutex> lock(m_dataMutex);
 
@@ -861,7 +971,9 @@ void DvbSiStorage::processBatEventCache(const BatTable& bat)
     if(it == m_batMap.end())
     {
         OS_LOG(DVB_DEBUG, "<%s> Adding BAT table to the map. Bouquet id: 0x%x\n", __FUNCTION__, bat.getBouquetId());
+        diffWithCache<BatTable>(NULL, bat, delta, m_deltaCb != NULL);
         m_batMap.insert(std::make_pair(bat.getBouquetId(), std::make_shared<BatTable>(bat)));
+        return true;
     }
     else
     {
@@ -869,11 +981,14 @@ void DvbSiStorage::processBatEventCache(const BatTable& bat)
         if(bat.getVersion() == it->second->getVersion())
         {
             OS_LOG(DVB_DEBUG, "<%s> BAT version matches (%d). Skipping\n", __FUNCTION__, bat.getVersion());
+            return false;
         }
         else
         {
             OS_LOG(DVB_DEBUG, "<%s> Current version: 0x%x, new version: 0x%x\n", __FUNCTION__, it->second->getVersion(), bat.getVersion());
+            diffWithCache(it->second.get(), bat, delta, m_deltaCb != NULL);
             it->second = std::make_shared<BatTable>(bat);
+            return true;
         }
     }
 }
@@ -1022,17 +1137,33 @@ void DvbSiStorage::processBatEventDb(const BatTable& bat)
  */
 void DvbSiStorage::handleSdtEvent(const SdtTable& sdt)
 {
-    processSdtEventCache(sdt);
+    TableDelta delta;
+
+    bool isNew = processSdtEventCache(sdt, delta);
+    if(isNew && delta.oldVersion != TableDelta::NO_VERSION)
+    {
+        // Only the entries that changed are written
+        applySdtDeltaDb(sdt, delta);
+    }
+    else
+    {
+        processSdtEventDb(sdt);
+    }
 
-    processSdtEventDb(sdt);
+    if(isNew)
+    {
+        notifyDelta(delta);
+    }
 }
 
 /**
  * Process Sdt table for cache storage
  *
  * @param sdt Sdt table
+ * @param delta filled with the differences to the cached version
+ * @return true if the table is new or a new version (delta is valid), false otherwise
  */
-void DvbSiStorage::processSdtEventCache(const SdtTable& sdt)
+bool DvbSiStorage::processSdtEventCache(const SdtTable& sdt, TableDelta& delta)
 {
     std::lock_guard<std::mutex> lock(m_dataMutex);
 
@@ -1041,7 +1172,9 @@ void DvbSiStorage::processSdtEventCache(const SdtTable& sdt)
     if(it == m_sdtMap.end())
     {
         OS_LOG(DVB_DEBUG, "<%s> Adding SDT table to the cache. nid.tsid: 0x%x.0x%x\n", __FUNCTION__, sdt.getOriginalNetworkId(), sdt.getExtensionId());
+        diffWithCache<SdtTable>(NULL, sdt, delta, m_deltaCb != NULL);
         m_sdtMap.insert(std::make_pair(key, std::make_shared<SdtTable>(sdt)));
+        return true;
     }
     else
     {
@@ -1049,11 +1182,14 @@ void DvbSiStorage::processSdtEventCache(const SdtTable& sdt)
         if(sdt.getVersion() == it->second->getVersion())
         {
             OS_LOG(DVB_DEBUG, "<%s> SDT version matches (0x%x). Skipping\n", __FUNCTION__, sdt.getVersion());
+            return false;
         }
         else
         {
             OS_LOG(DVB_DEBUG, "<%s> Current version: 0x%x, new version: 0x%x\n", __FUNCTION__, it->second->getVersion(), sdt.getVersion());
+            diffWithCache(it->second.get(), sdt, delta, m_deltaCb != NULL);
             it->second = std::make_shared<SdtTable>(sdt);
+            return true;
         }
     }
 }
@@ -1183,6 +1319,129 @@ void DvbSiStorage::processSdtEventDb(const SdtTable& sdt)
     m_db.performUpdate();
 }
 
+/**
+ * Apply the differences between two versions of an Sdt table to the database.
+ * Services that did not change only get the new version number. Changed services are
+ * rewritten, their events are kept; removed services are deleted with their events.
+ *
+ * @param sdt new version of the Sdt table
+ * @param delta differences to the previous version
+ */
+void DvbSiStorage::applySdtDeltaDb(const SdtTable& sdt, const TableDelta& delta)
+{
+    std::unordered_set<uint16_t> touched;
+    SdtTable changed(static_cast<uint8_t>(sdt.getTableId()), sdt.getExtensionId(), sdt.getVersion(), sdt.isCurrent());
+    changed.setOriginalNetworkId(sdt.getOriginalNetworkId());
+
+    bool eventsRemoved = false;
+
+    for(auto it = delta.services.begin(), end = delta.services.end(); it != end; ++it)
+    {
+        uint16_t serviceId = it->service.getServiceId();
+        touched.insert(serviceId);
+
+        if(it->kind != DeltaKind::ADDED)
+        {
+            DvbDb::Command cmd(m_db, string("DELETE FROM Sdt WHERE service_id = ? AND nit_transport_fk IN " \
+                                         " (SELECT nit_transport_pk FROM NitTransport "                    \
+                                         "  WHERE original_network_id = ? AND transport_id = ?);"));
+            cmd.bind(1, static_cast<int>(serviceId));
+            cmd.bind(2, static_cast<int>(sdt.getOriginalNetworkId()));
+            cmd.bind(3, static_cast<int>(sdt.getExtensionId()));
+            cmd.execute();
+
+            DvbDb::Command serviceCmd(m_db, string("DELETE FROM Service WHERE service_id = ? AND transport_fk IN " \
+                                                " (SELECT transport_pk FROM Transport "                        \
+                                                "  WHERE original_network_id = ? AND transport_id = ?);"));
+            serviceCmd.bind(1, static_cast<int>(serviceId));
+            serviceCmd.bind(2, static_cast<int>(sdt.getOriginalNetworkId()));
+            serviceCmd.bind(3, static_cast<int>(sdt.getExtensionId()));
+            serviceCmd.execute();
+        }
+
+        if(it->kind == DeltaKind::REMOVED)
+        {
+            OS_LOG(DVB_DEBUG, "<%s> Service removed. nid.tsid.sid: 0x%x.0x%x.0x%x\n",
+                    __FUNCTION__, sdt.getOriginalNetworkId(), sdt.getExtensionId(), serviceId);
+
+            DvbDb::Command eitCmd(m_db, string("DELETE FROM Eit WHERE network_id = ? AND transport_id = ? AND service_id = ?;"));
+            eitCmd.bind(1, static_cast<int>(sdt.getOriginalNetworkId()));
+            eitCmd.bind(2, static_cast<int>(sdt.getExtensionId()));
+            eitCmd.bind(3, static_cast<int>(serviceId));
+            eitCmd.execute();
+
+            DvbDb::Command eventCmd(m_db, string("DELETE FROM Event WHERE network_id = ? AND transport_id = ? AND service_id = ?;"));
+            eventCmd.bind(1, static_cast<int>(sdt.getOriginalNetworkId()));
+            eventCmd.bind(2, static_cast<int>(sdt.getExtensionId()));
+            eventCmd.bind(3, static_cast<int>(serviceId));
+            eventCmd.execute();
+
+            eventsRemoved = true;
+        }
+        else
+        {
+            OS_LOG(DVB_DEBUG, "<%s> Service %s. nid.tsid.sid: 0x%x.0x%x.0x%x, changes: 0x%x\n", __FUNCTION__,
+                    it->kind == DeltaKind::ADDED ? "added" : "changed",
+                    sdt.getOriginalNetworkId(), sdt.getExtensionId(), serviceId, it->changes);
+            changed.addService(it->service);
+        }
+    }
+
+    m_db.sqlCommand(string("DELETE FROM SdtDescriptor WHERE fkey NOT IN (SELECT DISTINCT sdt_pk FROM Sdt);"));
+    m_db.sqlCommand(string("DELETE FROM ServiceComponent WHERE fkey NOT IN (SELECT DISTINCT service_pk FROM Service);"));
+
+    if(eventsRemoved)
+    {
+        m_db.sqlCommand(string("DELETE FROM EitDescriptor WHERE fkey NOT IN (SELECT DISTINCT eit_pk FROM Eit);"));
+        m_db.sqlCommand(string("DELETE FROM EventItem WHERE event_fk NOT IN (SELECT DISTINCT event_pk FROM Event);"));
+        m_db.sqlCommand(string("DELETE FROM EventComponent WHERE fkey NOT IN (SELECT DISTINCT event_pk FROM Event);"));
+    }
+
+    // The unchanged services only get the new version number
+    std::stringstream ids;
+    int32_t unchanged = 0;
+    const std::vector<DvbService>& serviceList = sdt.getServices();
+    for(auto it = serviceList.begin(), end = serviceList.end(); it != end; ++it)
+    {
+        if(touched.find(it->getServiceId()) == touched.end())
+        {
+            ids << (unchanged++ ? ", " : "") << it->getServiceId();
+        }
+    }
+
+    bool complete = true;
+    if(unchanged > 0)
+    {
+        std::stringstream ss;
+        ss << "UPDATE Sdt SET version = " << static_cast<int>(sdt.getVersion())
+           << " WHERE service_id IN (" << ids.str() << ") AND nit_transport_fk IN "
+           << "(SELECT nit_transport_pk FROM NitTransport WHERE original_network_id = " << sdt.getOriginalNetworkId()
+           << " AND transport_id = " << sdt.getExtensionId() << ");";
+        m_db.sqlCommand(ss.str());
+        complete = (m_db.modifications() == unchanged);
+
+        ss.str("");
+        ss << "UPDATE Service SET version = " << static_cast<int>(sdt.getVersion())
+           << " WHERE service_id IN (" << ids.str() << ") AND transport_fk IN "
+           << "(SELECT transport_pk FROM Transport WHERE original_network_id = " << sdt.getOriginalNetworkId()
+           << " AND transport_id = " << sdt.getExtensionId() << ");";
+        m_db.sqlCommand(ss.str());
+        complete = complete && (m_db.modifications() == unchanged);
+    }
+
+    if(!complete)
+    {
+        // The database did not hold the previous version (e.g. the transport was not known yet)
+        OS_LOG(DVB_DEBUG, "<%s> Previous version incomplete in the database. nid.tsid: 0x%x.0x%x\n",
+                __FUNCTION__, sdt.getOriginalNetworkId(), sdt.getExtensionId());
+        processSdtEventDb(sdt);
+    }
+    else if(!changed.getServices().empty())
+    {
+        processSdtEventDb(changed);
+    }
+}
+
 /**
  * Handle Eit table
  *
@@ -1190,35 +1449,45 @@ void DvbSiStorage::processSdtEventDb(const SdtTable& sdt)
  */
 void DvbSiStorage::handleEitEvent(const EitTable& eit)
 {
-    processEitEventCache(eit);
+    TableDelta delta;
 
+    // The Eit/Event rows are keyed by event_id only and an event can be carried by several
+    // table_ids (p/f and schedule, two schedule tables across a day rollover): a removed event
+    // cannot be told apart from one another sub-table owns, so EIT is always written in full
+    bool isNew = processEitEventCache(eit, delta);
     processEitEventDb(eit);
+
+    if(isNew)
+    {
+        notifyDelta(delta);
+    }
 }
 
 /**
  * Process Eit table for cache storage
  *
  * @param eit Eit table
+ * @param delta filled with the differences to the cached version
+ * @return true if the table is new or a new version (delta is valid), false otherwise
  */
-void DvbSiStorage::processEitEventCache(const EitTable& eit)
+bool DvbSiStorage::processEitEventCache(const EitTable& eit, TableDelta& delta)
 {
     std::lock_guard<std::mutex> lock(m_dataMutex);
 
-    bool isPf = false;
-    TableId tableId = eit.getTableId();
-    if(tableId == TableId::EIT_PF || tableId == TableId::EIT_PF_OTHER)
-    {
-        isPf = true;
-    }
-
-    tuple<uint16_t, uint16_t, uint16_t, bool> key(eit.getNetworkId(), eit.getTsId(), eit.getExtensionId(), isPf);
+    // Every table_id is a sub-table of its own, with its own versions
+    tuple<uint16_t, uint16_t, uint16_t, uint8_t> key(eit.getNetworkId(), eit.getTsId(), eit.getExtensionId(),
+                                                      static_cast<uint8_t>(eit.getTableId()));
     auto it = m_eitMap.find(key);
     if(it == m_eitMap.end())
     {
         OS_LOG(DVB_DEBUG, "<%s> Adding EIT table to the cache. nid.tsid.sid: 0x%x.0x%x.0x%x\n",
                 __FUNCTION__, eit.getNetworkId(), eit.getTsId(), eit.getExtensionId());
 
+        diffWithCache<EitTable>(NULL, eit, delta, m_deltaCb != NULL);
+
         m_eitMap.insert(std::make_pair(key, std::make_shared<EitTable>(eit)));
+
+        return true;
     }
     else
     {
@@ -1226,11 +1495,14 @@ void DvbSiStorage::processEitEventCache(const EitTable& eit)
         if(eit.getVersion() == it->second->getVersion())
         {
             OS_LOG(DVB_DEBUG, "<%s> EIT version matches (0x%x). Skipping\n", __FUNCTION__, eit.getVersion());
+            return false;
         }
         else
         {
             OS_LOG(DVB_DEBUG, "<%s> Current version: 0x%x, new version: 0x%x\n", __FUNCTION__, it->second->getVersion(), eit.getVersion());
+            diffWithCache(it->second.get(), eit, delta, m_deltaCb != NULL);
             it->second = std::make_shared<EitTable>(eit);
+            return true;
         }
     }
 }
@@ -1327,6 +1599,23 @@ void DvbSiStorage::processEitEventDb(const EitTable& eit)
     } 
 }
 
+/**
+ * Pass a delta on to the delta callback
+ *
+ * @param delta differences
+ */
+void DvbSiStorage::notifyDelta(const TableDelta& delta)
+{
+    if(m_deltaCb && !delta.empty())
+    {
+        OS_LOG(DVB_DEBUG, "<%s> table id: 0x%x, ext id: 0x%x, version: %d -> %d, transports: %u, services: %u, events: %u\n",
+                __FUNCTION__, delta.tableId, delta.extensionId, delta.oldVersion, delta.newVersion,
+                static_cast<uint32_t>(delta.transports.size()), static_cast<uint32_t>(delta.services.size()),
+                static_cast<uint32_t>(delta.events.size()));
+        m_deltaCb(m_deltaContext, delta);
+    }
+}
+
 /**
  * Process Nit table for parsed database storage
  *
@@ -1336,25 +1625,26 @@ void DvbSiStorage::processEitEventDb(const EitTable& eit)
 int64_t  DvbSiStorage::processNetwork(const NitTable& nit)
 {
     int64_t network_fk = -1;
-    string networkName;
-    string iso639languageCode;
 
-    const vector<MpegDescriptor>& descList = nit.getNetworkDescriptors();
-
-    for(auto it = descList.cbegin(); it != descList.cend(); ++it)
+    // The network name descriptor wins, the descriptors after it are ignored
+    struct NetworkNameVisitor
     {
-        const MpegDescriptor& md = *it;
-        if(md.getTag() == DescriptorTag::NETWORK_NAME)
+        string networkName;
+        string iso639languageCode;
+        bool found;
+
+        void visit(const NetworkNameDescriptor& nnd)
         {
-            NetworkNameDescriptor nnd(md);
-            networkName = nnd.getName();
-            break;
+            if(!found)
+            {
+                networkName = nnd.getName();
+                found = true;
+            }
         }
 
-        if(md.getTag() == DescriptorTag::MULTILINGUAL_NETWORK_NAME)
+        void visit(const MultilingualNetworkNameDescriptor& mnnd)
         {
-            MultilingualNetworkNameDescriptor  mnnd(md);
-            for(int32_t i=0; i < mnnd.getCount(); i++)
+            for(int32_t i=0; !found && i < mnnd.getCount(); i++)
             {
                 iso639languageCode += mnnd.getLanguageCode(i);
                 iso639languageCode += " ";
@@ -1362,7 +1652,13 @@ int64_t  DvbSiStorage::processNetwork(const NitTable& nit)
                 networkName += " ";
             }
         }
-    }
+    } visitor;
+
+    visitor.found = false;
+    visitDescriptors(nit.getNetworkDescriptors(), visitor);
+
+    string& networkName = visitor.networkName;
+    string& iso639languageCode = visitor.iso639languageCode;
 
     DvbDb::Command cmd(m_db, string("INSERT OR IGNORE INTO Network (network_id, version, iso_639_language_code, name) " \
                                  " VALUES (?, ?, ?, ?);"));
@@ -1434,24 +1730,19 @@ int64_t  DvbSiStorage::processBouquet(const BatTable& bat)
 
     if(bouquet_fk < 1)  // NOT FOUND
     {
-        string networkName;
-        string iso639languageCode;
-
         // Either a Network Name descriptor or a Multilingual Network descriptor exists. 
-        const vector<MpegDescriptor>& descList = bat.getBouquetDescriptors();
-
-        for(auto it = descList.cbegin(); it != descList.cend(); ++it)
+        struct BouquetNameVisitor
         {
-            const MpegDescriptor& md = *it;
-            if(md.getTag() == DescriptorTag::NETWORK_NAME)
+            string networkName;
+            string iso639languageCode;
+
+            void visit(const NetworkNameDescriptor& nnd)
             {
-                NetworkNameDescriptor nnd(md);
                 networkName += nnd.getName();
             }
 
-            if(md.getTag() == DescriptorTag::MULTILINGUAL_NETWORK_NAME)
+            void visit(const MultilingualNetworkNameDescriptor& mnnd)
             {
-                MultilingualNetworkNameDescriptor  mnnd(md);
                 for(int32_t i=0; i < mnnd.getCount(); i++)
                 {
                     iso639languageCode += mnnd.getLanguageCode(i);
@@ -1460,7 +1751,12 @@ int64_t  DvbSiStorage::processBouquet(const BatTable& bat)
                     networkName += " ";
                 }
             }
-        }
+        } visitor;
+
+        visitDescriptors(bat.getBouquetDescriptors(), visitor);
+
+        string& networkName = visitor.networkName;
+        string& iso639languageCode = visitor.iso639languageCode;
 
         OS_LOG(DVB_DEBUG, "<%s> bouquet_id: %d version: %d networkName: %s iso: %s\n", __FUNCTION__, bat.getBouquetId(), bat.getVersion(), networkName.c_str(), iso639languageCode.c_str());
 
@@ -1557,20 +1853,16 @@ int64_t  DvbSiStorage::processTransport(const TransportStream& ts, int64_t netwo
     uint8_t  fecInner = 0;
     uint8_t  fecOuter = 0;
 
-    const vector<MpegDescriptor>& tsDesc = ts.getTsDescriptors();
+    DescriptorRange cableList = ts.getTsDescriptors().findAll(DescriptorTag::CABLE_DELIVERY);
 
-    for(auto it = tsDesc.cbegin(); it != tsDesc.cend(); ++it)
+    for(auto it = cableList.begin(), end = cableList.end(); it != end; ++it)
     {
-        const MpegDescriptor& md = *it;
-        if(md.getTag() == DescriptorTag::CABLE_DELIVERY)
-        {
-            CableDeliverySystemDescriptor cable(md);
-            frequency = cable.getFrequency();
-            modulation = static_cast<uint8_t>(mapModulationMode((DVBConstellation)cable.getModulation()));
-            symbolRate = cable.getSymbolRate();
-            fecInner = cable.getFecInner();
-            fecOuter = cable.getFecOuter();
-        }
+        CableDeliverySystemDescriptor cable(*it);
+        frequency = cable.getFrequency();
+        modulation = static_cast<uint8_t>(mapModulationMode((DVBConstellation)cable.getModulation()));
+        symbolRate = cable.getSymbolRate();
+        fecInner = cable.getFecInner();
+        fecOuter = cable.getFecOuter();
     }
 
     DvbDb::Command cmd(m_db, string("INSERT OR IGNORE INTO Transport (original_network_id, transport_id, network_fk, frequency, " \
@@ -1688,29 +1980,34 @@ int64_t  DvbSiStorage::processService(const SdtTable& sdt)
 
         if(service_fk < 1)  // NOT found
         {
-            uint8_t serviceType = 0;
-            uint16_t lcn = 0;
-            string serviceName;
-            string providerName;
-
-            const vector<MpegDescriptor>& serveDesc = service.getServiceDescriptors();
-
-            for(auto it = serveDesc.cbegin(); it != serveDesc.cend(); ++it)
+            struct ServiceVisitor
             {
-                const MpegDescriptor& md = *it;
-                if(md.getTag() == DescriptorTag::LOGICAL_CHANNEL)
+                uint8_t serviceType;
+                uint16_t lcn;
+                string serviceName;
+                string providerName;
+
+                void visit(const LogicalChannelDescriptor& lcd)
                 {
-                    LogicalChannelDescriptor lcd(md);
                     lcn = lcd.getLcn(0);
                 }
-                if(md.getTag() == DescriptorTag::SERVICE)
+
+                void visit(const ServiceDescriptor& sd)
                 {
-                    ServiceDescriptor sd(md);
                     serviceType = sd.getServiceType();
                     serviceName = sd.getServiceName();
                     providerName = sd.getServiceProviderName();
                 }
-            }
+            } visitor;
+
+            visitor.serviceType = 0;
+            visitor.lcn = 0;
+            visitDescriptors(service.getServiceDescriptors(), visitor);
+
+            uint8_t serviceType = visitor.serviceType;
+            uint16_t lcn = visitor.lcn;
+            string& serviceName = visitor.serviceName;
+            string& providerName = visitor.providerName;
 
             DvbDb::Command cmd(m_db, string("INSERT OR IGNORE INTO Service (service_id, transport_fk, version, service_type, " \
                                          "logical_channel_number, running, scrambled, schedule, present_following, "        \
@@ -1843,17 +2140,13 @@ int64_t  DvbSiStorage::processEvent(const EitTable& eit)
 
         if(event_fk < 1)  // NOT FOUND
         {
-            string parentalRating;
-            string content;
-
-            const vector<MpegDescriptor>& eventDesc = event.getEventDescriptors();
-
-            for(auto it = eventDesc.cbegin(); it != eventDesc.cend(); ++it)
+            struct EventVisitor
             {
-                const MpegDescriptor& md = *it;
-                if(md.getTag() == DescriptorTag::CONTENT_DESCRIPTOR)
+                string parentalRating;
+                string content;
+
+                void visit(const ContentDescriptor& cd)
                 {
-                    ContentDescriptor cd(md);
                     for(int i=0; i < cd.getCount(); i++)
                     {
                         string conStr("(");
@@ -1869,9 +2162,9 @@ int64_t  DvbSiStorage::processEvent(const EitTable& eit)
                         content += ")";
                     }
                 }
-                if(md.getTag() == DescriptorTag::PARENTAL_RATING)
+
+                void visit(const ParentalRatingDescriptor& prd)
                 {
-                    ParentalRatingDescriptor prd(md);
                     for(int i=0; i < prd.getCount(); i++)
                     {
                         parentalRating += "(";
@@ -1884,7 +2177,12 @@ int64_t  DvbSiStorage::processEvent(const EitTable& eit)
                         parentalRating += ")";
                     }
                 }
-            }
+            } visitor;
+
+            visitDescriptors(event.getEventDescriptors(), visitor);
+
+            string& parentalRating = visitor.parentalRating;
+            string& content = visitor.content;
 
             DvbDb::Command cmd(m_db, string("INSERT OR IGNORE INTO Event (network_id, transport_id, service_id, event_id, " \
                                          "version, start_time, duration, scrambled, running, parental_rating, content) " \
@@ -1936,63 +2234,61 @@ int64_t  DvbSiStorage::processEvent(const EitTable& eit)
 /**
  * Process Event Items for parsed database storage
  *
- * @param descList vector of eit descriptors
+ * @param descList list of eit descriptors
  * @param event_fk foreign key to event
  * @return foreign key
  */
-int64_t  DvbSiStorage::processEventItem(const vector<MpegDescriptor>& descList, int64_t event_fk)
+int64_t  DvbSiStorage::processEventItem(const DescriptorList& descList, int64_t event_fk)
 {
     int64_t eventItem_fk = -1; 
     string iso_639_language_code;
     string title;
     string description;
 
-    for(auto it = descList.cbegin(); it != descList.cend(); ++it)
+    DescriptorRange shortList = descList.findAll(DescriptorTag::SHORT_EVENT);
+    for(auto it = shortList.begin(), end = shortList.end(); it != end; ++it)
     {
         const MpegDescriptor& md = *it;
-        if(md.getTag() == DescriptorTag::SHORT_EVENT)
-        {
-            ShortEventDescriptor sed(md);
+        ShortEventDescriptor sed(md);
 
-            iso_639_language_code = sed.getLanguageCode();
-            title = sed.getEventName();
-            description = sed.getText();
+        iso_639_language_code = sed.getLanguageCode();
+        title = sed.getEventName();
+        description = sed.getText();
 
-            DvbDb::Command cmd(m_db, string("INSERT OR IGNORE INTO EventItem (event_fk, iso_639_language_code, title, description) " \
-                                         "VALUES (?, ?, ?, ?);"));
+        DvbDb::Command cmd(m_db, string("INSERT OR IGNORE INTO EventItem (event_fk, iso_639_language_code, title, description) " \
+                                     "VALUES (?, ?, ?, ?);"));
 
-            cmd.bind(1, (long long int)event_fk);
-            if(iso_639_language_code.empty())
-            {
-                cmd.bind(2);
-            }
-            else
-            {
-                cmd.bind(2, iso_639_language_code);
-            }
-               
-            if(title.empty())
-            {
-                cmd.bind(3);
-            }
-            else
-            {
-                cmd.bind(3, title);
-            }
-               
-            if(description.empty())
-            {
-                cmd.bind(4);
-            }
-            else
-            {
-                cmd.bind(4, description);
-            }
+        cmd.bind(1, (long long int)event_fk);
+        if(iso_639_language_code.empty())
+        {
+            cmd.bind(2);
+        }
+        else
+        {
+            cmd.bind(2, iso_639_language_code);
+        }
+           
+        if(title.empty())
+        {
+            cmd.bind(3);
+        }
+        else
+        {
+            cmd.bind(3, title);
+        }
+           
+        if(description.empty())
+        {
+            cmd.bind(4);
+        }
+        else
+        {
+            cmd.bind(4, description);
+        }
 
-            cmd.execute(eventItem_fk);
+        cmd.execute(eventItem_fk);
 
-            OS_LOG(DVB_DEBUG, "<%s> Insert eventItem_fk: %lld\n", __FUNCTION__, eventItem_fk);
-        }
+        OS_LOG(DVB_DEBUG, "<%s> Insert eventItem_fk: %lld\n", __FUNCTION__, eventItem_fk);
     }
 
     return  eventItem_fk; 
@@ -2601,18 +2897,13 @@ bool DvbSiStorage::checkTables(vector<shared_ptr<SiTable>>& tables, int timeout)
             }
             else if((tableId >= TableId::EIT_PF) && (tableId <= TableId::EIT_SCHED_OTHER_END))
             {
-                bool isPf = false;
-                if(tableId == TableId::EIT_PF || tableId == TableId::EIT_PF_OTHER)
-                {
-                    isPf = true;
-                }
-
                 shared_ptr<EitTable> eit = std::static_pointer_cast<EitTable>((*tbl));
 
-                OS_LOG(DVB_DEBUG, "%s:%d: Looking for EIT(0x%x.0x%x.0x%x) isPF: %d\n",
-                        __FUNCTION__, __LINE__, eit->getNetworkId(), eit->getTsId(), eit->getExtensionId(), isPf);
+                OS_LOG(DVB_DEBUG, "%s:%d: Looking for EIT(0x%x.0x%x.0x%x) table id: 0x%x\n",
+                        __FUNCTION__, __LINE__, eit->getNetworkId(), eit->getTsId(), eit->getExtensionId(), static_cast<int>(tableId));
 
-                tuple<uint16_t, uint16_t, uint16_t, bool> key(eit->getNetworkId(), eit->getTsId(), eit->getExtensionId(), isPf);
+                tuple<uint16_t, uint16_t, uint16_t, uint8_t> key(eit->getNetworkId(), eit->getTsId(), eit->getExtensionId(),
+                                                                  static_cast<uint8_t>(tableId));
                 auto it = m_eitMap.find(key);
                 if(it == m_eitMap.end())
                 {
@@ -2621,8 +2912,8 @@ bool DvbSiStorage::checkTables(vector<shared_ptr<SiTable>>& tables, int timeout)
                 }
                 else
                 {
-                    OS_LOG(DVB_DEBUG, "%s:%d: Looking for EIT(0x%x.0x%x.0x%x) isPF: %d found\n",
-                            __FUNCTION__, __LINE__, eit->getNetworkId(), eit->getTsId(), eit->getExtensionId(), isPf);
+                    OS_LOG(DVB_DEBUG, "%s:%d: Looking for EIT(0x%x.0x%x.0x%x) table id: 0x%x found\n",
+                            __FUNCTION__, __LINE__, eit->getNetworkId(), eit->getTsId(), eit->getExtensionId(), static_cast<int>(tableId));
                 }
             }
         }